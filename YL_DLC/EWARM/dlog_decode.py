@@ -0,0 +1,97 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""Text of the deferred binary event log (DebugLog.h) read out with READLOG.
+
+    python dlog_decode.py DebugLog.h [capture.txt]
+    python dlog_decode.py DebugLog.h --table
+
+The message table is read from DLOG_MESSAGES of DebugLog.h, the id of a message
+is its position. Use the DebugLog.h of the firmware that wrote the log. The
+capture is the terminal output of READLOG (stdin without file), other lines are
+ignored. --table prints the ids and texts, e.g. to keep them with a release.
+"""
+
+import re
+import sys
+
+MESSAGE = re.compile(r'X\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+HEADER = re.compile(r'^LOG,(\d+),(\d+),(\d+)\s*$')
+RECORD = re.compile(r'^([0-9A-Fa-f]{4}),([0-9A-Fa-f]{8}),([0-9A-Fa-f]+),([0-9A-Fa-f]{8}),([0-9A-Fa-f]{8})\s*$')
+CONVERSION = re.compile(r'%[-+ #0]*\d*(?:\.\d+)?([diuxXc%])')
+
+
+def read_table(header_path):
+    """list of (name, text), index = message id"""
+    with open(header_path, 'rb') as f:
+        text = f.read().decode('latin-1')
+    start = text.find('#define DLOG_MESSAGES')
+    if start < 0:
+        raise ValueError('no DLOG_MESSAGES in ' + header_path)
+    # the macro ends at the first line without continuation
+    body = []
+    for line in text[start:].splitlines():
+        body.append(line)
+        if not line.rstrip().endswith('\\'):
+            break
+    return MESSAGE.findall('\n'.join(body))
+
+
+def signed32(value):
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def format_message(table, msg_id, args):
+    if msg_id >= len(table):
+        return 'unknown message id %d, args 0x%08X 0x%08X' % (msg_id, args[0], args[1])
+    name, text = table[msg_id]
+    values = []
+    for conversion in CONVERSION.findall(text):
+        if conversion == '%':
+            continue
+        value = args[len(values)] if len(values) < len(args) else 0
+        values.append(signed32(value) if conversion in 'di' else value)
+    return '%-18s %s' % (name, text % tuple(values))
+
+
+def decode(table, lines, out):
+    expected_seq = None
+    for line in lines:
+        line = line.strip()
+        m = HEADER.match(line)
+        if m:
+            count, ids, records = (int(x) for x in m.groups())
+            out.write('%d records written, %d in the ring\n' % (count, records))
+            if ids != len(table):
+                out.write('warning: the firmware has %d message ids, the table %d\n' % (ids, len(table)))
+            expected_seq = None
+            continue
+        m = RECORD.match(line)
+        if not m:
+            continue
+        seq, time_us, msg_id, arg0, arg1 = (int(x, 16) for x in m.groups())
+        if expected_seq is not None and seq != expected_seq:
+            out.write('  ... %d records lost\n' % ((seq - expected_seq) & 0xFFFF))
+        expected_seq = (seq + 1) & 0xFFFF
+        out.write('%5d %11.6f  %s\n' % (seq, time_us / 1e6, format_message(table, msg_id, (arg0, arg1))))
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 2
+    table = read_table(argv[1])
+    if len(argv) > 2 and argv[2] == '--table':
+        for msg_id, (name, text) in enumerate(table):
+            print('%3d  %-18s %s' % (msg_id, name, text))
+        return 0
+    if len(argv) > 2:
+        with open(argv[2], 'rb') as f:
+            lines = f.read().decode('latin-1').splitlines()
+    else:
+        lines = sys.stdin.read().splitlines()
+    decode(table, lines, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,368 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""Poll rate and response times of a multi-drop RS485 line of YL_DLC scales.
+
+    python mb_bus_model.py [options]
+    python mb_bus_model.py --slaves 15 --baud 38400 --regs 8
+    python mb_bus_model.py --slaves 8 --hist 0,0,0,120,3400,210,0,0,0,0
+
+A Modbus RTU master polls --slaves scales round robin with FC03 over
+--regs registers on one half-duplex line. Every scale is the firmware
+itself: a copy of Host/build/libyl_dlc.so (make in Host/, see Host/Inc/Host.h)
+booted by HOST_Boot() with virtual time, its address on the address pins
+and COM1 on the line of the model. The receive interrupt, the double
+buffered frame of usart1_rx_FIFO, ModbusRTU_Process() and SendCom() run as
+on the target; the model gives the line and the time of the task. It is
+byte time accurate (8N1, 10 bits per character), with the same seed it
+gives the same result:
+
+  - the master waits 3.5 characters of silence (1750 us above 19200 baud)
+    plus --master-gap after a response or a timeout, then sends the next
+    request; no response within --timeout ms is a timeout
+  - a scale receives every frame on the line, the USART idle interrupt
+    one character after its last byte stores it. A frame not taken yet
+    is replaced by the newer one, MB_REG_DIAG_OVERRUN. APP_Com1Frame()
+    takes it in the next run of Uart1_ProcessTask, every --poll-ms
+    (osDelay(10)), --proc-us later; with --event-loop (APP_EVENT_LOOP 1)
+    right after the frame. Frames for other scales and the responses of
+    other scales are received too
+  - with --hist the time from the frame end to the run of the task is
+    drawn from the MBDIAG latency histogram of a real scale instead
+    (10 bins, bin 0 < 250 us, every further bin doubles the limit)
+  - the response is what the firmware transmits, at the time SendCom()
+    starts it; the scale drives the line --de-us after its last stop bit
+    (DE released in HAL_UART_TxCpltCallback). Transmissions that overlap
+    are both corrupted: a CRC error at every receiver, a timeout at the
+    master
+
+Printed are the polls per second of the line and per scale, the full scan
+time, the response time percentiles (request start to response end) and
+the error counters of the firmware. Change the baud rate, the register
+count or the firmware here before the line is changed.
+"""
+
+import argparse
+import ctypes
+import heapq
+import os
+import random
+import shutil
+import struct
+import sys
+import tempfile
+
+BITS_PER_CHAR = 10
+LATENCY_BINS = 10
+LATENCY_BIN0_US = 250
+MASTER = -1
+# address pins ADDR0..ADDR3
+MAX_ADDRESS = 15
+LIB = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'Host', 'build', 'libyl_dlc.so')
+
+
+def crc16_modbus(data, crc=0xFFFF):
+    """CRC-16/MODBUS, poly 0xA001 reflected, init 0xFFFF"""
+    for byte in bytearray(data):
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+class DiagCounters(ctypes.Structure):
+    """MODBUS_tDiagCounters of ModbusRTUSlave.h"""
+    _fields_ = [('rxFrameCount', ctypes.c_uint16),
+                ('busMsgCount', ctypes.c_uint16),
+                ('crcErrCount', ctypes.c_uint16),
+                ('exceptionCount', ctypes.c_uint16),
+                ('slaveMsgCount', ctypes.c_uint16),
+                ('wrongAddrCount', ctypes.c_uint16),
+                ('noRespCount', ctypes.c_uint16),
+                ('latencyLast', ctypes.c_uint32),
+                ('latencyMax', ctypes.c_uint32),
+                ('latencyHist', ctypes.c_uint16 * LATENCY_BINS)]
+
+
+class Frame(object):
+    def __init__(self, sender, data, start, end):
+        self.sender = sender            # MASTER or scale index
+        self.data = data
+        self.start = start
+        self.end = end                  # last stop bit, us
+        self.release = end              # line driven until here
+        self.corrupt = False
+
+    def received(self):
+        """bytes at a receiver, a collision breaks the CRC"""
+        if not self.corrupt:
+            return self.data
+        return self.data[:-1] + bytearray([self.data[-1] ^ 0xFF])
+
+
+class Scale(object):
+    """One copy of the firmware library, its time is the one of the model
+    from the end of HOST_Boot() on"""
+
+    def __init__(self, lib, addr, baud, phase):
+        self.addr = addr
+        self.phase = phase              # first run of Uart1_ProcessTask, us
+        self.scheduled = False          # run of the task for the frame pending
+        self.busy_until = 0             # response transmission
+        self.responses = 0
+
+        # a library is loaded once per path: a copy per scale, YL_ADDR is read when it loads
+        fd, path = tempfile.mkstemp(prefix='yl_dlc%d_' % addr, suffix='.so')
+        os.close(fd)
+        shutil.copy(lib, path)
+        os.environ['YL_ADDR'] = str(addr)
+        try:
+            self.lib = ctypes.CDLL(path)
+        finally:
+            os.remove(path)
+        self.lib.HOST_Now.restype = ctypes.c_uint64
+        self.lib.HOST_Sleep.argtypes = [ctypes.c_uint64]
+        self.lib.HOST_UartTakeTx.restype = ctypes.c_uint16
+
+        self.lib.HOST_SetVirtualTime(True)
+        self.lib.HOST_UartCapture(0)
+        self.lib.HOST_UartCapture(1)
+        self.lib.HOST_UartSetBaud(0, baud)
+        self.lib.HOST_Boot()
+        self.base = self.lib.HOST_Now()
+
+        self.rx_flag = ctypes.c_uint8.in_dll(self.lib, 'usart1_rx_flag')
+        self.drop_frames = (ctypes.c_uint16 * 2).in_dll(self.lib, 'usart_rx_drop_frames')
+        self.diag = DiagCounters.in_dll(self.lib, 'g_ModbusDiag')
+        self.tx = ctypes.create_string_buffer(1024)
+        self.tx_start = ctypes.c_uint64()
+
+    def advance(self, t):
+        """time of the scale to t us, the interrupts due are taken"""
+        target = self.base + int(t * 1000)
+        now = self.lib.HOST_Now()
+        if target > now:
+            self.lib.HOST_Sleep(target - now)
+        self.lib.HOST_Poll()
+
+    def receive(self, t, data):
+        """frame with its last stop bit at t"""
+        self.advance(t)
+        buf = bytes(data)
+        self.lib.HOST_UartInject(0, buf, len(buf))
+
+    def frame_pending(self):
+        return self.rx_flag.value != 0
+
+    def serve(self):
+        """APP_Com1Frame(), the response and the time of its first byte"""
+        self.lib.APP_Com1Frame()
+        n = self.lib.HOST_UartTakeTx(0, self.tx, len(self.tx), ctypes.byref(self.tx_start))
+        return bytearray(self.tx.raw[:n]), (self.tx_start.value - self.base) / 1000.0
+
+
+class Bus(object):
+    def __init__(self, args):
+        self.args = args
+        self.char_us = BITS_PER_CHAR * 1e6 / args.baud
+        self.t35_us = 1750.0 if args.baud > 19200 else 3.5 * self.char_us
+        self.rand = random.Random(args.seed)
+        self.events = []
+        self.event_count = 0
+        self.active = []                # frames on the line
+        os.environ.pop('YL_EEPROM', None)
+        self.slaves = [Scale(args.lib, addr, args.baud, self.rand.uniform(0, args.poll_ms * 1000.0))
+                       for addr in range(1, args.slaves + 1)]
+        self.hist = None
+        if args.hist:
+            counts = [int(x) for x in args.hist.split(',')]
+            if len(counts) != LATENCY_BINS or sum(counts) == 0:
+                raise ValueError('--hist needs %d counts, not all 0' % LATENCY_BINS)
+            self.hist = counts
+        # master
+        self.poll = 0
+        self.waiting = None             # (poll, scale index, request start)
+        self.next_slave = 0
+        self.times = []
+        self.timeouts = 0
+        self.collisions = 0
+        self.busy_us = 0.0
+
+    def schedule(self, t, kind, *data):
+        self.event_count += 1
+        heapq.heappush(self.events, (t, self.event_count, kind, data))
+
+    def frame_us(self, nbytes):
+        return nbytes * self.char_us
+
+    def transmit(self, sender, t, data):
+        frame = Frame(sender, data, t, t + self.frame_us(len(data)))
+        if sender != MASTER:
+            frame.release = frame.end + self.args.de_us
+        self.active = [f for f in self.active if f.release > t]
+        if self.active:
+            self.collisions += 1
+            frame.corrupt = True
+            for other in self.active:
+                other.corrupt = True
+        self.active.append(frame)
+        self.busy_us += frame.end - frame.start
+        self.schedule(frame.end, 'end', frame)
+        return frame
+
+    def hist_latency(self):
+        pick = self.rand.uniform(0, sum(self.hist))
+        for b, count in enumerate(self.hist):
+            pick -= count
+            if pick < 0:
+                break
+        low = 0 if b == 0 else LATENCY_BIN0_US << (b - 1)
+        high = LATENCY_BIN0_US << b
+        return self.rand.uniform(low, high)
+
+    def service_time(self, slave, t):
+        """run of the task that takes a frame stored at t"""
+        args = self.args
+        if self.hist is not None:
+            return t + self.hist_latency()
+        if args.event_loop:
+            return t + args.proc_us
+        period = args.poll_ms * 1000.0
+        runs = max(0, int((t - slave.phase) // period) + 1)
+        return slave.phase + runs * period + args.proc_us
+
+    def master_send(self, t):
+        args = self.args
+        index = self.next_slave
+        self.next_slave = (self.next_slave + 1) % args.slaves
+        self.poll += 1
+        self.waiting = (self.poll, index, t)
+        pdu = struct.pack('>BBHH', index + 1, 3, 0, args.regs)
+        self.transmit(MASTER, t, bytearray(pdu + struct.pack('<H', crc16_modbus(pdu))))
+        self.schedule(t + self.frame_us(8) + args.timeout * 1000.0, 'timeout', self.poll)
+
+    def master_next(self, t):
+        self.waiting = None
+        self.schedule(t + self.t35_us + self.args.master_gap, 'send')
+
+    def on_end(self, t, frame):
+        # the receivers store the frame one character after its end
+        for index, slave in enumerate(self.slaves):
+            if index != frame.sender:
+                slave.receive(t, frame.received())
+                self.schedule(t + self.char_us, 'idle', index)
+        # a response of the scale polled, the master cannot tell it from a late one
+        if (frame.sender != MASTER and self.waiting is not None and not frame.corrupt
+                and frame.sender == self.waiting[1] and frame.start > self.waiting[2]):
+            self.times.append(t - self.waiting[2])
+            self.master_next(t)
+
+    def on_idle(self, t, index):
+        slave = self.slaves[index]
+        slave.advance(t)
+        if slave.frame_pending() and not slave.scheduled:
+            slave.scheduled = True
+            self.schedule(self.service_time(slave, t), 'service', index)
+
+    def on_service(self, t, index):
+        slave = self.slaves[index]
+        slave.scheduled = False
+        # SendCom() waits for the end of the previous response
+        slave.advance(max(t, slave.busy_until))
+        data, start = slave.serve()
+        if data:
+            response = self.transmit(index, max(start, t), data)
+            slave.busy_until = response.end
+            slave.responses += 1
+
+    def on_timeout(self, t, poll):
+        if self.waiting is not None and self.waiting[0] == poll:
+            self.timeouts += 1
+            self.master_next(t)
+
+    def run(self):
+        end = self.args.seconds * 1e6
+        self.schedule(0.0, 'send')
+        while self.events:
+            t, _, kind, data = heapq.heappop(self.events)
+            if t > end:
+                break
+            if kind == 'send':
+                self.master_send(t)
+            elif kind == 'end':
+                self.on_end(t, *data)
+            elif kind == 'idle':
+                self.on_idle(t, *data)
+            elif kind == 'service':
+                self.on_service(t, *data)
+            elif kind == 'timeout':
+                self.on_timeout(t, *data)
+
+
+def percentile(values, permille):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, len(values) * permille // 1000)]
+
+
+def report(bus):
+    args = bus.args
+    seconds = float(args.seconds)
+    ok = len(bus.times)
+    print('')
+    print('%d scales, %d baud, FC03 %d registers, %.0f s, %s' % (
+        args.slaves, args.baud, args.regs, seconds,
+        'MBDIAG histogram' if bus.hist else
+        ('event loop, %d us' % args.proc_us if args.event_loop else
+         'task every %d ms, %d us' % (args.poll_ms, args.proc_us))))
+    print('-' * 60)
+    print('%-32s %10.1f' % ('polls/s answered', ok / seconds))
+    print('%-32s %10.2f' % ('polls/s per scale', ok / seconds / args.slaves))
+    if ok:
+        print('%-32s %10.1f' % ('full scan ms', seconds * 1000.0 * args.slaves / ok))
+    print('%-32s %10.1f' % ('line busy %', 100.0 * bus.busy_us / (seconds * 1e6)))
+    print('')
+    print('response ms (request start to response end)')
+    for name, permille in (('p50', 500), ('p90', 900), ('p99', 990), ('p99.9', 999), ('max', 1000)):
+        print('  %-30s %10.2f' % (name, percentile(bus.times, permille) / 1000.0))
+    print('')
+    print('%-32s %10d' % ('polls', bus.poll))
+    print('%-32s %10d' % ('timeouts', bus.timeouts))
+    print('%-32s %10d' % ('collisions', bus.collisions))
+    print('%-32s %10d' % ('overruns (all scales)', sum(s.drop_frames[0] for s in bus.slaves)))
+    print('%-32s %10d' % ('CRC errors (all scales)', sum(s.diag.crcErrCount for s in bus.slaves)))
+    print('%-32s %10d' % ('not answered (all scales)', sum(s.diag.noRespCount for s in bus.slaves)))
+    worst = max(bus.slaves, key=lambda s: s.drop_frames[0])
+    if worst.drop_frames[0]:
+        print('%-32s %10d' % ('most overruns, scale %d' % worst.addr, worst.drop_frames[0]))
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--slaves', type=int, default=8, help='scales on the line, 1..%d' % MAX_ADDRESS)
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--regs', type=int, default=8, help='FC03 register count, 8 = 0x0000..0x0007')
+    parser.add_argument('--seconds', type=float, default=10, help='simulated time')
+    parser.add_argument('--timeout', type=float, default=50, help='master response timeout ms')
+    parser.add_argument('--master-gap', type=float, default=0, help='master delay after 3.5 chars, us')
+    parser.add_argument('--de-us', type=float, default=5, help='scale DE release after the last stop bit, us')
+    parser.add_argument('--poll-ms', type=int, default=10, help='period of Uart1_ProcessTask')
+    parser.add_argument('--proc-us', type=int, default=400, help='task run up to the first TX byte')
+    parser.add_argument('--event-loop', action='store_true', help='APP_EVENT_LOOP 1, no task period')
+    parser.add_argument('--hist', help='MBDIAG latency histogram, 10 counts separated by commas')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--lib', default=LIB, help='firmware library of the host build')
+    args = parser.parse_args(argv[1:])
+    if not 1 <= args.slaves <= MAX_ADDRESS or not 1 <= args.regs <= 125:
+        parser.error('--slaves 1..%d, --regs 1..125' % MAX_ADDRESS)
+    if not os.path.exists(args.lib):
+        parser.error('%s not found, make in Host/' % args.lib)
+
+    bus = Bus(args)
+    bus.run()
+    report(bus)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
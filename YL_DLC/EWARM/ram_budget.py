@@ -0,0 +1,182 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""RAM and flash budget per subsystem from the IAR linker map file.
+
+Post-build step of YL_DLC.ewp:
+
+    python ram_budget.py YL_DLC.ewp YL_DLC.map [stm32f103xe_flash.icf]
+
+The report is for information only: a missing or unreadable file is reported
+and the script still returns 0, so it does not fail the build. The project runs
+it through cmd /c ... || exit 0, a missing Python does not fail it either.
+
+A subsystem is the group of a source file in the project tree (User/Comm,
+User/Scale, FreeRTOS, ...). The sizes are taken from the MODULE
+SUMMARY of the map file, the largest RAM objects from the ENTRY LIST. With the
+icf file the RAM use is also shown in percent of the RAM region.
+
+All RTOS objects (task stacks, TCBs, semaphores) are allocated statically, the
+stacks are the ...Buffer objects of freertos.o.
+"""
+
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+TOP_RAM_OBJECTS = 15
+
+
+def read_text(path):
+    with open(path, 'rb') as f:
+        return f.read().decode('latin-1')
+
+
+def module_groups(ewp_path):
+    """object file name -> group path of the source file in the project"""
+    groups = {}
+
+    def walk(node, path):
+        for group in node.findall('group'):
+            walk(group, path + [group.findtext('name')])
+        for f in node.findall('file'):
+            name = f.findtext('name').replace('\\', '/')
+            base, ext = os.path.splitext(os.path.basename(name))
+            if ext.lower() in ('.c', '.s', '.cpp'):
+                # the top level group (Application, Drivers, ...) does not help
+                groups[base.lower() + '.o'] = '/'.join(path[1:] or path)
+
+    walk(ET.parse(ewp_path).getroot(), [])
+    return groups
+
+
+def parse_number(text):
+    text = text.replace(' ', '').replace("'", '')
+    return int(text) if text.isdigit() else 0
+
+
+def module_summary(map_text):
+    """list of (source, module, ro code, ro data, rw data)"""
+    lines = map_text.splitlines()
+    start = None
+    for i, line in enumerate(lines):
+        if 'MODULE SUMMARY' in line:
+            start = i
+            break
+    if start is None:
+        raise ValueError('no MODULE SUMMARY in the map file')
+
+    columns = None
+    source = None
+    modules = []
+    for line in lines[start + 1:]:
+        if line.startswith('***') and columns is not None:
+            break
+        if columns is None:
+            if 'ro code' in line and 'rw data' in line:
+                # the numbers are right aligned to the column headers
+                columns = [line.index(h) + len(h) for h in ('ro code', 'ro data', 'rw data')]
+            continue
+        m = re.match(r'^(\S.*): \[\d+\]\s*$', line)
+        if m:
+            source = m.group(1).strip()
+            continue
+        m = re.match(r'^    (\S+(?: created)?)\s', line)
+        if not m or m.group(1).startswith('-') or m.group(1) in ('Module', 'Total:', 'Grand'):
+            continue
+        values = []
+        left = len(m.group(0)) - 1
+        for right in columns:
+            values.append(parse_number(line[left:right]))
+            left = right
+        modules.append((source, m.group(1), values[0], values[1], values[2]))
+    return modules
+
+
+def ram_objects(map_text, ram_start, ram_end):
+    """list of (size, name, module) of the data objects in RAM"""
+    objects = []
+    pattern = re.compile(r"^(\S*)\s+0x([0-9a-fA-F']+)\s+0x([0-9a-fA-F']+)\s+Data\s+\S+\s+(\S+)")
+    name = ''
+    for line in map_text.splitlines():
+        m = pattern.match(line)
+        if not m:
+            # a long name is on a line of its own, the values follow on the next line
+            name = line.strip() if re.match(r'^\S+\s*$', line) else ''
+            continue
+        if m.group(1):
+            name = m.group(1)
+        addr = int(m.group(2).replace("'", ''), 16)
+        size = int(m.group(3).replace("'", ''), 16)
+        if ram_start <= addr <= ram_end:
+            objects.append((size, name, m.group(4)))
+    objects.sort(reverse=True)
+    return objects
+
+
+def ram_region(icf_path):
+    text = read_text(icf_path)
+    start = re.search(r'__ICFEDIT_region_RAM_start__\s*=\s*(0x[0-9a-fA-F]+)', text)
+    end = re.search(r'__ICFEDIT_region_RAM_end__\s*=\s*(0x[0-9a-fA-F]+)', text)
+    if not start or not end:
+        return None
+    return int(start.group(1), 16), int(end.group(1), 16)
+
+
+def subsystem(groups, source, module):
+    if module == 'Linker created':
+        return 'Linker (CSTACK, HEAP)'
+    if module == 'Gaps':
+        return 'Alignment gaps'
+    if source and source.lower().endswith('.a'):
+        return 'Library ' + os.path.basename(source.replace('\\', '/'))
+    return groups.get(module.lower(), 'Other')
+
+
+def report(argv):
+    groups = module_groups(argv[1])
+    map_text = read_text(argv[2])
+    region = ram_region(argv[3]) if len(argv) > 3 else None
+
+    budget = {}
+    for source, module, ro_code, ro_data, rw_data in module_summary(map_text):
+        entry = budget.setdefault(subsystem(groups, source, module), [0, 0, 0])
+        entry[0] += ro_code
+        entry[1] += ro_data
+        entry[2] += rw_data
+
+    total = [sum(v[i] for v in budget.values()) for i in range(3)]
+    ram_size = region[1] - region[0] + 1 if region else 0
+
+    print('')
+    print('%-32s %9s %9s %9s %7s' % ('Subsystem', 'ro code', 'ro data', 'rw data', 'RAM %'))
+    print('-' * 70)
+    for name, (ro_code, ro_data, rw_data) in sorted(budget.items(), key=lambda kv: -kv[1][2]):
+        share = '%6.1f%%' % (100.0 * rw_data / ram_size) if ram_size else ''
+        print('%-32s %9d %9d %9d %7s' % (name, ro_code, ro_data, rw_data, share))
+    print('-' * 70)
+    share = '%6.1f%%' % (100.0 * total[2] / ram_size) if ram_size else ''
+    print('%-32s %9d %9d %9d %7s' % ('Total', total[0], total[1], total[2], share))
+    if ram_size:
+        print('%-32s %29d' % ('RAM free', ram_size - total[2]))
+
+    if region:
+        print('')
+        print('Largest RAM objects')
+        for size, name, module in ram_objects(map_text, region[0], region[1])[:TOP_RAM_OBJECTS]:
+            print('  %6d  %-32s %s' % (size, name, module))
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.stderr.write(__doc__)
+        return 2
+    try:
+        report(argv)
+    except (EnvironmentError, ValueError, ET.ParseError) as e:
+        sys.stderr.write('ram_budget.py: no report, %s\n' % e)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,149 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""Records of the binary telemetry stream (Telemetry.h) started with SETTLM.
+
+    python tlm_decode.py capture.bin
+    python tlm_decode.py --csv capture.bin > capture.csv
+    python tlm_decode.py --summary < capture.bin
+
+The capture is the raw byte stream of the port, e.g. from a terminal program
+that logs to a file (stdin without file). The decoder synchronizes on 0xA5 0x5A,
+checks the CRC of every record and resynchronizes one byte after a bad record.
+Records lost on the line or dropped by the sender show as a gap of the sequence
+number. --csv prints one line per record with a header, --summary only the
+counters and the sample interval.
+
+As a library: Decoder().feed(data) returns the records of a chunk, the counters
+are kept across chunks.
+"""
+
+import struct
+import sys
+
+SYNC = b'\xA5\x5A'
+FRAME_LEN = 29
+
+STATUS_BITS = (
+    (0x01, 'motion'),
+    (0x02, 'net'),
+    (0x04, 'coz'),
+    (0x08, 'over'),
+    (0x10, 'under'),
+    (0x20, 'no-pu-zero'),
+)
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    """CRC-16/CCITT, poly 0x1021, init 0xFFFF, as RB_CRC_16_CCITT_CFG"""
+    for byte in bytearray(data):
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def signed24(value):
+    return value - (1 << 24) if value & 0x800000 else value
+
+
+def status_text(status):
+    names = [name for bit, name in STATUS_BITS if status & bit]
+    return '|'.join(names) if names else '-'
+
+
+class Record(object):
+    def __init__(self, frame):
+        (self.seq, self.time_us) = struct.unpack_from('<HI', frame, 2)
+        self.raw1 = signed24(struct.unpack_from('<I', frame[8:11] + b'\x00')[0])
+        self.raw2 = signed24(struct.unpack_from('<I', frame[11:14] + b'\x00')[0])
+        (self.filtered, self.gross, self.net, self.status) = struct.unpack_from('<iffB', frame, 14)
+
+
+class Decoder(object):
+    def __init__(self):
+        self.buf = bytearray()
+        self.records = 0
+        self.crc_errors = 0
+        self.skipped = 0                # bytes outside of records
+        self.lost = 0                   # sequence numbers missing
+        self.expected_seq = None
+
+    def feed(self, data):
+        """records complete in the data received so far"""
+        self.buf.extend(data)
+        out = []
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                # keep a last 0xA5, it may be the start of the next sync
+                keep = 1 if self.buf[-1:] == SYNC[:1] else 0
+                self.skipped += len(self.buf) - keep
+                del self.buf[:len(self.buf) - keep]
+                break
+            self.skipped += start
+            del self.buf[:start]
+            if len(self.buf) < FRAME_LEN:
+                break
+            frame = bytes(self.buf[:FRAME_LEN])
+            crc = (bytearray(frame)[FRAME_LEN - 2] << 8) | bytearray(frame)[FRAME_LEN - 1]
+            if crc16_ccitt(frame[:FRAME_LEN - 2]) != crc:
+                # a sync pattern in the data or a damaged record, search from the next byte
+                self.crc_errors += 1
+                self.skipped += 1
+                del self.buf[:1]
+                continue
+            del self.buf[:FRAME_LEN]
+            record = Record(frame)
+            if self.expected_seq is not None and record.seq != self.expected_seq:
+                self.lost += (record.seq - self.expected_seq) & 0xFFFF
+            self.expected_seq = (record.seq + 1) & 0xFFFF
+            self.records += 1
+            out.append(record)
+        return out
+
+
+def main(argv):
+    args = argv[1:]
+    csv = '--csv' in args
+    summary = '--summary' in args
+    files = [a for a in args if not a.startswith('--')]
+    if len(files) > 1 or (csv and summary):
+        sys.stderr.write(__doc__)
+        return 2
+    if files:
+        with open(files[0], 'rb') as f:
+            data = f.read()
+    else:
+        data = getattr(sys.stdin, 'buffer', sys.stdin).read()
+
+    decoder = Decoder()
+    records = decoder.feed(data)
+    if csv:
+        print('seq,time_us,raw1,raw2,filtered,gross,net,status')
+    intervals = []
+    previous = None
+    for record in records:
+        if previous is not None and record.seq == ((previous.seq + 1) & 0xFFFF):
+            intervals.append((record.time_us - previous.time_us) & 0xFFFFFFFF)
+        previous = record
+        if csv:
+            print('%d,%d,%d,%d,%d,%.6g,%.6g,%d' % (
+                record.seq, record.time_us, record.raw1, record.raw2, record.filtered,
+                record.gross, record.net, record.status))
+        elif not summary:
+            print('%5d %11.6f %9d %9d %10d %12.6g %12.6g  %s' % (
+                record.seq, record.time_us / 1e6, record.raw1, record.raw2, record.filtered,
+                record.gross, record.net, status_text(record.status)))
+
+    out = sys.stderr if csv else sys.stdout
+    out.write('%d records, %d lost, %d CRC errors, %d bytes skipped\n' % (
+        decoder.records, decoder.lost, decoder.crc_errors, decoder.skipped))
+    if intervals:
+        out.write('sample interval us: min %d, mean %.1f, max %d\n' % (
+            min(intervals), sum(intervals) / float(len(intervals)), max(intervals)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,287 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "Host.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+typedef struct
+{
+    pthread_cond_t cond;            // signalled when the thread gets the core
+    bool bRunning;                  // holds the core
+    bool bExit;                     // task deleted, end the thread
+    TaskFunction_t pxCode;
+    void *pvParameters;
+} HOST_tThread;
+
+// held by the thread that runs, main() until the scheduler starts
+static pthread_mutex_t coreMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t mainCond = PTHREAD_COND_INITIALIZER;
+static bool bCoreTaken = false;
+static bool bSchedulerStarted = false;
+static HOST_tThread *pRunning = NULL;
+
+// as on the target, the interrupts masked by a critical section before the scheduler stay masked
+static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;
+
+// tasks.c, the first member of the TCB is pxTopOfStack
+extern void * volatile pxCurrentTCB;
+
+/**---------------------------------------------------------------------
+ * Name         : prvThreadOf
+ * Description  : thread of a task, pxPortInitialiseStack() left it in
+ *                place of the stack pointer
+ * Prototype in : port.c
+ * \param    	: pxTCB---task
+ * \return    	: thread
+ *---------------------------------------------------------------------*/
+static HOST_tThread *prvThreadOf(void *pxTCB)
+{
+    return *(HOST_tThread **)(*(StackType_t **)pxTCB);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : prvThreadEnd
+ * Description  : end the calling thread of a deleted task
+ * Prototype in : port.c
+ * \param    	: pThread---the calling thread
+ * \return    	: does not return
+ *---------------------------------------------------------------------*/
+static void prvThreadEnd(HOST_tThread *pThread)
+{
+    pthread_mutex_unlock(&coreMutex);
+    pthread_cond_destroy(&pThread->cond);
+    free(pThread);
+    pthread_exit(NULL);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : prvThreadStart
+ * Description  : thread of a task, waits for the core before the task
+ *                function runs
+ * Prototype in : port.c
+ * \param    	: pvArg---HOST_tThread
+ * \return    	: none, a task does not return
+ *---------------------------------------------------------------------*/
+static void *prvThreadStart(void *pvArg)
+{
+    HOST_tThread *pThread = pvArg;
+
+    pthread_mutex_lock(&coreMutex);
+    while (!pThread->bRunning)
+        pthread_cond_wait(&pThread->cond, &coreMutex);
+    if (pThread->bExit)
+        prvThreadEnd(pThread);
+
+    // the exception return into the first run of a task clears BASEPRI
+    portENABLE_INTERRUPTS();
+    pThread->pxCode(pThread->pvParameters);
+
+    // prvTaskExitError() of the target
+    vPortAssert(__FILE__, __LINE__);
+    return NULL;
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : pxPortInitialiseStack
+ * Description  : create the thread of a new task, it waits for the core.
+ *                The first call takes the core for main()
+ * Prototype in : portable.h
+ * \param    	: pxTopOfStack---top of the stack of the task
+ *                pxCode, pvParameters---task function and its argument
+ * \return    	: stack pointer saved in the TCB, points to the thread
+ *---------------------------------------------------------------------*/
+StackType_t *pxPortInitialiseStack(StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters)
+{
+    HOST_tThread *pThread;
+    pthread_attr_t attr;
+    pthread_t thread;
+    int err;
+
+    // HOST_Boot(): no thread, the task functions are called by the program
+    if (HOST_BootOnly())
+    {
+        pxTopOfStack -= sizeof(HOST_tThread *) / sizeof(StackType_t);
+        return pxTopOfStack;
+    }
+
+    if (!bCoreTaken)
+    {
+        pthread_mutex_lock(&coreMutex);
+        bCoreTaken = true;
+    }
+
+    pThread = calloc(1, sizeof(HOST_tThread));
+    configASSERT(pThread != NULL);
+    pthread_cond_init(&pThread->cond, NULL);
+    pThread->pxCode = pxCode;
+    pThread->pvParameters = pvParameters;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    err = pthread_create(&thread, &attr, prvThreadStart, pThread);
+    pthread_attr_destroy(&attr);
+    configASSERT(err == 0);
+
+    // below the top, aligned for the pointer
+    pxTopOfStack -= sizeof(HOST_tThread *) / sizeof(StackType_t);
+    pxTopOfStack = (StackType_t *)((uintptr_t)pxTopOfStack & ~(uintptr_t)(sizeof(HOST_tThread *) - 1));
+    *(HOST_tThread **)pxTopOfStack = pThread;
+    return pxTopOfStack;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : xPortStartScheduler
+ * Description  : hand the core to the first task, main() waits for good
+ * Prototype in : portable.h
+ * \return    	: does not return
+ *---------------------------------------------------------------------*/
+BaseType_t xPortStartScheduler(void)
+{
+    uxCriticalNesting = 0;
+    if (HOST_BootOnly())
+        HOST_BootReturn();
+    bSchedulerStarted = true;
+
+    pRunning = prvThreadOf(pxCurrentTCB);
+    pRunning->bRunning = true;
+    pthread_cond_signal(&pRunning->cond);
+    for (;;)
+        pthread_cond_wait(&mainCond, &coreMutex);
+    return 0;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : vPortEndScheduler
+ * Description  : not used by the firmware, ends the process
+ * Prototype in : portable.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void vPortEndScheduler(void)
+{
+    exit(0);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : vPortEnterCritical
+ * Description  : mask the kernel interrupts, nested
+ * Prototype in : portmacro.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void vPortEnterCritical(void)
+{
+    portDISABLE_INTERRUPTS();
+    uxCriticalNesting++;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : vPortExitCritical
+ * Description  : unmask the kernel interrupts at the outermost exit, the
+ *                pending ones and a pending context switch are taken
+ * Prototype in : portmacro.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void vPortExitCritical(void)
+{
+    configASSERT(uxCriticalNesting);
+    uxCriticalNesting--;
+    if (uxCriticalNesting == 0)
+        portENABLE_INTERRUPTS();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : xPortPendSVHandler
+ * Description  : PendSV_Handler, switch to the thread of the task
+ *                selected by vTaskSwitchContext(). The calling thread
+ *                waits here until it gets the core back
+ * Prototype in : HostCore.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void xPortPendSVHandler(void)
+{
+    HOST_tThread *pSelf = pRunning;
+    HOST_tThread *pNext;
+
+    if (!bSchedulerStarted)
+        return;
+
+    portDISABLE_INTERRUPTS();
+    vTaskSwitchContext();
+    pNext = prvThreadOf(pxCurrentTCB);
+    if (pNext != pSelf)
+    {
+        pSelf->bRunning = false;
+        pRunning = pNext;
+        pNext->bRunning = true;
+        pthread_cond_signal(&pNext->cond);
+        while (!pSelf->bRunning)
+            pthread_cond_wait(&pSelf->cond, &coreMutex);
+        if (pSelf->bExit)
+            prvThreadEnd(pSelf);
+    }
+    portENABLE_INTERRUPTS();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : xPortSysTickHandler
+ * Description  : kernel tick, called by osSystickHandler()
+ * Prototype in : cmsis_os.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void xPortSysTickHandler(void)
+{
+    if (xTaskIncrementTick() != pdFALSE)
+        portYIELD();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : vPortCleanUpTCB
+ * Description  : end the thread of a deleted task, it leaves once it
+ *                gets the mutex of the core
+ * Prototype in : portmacro.h
+ * \param    	: pxTCB---deleted task, not the calling one
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void vPortCleanUpTCB(void *pxTCB)
+{
+    HOST_tThread *pThread = prvThreadOf(pxTCB);
+
+    pThread->bExit = true;
+    pThread->bRunning = true;
+    pthread_cond_signal(&pThread->cond);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : vApplicationIdleHook
+ * Description  : WFI of the idle task
+ * Prototype in : task.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void vApplicationIdleHook(void)
+{
+    HOST_WaitForInterrupt();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : vPortAssert
+ * Description  : configASSERT() failed
+ * Prototype in : portmacro.h
+ * \param    	: pcFile, ulLine---place of the assertion
+ * \return    	: does not return
+ *---------------------------------------------------------------------*/
+void vPortAssert(const char *pcFile, unsigned long ulLine)
+{
+    fprintf(stderr, "configASSERT failed: %s:%lu\n", pcFile, ulLine);
+    abort();
+}
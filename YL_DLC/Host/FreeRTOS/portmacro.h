@@ -0,0 +1,95 @@
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+//==================================================================================================
+//  FreeRTOS port of the host build
+//
+//  The port of the Cortex-M3 on POSIX threads: a task is a thread, the thread of the current TCB
+//  holds the simulated core, all others wait. Critical sections set BASEPRI, portYIELD() pends
+//  the PendSV exception, which switches the thread once nothing masks it. The interrupt model
+//  behind BASEPRI is Host/Src/HostCore.c.
+//
+//  The idle hook is the WFI of the model, it is switched on here. configASSERT() reports the
+//  place and aborts instead of the endless loop of the target.
+//==================================================================================================
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define portCHAR                char
+#define portFLOAT               float
+#define portDOUBLE              double
+#define portLONG                long
+#define portSHORT               short
+#define portSTACK_TYPE          uint32_t
+#define portBASE_TYPE           long
+#define portPOINTER_SIZE_TYPE   uintptr_t
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if (configUSE_16_BIT_TICKS == 1)
+#error the host port has 32 bit ticks only
+#endif
+typedef uint32_t TickType_t;
+#define portMAX_DELAY           (TickType_t)0xffffffffUL
+#define portTICK_TYPE_IS_ATOMIC 1
+
+#define portSTACK_GROWTH        (-1)
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portBYTE_ALIGNMENT      8
+
+// scheduler utilities
+extern void HOST_SetPendSV(void);
+#define portYIELD()             HOST_SetPendSV()
+#define portEND_SWITCHING_ISR(xSwitchRequired) if ((xSwitchRequired) != pdFALSE) portYIELD()
+#define portYIELD_FROM_ISR(x)   portEND_SWITCHING_ISR(x)
+
+#if (configUSE_PORT_OPTIMISED_TASK_SELECTION == 1)
+#if (configMAX_PRIORITIES > 32)
+#error configUSE_PORT_OPTIMISED_TASK_SELECTION needs configMAX_PRIORITIES <= 32
+#endif
+#define portRECORD_READY_PRIORITY(uxPriority, uxReadyPriorities) (uxReadyPriorities) |= (1UL << (uxPriority))
+#define portRESET_READY_PRIORITY(uxPriority, uxReadyPriorities) (uxReadyPriorities) &= ~(1UL << (uxPriority))
+#define portGET_HIGHEST_PRIORITY(uxTopPriority, uxReadyPriorities) \
+    uxTopPriority = (31UL - (uint32_t)__builtin_clz((uint32_t)(uxReadyPriorities)))
+#endif
+
+// critical section management
+extern uint32_t __get_BASEPRI(void);
+extern void __set_BASEPRI(uint32_t basePri);
+extern void vPortEnterCritical(void);
+extern void vPortExitCritical(void);
+#define portDISABLE_INTERRUPTS()                __set_BASEPRI(configMAX_SYSCALL_INTERRUPT_PRIORITY)
+#define portENABLE_INTERRUPTS()                 __set_BASEPRI(0)
+#define portENTER_CRITICAL()                    vPortEnterCritical()
+#define portEXIT_CRITICAL()                     vPortExitCritical()
+#define portSET_INTERRUPT_MASK_FROM_ISR()       __get_BASEPRI(); portDISABLE_INTERRUPTS()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)    __set_BASEPRI(x)
+
+#define portTASK_FUNCTION_PROTO(vFunction, pvParameters) void vFunction(void *pvParameters)
+#define portTASK_FUNCTION(vFunction, pvParameters) void vFunction(void *pvParameters)
+
+#define portNOP()
+
+// a deleted task ends its thread
+extern void vPortCleanUpTCB(void *pxTCB);
+#define portCLEAN_UP_TCB(pxTCB) vPortCleanUpTCB(pxTCB)
+
+// the idle task sleeps in the hook until the next interrupt
+#undef configUSE_IDLE_HOOK
+#define configUSE_IDLE_HOOK     1
+
+extern void vPortAssert(const char *pcFile, unsigned long ulLine);
+#undef configASSERT
+#define configASSERT(x)         if ((x) == 0) vPortAssert(__FILE__, __LINE__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,2 @@
+// the file name as freertos.c spells it
+#include "ADS12XX.h"
@@ -0,0 +1,109 @@
+#ifndef _HOST_H
+#define _HOST_H
+
+//==================================================================================================
+//  Host build of the firmware
+//
+//  main(), the tasks of freertos.c, usart.c, the Modbus slave and the command interface run
+//  unchanged in one Linux process. The FreeRTOS port in Host/FreeRTOS runs each task as a thread,
+//  one at a time. The HAL of Host/Inc is implemented by peripheral models:
+//
+//    - HostCore.c: interrupt controller, TIM1 time base and SysTick from the monotonic clock, DWT
+//      cycle counter, GPIO with the Modbus address pins and two ADS1230 converters, reset flags
+//    - HostUart.c: USART1 and USART2 with their DMA channels on pseudo terminals, one character
+//      time per byte, the IDLE interrupt one character after the last received byte
+//    - HostEeprom.c: the 24C32 on I2C1 with its write cycle, page wrap, wear counters, a file as
+//      the content and an injected power loss
+//
+//  Interrupts are taken where the core would take them in the model: when the task lowers
+//  PRIMASK or BASEPRI, at every HAL_GetTick() and in the idle task, which sleeps until the next
+//  one is due. Code that spins without any of these is not interrupted. Stack high water marks
+//  mean nothing, the task runs on its thread stack. HAL_NVIC_SystemReset() starts the program
+//  again with the pseudo terminals kept open and the software reset flag set; unlike the target,
+//  the .noinit RAM of DebugLog and WarmStart does not survive it. The memory pools and mail queues
+//  of cmsis_os.c (osPool*, osMail*) keep addresses in 32 bits and must not be used here.
+//
+//  libyl_dlc.so is the same firmware for Python (ctypes). HOST_Boot() runs main() up to the start
+//  of the scheduler; with virtual time, ports without a terminal (HOST_UartCapture()) and the task
+//  functions called by the program, every copy of the library is one scale.
+//
+//  The environment configures the model, main() is the one of the firmware:
+//
+//    YL_COM1, YL_COM2      path of a symbolic link to the pseudo terminal of the port
+//    YL_EEPROM             file of the eeprom content, created erased (0xFF), else RAM only
+//    YL_ADDR               Modbus address on the address pins, 0..15, default 1
+//    YL_ADC1, YL_ADC2      raw counts of the converters, default 100000
+//==================================================================================================
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <poll.h>
+
+#include "stm32f1xx_hal.h"
+
+//! ns since the start of the process, the time of all models
+uint64_t HOST_Now(void);
+
+//! virtual time: the clock advances by HOST_Sleep() and the idle wait only, for test programs
+void HOST_SetVirtualTime(bool bOn);
+
+//! busy time of a model
+void HOST_Sleep(uint64_t ns);
+
+//! interrupt of a peripheral may be taken: enabled and not masked by PRIMASK or BASEPRI
+bool HOST_IrqReady(IRQn_Type irq);
+
+//! run the handler of a peripheral interrupt in handler mode
+void HOST_IrqRun(IRQn_Type irq, void (*pHandler)(void));
+
+//! request a context switch, taken when no interrupt is active and BASEPRI allows
+void HOST_SetPendSV(void);
+
+//! take the interrupts that are due and the pending context switch
+void HOST_Poll(void);
+
+//! idle task: sleep until the next interrupt is due and take it
+void HOST_WaitForInterrupt(void);
+
+//! main() up to the start of the scheduler, for a program that runs the task functions itself
+void HOST_Boot(void);
+bool HOST_BootOnly(void);
+void HOST_BootReturn(void);
+
+//! environment value as number
+long HOST_EnvNumber(const char *pName, long defaultValue);
+
+// UART model, HostUart.c
+void HOST_UartInit(void);
+void HOST_UartService(uint64_t now);
+uint64_t HOST_UartNextEvent(void);
+int HOST_UartPollFds(struct pollfd *pFds, int max);
+void HOST_UartKeepForReset(void);
+void HOST_UartCapture(uint8_t port);
+void HOST_UartSetBaud(uint8_t port, uint32_t baud);
+void HOST_UartInject(uint8_t port, const uint8_t *pData, uint16_t size);
+uint16_t HOST_UartTakeTx(uint8_t port, uint8_t *pData, uint16_t max, uint64_t *pStart);
+
+// eeprom model, HostEeprom.c
+typedef struct
+{
+    uint32_t pagePrograms;          // completed write cycles
+    uint32_t programBytes;
+    uint32_t readBytes;
+    uint32_t nacks;                 // transfers during a write cycle
+    uint32_t maxPageWear;           // write cycles of the most written page
+    uint32_t maxCellWear;           // programs of the most written byte
+} HOST_tEepromStat;
+
+void HOST_EepromOpen(const char *pPath);
+void HOST_EepromErase(void);
+void HOST_EepromPowerFail(uint32_t afterBytes);
+bool HOST_EepromPowerFailed(void);
+void HOST_EepromPowerOn(void);
+void HOST_EepromGetStat(HOST_tEepromStat *pStat);
+void HOST_EepromClearStat(void);
+uint32_t HOST_EepromPageWear(uint16_t page);
+uint32_t HOST_EepromCellWear(uint16_t address);
+const uint8_t *HOST_EepromImage(void);
+
+#endif
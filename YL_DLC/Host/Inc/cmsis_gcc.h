@@ -0,0 +1,7 @@
+#ifndef __CMSIS_GCC_H
+#define __CMSIS_GCC_H
+
+// cmsis_os.c takes the intrinsics from here when compiled by gcc
+#include "stm32f1xx.h"
+
+#endif
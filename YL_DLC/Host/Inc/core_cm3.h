@@ -0,0 +1,49 @@
+#ifndef __CORE_CM3_H
+#define __CORE_CM3_H
+
+//==================================================================================================
+//  Core registers and intrinsics of the host build
+//
+//  PRIMASK, BASEPRI and IPSR are the state of the interrupt model in Host/Src/HostCore.c. Setting
+//  a mask back to 0 takes the interrupts pending meanwhile, as the core does. The cycle counter
+//  counts the monotonic clock at SystemCoreClock.
+//==================================================================================================
+
+#include <stdint.h>
+
+typedef struct
+{
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    __IO uint32_t DHCSR;
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk          0x00000001U
+#define CoreDebug_DEMCR_TRCENA_Msk      0x01000000U
+
+// every read of DWT brings CYCCNT up to date, a write of CYCCNT sets the counter
+DWT_Type *HOST_Dwt(void);
+extern CoreDebug_Type HOST_CoreDebug;
+#define DWT                     (HOST_Dwt())
+#define CoreDebug               (&HOST_CoreDebug)
+
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_BASEPRI(void);
+void __set_BASEPRI(uint32_t basePri);
+uint32_t __get_IPSR(void);
+void __WFI(void);
+
+#define __NOP()                 do {} while (0)
+#define __DSB()                 __sync_synchronize()
+#define __ISB()                 __sync_synchronize()
+#define __DMB()                 __sync_synchronize()
+
+#endif
@@ -0,0 +1,2 @@
+// the file name as UserParam.c spells it
+#include "stm32f1xx_hal.h"
@@ -0,0 +1,126 @@
+#ifndef __STM32F1XX_H
+#define __STM32F1XX_H
+
+//==================================================================================================
+//  Device header of the host build
+//
+//  Only the registers the application touches. They are plain variables of Host/Src/HostCore.c,
+//  the peripheral models of Host/Src write them before the interrupt handler reads them.
+//==================================================================================================
+
+#include <stdint.h>
+
+#define STM32F1
+
+#define __IO                    volatile
+#define __I                     volatile const
+#define __O                     volatile
+
+#define __NVIC_PRIO_BITS        4
+
+typedef enum
+{
+    NonMaskableInt_IRQn   = -14,
+    SVCall_IRQn           = -5,
+    PendSV_IRQn           = -2,
+    SysTick_IRQn          = -1,
+    DMA1_Channel4_IRQn    = 14,
+    DMA1_Channel5_IRQn    = 15,
+    DMA1_Channel6_IRQn    = 16,
+    DMA1_Channel7_IRQn    = 17,
+    TIM1_UP_IRQn          = 25,
+    I2C1_EV_IRQn          = 31,
+    I2C1_ER_IRQn          = 32,
+    USART1_IRQn           = 37,
+    USART2_IRQn           = 38,
+    HOST_IRQ_NUM          = 43
+} IRQn_Type;
+
+typedef struct
+{
+    __IO uint32_t SR;
+    __IO uint32_t DR;
+    __IO uint32_t BRR;
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t CR3;
+    __IO uint32_t GTPR;
+} USART_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CCR;
+    __IO uint32_t CNDTR;
+    __IO uint32_t CPAR;
+    __IO uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR1;
+    __IO uint32_t SR;
+    __IO uint32_t CNT;
+} TIM_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CSR;
+} RCC_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t SR1;
+} I2C_TypeDef;
+
+extern USART_TypeDef HOST_Usart[2];
+extern DMA_Channel_TypeDef HOST_DmaChannel[7];
+extern TIM_TypeDef HOST_Tim1;
+extern RCC_TypeDef HOST_Rcc;
+extern GPIO_TypeDef HOST_Gpio[4];
+extern I2C_TypeDef HOST_I2c1;
+
+#define USART1                  (&HOST_Usart[0])
+#define USART2                  (&HOST_Usart[1])
+#define DMA1_Channel1           (&HOST_DmaChannel[0])
+#define DMA1_Channel2           (&HOST_DmaChannel[1])
+#define DMA1_Channel3           (&HOST_DmaChannel[2])
+#define DMA1_Channel4           (&HOST_DmaChannel[3])
+#define DMA1_Channel5           (&HOST_DmaChannel[4])
+#define DMA1_Channel6           (&HOST_DmaChannel[5])
+#define DMA1_Channel7           (&HOST_DmaChannel[6])
+#define TIM1                    (&HOST_Tim1)
+#define RCC                     (&HOST_Rcc)
+#define GPIOA                   (&HOST_Gpio[0])
+#define GPIOB                   (&HOST_Gpio[1])
+#define GPIOC                   (&HOST_Gpio[2])
+#define GPIOD                   (&HOST_Gpio[3])
+#define I2C1                    (&HOST_I2c1)
+
+#define USART_SR_IDLE           0x00000010U
+#define USART_SR_RXNE           0x00000020U
+#define USART_SR_TC             0x00000040U
+#define USART_SR_TXE            0x00000080U
+#define USART_CR1_IDLEIE        0x00000010U
+#define USART_CR1_TCIE          0x00000040U
+
+#define TIM_SR_UIF              0x00000001U
+
+#define RCC_CSR_RMVF            0x01000000U
+#define RCC_CSR_PINRSTF         0x04000000U
+#define RCC_CSR_PORRSTF         0x08000000U
+#define RCC_CSR_SFTRSTF         0x10000000U
+#define RCC_CSR_IWDGRSTF        0x20000000U
+#define RCC_CSR_WWDGRSTF        0x40000000U
+#define RCC_CSR_LPWRRSTF        0x80000000U
+
+extern uint32_t SystemCoreClock;
+
+#include "core_cm3.h"
+
+#endif
@@ -0,0 +1,2 @@
+// part of stm32f1xx_hal.h on the host
+#include "stm32f1xx_hal.h"
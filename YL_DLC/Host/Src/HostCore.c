@@ -0,0 +1,722 @@
+#define _GNU_SOURCE
+#include <poll.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "stm32f1xx_hal.h"
+#include "stm32f1xx_it.h"
+
+#include "Host.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+USART_TypeDef HOST_Usart[2];
+DMA_Channel_TypeDef HOST_DmaChannel[7];
+TIM_TypeDef HOST_Tim1;
+RCC_TypeDef HOST_Rcc;
+GPIO_TypeDef HOST_Gpio[4];
+I2C_TypeDef HOST_I2c1;
+CoreDebug_Type HOST_CoreDebug;
+
+uint32_t SystemCoreClock = 72000000;
+// the TIM1 time base, stm32f1xx_hal_timebase_TIM.c on the target
+TIM_HandleTypeDef htim1;
+
+#define HOST_NS_PER_MS          1000000ULL
+// IRQn of the exceptions are negative
+#define HOST_IRQ_INDEX(irq)     ((int)(irq) + 16)
+#define HOST_IRQ_SLOTS          (HOST_IRQ_NUM + 16)
+// ADS1230 at 80 samples per second
+#define HOST_ADS_PERIOD_NS      12500000ULL
+#define HOST_ADS_DATA_BITS      20
+
+int main(void);
+
+static struct timespec startTime;
+static bool bVirtualTime = false;
+static uint64_t virtualNs = 0;
+
+// HOST_Boot(), main() returns at the start of the scheduler
+static bool bBootOnly = false;
+static jmp_buf bootJmp;
+
+// interrupt model
+static uint32_t primask = 0;
+static uint32_t basepri = 0;
+static uint32_t ipsr = 0;                       // exception number of the running handler
+static bool bPendSV = false;
+static uint8_t irqPriority[HOST_IRQ_SLOTS];
+static bool irqEnabled[HOST_IRQ_SLOTS];
+
+// time bases, the interrupts taken since their start
+static bool bTim1On = false;
+static uint64_t tim1StartNs;
+static uint32_t tim1Updates;
+static bool bSysTickOn = false;
+static uint64_t sysTickStartNs;
+static uint32_t sysTicks;
+static bool bTickSuspended = false;
+static volatile uint32_t uwTick;
+
+// DWT cycle counter, CYCCNT = cycles of the clock - base
+static DWT_Type dwt;
+static uint32_t dwtBase;
+static uint32_t dwtLast;
+
+typedef struct
+{
+    GPIO_TypeDef *pDoutPort;
+    uint16_t doutPin;
+    GPIO_TypeDef *pSclkPort;
+    uint16_t sclkPin;
+    int32_t code;                               // 20 bit conversion result
+    uint64_t nextNs;                            // end of the next conversion
+    bool bReady;                                // conversion not retrieved yet
+    uint8_t clocks;                             // SCLK edges since the conversion
+} HOST_tAds;
+
+static HOST_tAds ads[2] =
+{
+    {LC1_DOUT_GPIO_Port, LC1_DOUT_Pin, LC1_SCLK_GPIO_Port, LC1_SCLK_Pin},
+    {LC2_DOUT_GPIO_Port, LC2_DOUT_Pin, LC2_SCLK_GPIO_Port, LC2_SCLK_Pin},
+};
+
+// vector table, a handler the image does not link is ignored as by Default_Handler
+void HOST_DefaultHandler(void) {}
+void SysTick_Handler(void) __attribute__((weak, alias("HOST_DefaultHandler")));
+void PendSV_Handler(void) __attribute__((weak, alias("HOST_DefaultHandler")));
+
+/**---------------------------------------------------------------------
+ * Name         : TIM1_UP_IRQHandler
+ * Description  : time base without the handler of stm32f1xx_it.c, e.g.
+ *                in a test program
+ * Prototype in : stm32f1xx_it.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+__attribute__((weak)) void TIM1_UP_IRQHandler(void)
+{
+    HAL_IncTick();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_CoreInit
+ * Description  : power on, before main(): the clock starts, the reset
+ *                flags and the address pins are set
+ * Prototype in : HostCore.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+__attribute__((constructor)) static void HOST_CoreInit(void)
+{
+    long addr = HOST_EnvNumber("YL_ADDR", 1);
+    const char *pReset = getenv("YL_RESET");
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    // HAL_NVIC_SystemReset() starts the process again with YL_RESET set
+    HOST_Rcc.CSR = RCC_CSR_PINRSTF | ((pReset != NULL) ? RCC_CSR_SFTRSTF : RCC_CSR_PORRSTF);
+    unsetenv("YL_RESET");
+
+    if (addr & 1)
+        ADDR0_GPIO_Port->IDR |= ADDR0_Pin;
+    if (addr & 2)
+        ADDR1_GPIO_Port->IDR |= ADDR1_Pin;
+    if (addr & 4)
+        ADDR2_GPIO_Port->IDR |= ADDR2_Pin;
+    if (addr & 8)
+        ADDR3_GPIO_Port->IDR |= ADDR3_Pin;
+
+    // ReadADS1230Value1() returns the code >> 1
+    ads[0].code = (int32_t)HOST_EnvNumber("YL_ADC1", 100000) * 2;
+    ads[1].code = (int32_t)HOST_EnvNumber("YL_ADC2", 100000) * 2;
+    ads[0].nextNs = HOST_ADS_PERIOD_NS;
+    ads[1].nextNs = HOST_ADS_PERIOD_NS + HOST_ADS_PERIOD_NS / 3;
+
+    irqPriority[HOST_IRQ_INDEX(PendSV_IRQn)] = 15;
+    irqPriority[HOST_IRQ_INDEX(SysTick_IRQn)] = 15;
+    irqEnabled[HOST_IRQ_INDEX(SysTick_IRQn)] = true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_TicksDue
+ * Description  : 1 ms periods of a time base since its start
+ * Prototype in : HostCore.c
+ * \param    	: startNs---start of the time base, now---HOST_Now()
+ * \return    	: number of periods
+ *---------------------------------------------------------------------*/
+static uint32_t HOST_TicksDue(uint64_t startNs, uint64_t now)
+{
+    return (uint32_t)((now - startNs) / HOST_NS_PER_MS);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_NextEvent
+ * Description  : time of the next interrupt of the time bases and the
+ *                UART model that may be taken
+ * Prototype in : HostCore.c
+ * \param    	: now---HOST_Now()
+ *                bUart---with the UART model
+ * \return    	: ns, UINT64_MAX = none
+ *---------------------------------------------------------------------*/
+static uint64_t HOST_NextEvent(uint64_t now, bool bUart)
+{
+    uint64_t next = bUart ? HOST_UartNextEvent() : UINT64_MAX;
+    uint64_t t;
+
+    if (bTim1On && !bTickSuspended && HOST_IrqReady(TIM1_UP_IRQn))
+    {
+        t = tim1StartNs + (uint64_t)(tim1Updates + 1) * HOST_NS_PER_MS;
+        if (t < next)
+            next = t;
+    }
+    if (bSysTickOn && HOST_IrqReady(SysTick_IRQn))
+    {
+        t = sysTickStartNs + (uint64_t)(sysTicks + 1) * HOST_NS_PER_MS;
+        if (t < next)
+            next = t;
+    }
+    return (next < now) ? now : next;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_AdsUpdate
+ * Description  : end of the conversions up to now
+ * Prototype in : HostCore.c
+ * \param    	: pAds---converter
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void HOST_AdsUpdate(HOST_tAds *pAds)
+{
+    uint64_t now = HOST_Now();
+
+    if (now < pAds->nextNs)
+        return;
+    while (pAds->nextNs <= now)
+        pAds->nextNs += HOST_ADS_PERIOD_NS;
+    pAds->bReady = true;
+    pAds->clocks = 0;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_AdsDout
+ * Description  : DOUT/DRDY of the ADS1230: low while a conversion waits,
+ *                after the n-th SCLK bit 20 - n of the result, high
+ *                from the 21st SCLK to the next conversion
+ * Prototype in : HostCore.c
+ * \param    	: pAds---converter
+ * \return    	: level of the pin
+ *---------------------------------------------------------------------*/
+static GPIO_PinState HOST_AdsDout(HOST_tAds *pAds)
+{
+    HOST_AdsUpdate(pAds);
+    if (pAds->clocks == 0)
+        return pAds->bReady ? GPIO_PIN_RESET : GPIO_PIN_SET;
+    if (pAds->clocks > HOST_ADS_DATA_BITS)
+        return GPIO_PIN_SET;
+    return ((uint32_t)pAds->code >> (HOST_ADS_DATA_BITS - pAds->clocks)) & 1 ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_Now
+ * Description  : time of the models
+ * Prototype in : Host.h
+ * \return    	: ns since the start of the process
+ *---------------------------------------------------------------------*/
+uint64_t HOST_Now(void)
+{
+    struct timespec ts;
+
+    if (bVirtualTime)
+        return virtualNs;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)(ts.tv_sec - startTime.tv_sec) * 1000000000ULL + (uint64_t)ts.tv_nsec - (uint64_t)startTime.tv_nsec;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_SetVirtualTime
+ * Description  : the clock stands still and advances by HOST_Sleep()
+ *                only, for test programs without the scheduler
+ * Prototype in : Host.h
+ * \param    	: bOn---virtual time from the current time on
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_SetVirtualTime(bool bOn)
+{
+    if (bOn && !bVirtualTime)
+        virtualNs = HOST_Now();
+    bVirtualTime = bOn;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_Sleep
+ * Description  : busy time of a model, e.g. an I2C transfer
+ * Prototype in : Host.h
+ * \param    	: ns---duration
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_Sleep(uint64_t ns)
+{
+    struct timespec ts;
+
+    if (bVirtualTime)
+    {
+        virtualNs += ns;
+        return;
+    }
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    nanosleep(&ts, NULL);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_Boot
+ * Description  : main() up to osKernelStart() with all its initialization,
+ *                the tasks do not run. The calling program runs their
+ *                functions, e.g. APP_Com1Frame(), and the interrupts by
+ *                HOST_Poll()
+ * Prototype in : Host.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_Boot(void)
+{
+    bBootOnly = true;
+    if (setjmp(bootJmp) == 0)
+        main();
+    // vTaskStartScheduler() masked the interrupts
+    __set_BASEPRI(0);
+}
+
+bool HOST_BootOnly(void)
+{
+    return bBootOnly;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_BootReturn
+ * Description  : back to HOST_Boot() in place of the first task
+ * Prototype in : Host.h
+ * \return    	: does not return
+ *---------------------------------------------------------------------*/
+void HOST_BootReturn(void)
+{
+    longjmp(bootJmp, 1);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_EnvNumber
+ * Description  : number from the environment
+ * Prototype in : Host.h
+ * \param    	: pName---variable, defaultValue---if not set
+ * \return    	: value
+ *---------------------------------------------------------------------*/
+long HOST_EnvNumber(const char *pName, long defaultValue)
+{
+    const char *pValue = getenv(pName);
+
+    return ((pValue != NULL) && (*pValue != 0)) ? strtol(pValue, NULL, 0) : defaultValue;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_IrqReady
+ * Description  : an interrupt of the priority is taken now: enabled, no
+ *                handler active and not masked by PRIMASK or BASEPRI
+ * Prototype in : Host.h
+ * \param    	: irq---interrupt
+ * \return    	: true = may be taken
+ *---------------------------------------------------------------------*/
+bool HOST_IrqReady(IRQn_Type irq)
+{
+    uint32_t priority = (uint32_t)irqPriority[HOST_IRQ_INDEX(irq)] << (8 - __NVIC_PRIO_BITS);
+
+    if (!irqEnabled[HOST_IRQ_INDEX(irq)] || (ipsr != 0) || (primask != 0))
+        return false;
+    return (basepri == 0) || (priority < basepri);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_IrqRun
+ * Description  : run an interrupt handler, interrupts do not nest
+ * Prototype in : Host.h
+ * \param    	: irq---interrupt, pHandler---its handler
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_IrqRun(IRQn_Type irq, void (*pHandler)(void))
+{
+    ipsr = (uint32_t)HOST_IRQ_INDEX(irq);
+    pHandler();
+    ipsr = 0;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_SetPendSV
+ * Description  : portYIELD(), the switch is taken at once in thread
+ *                mode without a mask, else when the mask goes
+ * Prototype in : Host.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_SetPendSV(void)
+{
+    bPendSV = true;
+    HOST_Poll();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_Poll
+ * Description  : take the interrupts due and then a pending context
+ *                switch, the switch returns when the task runs again
+ * Prototype in : Host.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_Poll(void)
+{
+    uint64_t now;
+
+    if ((ipsr != 0) || (primask != 0))
+        return;
+
+    now = HOST_Now();
+    while (bTim1On && !bTickSuspended && (tim1Updates < HOST_TicksDue(tim1StartNs, now)) &&
+           HOST_IrqReady(TIM1_UP_IRQn))
+    {
+        tim1Updates++;
+        HOST_IrqRun(TIM1_UP_IRQn, TIM1_UP_IRQHandler);
+    }
+    while (bSysTickOn && (sysTicks < HOST_TicksDue(sysTickStartNs, now)) && HOST_IrqReady(SysTick_IRQn))
+    {
+        sysTicks++;
+        HOST_IrqRun(SysTick_IRQn, SysTick_Handler);
+    }
+    HOST_UartService(now);
+
+    if (bPendSV && (basepri == 0) && (primask == 0))
+    {
+        bPendSV = false;
+        PendSV_Handler();
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_WaitForInterrupt
+ * Description  : sleep until the next interrupt is due or a pseudo
+ *                terminal has data, then take it
+ * Prototype in : Host.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_WaitForInterrupt(void)
+{
+    struct pollfd fds[4];
+    struct timespec ts;
+    uint64_t now = HOST_Now();
+    uint64_t next = HOST_NextEvent(now, true);
+    int n;
+
+    // a masked UART interrupt is due: the core runs on, in virtual time up to the next tick
+    if (bVirtualTime && (next <= now))
+        next = HOST_NextEvent(now, false);
+    if (next > now)
+    {
+        n = HOST_UartPollFds(fds, 4);
+        if (next == UINT64_MAX)
+            next = now + 100 * HOST_NS_PER_MS;
+        if (bVirtualTime)
+            virtualNs = next;
+        else
+        {
+            ts.tv_sec = (time_t)((next - now) / 1000000000ULL);
+            ts.tv_nsec = (long)((next - now) % 1000000000ULL);
+            ppoll(fds, (nfds_t)n, &ts, NULL);
+        }
+    }
+    HOST_Poll();
+}
+
+//--------------------------------------------------------------------------------------------------
+// core registers
+
+uint32_t __get_PRIMASK(void)
+{
+    return primask;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+    primask = priMask & 1;
+    if (primask == 0)
+        HOST_Poll();
+}
+
+void __disable_irq(void)
+{
+    primask = 1;
+}
+
+void __enable_irq(void)
+{
+    __set_PRIMASK(0);
+}
+
+uint32_t __get_BASEPRI(void)
+{
+    return basepri;
+}
+
+void __set_BASEPRI(uint32_t basePri)
+{
+    basepri = basePri & 0xFF;
+    if (basepri == 0)
+        HOST_Poll();
+}
+
+uint32_t __get_IPSR(void)
+{
+    return ipsr;
+}
+
+void __WFI(void)
+{
+    HOST_WaitForInterrupt();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_Dwt
+ * Description  : DWT with CYCCNT of the current time, a value written
+ *                to CYCCNT since the last call sets the counter
+ * Prototype in : core_cm3.h
+ * \return    	: registers
+ *---------------------------------------------------------------------*/
+DWT_Type *HOST_Dwt(void)
+{
+    uint32_t cycles = (uint32_t)(HOST_Now() * (SystemCoreClock / 1000000) / 1000);
+
+    if (dwt.CYCCNT != dwtLast)
+        dwtBase = cycles - dwt.CYCCNT;
+    dwtLast = cycles - dwtBase;
+    dwt.CYCCNT = dwtLast;
+    return &dwt;
+}
+
+//--------------------------------------------------------------------------------------------------
+// HAL, Cortex and tick
+
+void HAL_Init(void)
+{
+    // HAL_InitTick(TICK_INT_PRIORITY) of stm32f1xx_hal_timebase_TIM.c
+    htim1.Instance = TIM1;
+    HAL_NVIC_SetPriority(TIM1_UP_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(TIM1_UP_IRQn);
+    tim1StartNs = HOST_Now();
+    tim1Updates = 0;
+    bTim1On = true;
+}
+
+void HAL_IncTick(void)
+{
+    uwTick++;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    HOST_Poll();
+    return uwTick;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    uint32_t tickstart = HAL_GetTick();
+    uint32_t wait = Delay;
+
+    if (wait < HAL_MAX_DELAY)
+        wait++;
+    // sleeps to the next tick instead of spinning, the other threads wait for the core anyway
+    while ((HAL_GetTick() - tickstart) < wait)
+        HOST_WaitForInterrupt();
+}
+
+void HAL_SuspendTick(void)
+{
+    bTickSuspended = true;
+}
+
+void HAL_ResumeTick(void)
+{
+    if (bTickSuspended)
+        tim1StartNs = HOST_Now() - (uint64_t)tim1Updates * HOST_NS_PER_MS;
+    bTickSuspended = false;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    (void)SubPriority;
+    irqPriority[HOST_IRQ_INDEX(IRQn)] = (uint8_t)(PreemptPriority & 0x0F);
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    irqEnabled[HOST_IRQ_INDEX(IRQn)] = true;
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    irqEnabled[HOST_IRQ_INDEX(IRQn)] = false;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HAL_NVIC_SystemReset
+ * Description  : start the process again, the pseudo terminals stay open
+ *                and the eeprom file keeps its content. The .noinit RAM
+ *                of the target is not kept
+ * Prototype in : stm32f1xx_hal.h
+ * \return    	: does not return
+ *---------------------------------------------------------------------*/
+void HAL_NVIC_SystemReset(void)
+{
+    HOST_UartKeepForReset();
+    setenv("YL_RESET", "1", 1);
+    execl("/proc/self/exe", "/proc/self/exe", (char *)NULL);
+    perror("HAL_NVIC_SystemReset");
+    exit(1);
+}
+
+uint32_t HAL_SYSTICK_Config(uint32_t TicksNumb)
+{
+    (void)TicksNumb;
+    sysTickStartNs = HOST_Now();
+    sysTicks = 0;
+    bSysTickOn = true;
+    return 0;
+}
+
+void HAL_SYSTICK_CLKSourceConfig(uint32_t CLKSource)
+{
+    (void)CLKSource;
+}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct)
+{
+    (void)RCC_OscInitStruct;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency)
+{
+    (void)RCC_ClkInitStruct;
+    (void)FLatency;
+    return HAL_OK;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void)
+{
+    return SystemCoreClock;
+}
+
+//--------------------------------------------------------------------------------------------------
+// TIM1 time base
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_TimCounter
+ * Description  : CNT of the 1 MHz time base, the us in the current ms
+ * Prototype in : stm32f1xx_hal.h
+ * \param    	: htim---TIM1
+ * \return    	: 0..999
+ *---------------------------------------------------------------------*/
+uint32_t HOST_TimCounter(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+    if (!bTim1On)
+        return 0;
+    return (uint32_t)(((HOST_Now() - tim1StartNs) / 1000) % 1000);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_TimFlags
+ * Description  : SR of the time base, UIF while an update interrupt is
+ *                pending
+ * Prototype in : stm32f1xx_hal.h
+ * \param    	: htim---TIM1
+ * \return    	: flags
+ *---------------------------------------------------------------------*/
+uint32_t HOST_TimFlags(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+    if (!bTim1On || bTickSuspended)
+        return 0;
+    return (tim1Updates < HOST_TicksDue(tim1StartNs, HOST_Now())) ? TIM_FLAG_UPDATE : 0;
+}
+
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef *htim)
+{
+    HAL_TIM_PeriodElapsedCallback(htim);
+}
+
+__attribute__((weak)) void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+}
+
+//--------------------------------------------------------------------------------------------------
+// GPIO with the converters on LC1 and LC2
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+    (void)GPIOx;
+    (void)GPIO_Init;
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
+{
+    (void)GPIOx;
+    (void)GPIO_Pin;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        if ((GPIOx == ads[i].pDoutPort) && (GPIO_Pin == ads[i].doutPin))
+            return HOST_AdsDout(&ads[i]);
+    }
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    uint32_t before = GPIOx->ODR;
+    int i;
+
+    if (PinState != GPIO_PIN_RESET)
+        GPIOx->ODR |= GPIO_Pin;
+    else
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    GPIOx->IDR = (GPIOx->IDR & ~(uint32_t)GPIO_Pin) | (GPIOx->ODR & GPIO_Pin);
+
+    // a rising SCLK shifts out the next bit of a converter
+    for (i = 0; i < 2; i++)
+    {
+        if ((GPIOx == ads[i].pSclkPort) && (GPIO_Pin & ads[i].sclkPin) && !(before & ads[i].sclkPin) &&
+            (PinState != GPIO_PIN_RESET))
+        {
+            HOST_AdsUpdate(&ads[i]);
+            if (ads[i].clocks < 0xFF)
+                ads[i].clocks++;
+            if (ads[i].clocks > HOST_ADS_DATA_BITS)
+                ads[i].bReady = false;
+        }
+    }
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    HAL_GPIO_WritePin(GPIOx, GPIO_Pin, (GPIOx->ODR & GPIO_Pin) ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
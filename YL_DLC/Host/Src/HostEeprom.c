@@ -0,0 +1,311 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "stm32f1xx_hal.h"
+
+#include "Host.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+// 24C32 as on the board: 4 kByte, 64 byte pages, 5 ms write cycle, 100 kHz bus
+#define HOST_EE_SIZE            4096
+#define HOST_EE_PAGE_SIZE       64
+#define HOST_EE_PAGES           (HOST_EE_SIZE / HOST_EE_PAGE_SIZE)
+#define HOST_EE_WRITE_NS        5000000ULL
+#define HOST_EE_BYTE_NS         90000ULL        // 9 clocks
+#define HOST_EE_DEVICE          0xA0
+
+static uint8_t image[HOST_EE_SIZE];
+static uint32_t pageWear[HOST_EE_PAGES];
+static uint32_t cellWear[HOST_EE_SIZE];         // programs of each byte
+static HOST_tEepromStat stat;
+static uint64_t busyUntil;                      // end of the write cycle
+static int fd = -1;
+static bool bLoaded = false;
+
+// injected power loss
+static bool bFailArmed = false;
+static uint32_t failAfter;
+static bool bPowerOff = false;
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_EepromLoad
+ * Description  : content of YL_EEPROM at the first access
+ * Prototype in : HostEeprom.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void HOST_EepromLoad(void)
+{
+    if (bLoaded)
+        return;
+    bLoaded = true;
+    HOST_EepromOpen(getenv("YL_EEPROM"));
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_EepromAck
+ * Description  : device address phase of a transfer, no acknowledge
+ *                during a write cycle or without power
+ * Prototype in : HostEeprom.c
+ * \param    	: DevAddress---address with the R/W bit
+ * \return    	: true = acknowledged
+ *---------------------------------------------------------------------*/
+static bool HOST_EepromAck(uint16_t DevAddress)
+{
+    HOST_EepromLoad();
+    if (((DevAddress & 0xFE) != HOST_EE_DEVICE) || bPowerOff || (HOST_Now() < busyUntil))
+    {
+        stat.nacks++;
+        HOST_Sleep(HOST_EE_BYTE_NS);
+        return false;
+    }
+    return true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_EepromSave
+ * Description  : page to the file
+ * Prototype in : HostEeprom.c
+ * \param    	: page---page number
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void HOST_EepromSave(uint16_t page)
+{
+    off_t offset = (off_t)page * HOST_EE_PAGE_SIZE;
+
+    if ((fd >= 0) && (pwrite(fd, &image[offset], HOST_EE_PAGE_SIZE, offset) != HOST_EE_PAGE_SIZE))
+        perror("YL_EEPROM");
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_EepromOpen
+ * Description  : content from a file, a new file is erased. Without a
+ *                file the content is erased and lives in RAM only
+ * Prototype in : Host.h
+ * \param    	: pPath---file, NULL or "" = none
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_EepromOpen(const char *pPath)
+{
+    ssize_t n = 0;
+
+    bLoaded = true;
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+    memset(image, 0xFF, sizeof(image));
+    if ((pPath == NULL) || (*pPath == 0))
+        return;
+
+    fd = open(pPath, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        perror(pPath);
+        return;
+    }
+    n = pread(fd, image, sizeof(image), 0);
+    if (n < (ssize_t)sizeof(image))
+    {
+        memset(&image[(n > 0) ? n : 0], 0xFF, sizeof(image) - (size_t)((n > 0) ? n : 0));
+        if (pwrite(fd, image, sizeof(image), 0) != (ssize_t)sizeof(image))
+            perror(pPath);
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_EepromErase
+ * Description  : content 0xFF, counters and wear cleared
+ * Prototype in : Host.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_EepromErase(void)
+{
+    uint16_t page;
+
+    HOST_EepromLoad();
+    memset(image, 0xFF, sizeof(image));
+    HOST_EepromClearStat();
+    busyUntil = 0;
+    for (page = 0; page < HOST_EE_PAGES; page++)
+        HOST_EepromSave(page);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_EepromPowerFail
+ * Description  : the supply fails after the given number of programmed
+ *                bytes: the byte being programmed gets an undefined
+ *                value, the rest of the page keeps its old content and
+ *                the device does not answer until HOST_EepromPowerOn()
+ * Prototype in : Host.h
+ * \param    	: afterBytes---bytes programmed before the loss
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_EepromPowerFail(uint32_t afterBytes)
+{
+    bFailArmed = true;
+    failAfter = afterBytes;
+}
+
+bool HOST_EepromPowerFailed(void)
+{
+    return bPowerOff;
+}
+
+void HOST_EepromPowerOn(void)
+{
+    bFailArmed = false;
+    bPowerOff = false;
+    busyUntil = 0;
+}
+
+void HOST_EepromGetStat(HOST_tEepromStat *pStat)
+{
+    uint16_t i;
+
+    *pStat = stat;
+    pStat->maxPageWear = 0;
+    pStat->maxCellWear = 0;
+    for (i = 0; i < HOST_EE_PAGES; i++)
+    {
+        if (pageWear[i] > pStat->maxPageWear)
+            pStat->maxPageWear = pageWear[i];
+    }
+    for (i = 0; i < HOST_EE_SIZE; i++)
+    {
+        if (cellWear[i] > pStat->maxCellWear)
+            pStat->maxCellWear = cellWear[i];
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_EepromClearStat
+ * Description  : counters and wear cleared, the content stays
+ * Prototype in : Host.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_EepromClearStat(void)
+{
+    memset(pageWear, 0, sizeof(pageWear));
+    memset(cellWear, 0, sizeof(cellWear));
+    memset(&stat, 0, sizeof(stat));
+}
+
+uint32_t HOST_EepromPageWear(uint16_t page)
+{
+    return (page < HOST_EE_PAGES) ? pageWear[page] : 0;
+}
+
+uint32_t HOST_EepromCellWear(uint16_t address)
+{
+    return (address < HOST_EE_SIZE) ? cellWear[address] : 0;
+}
+
+const uint8_t *HOST_EepromImage(void)
+{
+    HOST_EepromLoad();
+    return image;
+}
+
+//--------------------------------------------------------------------------------------------------
+// HAL
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+    HAL_I2C_MspInit(hi2c);
+    hi2c->State = HAL_I2C_STATE_READY;
+    return HAL_OK;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HAL_I2C_Mem_Write
+ * Description  : page write, the address rolls over within the page. The
+ *                write cycle starts at the stop condition
+ * Prototype in : stm32f1xx_hal.h
+ * \return    	: HAL_ERROR = no acknowledge
+ *---------------------------------------------------------------------*/
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    uint16_t address = MemAddress % HOST_EE_SIZE;
+    uint16_t page = address / HOST_EE_PAGE_SIZE;
+    uint16_t i;
+
+    (void)MemAddSize;
+    (void)Timeout;
+    if (!HOST_EepromAck(DevAddress))
+        return HAL_ERROR;
+    hi2c->State = HAL_I2C_STATE_BUSY;
+    HOST_Sleep((3 + (uint64_t)Size) * HOST_EE_BYTE_NS);
+
+    for (i = 0; i < Size; i++)
+    {
+        if (bFailArmed && (failAfter == 0))
+        {
+            image[address] = (uint8_t)(image[address] ^ 0xA5);
+            bFailArmed = false;
+            bPowerOff = true;
+            break;
+        }
+        if (bFailArmed)
+            failAfter--;
+        image[address] = pData[i];
+        cellWear[address]++;
+        address = (uint16_t)(page * HOST_EE_PAGE_SIZE + (address + 1) % HOST_EE_PAGE_SIZE);
+    }
+
+    stat.pagePrograms++;
+    stat.programBytes += i;
+    pageWear[page]++;
+    HOST_EepromSave(page);
+    busyUntil = HOST_Now() + HOST_EE_WRITE_NS;
+    hi2c->State = HAL_I2C_STATE_READY;
+    return bPowerOff ? HAL_ERROR : HAL_OK;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HAL_I2C_Mem_Read
+ * Description  : random address read, sequential, wraps at the end
+ * Prototype in : stm32f1xx_hal.h
+ * \return    	: HAL_ERROR = no acknowledge
+ *---------------------------------------------------------------------*/
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    uint16_t i;
+
+    (void)MemAddSize;
+    (void)Timeout;
+    if (!HOST_EepromAck(DevAddress))
+        return HAL_ERROR;
+    hi2c->State = HAL_I2C_STATE_BUSY;
+    HOST_Sleep((4 + (uint64_t)Size) * HOST_EE_BYTE_NS);
+    for (i = 0; i < Size; i++)
+        pData[i] = image[(MemAddress + i) % HOST_EE_SIZE];
+    stat.readBytes += Size;
+    hi2c->State = HAL_I2C_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef *hi2c)
+{
+    return hi2c->State;
+}
+
+__attribute__((weak)) void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+__attribute__((weak)) void HAL_I2C_MspDeInit(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
@@ -0,0 +1,556 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+// the delay masks of termios.h, names of the USART registers
+#undef CR1
+#undef CR2
+#undef CR3
+
+#include "stm32f1xx_hal.h"
+#include "stm32f1xx_it.h"
+
+#include "Host.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+#define HOST_UART_PORTS         2
+// the bytes a pseudo terminal received are taken at most this often, a read is a system call
+#define HOST_UART_READ_NS       20000ULL
+
+typedef struct
+{
+    USART_TypeDef *pInstance;
+    IRQn_Type irq;
+    IRQn_Type txDmaIrq;
+    void (*pIrqHandler)(void);
+    void (*pTxDmaIrqHandler)(void);
+    const char *pLinkEnv;                       // YL_COMn, link to the pseudo terminal
+    const char *pFdEnv;                         // YL_COMn_FD, descriptors kept by the reset
+
+    UART_HandleTypeDef *pHandle;
+    bool bCapture;                              // no terminal, HOST_UartInject() and HOST_UartTakeTx()
+    int master;                                 // -1 = not open
+    int slave;
+    uint32_t baud;                              // HOST_UartSetBaud(), 0 = the one of HAL_UART_Init()
+    uint64_t charNs;                            // 10 bits at the baud rate
+
+    // receive DMA
+    uint8_t *pRxBuff;
+    uint16_t rxSize;
+    uint64_t nextReadAt;
+    uint64_t lineFreeAt;                        // end of the last received character
+    bool bIdlePending;
+    uint64_t idleAt;
+
+    // transmit
+    bool bTxBusy;
+    bool bTxDma;
+    uint64_t txDoneAt;
+    uint8_t txCapture[1024];
+    uint16_t txCaptureLen;
+    uint64_t txCaptureStart;
+} HOST_tUart;
+
+static HOST_tUart uart[HOST_UART_PORTS] =
+{
+    {USART1, USART1_IRQn, DMA1_Channel4_IRQn, USART1_IRQHandler, DMA1_Channel4_IRQHandler, "YL_COM1", "YL_COM1_FD"},
+    {USART2, USART2_IRQn, DMA1_Channel7_IRQn, USART2_IRQHandler, DMA1_Channel7_IRQHandler, "YL_COM2", "YL_COM2_FD"},
+};
+
+// vector table, a program without stm32f1xx_it.c takes no UART interrupt
+void HOST_UartDefaultHandler(void) {}
+void USART1_IRQHandler(void) __attribute__((weak, alias("HOST_UartDefaultHandler")));
+void USART2_IRQHandler(void) __attribute__((weak, alias("HOST_UartDefaultHandler")));
+void DMA1_Channel4_IRQHandler(void) __attribute__((weak, alias("HOST_UartDefaultHandler")));
+void DMA1_Channel5_IRQHandler(void) __attribute__((weak, alias("HOST_UartDefaultHandler")));
+void DMA1_Channel6_IRQHandler(void) __attribute__((weak, alias("HOST_UartDefaultHandler")));
+void DMA1_Channel7_IRQHandler(void) __attribute__((weak, alias("HOST_UartDefaultHandler")));
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartOf
+ * Description  : model of a USART
+ * Prototype in : HostUart.c
+ * \param    	: pInstance---registers
+ * \return    	: port, NULL = no model
+ *---------------------------------------------------------------------*/
+static HOST_tUart *HOST_UartOf(USART_TypeDef *pInstance)
+{
+    int i;
+
+    for (i = 0; i < HOST_UART_PORTS; i++)
+    {
+        if (uart[i].pInstance == pInstance)
+            return &uart[i];
+    }
+    return NULL;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartOpen
+ * Description  : pseudo terminal of a port, the one of the process
+ *                before HAL_NVIC_SystemReset() or a new one. The slave
+ *                stays open in raw mode, so the master never sees a hang
+ *                up while no program has the port open
+ * Prototype in : HostUart.c
+ * \param    	: pPort---port
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void HOST_UartOpen(HOST_tUart *pPort)
+{
+    const char *pFds = getenv(pPort->pFdEnv);
+    const char *pLink = getenv(pPort->pLinkEnv);
+    const char *pName;
+    struct termios tio;
+
+    if ((pPort->master >= 0) || pPort->bCapture)
+        return;
+
+    if ((pFds != NULL) && (sscanf(pFds, "%d,%d", &pPort->master, &pPort->slave) == 2))
+        return;
+
+    pPort->master = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((pPort->master < 0) || (grantpt(pPort->master) != 0) || (unlockpt(pPort->master) != 0))
+    {
+        perror("posix_openpt");
+        exit(1);
+    }
+    pName = ptsname(pPort->master);
+    pPort->slave = open(pName, O_RDWR | O_NOCTTY);
+    if ((pPort->slave >= 0) && (tcgetattr(pPort->slave, &tio) == 0))
+    {
+        cfmakeraw(&tio);
+        tcsetattr(pPort->slave, TCSANOW, &tio);
+    }
+    fcntl(pPort->master, F_SETFL, fcntl(pPort->master, F_GETFL) | O_NONBLOCK);
+
+    if ((pLink != NULL) && (*pLink != 0))
+    {
+        unlink(pLink);
+        if (symlink(pName, pLink) != 0)
+            perror(pLink);
+    }
+    fprintf(stderr, "COM%d %s\n", (int)(pPort - uart) + 1, pName);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartStore
+ * Description  : bytes on the line, the DMA stores them while it is
+ *                armed, the rest is lost. The line is busy one character
+ *                time per byte, IDLE follows one character after the last
+ * Prototype in : HostUart.c
+ * \param    	: pPort---port, pData, n---bytes, lineStart---first start bit
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void HOST_UartStore(HOST_tUart *pPort, const uint8_t *pData, uint32_t n, uint64_t lineStart)
+{
+    DMA_Channel_TypeDef *pDma = (pPort->pHandle->hdmarx != NULL) ? pPort->pHandle->hdmarx->Instance : NULL;
+    uint32_t k = 0;
+
+    if ((pPort->pHandle->RxState == HAL_UART_STATE_BUSY_RX) && (pDma != NULL))
+    {
+        k = (n < pDma->CNDTR) ? n : pDma->CNDTR;
+        memcpy(pPort->pRxBuff + (pPort->rxSize - pDma->CNDTR), pData, k);
+        pDma->CNDTR -= k;
+    }
+
+    pPort->lineFreeAt = ((pPort->lineFreeAt > lineStart) ? pPort->lineFreeAt : lineStart) + (uint64_t)n * pPort->charNs;
+    pPort->idleAt = pPort->lineFreeAt + pPort->charNs;
+    pPort->bIdlePending = true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartReceive
+ * Description  : bytes from the pseudo terminal, they start now
+ * Prototype in : HostUart.c
+ * \param    	: pPort---port, now---HOST_Now()
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void HOST_UartReceive(HOST_tUart *pPort, uint64_t now)
+{
+    uint8_t buff[256];
+    ssize_t n;
+
+    if ((pPort->master < 0) || (now < pPort->nextReadAt))
+        return;
+    pPort->nextReadAt = now + HOST_UART_READ_NS;
+
+    n = read(pPort->master, buff, sizeof(buff));
+    if (n > 0)
+        HOST_UartStore(pPort, buff, (uint32_t)n, now);
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartInit
+ * Description  : no port open yet, HAL_UART_Init() opens them
+ * Prototype in : Host.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_UartInit(void)
+{
+    int i;
+
+    for (i = 0; i < HOST_UART_PORTS; i++)
+    {
+        uart[i].master = -1;
+        uart[i].slave = -1;
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartService
+ * Description  : receive, raise IDLE and the end of a transmission and
+ *                take their interrupts when they are not masked
+ * Prototype in : Host.h
+ * \param    	: now---HOST_Now()
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_UartService(uint64_t now)
+{
+    HOST_tUart *pPort;
+    int i;
+
+    for (i = 0; i < HOST_UART_PORTS; i++)
+    {
+        pPort = &uart[i];
+        if ((pPort->pHandle == NULL) || ((pPort->master < 0) && !pPort->bCapture))
+            continue;
+
+        HOST_UartReceive(pPort, now);
+        if (pPort->bIdlePending && (now >= pPort->idleAt) && (pPort->pInstance->CR1 & USART_CR1_IDLEIE))
+        {
+            pPort->pInstance->SR |= USART_SR_IDLE;
+            if (HOST_IrqReady(pPort->irq))
+            {
+                pPort->bIdlePending = false;
+                HOST_IrqRun(pPort->irq, pPort->pIrqHandler);
+            }
+        }
+
+        if (pPort->bTxBusy && (now >= pPort->txDoneAt))
+        {
+            // DMA transfer complete, its handler enables TC of the USART
+            if (pPort->bTxDma && HOST_IrqReady(pPort->txDmaIrq))
+            {
+                pPort->bTxDma = false;
+                HOST_IrqRun(pPort->txDmaIrq, pPort->pTxDmaIrqHandler);
+            }
+            pPort->pInstance->SR |= USART_SR_TC;
+            if (pPort->bTxDma)
+                continue;
+            if (!(pPort->pInstance->CR1 & USART_CR1_TCIE))
+                pPort->bTxBusy = false;
+            else if (HOST_IrqReady(pPort->irq))
+            {
+                pPort->bTxBusy = false;
+                HOST_IrqRun(pPort->irq, pPort->pIrqHandler);
+            }
+        }
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartNextEvent
+ * Description  : next IDLE or end of a transmission whose interrupt
+ *                may be taken, a masked one waits for the unmask
+ * Prototype in : Host.h
+ * \return    	: ns, UINT64_MAX = none
+ *---------------------------------------------------------------------*/
+uint64_t HOST_UartNextEvent(void)
+{
+    HOST_tUart *pPort;
+    uint64_t next = UINT64_MAX;
+    int i;
+
+    for (i = 0; i < HOST_UART_PORTS; i++)
+    {
+        pPort = &uart[i];
+        if (pPort->bIdlePending && (pPort->idleAt < next) && (pPort->pInstance->CR1 & USART_CR1_IDLEIE) &&
+            HOST_IrqReady(pPort->irq))
+            next = pPort->idleAt;
+        if (pPort->bTxBusy && (pPort->txDoneAt < next) &&
+            (pPort->bTxDma ? HOST_IrqReady(pPort->txDmaIrq) :
+             (!(pPort->pInstance->CR1 & USART_CR1_TCIE) || HOST_IrqReady(pPort->irq))))
+            next = pPort->txDoneAt;
+    }
+    return next;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartPollFds
+ * Description  : the pseudo terminals to wait for in the idle task
+ * Prototype in : Host.h
+ * \param    	: pFds---poll entries, max---entries available
+ * \return    	: entries used
+ *---------------------------------------------------------------------*/
+int HOST_UartPollFds(struct pollfd *pFds, int max)
+{
+    int n = 0;
+    int i;
+
+    for (i = 0; (i < HOST_UART_PORTS) && (n < max); i++)
+    {
+        if ((uart[i].pHandle == NULL) || (uart[i].master < 0))
+            continue;
+        pFds[n].fd = uart[i].master;
+        pFds[n].events = POLLIN;
+        pFds[n].revents = 0;
+        n++;
+    }
+    return n;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartKeepForReset
+ * Description  : pass the pseudo terminals to the process after the
+ *                reset, a program on the port keeps its connection
+ * Prototype in : Host.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_UartKeepForReset(void)
+{
+    char fds[32];
+    int i;
+
+    for (i = 0; i < HOST_UART_PORTS; i++)
+    {
+        if (uart[i].master < 0)
+            continue;
+        snprintf(fds, sizeof(fds), "%d,%d", uart[i].master, uart[i].slave);
+        setenv(uart[i].pFdEnv, fds, 1);
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartCapture
+ * Description  : the port gets no pseudo terminal: the program puts the
+ *                received bytes on the line and takes the transmitted
+ *                ones. Before HAL_UART_Init()
+ * Prototype in : Host.h
+ * \param    	: port---0 = USART1, 1 = USART2
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_UartCapture(uint8_t port)
+{
+    if (port < HOST_UART_PORTS)
+        uart[port].bCapture = true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartSetBaud
+ * Description  : line rate of the model in place of the one the firmware
+ *                sets, to try another baud rate. Before HAL_UART_Init()
+ * Prototype in : Host.h
+ * \param    	: port---0 = USART1, 1 = USART2, baud---bits per second
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_UartSetBaud(uint8_t port, uint32_t baud)
+{
+    if (port < HOST_UART_PORTS)
+        uart[port].baud = baud;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartInject
+ * Description  : bytes received with the last stop bit now, IDLE is due
+ *                one character later
+ * Prototype in : Host.h
+ * \param    	: port---0 = USART1, 1 = USART2, pData, size---bytes
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_UartInject(uint8_t port, const uint8_t *pData, uint16_t size)
+{
+    HOST_tUart *pPort = &uart[port % HOST_UART_PORTS];
+    uint64_t now = HOST_Now();
+    uint64_t duration;
+
+    if (pPort->pHandle == NULL)
+        return;
+    duration = (uint64_t)size * pPort->charNs;
+    HOST_UartStore(pPort, pData, size, (now > duration) ? now - duration : 0);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartTakeTx
+ * Description  : bytes transmitted since the last call
+ * Prototype in : Host.h
+ * \param    	: port---0 = USART1, 1 = USART2, pData, max---buffer
+ *                pStart---time of the first start bit
+ * \return    	: number of bytes
+ *---------------------------------------------------------------------*/
+uint16_t HOST_UartTakeTx(uint8_t port, uint8_t *pData, uint16_t max, uint64_t *pStart)
+{
+    HOST_tUart *pPort = &uart[port % HOST_UART_PORTS];
+    uint16_t n = (pPort->txCaptureLen < max) ? pPort->txCaptureLen : max;
+
+    memcpy(pData, pPort->txCapture, n);
+    *pStart = pPort->txCaptureStart;
+    pPort->txCaptureLen = 0;
+    return n;
+}
+
+//--------------------------------------------------------------------------------------------------
+// HAL
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    HOST_tUart *pPort = HOST_UartOf(huart->Instance);
+    static bool bInit = false;
+
+    if (pPort == NULL)
+        return HAL_ERROR;
+    if (!bInit)
+    {
+        HOST_UartInit();
+        bInit = true;
+    }
+
+    HAL_UART_MspInit(huart);
+    pPort->pHandle = huart;
+    pPort->charNs = 10000000000ULL / ((pPort->baud != 0) ? pPort->baud : huart->Init.BaudRate);
+    HOST_UartOpen(pPort);
+
+    huart->Instance->SR = USART_SR_TC | USART_SR_TXE;
+    huart->Instance->CR1 = 0;
+    huart->ErrorCode = 0;
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_UartTransmit
+ * Description  : the bytes go to the pseudo terminal at once, the port is
+ *                busy for their character times
+ * Prototype in : HostUart.c
+ * \param    	: huart---port, pData, Size---bytes, bDma---by DMA
+ * \return    	: HAL_BUSY while a transmission runs
+ *---------------------------------------------------------------------*/
+static HAL_StatusTypeDef HOST_UartTransmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, bool bDma)
+{
+    HOST_tUart *pPort = HOST_UartOf(huart->Instance);
+    uint64_t now = HOST_Now();
+    size_t n;
+
+    if (huart->gState != HAL_UART_STATE_READY)
+        return HAL_BUSY;
+    if ((pPort == NULL) || (pData == NULL) || (Size == 0))
+        return HAL_ERROR;
+
+    huart->pTxBuffPtr = pData;
+    huart->TxXferSize = Size;
+    huart->TxXferCount = 0;
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    huart->Instance->SR &= ~USART_SR_TC;
+    if (!bDma)
+        huart->Instance->CR1 |= USART_CR1_TCIE;
+
+    if (pPort->bCapture)
+    {
+        if (pPort->txCaptureLen == 0)
+            pPort->txCaptureStart = (pPort->txDoneAt > now) ? pPort->txDoneAt : now;
+        n = (Size < sizeof(pPort->txCapture) - pPort->txCaptureLen) ? Size : sizeof(pPort->txCapture) - pPort->txCaptureLen;
+        memcpy(&pPort->txCapture[pPort->txCaptureLen], pData, n);
+        pPort->txCaptureLen += (uint16_t)n;
+    }
+    // a full pseudo terminal drops, as the line does when nobody listens
+    else if (write(pPort->master, pData, Size) < 0 && (errno != EAGAIN))
+        perror("HAL_UART_Transmit");
+
+    pPort->bTxBusy = true;
+    pPort->bTxDma = bDma;
+    pPort->txDoneAt = ((pPort->txDoneAt > now) ? pPort->txDoneAt : now) + (uint64_t)Size * pPort->charNs;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    return HOST_UartTransmit(huart, pData, Size, false);
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    return HOST_UartTransmit(huart, pData, Size, true);
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    HOST_tUart *pPort = HOST_UartOf(huart->Instance);
+
+    if (huart->RxState != HAL_UART_STATE_READY)
+        return HAL_BUSY;
+    if ((pPort == NULL) || (pData == NULL) || (Size == 0) || (huart->hdmarx == NULL))
+        return HAL_ERROR;
+
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    huart->hdmarx->Instance->CNDTR = Size;
+    pPort->pRxBuff = pData;
+    pPort->rxSize = Size;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart)
+{
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart)
+{
+    if ((huart->Instance->SR & USART_SR_TC) && (huart->Instance->CR1 & USART_CR1_TCIE))
+    {
+        huart->Instance->CR1 &= ~USART_CR1_TCIE;
+        huart->TxXferCount = huart->TxXferSize;
+        huart->gState = HAL_UART_STATE_READY;
+        HAL_UART_TxCpltCallback(huart);
+    }
+}
+
+__attribute__((weak)) void HAL_UART_MspInit(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__attribute__((weak)) void HAL_UART_MspDeInit(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
+{
+    UART_HandleTypeDef *huart = hdma->Parent;
+
+    // UART_DMATransmitCplt(): the USART interrupts at the end of the last character
+    if ((huart != NULL) && (huart->hdmatx == hdma))
+        huart->Instance->CR1 |= USART_CR1_TCIE;
+}
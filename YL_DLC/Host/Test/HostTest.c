@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "Host.h"
+#include "HostTest.h"
+
+#include "usart.h"
+#include "UserParam.h"
+#include "EventLoop.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+#define HOST_TEST_NS_PER_MS     1000000ULL
+
+// periods of the tasks, the osDelay() of freertos.c
+#define HOST_TEST_ADC_MS        10
+#define HOST_TEST_WEIGH_MS      100
+#define HOST_TEST_COM2_MS       20
+
+// next run of each task, relative to the end of its last run as osDelay()
+static uint64_t nextAdc;
+static uint64_t nextWeigh;
+static uint64_t nextCom2;
+static uint64_t flushAt;
+static bool bFlushPending = false;
+
+// COM2 output since the last command
+static char reply[1024];
+static uint16_t replyLen;
+
+static int failures = 0;
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_TestTakeReply
+ * Description  : COM2 output of the firmware into the reply buffer
+ * Prototype in : HostTest.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void HOST_TestTakeReply(void)
+{
+    uint8_t buf[256];
+    uint64_t start;
+    uint16_t n;
+
+    HOST_UartTakeTx(0, buf, sizeof(buf), &start);
+    n = HOST_UartTakeTx(1, buf, sizeof(buf), &start);
+    if (n > sizeof(reply) - 1 - replyLen)
+        n = sizeof(reply) - 1 - replyLen;
+    memcpy(&reply[replyLen], buf, n);
+    replyLen += n;
+    reply[replyLen] = 0;
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_TestBoot
+ * Description  : main() up to the scheduler on an erased eeprom, it
+ *                writes the defaults
+ * Prototype in : HostTest.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_TestBoot(void)
+{
+    uint64_t now;
+
+    HOST_EepromOpen(NULL);
+    HOST_SetVirtualTime(true);
+    HOST_UartCapture(0);
+    HOST_UartCapture(1);
+    HOST_Boot();
+
+    now = HOST_Now();
+    nextAdc = now;
+    nextWeigh = now;
+    nextCom2 = now;
+    HOST_TestTakeReply();
+    replyLen = 0;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_TestRun
+ * Description  : the tasks of freertos.c for the given time, each one
+ *                when its osDelay() ends
+ * Prototype in : HostTest.h
+ * \param    	: ms---time to run
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_TestRun(uint32_t ms)
+{
+    uint64_t end = HOST_Now() + ms * HOST_TEST_NS_PER_MS;
+    uint64_t now, next;
+
+    for (;;)
+    {
+        now = HOST_Now();
+        if (now >= nextAdc)
+        {
+            APP_AdcPoll();
+            nextAdc = HOST_Now() + HOST_TEST_ADC_MS * HOST_TEST_NS_PER_MS;
+        }
+        if (now >= nextWeigh)
+        {
+            APP_WeighCycle();
+            nextWeigh = HOST_Now() + HOST_TEST_WEIGH_MS * HOST_TEST_NS_PER_MS;
+        }
+        if (now >= nextCom2)
+        {
+            if (usart2_rx_flag == 1)
+                APP_Com2Frame();
+            APP_SicsPoll();
+            nextCom2 = HOST_Now() + HOST_TEST_COM2_MS * HOST_TEST_NS_PER_MS;
+        }
+
+        // EE_FlushTask: woken by the change, writes after the delay
+        if (bFlushPending && (now >= flushAt))
+        {
+            bFlushPending = false;
+            APP_ParamFlush();
+        }
+        if (!bFlushPending && USER_PARAM_IsDirty())
+        {
+            bFlushPending = true;
+            flushAt = HOST_Now() + USER_PARAM_FLUSH_DELAY * HOST_TEST_NS_PER_MS;
+        }
+        HOST_TestTakeReply();
+
+        now = HOST_Now();
+        if (now >= end)
+            break;
+        next = (nextAdc < nextWeigh) ? nextAdc : nextWeigh;
+        if (nextCom2 < next)
+            next = nextCom2;
+        if (bFlushPending && (flushAt < next))
+            next = flushAt;
+        if (end < next)
+            next = end;
+        // one step at most 1 ms, the interrupts are taken on the way
+        if (next > now + HOST_TEST_NS_PER_MS)
+            next = now + HOST_TEST_NS_PER_MS;
+        if (next > now)
+            HOST_Sleep(next - now);
+        HOST_Poll();
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : HOST_TestCommand
+ * Description  : a line on COM2, the tasks run until Uart2_ProcessTask
+ *                has answered it
+ * Prototype in : HostTest.h
+ * \param    	: pLine---command without the line end
+ *                pReply, max---the output on COM2 meanwhile, NULL = none
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void HOST_TestCommand(const char *pLine, char *pReply, uint16_t max)
+{
+    char line[128];
+    int n = snprintf(line, sizeof(line), "%s\r\n", pLine);
+
+    replyLen = 0;
+    reply[0] = 0;
+    HOST_UartInject(1, (const uint8_t *)line, (uint16_t)n);
+    HOST_TestRun(2 * HOST_TEST_COM2_MS);
+    if ((pReply != NULL) && (max > 0))
+    {
+        strncpy(pReply, reply, max - 1);
+        pReply[max - 1] = 0;
+    }
+}
+
+bool HOST_TestCheck(bool bOk, const char *pText, const char *pFile, int line)
+{
+    if (!bOk)
+    {
+        fprintf(stderr, "%s:%d: check failed: %s\n", pFile, line, pText);
+        failures++;
+    }
+    return bOk;
+}
+
+int HOST_TestFailures(void)
+{
+    return failures;
+}
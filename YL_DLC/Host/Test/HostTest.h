@@ -0,0 +1,34 @@
+#ifndef _HOST_TEST_H
+#define _HOST_TEST_H
+
+//==================================================================================================
+//  Test programs on libyl_dlc.so
+//
+//  The firmware is booted by HOST_Boot() with virtual time, the eeprom in RAM and both ports
+//  captured. HOST_TestRun() then runs the task functions of freertos.c at their periods in place
+//  of the scheduler: APP_AdcPoll() every 10 ms, APP_WeighCycle() every 100 ms, APP_Com2Frame() and
+//  APP_SicsPoll() every 20 ms and APP_ParamFlush() USER_PARAM_FLUSH_DELAY after a parameter
+//  change, as EE_FlushTask does. The time the eeprom driver spends in HAL_Delay() passes on the
+//  same clock.
+//==================================================================================================
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//! boot the firmware, the eeprom content is erased
+void HOST_TestBoot(void);
+
+//! run the tasks for the given time
+void HOST_TestRun(uint32_t ms);
+
+//! command line on COM2 as the terminal sends it, the reply in pReply (may be NULL)
+void HOST_TestCommand(const char *pLine, char *pReply, uint16_t max);
+
+//! failed check, counted by HOST_TestCheck()
+#define HOST_CHECK(cond)    HOST_TestCheck((cond), #cond, __FILE__, __LINE__)
+bool HOST_TestCheck(bool bOk, const char *pText, const char *pFile, int line);
+
+//! checks failed so far
+int HOST_TestFailures(void);
+
+#endif
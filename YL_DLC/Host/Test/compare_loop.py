@@ -0,0 +1,200 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""The same input through the task build and the event loop build.
+
+    make loop
+    python compare_loop.py <yl_dlc of APP_EVENT_LOOP 0> <yl_dlc of APP_EVENT_LOOP 1>
+
+Each program runs on its pseudo terminals with an erased eeprom and gets the
+recorded input of INPUT: the SimLoad script on COM2, then for RUN_SECONDS an
+FC03 on COM1 every 100 ms and an SI on COM2 every second, at the same offsets.
+Per build the report shows
+
+    RAM         .data and .bss of the firmware objects, the models of Host/
+                not included; x86-64 sizes, the difference of the builds is
+                what carries over to the Cortex-M3
+    switches    context switches per second, READTASK SWITCH
+    dispatches  RB_OS task calls per second, READTASK LOOP, event loop only
+    Modbus      replies, worst time from the request to the end of the reply
+                at the master and the worst MBDIAG latency of the firmware
+    SICS        worst time from SI to its line
+
+Every request must be answered in both builds, the event loop build must
+switch less than the task build and the worst times stay below the limits of
+WORST_MODBUS_MS and WORST_SICS_MS. The times are wall clock times of a host
+that also runs the master; they compare the builds, they are no target values.
+"""
+
+import os
+import select
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+from test_sim import ADDRESS, Port, crc16_modbus, frame
+
+RUN_SECONDS = 10.0
+WORST_MODBUS_MS = 100.0
+WORST_SICS_MS = 200.0
+
+# recorded input: (seconds from the start, port, bytes), replayed in this order
+INPUT = [(0.0, 2, b'SETSIM CLR\r\n'),
+         (0.1, 2, b'SETSIM STEP 200000,300\r\n'),
+         (0.2, 2, b'SETSIM RAMP 600000,500\r\n'),
+         (0.3, 2, b'SETSIM STEP 600000,300\r\n'),
+         (0.4, 2, b'SETSIM RAMP 200000,500\r\n'),
+         (0.5, 2, b'SETSIM ON 4711,50,1\r\n'),
+         (0.6, 2, b'MBDIAG CLR\r\n')]
+START = 1.0
+INPUT += [(START + n * 0.1, 1, frame(struct.pack('>BBHH', ADDRESS, 3, 0, 4)))
+          for n in range(int(RUN_SECONDS * 10))]
+INPUT += [(START + 0.05 + n, 2, b'SI\r\n') for n in range(int(RUN_SECONDS))]
+INPUT.sort(key=lambda item: item[0])
+
+FC03_REPLY = 5 + 8
+FIRMWARE_DIRS = ('Src', 'ADC_Driver', 'Middlewares')
+
+
+def static_ram(build_dir):
+    """.data + .bss of the firmware objects in bytes"""
+    objects = []
+    # not Host/ and not the builds in subdirectories of build/
+    for top in FIRMWARE_DIRS:
+        for root, _, files in os.walk(os.path.join(build_dir, top)):
+            objects += [os.path.join(root, f) for f in files if f.endswith('.o')]
+    out = subprocess.check_output(['size', '-t'] + sorted(objects)).decode()
+    total = out.strip().splitlines()[-1].split()
+    return int(total[1]) + int(total[2])
+
+
+def read_task(port):
+    """SWITCH and LOOP counts of READTASK, LOOP None in the task build"""
+    port.write(b'READTASK\r\n')
+    lines = port.read(1.0).decode('latin-1').split('\r\n')
+    switches, dispatches = None, None
+    for line in lines:
+        fields = line.split(',')
+        if fields[0] == 'SWITCH':
+            switches = int(fields[1])
+        elif fields[0] == 'LOOP':
+            dispatches = int(fields[1])
+    return switches, dispatches
+
+
+def run(program):
+    """play INPUT to one build, its figures as a dict"""
+    tmp = tempfile.mkdtemp(prefix='yl_dlc')
+    env = dict(os.environ)
+    env.update(YL_COM1=os.path.join(tmp, 'com1'), YL_COM2=os.path.join(tmp, 'com2'),
+               YL_EEPROM=os.path.join(tmp, 'eeprom.bin'), YL_ADDR=str(ADDRESS))
+    proc = subprocess.Popen([program], env=env, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    try:
+        end = time.time() + 5
+        while not (os.path.exists(env['YL_COM1']) and os.path.exists(env['YL_COM2'])):
+            if time.time() > end:
+                raise RuntimeError('%s did not open its ports' % program)
+            time.sleep(0.05)
+        com1, com2 = Port(env['YL_COM1']), Port(env['YL_COM2'])
+        time.sleep(1.0)
+        com2.read(0.1)
+
+        result = dict(modbus=0, replies=0, modbusMs=0.0, sics=0, lines=0, sicsMs=0.0)
+        # requests waiting for their reply: port -> (time sent, bytes so far)
+        waiting = {}
+        switches0, dispatches0 = read_task(com2)
+        t0 = time.time()
+        pending = list(INPUT)
+        while pending or waiting:
+            now = time.time() - t0
+            # no answer within a second: not answered, the input goes on
+            for port in [p for p, (sent, _) in waiting.items() if time.time() - sent > 1.0]:
+                del waiting[port]
+            if pending and now >= pending[0][0] and pending[0][1] not in waiting:
+                _, port, data = pending.pop(0)
+                (com1 if port == 1 else com2).write(data)
+                if port == 1:
+                    result['modbus'] += 1
+                    waiting[1] = (time.time(), b'')
+                elif data == b'SI\r\n':
+                    result['sics'] += 1
+                    waiting[2] = (time.time(), b'')
+                continue
+            if now > RUN_SECONDS + START + 2.0:
+                break
+            ready, _, _ = select.select([com1.fd, com2.fd], [], [], 0.002)
+            for fd in ready:
+                port = 1 if fd == com1.fd else 2
+                data = os.read(fd, 1024)
+                if port not in waiting:
+                    continue
+                sent, got = waiting[port]
+                got += data
+                ms = (time.time() - sent) * 1000.0
+                if port == 1 and len(got) >= FC03_REPLY:
+                    if crc16_modbus(got[:FC03_REPLY]) == 0:
+                        result['replies'] += 1
+                        result['modbusMs'] = max(result['modbusMs'], ms)
+                    del waiting[1]
+                elif port == 2 and got.endswith(b'\r\n'):
+                    result['lines'] += 1
+                    result['sicsMs'] = max(result['sicsMs'], ms)
+                    del waiting[2]
+                else:
+                    waiting[port] = (sent, got)
+        elapsed = time.time() - t0
+
+        switches1, dispatches1 = read_task(com2)
+        result['switches'] = (switches1 - switches0) / elapsed
+        result['dispatches'] = None if dispatches1 is None else (dispatches1 - dispatches0) / elapsed
+        com2.write(b'MBDIAG\r\n')
+        diag = com2.read(1.0, b'\r\n').decode('latin-1').split('\r\n')[0].split(',')
+        result['mbLatencyMaxUs'] = int(diag[10])
+        result['ram'] = static_ram(os.path.dirname(os.path.abspath(program)))
+        com1.close()
+        com2.close()
+        return result
+    finally:
+        proc.kill()
+        proc.wait()
+        shutil.rmtree(tmp)
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write(__doc__)
+        return 2
+    names = ('tasks', 'event loop')
+    results = [run(argv[1]), run(argv[2])]
+
+    print('%-12s %10s %10s %10s %10s %12s %10s %10s' % ('build', 'RAM', 'switch/s', 'disp/s', 'Modbus',
+                                                        'worst ms', 'fw max us', 'SICS ms'))
+    for name, r in zip(names, results):
+        print('%-12s %10d %10.0f %10s %5d/%-4d %12.1f %10d %10.1f' % (
+            name, r['ram'], r['switches'], '-' if r['dispatches'] is None else '%.0f' % r['dispatches'],
+            r['replies'], r['modbus'], r['modbusMs'], r['mbLatencyMaxUs'], r['sicsMs']))
+    print('RAM of the event loop build %+d bytes' % (results[1]['ram'] - results[0]['ram']))
+
+    failed = []
+    for name, r in zip(names, results):
+        if r['replies'] != r['modbus'] or r['lines'] != r['sics']:
+            failed.append('%s: %d of %d FC03, %d of %d SI answered' % (name, r['replies'], r['modbus'],
+                                                                       r['lines'], r['sics']))
+        if r['modbusMs'] > WORST_MODBUS_MS or r['sicsMs'] > WORST_SICS_MS:
+            failed.append('%s: worst response %.1f ms Modbus, %.1f ms SICS' % (name, r['modbusMs'],
+                                                                               r['sicsMs']))
+    if results[1]['dispatches'] is None:
+        failed.append('%s is not an event loop build' % argv[2])
+    if not results[1]['switches'] < results[0]['switches']:
+        failed.append('event loop: %.0f switches/s, tasks %.0f' % (results[1]['switches'],
+                                                                   results[0]['switches']))
+    for text in failed:
+        print('FAILED: ' + text)
+    print('%s, %d checks failed' % ('FAILED' if failed else 'OK', len(failed)))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
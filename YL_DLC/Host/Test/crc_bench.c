@@ -0,0 +1,85 @@
+//==================================================================================================
+//  Cost of RB_CRC.c per path
+//
+//    build/crc_bench
+//
+//  ns per KByte of every predefined configuration bit by bit (table NULL), byte-wise and, the
+//  reflected ones, slicing-by-4, over a buffer of BENCH_BYTES. Host time, the ratio between the
+//  paths is what carries over to the target.
+//==================================================================================================
+
+#include <stdio.h>
+#include <time.h>
+
+#include "RB_CRC.h"
+
+#define BENCH_BYTES             1024
+#define BENCH_ROUNDS            2000
+
+static uint8_t data[BENCH_BYTES];
+static volatile RB_CRC_tCRC sink;
+
+static double BENCH_Seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : BENCH_Run
+ * Description  : time of one configuration over the buffer
+ * \return    	: ns per KByte
+ *---------------------------------------------------------------------*/
+static double BENCH_Run(const RB_CRC_tCfg *pCfg, uint32_t rounds)
+{
+    double t0;
+    uint32_t i;
+
+    t0 = BENCH_Seconds();
+    for (i = 0; i < rounds; i++)
+        sink = RB_CRC_Calculate(data, 0, BENCH_BYTES, pCfg);
+    return (BENCH_Seconds() - t0) * 1e9 / rounds * 1024 / BENCH_BYTES;
+}
+
+int main(void)
+{
+    static const struct
+    {
+        const char *pName;
+        const RB_CRC_tCfg *pCfg;
+    } configs[] = {
+        {"8 CCITT", &RB_CRC_8_CCITT_CFG},
+        {"16 CCITT", &RB_CRC_16_CCITT_CFG},
+        {"16 MODBUS", &RB_CRC_16_MODBUS_CFG},
+        {"32 IEEE802.3", &RB_CRC_32_IEEE802_3_CFG},
+    };
+    RB_CRC_tCfg cfg;
+    unsigned c;
+    uint32_t i;
+
+    for (i = 0; i < BENCH_BYTES; i++)
+        data[i] = (uint8_t)(i * 131 + 7);
+
+    printf("%-12s %10s %10s %10s  ns per KByte\n", "", "bit", "byte-wise", "slicing-4");
+    for (c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        printf("%-12s", configs[c].pName);
+        cfg = *configs[c].pCfg;
+        cfg.table = NULL;
+        printf(" %10.0f", BENCH_Run(&cfg, BENCH_ROUNDS / 10));
+        cfg = *configs[c].pCfg;
+        cfg.tableSlices = 1;
+        if (cfg.table != NULL)
+            printf(" %10.0f", BENCH_Run(&cfg, BENCH_ROUNDS));
+        else
+            printf(" %10s", "-");
+        if (configs[c].pCfg->tableSlices >= 4)
+            printf(" %10.0f", BENCH_Run(configs[c].pCfg, BENCH_ROUNDS));
+        else
+            printf(" %10s", "-");
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+//==================================================================================================
+//  Eeprom traffic and wear of the parameter storage
+//
+//    build/ee_bench [cal=N] [fhz=N] [zt=N]
+//
+//  Each scenario runs a number of operations on the booted firmware and counts the write cycles
+//  of the eeprom model and the bus time of the driver. The wear per operation times the rate,
+//  operations per day, gives the wear of the most written page in 10 years and the years until
+//  EE_WRITE_CYCLES. The rates are assumptions of a busy line, change them on the command line:
+//    cal   4       calibration, both testpoints, a shift change
+//    fhz   1440    SETFHZ by a PLC once a minute
+//    zt    8640    ZEROZ and SETTA every 10 s
+//  The bench fails if a page, of one scenario or of all of them together, reaches EE_WRITE_CYCLES
+//  within BENCH_YEARS. make test runs it with these rates.
+//==================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Host.h"
+#include "HostTest.h"
+
+#include "i2c.h"
+#include "UserParam.h"
+#include "Scale.h"
+
+#define BENCH_OPS               200
+#define BENCH_PAGES             (EE_SIZE / EE_PAGE_SIZE)
+#define BENCH_DAYS_PER_YEAR     365.0
+#define BENCH_YEARS             10.0
+
+typedef struct
+{
+    const char *pName;
+    double perDay;
+    void (*pOp)(int i);
+    double pageWear[BENCH_PAGES];   // write cycles per operation
+} BENCH_tScenario;
+
+// testpoint 0 and 1 as the CALZERO and CALSPAN commands, counts change every time
+static void BENCH_Cal(int i)
+{
+    CAL_AdjustCalParams(&g_ScaleData, 0, 0.0, 1000 + i);
+    CAL_AdjustCalParams(&g_ScaleData, 1, 10.0, 50000 + i);
+    HOST_TestRun(2 * USER_PARAM_FLUSH_DELAY);
+}
+
+static void BENCH_Fhz(int i)
+{
+    HOST_TestCommand((i & 1) ? "SETFHZ 5.0" : "SETFHZ 3.0", NULL, 0);
+    HOST_TestRun(2 * USER_PARAM_FLUSH_DELAY);
+}
+
+static void BENCH_ZeroTare(int i)
+{
+    HOST_TestCommand((i & 1) ? "SETTA" : "ZEROZ", NULL, 0);
+    HOST_TestRun(2 * USER_PARAM_FLUSH_DELAY);
+}
+
+static BENCH_tScenario scenarios[] = {
+    {"cal", 4, BENCH_Cal, {0}},
+    {"fhz", 1440, BENCH_Fhz, {0}},
+    {"zt", 8640, BENCH_ZeroTare, {0}},
+};
+
+#define BENCH_SCENARIOS     (sizeof(scenarios) / sizeof(scenarios[0]))
+
+/**---------------------------------------------------------------------
+ * Name         : BENCH_Years
+ * Description  : years until the endurance of a page
+ * \param    	: perDay---write cycles of the page per day
+ * \return    	: years, 0 = never
+ *---------------------------------------------------------------------*/
+static double BENCH_Years(double perDay)
+{
+    if (perDay <= 0)
+        return 0;
+    return EE_WRITE_CYCLES / perDay / BENCH_DAYS_PER_YEAR;
+}
+
+static void BENCH_Run(BENCH_tScenario *pScn)
+{
+    HOST_tEepromStat stat;
+    EEPROM_tStat eeStat;
+    uint16_t maxWear, maxPage;
+    double perOp, busMs, worst;
+    uint16_t page;
+    int i;
+
+    // one operation first, the values before the count are known
+    pScn->pOp(-1);
+    HOST_EepromClearStat();
+    EEPROM_GetStat(&eeStat, &maxWear, &maxPage, 1);
+
+    for (i = 0; i < BENCH_OPS; i++)
+        pScn->pOp(i);
+
+    HOST_EepromGetStat(&stat);
+    EEPROM_GetStat(&eeStat, &maxWear, &maxPage, 0);
+    worst = 0;
+    for (page = 0; page < BENCH_PAGES; page++)
+    {
+        pScn->pageWear[page] = (double)HOST_EepromPageWear(page) / BENCH_OPS;
+        if (pScn->pageWear[page] > worst)
+            worst = pScn->pageWear[page];
+    }
+    perOp = (double)stat.pagePrograms / BENCH_OPS;
+    busMs = eeStat.busTimeUs / 1000.0 / BENCH_OPS;
+
+    printf("%-4s %7.0f/day  %6.2f programs %7.1f bytes %6.2f ms per op, worst page %u (%u) byte %u, ",
+           pScn->pName, pScn->perDay, perOp, (double)stat.programBytes / BENCH_OPS, busMs,
+           (unsigned)stat.maxPageWear, (unsigned)maxPage, (unsigned)stat.maxCellWear);
+    if (worst > 0)
+        printf("%.0f cycles in %.0f years, endurance in %.1f years\n",
+               worst * pScn->perDay * BENCH_DAYS_PER_YEAR * BENCH_YEARS, BENCH_YEARS,
+               BENCH_Years(worst * pScn->perDay));
+    else
+        printf("no eeprom writes\n");
+    HOST_CHECK((worst == 0) || (BENCH_Years(worst * pScn->perDay) >= BENCH_YEARS));
+}
+
+int main(int argc, char **argv)
+{
+    double perDay, worst = 0;
+    uint16_t page, worstPage = 0;
+    unsigned s;
+    int a;
+
+    for (a = 1; a < argc; a++)
+    {
+        for (s = 0; s < BENCH_SCENARIOS; s++)
+        {
+            size_t n = strlen(scenarios[s].pName);
+            if ((strncmp(argv[a], scenarios[s].pName, n) == 0) && (argv[a][n] == '='))
+                break;
+        }
+        if (s == BENCH_SCENARIOS)
+        {
+            fprintf(stderr, "usage: %s [cal=N] [fhz=N] [zt=N], operations per day\n", argv[0]);
+            return 2;
+        }
+        scenarios[s].perDay = atof(strchr(argv[a], '=') + 1);
+    }
+
+    HOST_TestBoot();
+    HOST_TestRun(1000);
+    for (s = 0; s < BENCH_SCENARIOS; s++)
+        BENCH_Run(&scenarios[s]);
+
+    // all of them on one scale, the pages add up
+    for (page = 0; page < BENCH_PAGES; page++)
+    {
+        perDay = 0;
+        for (s = 0; s < BENCH_SCENARIOS; s++)
+            perDay += scenarios[s].pageWear[page] * scenarios[s].perDay;
+        if (perDay > worst)
+        {
+            worst = perDay;
+            worstPage = page;
+        }
+    }
+    if (worst > 0)
+        printf("all  page %u %.1f cycles/day, endurance in %.1f years\n", (unsigned)worstPage, worst,
+               BENCH_Years(worst));
+    else
+        printf("all  no eeprom writes\n");
+    HOST_CHECK((worst == 0) || (BENCH_Years(worst) >= BENCH_YEARS));
+
+    printf("%s, %d checks failed\n", HOST_TestFailures() ? "FAILED" : "OK", HOST_TestFailures());
+    return HOST_TestFailures() ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+//==================================================================================================
+//  Cost of the weight cycle with and without readers of the display strings
+//
+//    build/format_bench
+//
+//  The weight strings are formatted by SCALE_CopyDisplayString() when a reader takes them: a weight
+//  bus subscriber with WBUS_SUB_STRINGS, the SICS port while SIR runs, the continuous output while
+//  it is assigned. A scripted load ramps the weight so that it changes in every cycle, and the
+//  weight cycles are run without a reader, with SIR on COM2 and with the continuous output on COM1.
+//  The cache key of the net string shows whether it was formatted in a cycle: without a reader
+//  never, with one in every cycle the weight changed. The time of APP_WeighCycle() is host time,
+//  the best of BENCH_ROUNDS rounds; the difference of the scenarios is the formatting, which the
+//  direct time of SCALE_FormatDisplayWeight() for the net and the tare string is printed next to.
+//==================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "Host.h"
+#include "HostTest.h"
+
+#include "Scale.h"
+#include "SimLoad.h"
+#include "EventLoop.h"
+
+#define BENCH_NS_PER_MS         1000000ULL
+#define BENCH_CYCLES            1000
+#define BENCH_ROUNDS            5
+#define BENCH_FORMAT_CALLS      200000
+// a reader starts or stops in the weight cycle after its command
+#define BENCH_SETTLE_MS         300
+
+// raw counts of the ramp, the weight changes by several increments per weight cycle
+#define BENCH_RAMP_LEVEL        400000
+#define BENCH_RAMP_SAMPLES      20000
+
+typedef enum
+{
+    BENCH_NO_READER = 0,
+    BENCH_SIR,
+    BENCH_CONT,
+    BENCH_SCENARIOS
+} BENCH_tScenario;
+
+static const char * const scenarioName[BENCH_SCENARIOS] = {"no reader", "SICS SIR", "continuous"};
+
+// commands that start and stop the reader of a scenario
+static const char * const startCommand[BENCH_SCENARIOS] = {NULL, "SIR", "SETCONT 1 3 0"};
+static const char * const stopCommand[BENCH_SCENARIOS] = {NULL, "@", "SETCONT 1 0 0"};
+
+typedef struct
+{
+    uint32_t changed;               // cycles the net weight changed in
+    uint32_t formatted;             // of them, the net string was formatted
+    double   bestNs;                // per weight cycle, best round
+} BENCH_tResult;
+
+extern SCALE g_ScaleData;
+
+static double BENCH_Seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : BENCH_Cycles
+ * Description  : weight cycles as HOST_TestRun() runs them, the ADC poll
+ *                every 10 ms and the COM2 task every 20 ms, with only
+ *                APP_WeighCycle() timed; the output of both ports is
+ *                taken away
+ * \param    	: pResult---changed and formatted cycles are counted
+ * \return    	: ns per weight cycle
+ *---------------------------------------------------------------------*/
+static double BENCH_Cycles(uint32_t cycles, BENCH_tResult *pResult)
+{
+    SCALE_tStringKey *pKey = &g_ScaleData.stringKey[SCALE_STRING_NET];
+    double lastNet = g_ScaleData.roundedNetWeight;
+    double t, sum = 0.0;
+    uint8_t buf[256];
+    uint64_t start;
+    uint32_t n, k;
+
+    for (n = 0; n < cycles; n++)
+    {
+        for (k = 0; k < 10; k++)
+        {
+            APP_AdcPoll();
+            if (k & 1)
+                APP_SicsPoll();
+            HOST_Sleep(10 * BENCH_NS_PER_MS);
+            HOST_Poll();
+            while (HOST_UartTakeTx(0, buf, sizeof(buf), &start) > 0)
+                ;
+            while (HOST_UartTakeTx(1, buf, sizeof(buf), &start) > 0)
+                ;
+        }
+
+        t = BENCH_Seconds();
+        APP_WeighCycle();
+        sum += BENCH_Seconds() - t;
+
+        if (g_ScaleData.roundedNetWeight != lastNet)
+        {
+            pResult->changed++;
+            if (pKey->bValid && (pKey->weight == g_ScaleData.roundedNetWeight))
+                pResult->formatted++;
+        }
+        lastNet = g_ScaleData.roundedNetWeight;
+    }
+    return sum * 1e9 / cycles;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : BENCH_FormatNs
+ * Description  : SCALE_FormatDisplayWeight() of the net and the tare
+ *                weight, what a reader adds to a cycle at most
+ * \return    	: ns per pair of strings
+ *---------------------------------------------------------------------*/
+static double BENCH_FormatNs(void)
+{
+    char net[sizeof(g_ScaleData.netString)], tare[sizeof(g_ScaleData.tareString)];
+    double weight, t;
+    uint32_t i;
+
+    t = BENCH_Seconds();
+    for (i = 0; i < BENCH_FORMAT_CALLS; i++)
+    {
+        // a new weight every call, as in the ramp
+        weight = g_ScaleData.currInc * (i % 5000);
+        SCALE_FormatDisplayWeight(net, &weight, &g_ScaleData);
+        SCALE_FormatDisplayWeight(tare, &g_ScaleData.roundedTareWeight, &g_ScaleData);
+    }
+    return (BENCH_Seconds() - t) * 1e9 / BENCH_FORMAT_CALLS;
+}
+
+int main(void)
+{
+    BENCH_tResult result[BENCH_SCENARIOS];
+    double ns, formatNs;
+    int s, round;
+
+    HOST_TestBoot();
+    HOST_TestRun(3000);
+
+    // up and down, the weight changes in every cycle of the ramps
+    SIM_Stop();
+    HOST_CHECK(SIM_ClearScript());
+    HOST_CHECK(SIM_AddSegment(SIM_SEG_RAMP, BENCH_RAMP_LEVEL, BENCH_RAMP_SAMPLES));
+    HOST_CHECK(SIM_AddSegment(SIM_SEG_RAMP, 0, BENCH_RAMP_SAMPLES));
+    HOST_CHECK(SIM_Start(1, 0, true));
+
+    memset(result, 0, sizeof(result));
+    for (round = 0; round < BENCH_ROUNDS; round++)
+    {
+        for (s = 0; s < BENCH_SCENARIOS; s++)
+        {
+            if (startCommand[s] != NULL)
+                HOST_TestCommand(startCommand[s], NULL, 0);
+            HOST_TestRun(BENCH_SETTLE_MS);
+            ns = BENCH_Cycles(BENCH_CYCLES, &result[s]);
+            if ((round == 0) || (ns < result[s].bestNs))
+                result[s].bestNs = ns;
+            if (stopCommand[s] != NULL)
+                HOST_TestCommand(stopCommand[s], NULL, 0);
+        }
+    }
+    formatNs = BENCH_FormatNs();
+
+    printf("%-12s %10s %10s %12s %12s\n", "reader", "changed", "formatted", "ns/cycle", "+ns/cycle");
+    for (s = 0; s < BENCH_SCENARIOS; s++)
+    {
+        printf("%-12s %10u %10u %12.0f %12.0f\n", scenarioName[s], (unsigned)result[s].changed,
+               (unsigned)result[s].formatted, result[s].bestNs,
+               result[s].bestNs - result[BENCH_NO_READER].bestNs);
+    }
+    printf("SCALE_FormatDisplayWeight() net and tare: %.0f ns\n", formatNs);
+
+    // the ramp must change the weight in most cycles, else nothing is measured
+    for (s = 0; s < BENCH_SCENARIOS; s++)
+        HOST_CHECK(result[s].changed > BENCH_ROUNDS * BENCH_CYCLES * 9 / 10);
+    // no reader, no string; a reader, a string in every cycle the weight changed
+    HOST_CHECK(result[BENCH_NO_READER].formatted == 0);
+    HOST_CHECK(result[BENCH_SIR].formatted == result[BENCH_SIR].changed);
+    HOST_CHECK(result[BENCH_CONT].formatted == result[BENCH_CONT].changed);
+    HOST_CHECK(result[BENCH_NO_READER].bestNs < result[BENCH_SIR].bestNs);
+    HOST_CHECK(result[BENCH_NO_READER].bestNs < result[BENCH_CONT].bestNs);
+
+    printf("%s, %d checks failed\n", HOST_TestFailures() ? "FAILED" : "OK", HOST_TestFailures());
+    return HOST_TestFailures() ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""Worst case stack depth of the tasks from the GCC call graph.
+
+    make stack
+    python3 Test/stack_depth.py <build dir> <task function> ...
+
+The host build compiled with -fcallgraph-info=su writes a .ci file per object,
+the frame size of every function and its calls. The depth of a task is its
+deepest call path. A call through a function pointer may reach every function
+whose address is taken in the same source: the command tables of CmdProcess.c
+and MTSICS.c, the register map of ModbusRTUSlave.c, the member functions of
+the scale objects of Src/Scale and the RB_OS tasks and RB_Timer callbacks of
+EventLoop.c. Recursion ends the path. The HAL models of Host/ and the C
+library count 0 and are listed per task.
+
+The frames are x86-64 frames, 8 byte pointers and 16 byte alignment, larger
+than those of the Cortex-M3. The exception frame and the saved context of the
+kernel, 16 words on the task stack, are not included.
+"""
+
+import collections
+import glob
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..')
+
+NODE = re.compile(r'node: \{ title: "([^"]*)" label: "[^"\\]*\\n[^"\\]*\\n(\d+) bytes')
+EDGE = re.compile(r'edge: \{ sourcename: "([^"]*)" targetname: "([^"]*)"')
+TAKEN = re.compile(r'(?:[=,{(]|&)\s*([A-Za-z_]\w*)\s*(?=[,};)])')
+
+# sources whose function pointer calls reach functions of another source: (source, names)
+INDIRECT_OTHER = {
+    'Src/util/RB_OS.c': ('Src/commsrc/EventLoop.c', re.compile(r'EVLOOP_\w+Task$')),
+    'Src/util/RB_Timer.c': ('Src/commsrc/EventLoop.c', re.compile(r'EVLOOP_\w+Timeout$')),
+}
+
+
+def plain(name):
+    # a static function is titled <source>:<name>
+    return name.split(':')[-1]
+
+
+def read_graph(build_dir):
+    frame, calls, source = {}, collections.defaultdict(set), {}
+    for path in glob.glob(os.path.join(build_dir, '**', '*.ci'), recursive=True):
+        rel = os.path.relpath(path, build_dir)[:-len('.ci')]
+        if rel.startswith('Host' + os.sep):
+            continue
+        with open(path) as f:
+            text = f.read()
+        for name, size in NODE.findall(text):
+            frame[name] = int(size)
+            source[name] = rel.replace(os.sep, '/')
+        for caller, callee in EDGE.findall(text):
+            calls[caller].add(callee)
+    return frame, calls, source
+
+
+def address_taken(sources):
+    taken = {}
+    for rel in sources:
+        path = os.path.join(ROOT, rel)
+        if os.path.exists(path):
+            with open(path, encoding='latin-1') as f:
+                taken[rel] = set(TAKEN.findall(f.read()))
+    return taken
+
+
+def resolve_indirect(frame, calls, source):
+    taken = address_taken(set(source.values()) | {s for s, _ in INDIRECT_OTHER.values()})
+    by_name = {plain(n): n for n in frame}
+    for caller, callees in calls.items():
+        if '__indirect_call' not in callees:
+            continue
+        callees.discard('__indirect_call')
+        rel = source.get(caller, '')
+        names = None
+        if rel.startswith('Src/Scale/'):
+            group = [s for s in taken if s.startswith('Src/Scale/')]
+        elif rel in INDIRECT_OTHER:
+            group, names = [INDIRECT_OTHER[rel][0]], INDIRECT_OTHER[rel][1]
+        else:
+            group = [rel]
+        for s in group:
+            callees |= {by_name[n] for n in taken.get(s, ())
+                        if n in by_name and (names is None or names.match(n))}
+
+
+def deepest(frame, calls):
+    memo = {}
+
+    def walk(name, path):
+        if name in path:
+            return 0, []
+        if name in memo:
+            return memo[name]
+        best = (0, [])
+        for callee in calls.get(name, ()):
+            depth, chain = walk(callee, path | {name})
+            if depth > best[0]:
+                best = (depth, chain)
+        memo[name] = (frame.get(name, 0) + best[0], [name] + best[1])
+        return memo[name]
+
+    return walk
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.stderr.write(__doc__)
+        return 2
+    frame, calls, source = read_graph(argv[1])
+    resolve_indirect(frame, calls, source)
+    walk = deepest(frame, calls)
+    by_name = {plain(n): n for n in frame}
+
+    for task in argv[2:]:
+        if task not in by_name:
+            print('%-20s not in the build' % task)
+            continue
+        depth, chain = walk(by_name[task], frozenset())
+        print('%-20s %5d bytes %4d words  %s' % (task, depth, (depth + 3) // 4,
+                                                 ' > '.join(plain(n) for n in chain)))
+        stack = [by_name[task]]
+        seen = set()
+        while stack:
+            name = stack.pop()
+            if name not in seen:
+                seen.add(name)
+                stack.extend(calls.get(name, ()))
+        external = sorted({plain(n) for n in seen if n not in frame})
+        print('%-20s not counted: %s' % ('', ', '.join(external)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,141 @@
+//==================================================================================================
+//  Boot timeline of BootTime.c on the eeprom file
+//
+//    build/test_boot
+//
+//  main() runs up to the start of the scheduler with virtual time, on which the eeprom model
+//  charges its bus and write cycle times, twice in a child process each on the same eeprom file:
+//  the first power on on an erased eeprom writes the defaults, the second one loads them as every
+//  later power on does. The stages must be stamped in the order of BOOT_tStage, up to SCALE by
+//  main(); SCHED is stamped by WeighProcessTask, which the test does not run. The tasks then run
+//  until the first stable weight, ADC and WEIGHT follow SCALE.
+//
+//  Virtual time passes only in the models, the stages without eeprom or UART traffic take 0 us
+//  here: the timeline is the time of the I2C and UART transfers, on the target the code runs on top.
+//  On the second power on main() must reach the scheduler within TEST_BUDGET_US and the parameter
+//  load, the PARAM stage, may take at most TEST_PARAM_SHARE percent of that budget. Read byte by
+//  byte with a write cycle wait each, as before the reads were made page-wise, it took seconds.
+//==================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "Host.h"
+#include "HostTest.h"
+
+#include "BootTime.h"
+
+// main() up to the scheduler on a loaded eeprom
+#define TEST_BUDGET_US          500000
+// PARAM of TEST_BUDGET_US [%]
+#define TEST_PARAM_SHARE        50
+// tasks run until the first stable weight
+#define TEST_WEIGHT_MS          20000
+
+/**---------------------------------------------------------------------
+ * Name         : TEST_PowerOn
+ * Description  : one power on in this process, the timeline printed
+ *                and checked
+ * \param    	: pPath---eeprom file
+ *                bLoaded---the file holds the parameters, the budget
+ *                is checked
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void TEST_PowerOn(const char *pPath, bool bLoaded)
+{
+    uint32_t us[BOOT_STAGE_NUM], total, param;
+    HOST_tEepromStat stat;
+    uint32_t ms;
+    int stage;
+
+    HOST_EepromOpen(pPath);
+    HOST_SetVirtualTime(true);
+    HOST_UartCapture(0);
+    HOST_UartCapture(1);
+    HOST_Boot();
+    HOST_EepromGetStat(&stat);
+
+    printf("%s power on\n", bLoaded ? "second" : "first");
+    for (stage = BOOT_STAGE_MAIN; stage <= BOOT_STAGE_SCALE; stage++)
+    {
+        if (!HOST_CHECK(BOOT_GetStage((BOOT_tStage)stage, &us[stage])))
+        {
+            fprintf(stderr, "  %s not stamped\n", BOOT_GetStageName((BOOT_tStage)stage));
+            return;
+        }
+        printf("  %-8s %8lu us %8lu us\n", BOOT_GetStageName((BOOT_tStage)stage), (unsigned long)us[stage],
+               (unsigned long)((stage > 0) ? us[stage] - us[stage - 1] : 0));
+        if (stage > 0)
+            HOST_CHECK(us[stage] >= us[stage - 1]);
+    }
+    HOST_CHECK(!BOOT_GetStage(BOOT_STAGE_SCHED, &us[BOOT_STAGE_SCHED]));
+
+    total = us[BOOT_STAGE_SCALE];
+    param = us[BOOT_STAGE_PARAM] - us[BOOT_STAGE_PERIPH];
+    printf("  scheduler after %lu us, PARAM %lu %% of %lu us, %lu bytes read, %lu page programs\n",
+           (unsigned long)total, (unsigned long)((uint64_t)param * 100 / TEST_BUDGET_US),
+           (unsigned long)TEST_BUDGET_US, (unsigned long)stat.readBytes, (unsigned long)stat.pagePrograms);
+    if (bLoaded)
+    {
+        HOST_CHECK(total <= TEST_BUDGET_US);
+        HOST_CHECK((uint64_t)param * 100 <= (uint64_t)TEST_BUDGET_US * TEST_PARAM_SHARE);
+    }
+
+    for (ms = 0; (ms < TEST_WEIGHT_MS) && !BOOT_GetStage(BOOT_STAGE_WEIGHT, &us[BOOT_STAGE_WEIGHT]); ms += 100)
+        HOST_TestRun(100);
+    HOST_CHECK(BOOT_GetStage(BOOT_STAGE_ADC, &us[BOOT_STAGE_ADC]));
+    if (HOST_CHECK(BOOT_GetStage(BOOT_STAGE_WEIGHT, &us[BOOT_STAGE_WEIGHT])))
+    {
+        printf("  %-8s %8lu us\n  %-8s %8lu us\n", BOOT_GetStageName(BOOT_STAGE_ADC),
+               (unsigned long)us[BOOT_STAGE_ADC], BOOT_GetStageName(BOOT_STAGE_WEIGHT),
+               (unsigned long)us[BOOT_STAGE_WEIGHT]);
+        HOST_CHECK(us[BOOT_STAGE_ADC] >= us[BOOT_STAGE_SCALE]);
+        HOST_CHECK(us[BOOT_STAGE_WEIGHT] >= us[BOOT_STAGE_ADC]);
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TEST_Child
+ * Description  : TEST_PowerOn() in a child process, every power on
+ *                starts with the firmware data of the program
+ * \return    	: failed checks of the child
+ *---------------------------------------------------------------------*/
+static int TEST_Child(const char *pPath, bool bLoaded)
+{
+    pid_t pid;
+    int status;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+    {
+        TEST_PowerOn(pPath, bLoaded);
+        fflush(stdout);
+        _exit(HOST_TestFailures() > 255 ? 255 : HOST_TestFailures());
+    }
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid) || !WIFEXITED(status))
+        return 1;
+    return WEXITSTATUS(status);
+}
+
+int main(void)
+{
+    char path[] = "/tmp/test_boot_XXXXXX";
+    int fd, failures;
+
+    // the eeprom model creates the file erased
+    fd = mkstemp(path);
+    if (!HOST_CHECK(fd >= 0))
+        return 1;
+    close(fd);
+    unlink(path);
+
+    failures = TEST_Child(path, false);
+    failures += TEST_Child(path, true);
+    unlink(path);
+
+    printf("%s, %d checks failed\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""EWARM/mb_bus_model.py on the firmware library of the host build.
+
+    python test_bus_model.py [path of libyl_dlc.so]
+
+Scales of the model answer the FC03 of their address with the bytes the
+firmware transmits, a frame not taken by the task before the next one is
+an overrun of the firmware counters and the newer frame is answered.
+"""
+
+import argparse
+import os
+import sys
+import unittest
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, '..', '..', 'EWARM'))
+
+import mb_bus_model  # noqa: E402
+
+LIB = os.path.join(HERE, '..', 'build', 'libyl_dlc.so')
+
+
+def frame(pdu):
+    """PDU with its CRC, low byte first"""
+    crc = mb_bus_model.crc16_modbus(pdu)
+    return bytearray(pdu) + bytearray([crc & 0xFF, crc >> 8])
+
+
+def model_args(**options):
+    args = argparse.Namespace(slaves=2, baud=115200, regs=4, seconds=1.0, timeout=50, master_gap=0,
+                              de_us=5, poll_ms=10, proc_us=400, event_loop=False, hist=None, seed=1,
+                              lib=LIB)
+    for name, value in options.items():
+        setattr(args, name, value)
+    return args
+
+
+class BusModel(unittest.TestCase):
+
+    def test_event_loop(self):
+        bus = mb_bus_model.Bus(model_args(event_loop=True))
+        bus.run()
+        self.assertGreater(len(bus.times), 100)
+        self.assertEqual(bus.timeouts, 0)
+        self.assertEqual(bus.collisions, 0)
+        for scale in bus.slaves:
+            self.assertGreater(scale.responses, 50)
+            self.assertEqual(scale.diag.crcErrCount, 0)
+            self.assertEqual(scale.drop_frames[0], 0)
+
+    def test_response_bytes(self):
+        scale = mb_bus_model.Bus(model_args(slaves=1)).slaves[0]
+        scale.receive(1000.0, frame([1, 3, 0, 0, 0, 4]))
+        scale.advance(1100.0)
+        self.assertTrue(scale.frame_pending())
+        data, start = scale.serve()
+        self.assertEqual(data[:3], bytearray([1, 3, 8]))
+        self.assertEqual(len(data), 5 + 8)
+        self.assertEqual(mb_bus_model.crc16_modbus(data), 0)
+        self.assertGreaterEqual(start, 1100.0)
+
+    def test_overrun_latest_frame(self):
+        scale = mb_bus_model.Bus(model_args(slaves=1)).slaves[0]
+        t = 1000.0
+        # 1 register, then 2 before the task runs
+        for pdu in ([1, 3, 0, 0, 0, 1], [1, 3, 0, 0, 0, 2]):
+            scale.receive(t, frame(pdu))
+            t += 500.0
+            scale.advance(t)
+        self.assertEqual(scale.drop_frames[0], 1)
+        data, _ = scale.serve()
+        self.assertEqual(data[:3], bytearray([1, 3, 4]))
+        self.assertFalse(scale.frame_pending())
+
+
+def main(argv):
+    global LIB
+    if len(argv) > 1 and not argv[1].startswith('-'):
+        LIB = argv.pop(1)
+    unittest.main(argv=argv)
+
+
+if __name__ == '__main__':
+    main(sys.argv)
@@ -0,0 +1,185 @@
+//==================================================================================================
+//  RB_CRC.c, the table paths against the bit by bit calculation
+//
+//    build/test_crc
+//
+//  Every predefined configuration is calculated bit by bit (table NULL), byte-wise (1 slice) and,
+//  the reflected ones, slicing-by-4, over random data at every start alignment and lengths
+//  around the 4 byte steps of the slices. The embedded tables must be the ones RB_CRC_BuildTable
+//  builds. A CRC updated in pieces must be the one of RB_CRC_Calculate, which takes an
+//  initialized configuration (crcMask != 0) as it is and initializes another one itself.
+//==================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+
+#include "HostTest.h"
+
+#include "RB_CRC.h"
+
+#define TEST_MAX_LEN            67
+#define TEST_ALIGN              4
+
+typedef struct
+{
+    const char *pName;
+    const RB_CRC_tCfg *pCfg;
+    RB_CRC_tCRC check;              // CRC of "123456789", 0 = not a catalogued CRC
+} TEST_tConfig;
+
+static const TEST_tConfig configs[] = {
+    {"8 CCITT", &RB_CRC_8_CCITT_CFG, 0},
+    {"16 CCITT", &RB_CRC_16_CCITT_CFG, 0x29B1},
+    {"16 MODBUS", &RB_CRC_16_MODBUS_CFG, 0x4B37},
+    // xorOut 0 as always in RB_CRC, the complement of CRC-32 0xCBF43926
+    {"32 IEEE802.3", &RB_CRC_32_IEEE802_3_CFG, 0x340BC6D9},
+};
+
+#define TEST_CONFIGS            (sizeof(configs) / sizeof(configs[0]))
+
+static uint8_t data[TEST_MAX_LEN + TEST_ALIGN];
+static RB_CRC_tCRC table[4 * 256];
+static uint32_t rand32 = 4711;
+
+static uint32_t TEST_Rand(uint32_t range)
+{
+    rand32 = rand32 * 1664525uL + 1013904223uL;
+    return (rand32 >> 8) % range;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TEST_Crc
+ * Description  : CRC of a buffer with a configuration, in one piece
+ * \return    	: final CRC
+ *---------------------------------------------------------------------*/
+static RB_CRC_tCRC TEST_Crc(const RB_CRC_tCfg *pCfg, const uint8_t *pData, size_t len)
+{
+    RB_CRC_tCRC crc = RB_CRC_InitialValue(pCfg);
+
+    crc = RB_CRC_UpdateValue(pCfg, crc, pData, len);
+    return RB_CRC_FinalizeValue(pCfg, crc);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TEST_Paths
+ * Description  : bit by bit, byte-wise and slicing-by-4 of one
+ *                configuration over all alignments and lengths
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void TEST_Paths(const TEST_tConfig *pConfig)
+{
+    RB_CRC_tCfg bit, bytewise, slices;
+    RB_CRC_tCRC crc;
+    size_t len, align;
+    uint32_t i, n = 0;
+    bool bSlices;
+
+    bit = *pConfig->pCfg;
+    bit.table = NULL;
+    bytewise = *pConfig->pCfg;
+    bytewise.tableSlices = 1;
+    bSlices = (pConfig->pCfg->tableSlices >= 4);
+    slices = *pConfig->pCfg;
+
+    if (pConfig->check != 0)
+    {
+        HOST_CHECK(TEST_Crc(&bit, (const uint8_t *)"123456789", 9) == pConfig->check);
+        HOST_CHECK(RB_CRC_Calculate((const uint8_t *)"x123456789", 1, 9, pConfig->pCfg) == pConfig->check);
+    }
+
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)TEST_Rand(256);
+
+    for (align = 0; align < TEST_ALIGN; align++)
+    {
+        for (len = 0; len <= TEST_MAX_LEN; len++)
+        {
+            crc = TEST_Crc(&bit, &data[align], len);
+            if (pConfig->pCfg->table != NULL)
+            {
+                if (!HOST_CHECK(TEST_Crc(&bytewise, &data[align], len) == crc))
+                    fprintf(stderr, "  %s byte-wise, offset %u length %u\n", pConfig->pName,
+                            (unsigned)align, (unsigned)len);
+            }
+            if (bSlices && !HOST_CHECK(TEST_Crc(&slices, &data[align], len) == crc))
+                fprintf(stderr, "  %s slicing-by-4, offset %u length %u\n", pConfig->pName,
+                        (unsigned)align, (unsigned)len);
+            HOST_CHECK(RB_CRC_Calculate(data, align, len, pConfig->pCfg) == crc);
+            n++;
+        }
+    }
+    printf("%-12s %u buffers, table %s\n", pConfig->pName, (unsigned)n,
+           (pConfig->pCfg->table == NULL) ? "none" : bSlices ? "slicing-by-4" : "byte-wise");
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TEST_Tables
+ * Description  : the embedded tables are the built ones
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void TEST_Tables(const TEST_tConfig *pConfig)
+{
+    RB_CRC_tCfg cfg;
+    uint32_t slices = pConfig->pCfg->tableSlices;
+
+    if (pConfig->pCfg->table == NULL)
+        return;
+    HOST_CHECK(RB_CRC_InitializeConfig(&cfg, pConfig->pCfg));
+    HOST_CHECK(RB_CRC_BuildTable(&cfg, table, slices));
+    if (!HOST_CHECK(memcmp(table, pConfig->pCfg->table, slices * 256 * sizeof(RB_CRC_tCRC)) == 0))
+        fprintf(stderr, "  %s embedded table differs\n", pConfig->pName);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TEST_Continuation
+ * Description  : a CRC updated in random pieces, with the predefined
+ *                configuration and with a copy not initialized
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void TEST_Continuation(const TEST_tConfig *pConfig)
+{
+    RB_CRC_tCfg raw, cfg;
+    RB_CRC_tCRC crc, whole;
+    size_t pos, piece;
+    uint32_t i;
+
+    // as declared by a user: the internal parameters 0, RB_CRC_Calculate initializes them
+    raw = *pConfig->pCfg;
+    raw.msbMask = 0;
+    raw.crcMask = 0;
+    raw.polyRefl = 0;
+    whole = RB_CRC_Calculate(data, 1, TEST_MAX_LEN, pConfig->pCfg);
+    HOST_CHECK(RB_CRC_Calculate(data, 1, TEST_MAX_LEN, &raw) == whole);
+    HOST_CHECK(RB_CRC_InitializeConfig(&cfg, &raw));
+    HOST_CHECK((cfg.msbMask == pConfig->pCfg->msbMask) && (cfg.crcMask == pConfig->pCfg->crcMask) &&
+               (cfg.polyRefl == pConfig->pCfg->polyRefl));
+
+    for (i = 0; i < 100; i++)
+    {
+        crc = RB_CRC_InitialValue(pConfig->pCfg);
+        for (pos = 0; pos < TEST_MAX_LEN; pos += piece)
+        {
+            piece = 1 + TEST_Rand(9);
+            if (piece > TEST_MAX_LEN - pos)
+                piece = TEST_MAX_LEN - pos;
+            crc = RB_CRC_UpdateValue(pConfig->pCfg, crc, &data[1 + pos], piece);
+        }
+        if (!HOST_CHECK(RB_CRC_FinalizeValue(pConfig->pCfg, crc) == whole))
+            break;
+    }
+}
+
+int main(void)
+{
+    unsigned c;
+
+    for (c = 0; c < TEST_CONFIGS; c++)
+    {
+        TEST_Tables(&configs[c]);
+        TEST_Paths(&configs[c]);
+        TEST_Continuation(&configs[c]);
+    }
+
+    printf("%s, %d checks failed\n", HOST_TestFailures() ? "FAILED" : "OK", HOST_TestFailures());
+    return HOST_TestFailures() ? 1 : 0;
+}
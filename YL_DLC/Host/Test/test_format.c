@@ -0,0 +1,161 @@
+//==================================================================================================
+//  RB_FORMAT_Fixed() and RB_PARSE_Fixed() against their float64 versions
+//
+//    build/test_format
+//
+//  Every mantissa of the display range, 7 digits and sign, with 0..CONFIG_MAX_DP decimal places is
+//  written by RB_FORMAT_Fixed() and by RB_FORMAT_Double() of mantissa / 10^decPlaces, into a buffer
+//  of the exact size and one byte short. The strings must be the same and parse back to the
+//  mantissa. The time per call of both is printed; it is host time, the ratio is what carries over
+//  to the Cortex-M3, which has no FPU and emulates every float64 operation.
+//==================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "HostTest.h"
+
+#include "RB_Format.h"
+#include "RB_Parse.h"
+#include "ScaleConfig.h"
+
+#define TEST_MAX_MANTISSA       9999999
+#define TEST_BENCH_CALLS        2000000
+
+static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+
+static double TEST_Seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TEST_Compare
+ * Description  : one mantissa, the strings of both functions and the
+ *                parse back
+ * \return    	: true = same
+ *---------------------------------------------------------------------*/
+static bool TEST_Compare(int32_t mantissa, int dp)
+{
+    char fixed[24], dbl[24];
+    const char *p = fixed;
+    size_t nFixed, nDouble;
+    int64_t back;
+
+    nFixed = RB_FORMAT_Fixed(fixed, mantissa, dp, sizeof(fixed));
+    nDouble = RB_FORMAT_Double(dbl, dp, mantissa / pow10[dp], sizeof(dbl));
+    if ((nFixed != nDouble) || (strcmp(fixed, dbl) != 0))
+    {
+        fprintf(stderr, "  %d dp %d: \"%s\" \"%s\"\n", (int)mantissa, dp, fixed, dbl);
+        return false;
+    }
+
+    // exact size and one short
+    if ((RB_FORMAT_Fixed(dbl, mantissa, dp, nFixed + 1) != nFixed) || (strcmp(fixed, dbl) != 0) ||
+        (RB_FORMAT_Fixed(dbl, mantissa, dp, nFixed) != 0) || (dbl[0] != 0))
+    {
+        fprintf(stderr, "  %d dp %d: buffer length\n", (int)mantissa, dp);
+        return false;
+    }
+
+    if (!RB_PARSE_Fixed(&p, &back, dp) || (back != mantissa) || (*p != 0))
+    {
+        fprintf(stderr, "  %d dp %d: \"%s\" parsed %lld\n", (int)mantissa, dp, fixed, (long long)back);
+        return false;
+    }
+    return true;
+}
+
+static void TEST_Exhaustive(void)
+{
+    unsigned long count = 0;
+    int32_t m;
+    int dp;
+
+    for (dp = 0; dp <= CONFIG_MAX_DP; dp++)
+    {
+        for (m = -TEST_MAX_MANTISSA; m <= TEST_MAX_MANTISSA; m++)
+        {
+            if (!HOST_CHECK(TEST_Compare(m, dp)))
+                return;
+            count++;
+        }
+    }
+    printf("format: %lu values the same\n", count);
+}
+
+static void TEST_Parse(void)
+{
+    static const struct
+    {
+        const char *pText;
+        int dp;
+        bool bOk;
+        int64_t mantissa;
+    } cases[] = {
+        {"123.456", 2, true, 12346},
+        {"-123.455", 2, true, -12346},
+        {"0.004", 2, true, 0},
+        {"+7", 3, true, 7000},
+        {"  12.5 kg", 0, true, 13},
+        {".5", 1, true, 5},
+        {"9223372036854775807", 0, true, INT64_MAX},
+        {"9223372036854775808", 0, false, 0},
+        {"-9223372036854775808", 0, true, INT64_MIN},
+        {"922337203685477580.8", 1, false, 0},
+        {"1000000000000000000.5", 0, true, 1000000000000000001LL},
+        {"1.0000000000000000005", 18, true, 1000000000000000001LL},
+        {"12345678901234567890", 0, false, 0},
+        {"kg", 2, false, 0},
+        {"-", 2, false, 0},
+    };
+    const char *p;
+    int64_t mantissa;
+    unsigned i;
+    bool bOk;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        p = cases[i].pText;
+        mantissa = 0;
+        bOk = RB_PARSE_Fixed(&p, &mantissa, cases[i].dp);
+        if (!HOST_CHECK((bOk == cases[i].bOk) && (!bOk || (mantissa == cases[i].mantissa))))
+            fprintf(stderr, "  \"%s\" dp %d: %d %lld\n", cases[i].pText, cases[i].dp, bOk,
+                    (long long)mantissa);
+    }
+}
+
+static void TEST_Time(void)
+{
+    volatile size_t sink = 0;
+    char buf[24];
+    double t0, tFixed, tDouble;
+    int32_t i;
+
+    t0 = TEST_Seconds();
+    for (i = 0; i < TEST_BENCH_CALLS; i++)
+        sink += RB_FORMAT_Fixed(buf, 1234567 - i, 3, sizeof(buf));
+    tFixed = TEST_Seconds() - t0;
+
+    t0 = TEST_Seconds();
+    for (i = 0; i < TEST_BENCH_CALLS; i++)
+        sink += RB_FORMAT_Double(buf, 3, (1234567 - i) / 1e3, sizeof(buf));
+    tDouble = TEST_Seconds() - t0;
+
+    printf("time per call: RB_FORMAT_Fixed %.0f ns, RB_FORMAT_Double %.0f ns, %.1f times\n",
+           tFixed * 1e9 / TEST_BENCH_CALLS, tDouble * 1e9 / TEST_BENCH_CALLS, tDouble / tFixed);
+}
+
+int main(void)
+{
+    TEST_Exhaustive();
+    TEST_Parse();
+    TEST_Time();
+
+    printf("%s, %d checks failed\n", HOST_TestFailures() ? "FAILED" : "OK", HOST_TestFailures());
+    return HOST_TestFailures() ? 1 : 0;
+}
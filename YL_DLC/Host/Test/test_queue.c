@@ -0,0 +1,282 @@
+//==================================================================================================
+//  Single producer / single consumer mode of RB_Queue.c
+//
+//    build/test_queue
+//
+//  RB_QUEUE_PutN/GetN and the Peek/Commit pairs are run from every position of the indices in a
+//  small queue with every number of elements, so each of them is split at the end of the buffer
+//  once. The free running indices pass 0xFFFF, an element count that is not a power of two is
+//  rounded down and 0 is rejected. Last a producer and a consumer thread move a sequence of
+//  octets through RB_FIFO_Write/Read and the in-place calls, the consumer checks the order.
+//==================================================================================================
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "HostTest.h"
+
+#include "RB_FIFO.h"
+
+#define TEST_ELEMENTS           8
+#define TEST_ELEMENT_LEN        3
+#define TEST_STREAM_OCTETS      4000000uL
+
+typedef struct
+{
+    uint8_t b[TEST_ELEMENT_LEN];
+} TEST_tElement;
+
+static TEST_tElement buffer[TEST_ELEMENTS];
+static RB_QUEUE_tSpscQueue queue;
+
+static void TEST_Fill(TEST_tElement *pE, uint16_t num, uint8_t first)
+{
+    uint16_t i;
+
+    for (i = 0; i < num; i++)
+        memset(pE[i].b, (uint8_t)(first + i), TEST_ELEMENT_LEN);
+}
+
+static bool TEST_Equal(const TEST_tElement *pE, uint16_t num, uint8_t first)
+{
+    TEST_tElement expected[TEST_ELEMENTS];
+
+    TEST_Fill(expected, num, first);
+    return memcmp(pE, expected, num * sizeof(TEST_tElement)) == 0;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TEST_Position
+ * Description  : empty queue with head and tail at the given index
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void TEST_Position(uint16_t start)
+{
+    TEST_tElement dummy[TEST_ELEMENTS];
+
+    RB_QUEUE_SpscInitialize(&queue, buffer, TEST_ELEMENTS, TEST_ELEMENT_LEN);
+    RB_QUEUE_PutN(&queue, dummy, start);
+    RB_QUEUE_GetN(&queue, dummy, start);
+}
+
+static void TEST_Initialize(void)
+{
+    static uint8_t big[40000];
+    RB_FIFO_tSpscFifo fifo;
+    uint16_t num;
+    uint8_t octet = 0x55;
+
+    HOST_CHECK(RB_QUEUE_SpscInitialize(&queue, buffer, 6, TEST_ELEMENT_LEN));
+    HOST_CHECK(RB_QUEUE_SpscFree(&queue) == 4);
+    HOST_CHECK(RB_FIFO_SpscInitialize(&fifo, big, 100));
+    HOST_CHECK(RB_QUEUE_SpscFree(&fifo) == 64);
+    HOST_CHECK(RB_FIFO_SpscInitialize(&fifo, big, sizeof(big)));
+    HOST_CHECK(RB_QUEUE_SpscFree(&fifo) == 32768);
+
+    // rejected, but safe to use
+    HOST_CHECK(!RB_FIFO_SpscInitialize(&fifo, big, 0));
+    HOST_CHECK(RB_QUEUE_SpscFree(&fifo) == 0);
+    HOST_CHECK(RB_FIFO_Write(&fifo, &octet, 1) == 0);
+    HOST_CHECK(RB_FIFO_Read(&fifo, &octet, 1) == 0);
+    RB_FIFO_PeekWrite(&fifo, &num);
+    HOST_CHECK(num == 0);
+    RB_FIFO_PeekRead(&fifo, &num);
+    HOST_CHECK(num == 0);
+    HOST_CHECK(RB_QUEUE_SpscLevel(&fifo) == 0);
+}
+
+static void TEST_CopyWrap(void)
+{
+    TEST_tElement in[TEST_ELEMENTS + 1], out[TEST_ELEMENTS + 1];
+    uint16_t start, num;
+
+    for (start = 0; start < TEST_ELEMENTS; start++)
+    {
+        for (num = 1; num <= TEST_ELEMENTS; num++)
+        {
+            TEST_Position(start);
+            TEST_Fill(in, TEST_ELEMENTS + 1, (uint8_t)(start * 16 + num));
+            // one more than fits is dropped
+            HOST_CHECK(RB_QUEUE_PutN(&queue, in, num) == num);
+            HOST_CHECK(RB_QUEUE_PutN(&queue, &in[num], TEST_ELEMENTS + 1 - num) == TEST_ELEMENTS - num);
+            HOST_CHECK(RB_QUEUE_SpscFree(&queue) == 0);
+            HOST_CHECK(RB_QUEUE_SpscLevel(&queue) == TEST_ELEMENTS);
+
+            memset(out, 0, sizeof(out));
+            HOST_CHECK(RB_QUEUE_GetN(&queue, out, num) == num);
+            HOST_CHECK(TEST_Equal(out, num, (uint8_t)(start * 16 + num)));
+            HOST_CHECK(RB_QUEUE_GetN(&queue, out, TEST_ELEMENTS + 1) == TEST_ELEMENTS - num);
+            HOST_CHECK(TEST_Equal(out, TEST_ELEMENTS - num, (uint8_t)(start * 16 + 2 * num)));
+            HOST_CHECK(RB_QUEUE_SpscLevel(&queue) == 0);
+        }
+    }
+}
+
+static void TEST_PeekWrap(void)
+{
+    TEST_tElement *pW;
+    const TEST_tElement *pR;
+    uint16_t start, num, span, rest;
+
+    for (start = 0; start < TEST_ELEMENTS; start++)
+    {
+        for (num = 1; num <= TEST_ELEMENTS; num++)
+        {
+            TEST_Position(start);
+
+            // the span stops at the end of the buffer, the rest follows at its start
+            pW = RB_QUEUE_PeekWrite(&queue, &span);
+            HOST_CHECK((pW == &buffer[start]) && (span == TEST_ELEMENTS - start));
+            if (span > num)
+                span = num;
+            TEST_Fill(pW, span, (uint8_t)num);
+            RB_QUEUE_CommitWrite(&queue, span);
+            rest = num - span;
+            pW = RB_QUEUE_PeekWrite(&queue, &span);
+            HOST_CHECK(span >= rest);
+            if (rest > 0)
+                HOST_CHECK(pW == &buffer[0]);
+            TEST_Fill(pW, rest, (uint8_t)(num + num - rest));
+            RB_QUEUE_CommitWrite(&queue, rest);
+            HOST_CHECK(RB_QUEUE_SpscLevel(&queue) == num);
+
+            pR = RB_QUEUE_PeekRead(&queue, &span);
+            HOST_CHECK((pR == &buffer[start]) && (span == num - rest));
+            HOST_CHECK(TEST_Equal(pR, span, (uint8_t)num));
+            RB_QUEUE_CommitRead(&queue, span);
+            pR = RB_QUEUE_PeekRead(&queue, &span);
+            HOST_CHECK(span == rest);
+            HOST_CHECK(TEST_Equal(pR, rest, (uint8_t)(num + num - rest)));
+            RB_QUEUE_CommitRead(&queue, rest);
+            HOST_CHECK(RB_QUEUE_SpscLevel(&queue) == 0);
+        }
+    }
+}
+
+static void TEST_IndexWrap(void)
+{
+    TEST_tElement in[5], out[5];
+    uint32_t i;
+    bool bOk = true;
+
+    RB_QUEUE_SpscInitialize(&queue, buffer, TEST_ELEMENTS, TEST_ELEMENT_LEN);
+    // 5 elements per round, the 16 bit indices pass 0xFFFF several times
+    for (i = 0; i < 100000uL; i++)
+    {
+        TEST_Fill(in, 5, (uint8_t)i);
+        bOk &= (RB_QUEUE_PutN(&queue, in, 5) == 5);
+        bOk &= (RB_QUEUE_SpscLevel(&queue) == 5);
+        bOk &= (RB_QUEUE_GetN(&queue, out, 5) == 5);
+        bOk &= TEST_Equal(out, 5, (uint8_t)i);
+    }
+    HOST_CHECK(bOk);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  producer and consumer thread
+//--------------------------------------------------------------------------------------------------
+
+static uint8_t streamBuf[256];
+static RB_FIFO_tSpscFifo stream;
+static volatile bool bStreamError = false;
+
+static void *TEST_Producer(void *pArg)
+{
+    uint8_t chunk[97];
+    uint32_t sent = 0;
+    uint16_t n, i, span;
+    uint8_t *pW;
+
+    while (sent < TEST_STREAM_OCTETS)
+    {
+        if (sent & 0x4000uL)
+        {
+            // in place
+            pW = RB_FIFO_PeekWrite(&stream, &span);
+            if (span > TEST_STREAM_OCTETS - sent)
+                span = (uint16_t)(TEST_STREAM_OCTETS - sent);
+            for (i = 0; i < span; i++)
+                pW[i] = (uint8_t)(sent + i);
+            RB_FIFO_CommitWrite(&stream, span);
+            sent += span;
+            if (span == 0)
+                sched_yield();
+        }
+        else
+        {
+            n = (uint16_t)(1 + (sent % sizeof(chunk)));
+            if (n > TEST_STREAM_OCTETS - sent)
+                n = (uint16_t)(TEST_STREAM_OCTETS - sent);
+            for (i = 0; i < n; i++)
+                chunk[i] = (uint8_t)(sent + i);
+            n = RB_FIFO_Write(&stream, chunk, n);
+            sent += n;
+            if (n == 0)
+                sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *TEST_Consumer(void *pArg)
+{
+    uint8_t chunk[61];
+    uint32_t received = 0;
+    uint16_t n, i;
+    const uint8_t *pR;
+
+    while (received < TEST_STREAM_OCTETS)
+    {
+        if (received & 0x8000uL)
+        {
+            pR = RB_FIFO_PeekRead(&stream, &n);
+            for (i = 0; i < n; i++)
+                if (pR[i] != (uint8_t)(received + i))
+                    bStreamError = true;
+            RB_FIFO_CommitRead(&stream, n);
+        }
+        else
+        {
+            n = RB_FIFO_Read(&stream, chunk, sizeof(chunk));
+            for (i = 0; i < n; i++)
+                if (chunk[i] != (uint8_t)(received + i))
+                    bStreamError = true;
+        }
+        received += n;
+        if (bStreamError)
+            break;
+        // the producer may run on the same core
+        if (n == 0)
+            sched_yield();
+    }
+    return NULL;
+}
+
+static void TEST_Threads(void)
+{
+    pthread_t producer, consumer;
+
+    RB_FIFO_SpscInitialize(&stream, streamBuf, sizeof(streamBuf));
+    pthread_create(&consumer, NULL, TEST_Consumer, NULL);
+    pthread_create(&producer, NULL, TEST_Producer, NULL);
+    pthread_join(consumer, NULL);
+    if (bStreamError)
+        pthread_cancel(producer);
+    pthread_join(producer, NULL);
+    HOST_CHECK(!bStreamError);
+    printf("threads: %lu octets in order\n", TEST_STREAM_OCTETS);
+}
+
+int main(void)
+{
+    TEST_Initialize();
+    TEST_CopyWrap();
+    TEST_PeekWrap();
+    TEST_IndexWrap();
+    TEST_Threads();
+
+    printf("%s, %d checks failed\n", HOST_TestFailures() ? "FAILED" : "OK", HOST_TestFailures());
+    return HOST_TestFailures() ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""The firmware of the host build on its pseudo terminals.
+
+    python test_sim.py [path of yl_dlc]
+
+Starts build/yl_dlc with COM1 and COM2 on pseudo terminals in a temporary
+directory and talks to it as the Modbus master on COM1 and the terminal on
+COM2: FC03 of the address on the address pins, no reply to another address,
+a command of CmdProcess, RESET, after which the process starts again on the
+same terminals and the eeprom file keeps the parameters.
+"""
+
+import os
+import select
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+import tty
+import unittest
+
+SIM = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'build', 'yl_dlc')
+ADDRESS = 1
+
+
+def crc16_modbus(data, crc=0xFFFF):
+    """CRC-16/MODBUS, poly 0xA001 reflected, init 0xFFFF"""
+    for byte in bytearray(data):
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def frame(pdu):
+    """PDU with its CRC, low byte first"""
+    return pdu + struct.pack('<H', crc16_modbus(pdu))
+
+
+class Port(object):
+    """Raw pseudo terminal of the simulator"""
+
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+        tty.setraw(self.fd)
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def read(self, timeout, until=None):
+        """bytes until the timeout or the terminating bytes"""
+        data = b''
+        end = time.time() + timeout
+        while time.time() < end:
+            ready, _, _ = select.select([self.fd], [], [], 0.02)
+            if ready:
+                data += os.read(self.fd, 1024)
+                if until is not None and data.endswith(until):
+                    break
+        return data
+
+    def close(self):
+        os.close(self.fd)
+
+
+class Sim(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(cls):
+        cls.dir = tempfile.mkdtemp(prefix='yl_dlc')
+        env = dict(os.environ)
+        env.update(YL_COM1=os.path.join(cls.dir, 'com1'), YL_COM2=os.path.join(cls.dir, 'com2'),
+                   YL_EEPROM=os.path.join(cls.dir, 'eeprom.bin'), YL_ADDR=str(ADDRESS))
+        cls.proc = subprocess.Popen([SIM], env=env, stderr=subprocess.PIPE)
+        end = time.time() + 5
+        while not (os.path.exists(env['YL_COM1']) and os.path.exists(env['YL_COM2'])):
+            if time.time() > end:
+                raise RuntimeError('simulator did not open its ports')
+            time.sleep(0.05)
+        cls.com1 = Port(env['YL_COM1'])
+        cls.com2 = Port(env['YL_COM2'])
+        cls.eeprom = env['YL_EEPROM']
+        # parameters loaded, the scale runs
+        time.sleep(1.0)
+        cls.com2.read(0.1)
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.com1.close()
+        cls.com2.close()
+        cls.proc.kill()
+        cls.proc.wait()
+        shutil.rmtree(cls.dir)
+
+    def read_holding(self, address, start, count):
+        self.com1.read(0.01)
+        self.com1.write(frame(struct.pack('>BBHH', address, 3, start, count)))
+        return self.com1.read(0.3)
+
+    def command(self, text):
+        self.com2.write(text + b'\r\n')
+        return self.com2.read(1.0, b'\r\n')
+
+    def test_fc03(self):
+        reply = self.read_holding(ADDRESS, 0, 4)
+        self.assertEqual(len(reply), 5 + 8)
+        self.assertEqual(reply[:3], bytes(bytearray([ADDRESS, 3, 8])))
+        self.assertEqual(crc16_modbus(reply), 0)
+
+    def test_other_address(self):
+        self.assertEqual(self.read_holding(ADDRESS + 1, 0, 4), b'')
+
+    def test_broadcast(self):
+        # not answered, not in the latency histogram of MBDIAG
+        self.command(b'MBDIAG CLR')
+        self.assertEqual(self.read_holding(0, 0, 4), b'')
+        self.com2.write(b'MBDIAG\r\n')
+        diag = self.com2.read(0.5).split(b'\r\n')
+        counters, hist = diag[0].split(b','), diag[1].split(b',')
+        self.assertEqual(int(counters[6]), 1)
+        self.assertEqual(sum(int(n) for n in hist), 0)
+
+    def test_command(self):
+        reply = self.command(b'SI')
+        self.assertTrue(reply.startswith(b'S '), reply)
+        self.assertTrue(reply.endswith(b'\r\n'), reply)
+
+    def test_parameter_flush(self):
+        with open(self.eeprom, 'rb') as f:
+            before = f.read()
+        reply = self.command(b'SETFHZ 7.5')
+        self.assertIn(b'OK', reply)
+        # USER_PARAM_FLUSH_DELAY, then the write cycles
+        time.sleep(0.5)
+        with open(self.eeprom, 'rb') as f:
+            self.assertNotEqual(f.read(), before)
+
+    def test_reset(self):
+        reply = self.command(b'RESET')
+        self.assertIn(b'System will reset', reply)
+        # started again on the same terminals, the eeprom file stays
+        time.sleep(1.5)
+        self.assertIsNone(self.proc.poll())
+        reply = self.read_holding(ADDRESS, 0, 4)
+        self.assertEqual(crc16_modbus(reply), 0)
+        self.assertEqual(os.path.getsize(self.eeprom), 4096)
+
+
+def main(argv):
+    global SIM
+    if len(argv) > 1 and not argv[1].startswith('-'):
+        SIM = argv.pop(1)
+    unittest.main(argv=argv)
+
+
+if __name__ == '__main__':
+    main(sys.argv)
@@ -0,0 +1,211 @@
+//==================================================================================================
+//  RB_Timer.c against a reference of the expiration ticks
+//
+//    build/test_timer
+//
+//  Interrupt level timers are set, reloaded and canceled at random, from the test and from their
+//  callbacks, with timeouts up to beyond the reach of the wheel, while RB_TIMER_Ticker() runs at
+//  1000 ticks per second as in EVLOOP_Run(). Every callback must come at the tick the reference
+//  expects and every cancel must return whether the timer was pending. Elements that have never
+//  been set contain garbage, as on the stack: cancel returns false and set works, without a zero
+//  initialization.
+//==================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+
+#include "HostTest.h"
+
+#include "RB_Timer.h"
+
+#define TEST_TIMERS             64
+#define TEST_TICKS              4000000uL
+// beyond TIMER_WHEEL_MAX_TICKS of 4 levels of 5 bits
+#define TEST_MAX_TIMEOUT        1500000uL
+
+typedef struct
+{
+    RB_TIMER_tElement element;
+    bool bPending;
+    uint32_t expiry;                // RB_TIMER_GetSystemTime() of the expected callback
+    uint32_t period;
+    uint32_t fired;
+} TEST_tTimer;
+
+static TEST_tTimer timers[TEST_TIMERS];
+static uint32_t rand32 = 12345;
+static uint32_t callbacks = 0;
+static uint32_t cancels = 0;
+
+static uint32_t TEST_Rand(uint32_t range)
+{
+    rand32 = rand32 * 1664525uL + 1013904223uL;
+    return (rand32 >> 8) % range;
+}
+
+// short timeouts mostly, some to the higher levels and beyond the wheel
+static uint32_t TEST_Timeout(void)
+{
+    switch (TEST_Rand(8))
+    {
+        case 0:
+            return 1 + TEST_Rand(TEST_MAX_TIMEOUT);
+        case 1:
+        case 2:
+            return 1 + TEST_Rand(40000);
+        default:
+            return 1 + TEST_Rand(1100);
+    }
+}
+
+static void TEST_Callback(void);
+
+static void TEST_Set(TEST_tTimer *pT)
+{
+    uint32_t ms = TEST_Timeout();
+    bool bPeriodic = (TEST_Rand(4) == 0);
+
+    HOST_CHECK(RB_TIMER_SetTimeout(&pT->element, TEST_Callback, ms, bPeriodic, true));
+    pT->bPending = true;
+    pT->expiry = RB_TIMER_GetSystemTime() + ms;
+    pT->period = bPeriodic ? ms : 0;
+}
+
+static void TEST_Cancel(TEST_tTimer *pT)
+{
+    bool bRet = RB_TIMER_CancelTimeout(&pT->element);
+
+    if (!HOST_CHECK(bRet == pT->bPending))
+        fprintf(stderr, "  timer %d cancel %d at %u\n", (int)(pT - timers), bRet,
+                (unsigned)RB_TIMER_GetSystemTime());
+    pT->bPending = false;
+    cancels++;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TEST_Callback
+ * Description  : callback of all timers, checks the tick and sometimes
+ *                sets or cancels this or another timer
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void TEST_Callback(void)
+{
+    TEST_tTimer *pT = (TEST_tTimer *)RB_TIMER_GetTimerElement();
+    TEST_tTimer *pOther;
+    uint32_t now = RB_TIMER_GetSystemTime();
+
+    callbacks++;
+    if (!HOST_CHECK((pT != NULL) && pT->bPending && (pT->expiry == now)))
+    {
+        if (pT != NULL)
+            fprintf(stderr, "  timer %d at %u, expected %u pending %d\n", (int)(pT - timers),
+                    (unsigned)now, (unsigned)pT->expiry, pT->bPending);
+        return;
+    }
+    pT->fired++;
+    if (pT->period)
+        pT->expiry = now + pT->period;
+    else
+        pT->bPending = false;
+
+    switch (TEST_Rand(16))
+    {
+        case 0:
+            TEST_Set(pT);
+            break;
+        case 1:
+            TEST_Cancel(pT);
+            break;
+        case 2:
+            // may be expired in the same tick and not called yet
+            pOther = &timers[TEST_Rand(TEST_TIMERS)];
+            TEST_Cancel(pOther);
+            break;
+        default:
+            break;
+    }
+}
+
+static void TEST_Random(void)
+{
+    RB_TIMER_tElement linked;
+    uint32_t tick, i, fired = 0;
+
+    // garbage as on the stack, some are copies of a pending element, their pointers look valid
+    memset(timers, 0xA5, sizeof(timers));
+    HOST_CHECK(RB_TIMER_SetTimeout(&linked, TEST_Callback, TEST_MAX_TIMEOUT, false, true));
+    for (i = 0; i < TEST_TIMERS; i++)
+    {
+        timers[i].bPending = false;
+        timers[i].fired = 0;
+        if (i & 1)
+            timers[i].element = linked;
+    }
+    HOST_CHECK(RB_TIMER_CancelTimeout(&linked));
+    for (i = 0; i < TEST_TIMERS; i += 2)
+        TEST_Cancel(&timers[i]);
+    for (i = 1; i < TEST_TIMERS; i += 2)
+        TEST_Set(&timers[i]);
+
+    for (tick = 0; tick < TEST_TICKS; tick++)
+    {
+        if (TEST_Rand(8) == 0)
+        {
+            TEST_tTimer *pT = &timers[TEST_Rand(TEST_TIMERS)];
+            if (TEST_Rand(3) == 0)
+                TEST_Cancel(pT);
+            else
+                TEST_Set(pT);
+        }
+        RB_TIMER_Ticker();
+        if (HOST_TestFailures() > 10)
+            return;
+    }
+
+    // no callback missed: nothing pending is overdue
+    for (i = 0; i < TEST_TIMERS; i++)
+    {
+        if (timers[i].bPending)
+            HOST_CHECK((int32_t)(timers[i].expiry - RB_TIMER_GetSystemTime()) > 0);
+        if (timers[i].fired)
+            fired++;
+    }
+    HOST_CHECK(fired == TEST_TIMERS);
+    printf("random: %u callbacks, %u cancels in %lu ticks\n", (unsigned)callbacks, (unsigned)cancels,
+           TEST_TICKS);
+}
+
+static void TEST_Message(void)
+{
+    RB_OS_tMsgQueue queue;
+    RB_OS_tMessage buffer[2];
+    RB_OS_tMessage msg;
+    RB_TIMER_tElement element;
+    int count = 0;
+    uint32_t tick;
+
+    memset(&element, 0x5A, sizeof(element));
+    RB_OS_MsgQueueCreate(&queue, buffer, 2, "test");
+    HOST_CHECK(RB_TIMER_SetTimeoutMessage(&element, &queue, 7, 8, 10, true));
+    for (tick = 0; tick < 35; tick++)
+    {
+        RB_TIMER_Ticker();
+        while (RB_OS_MsgQueueAccept(&queue, &msg) == RB_OS_OK)
+        {
+            HOST_CHECK((msg.src == 7) && (msg.evt == 8));
+            count++;
+        }
+    }
+    HOST_CHECK(count == 3);
+    HOST_CHECK(RB_TIMER_CancelTimeout(&element));
+    HOST_CHECK(!RB_TIMER_CancelTimeout(&element));
+}
+
+int main(void)
+{
+    TEST_Random();
+    TEST_Message();
+
+    printf("%s, %d checks failed\n", HOST_TestFailures() ? "FAILED" : "OK", HOST_TestFailures());
+    return HOST_TestFailures() ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+//==================================================================================================
+//  UserParam.c on the eeprom model, power loss at every programmed byte
+//
+//    build/test_userparam
+//
+//  A calibration set written in one transaction and a single parameter written by the flush task
+//  are interrupted at each byte of their commit in turn. The load of the next boot,
+//  USER_PARAM_Initialize(), must find the block valid with either all old or all new values.
+//  Changes within USER_PARAM_FLUSH_DELAY are written with one commit. USER_PARAM_Sync() writes
+//  nothing of an open transaction and does not close it.
+//==================================================================================================
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Host.h"
+#include "HostTest.h"
+
+#include "UserParam.h"
+
+// no test needs more: the block of a commit is below 1 kByte
+#define TEST_MAX_FAIL_BYTES     2000
+
+typedef struct
+{
+    int32_t zeroCounts;
+    double highWeight;
+    int32_t highCounts;
+} TEST_tCalSet;
+
+static const TEST_tCalSet calOld = {1000, 10.0, 50000};
+static const TEST_tCalSet calNew = {2000, 20.0, 90000};
+
+static void TEST_SetCal(const TEST_tCalSet *pCal)
+{
+    USER_PARAM_Begin();
+    USER_PARAM_Set(BLK0_zeroCalCounts, (uint8_t *)&pCal->zeroCounts);
+    USER_PARAM_Set(BLK0_highCalWeight, (uint8_t *)&pCal->highWeight);
+    USER_PARAM_Set(BLK0_highCalCounts, (uint8_t *)&pCal->highCounts);
+    USER_PARAM_Commit();
+    USER_PARAM_Sync();
+}
+
+static void TEST_GetCal(TEST_tCalSet *pCal)
+{
+    USER_PARAM_Get(BLK0_zeroCalCounts, (uint8_t *)&pCal->zeroCounts);
+    USER_PARAM_Get(BLK0_highCalWeight, (uint8_t *)&pCal->highWeight);
+    USER_PARAM_Get(BLK0_highCalCounts, (uint8_t *)&pCal->highCounts);
+}
+
+static bool TEST_CalEqual(const TEST_tCalSet *pA, const TEST_tCalSet *pB)
+{
+    return (pA->zeroCounts == pB->zeroCounts) && (pA->highWeight == pB->highWeight) &&
+           (pA->highCounts == pB->highCounts);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TEST_Reboot
+ * Description  : power on after a loss, the parameters are loaded again
+ * \return    	: error of block 0, the one of all parameters written here.
+ *                The blocks the defaults do not write stay invalid
+ *---------------------------------------------------------------------*/
+static int TEST_Reboot(void)
+{
+    HOST_EepromPowerOn();
+    return USER_PARAM_Initialize() & 1;
+}
+
+static void TEST_Defaults(void)
+{
+    char name[21];
+
+    HOST_CHECK(TEST_Reboot() == 0);
+    USER_PARAM_Get(BLK0_setupScaleName, (uint8_t *)name);
+    HOST_CHECK(strncmp(name, "Scale 1", 7) == 0);
+}
+
+static void TEST_TransactionPowerLoss(void)
+{
+    TEST_tCalSet cal;
+    uint32_t n;
+    int olds = 0;
+
+    TEST_SetCal(&calOld);
+    for (n = 0; n < TEST_MAX_FAIL_BYTES; n++)
+    {
+        HOST_EepromPowerFail(n);
+        TEST_SetCal(&calNew);
+        if (!HOST_EepromPowerFailed())
+            break;
+
+        if (!HOST_CHECK(TEST_Reboot() == 0))
+            break;
+        TEST_GetCal(&cal);
+        if (!HOST_CHECK(TEST_CalEqual(&cal, &calOld) || TEST_CalEqual(&cal, &calNew)))
+        {
+            fprintf(stderr, "  power loss after %u bytes: %d %g %d\n", (unsigned)n, (int)cal.zeroCounts,
+                    cal.highWeight, (int)cal.highCounts);
+            break;
+        }
+        if (TEST_CalEqual(&cal, &calOld))
+            olds++;
+        TEST_SetCal(&calOld);
+    }
+    HOST_CHECK(n < TEST_MAX_FAIL_BYTES);
+    // the record is valid with its last byte, every loss before keeps the old set
+    HOST_CHECK(olds > 0);
+
+    HOST_CHECK(TEST_Reboot() == 0);
+    TEST_GetCal(&cal);
+    HOST_CHECK(TEST_CalEqual(&cal, &calNew));
+    printf("transaction: %u loss points, old set kept %d times\n", (unsigned)n, olds);
+}
+
+static void TEST_FlushPowerLoss(void)
+{
+    double hzOld = 2.0;
+    double hzNew = 5.5;
+    double hz;
+    uint32_t n;
+
+    USER_PARAM_Set(BLK0_setupLowPassFilter, (uint8_t *)&hzOld);
+    USER_PARAM_Flush();
+    for (n = 0; n < TEST_MAX_FAIL_BYTES; n++)
+    {
+        // write-behind, the flush task commits
+        USER_PARAM_Set(BLK0_setupLowPassFilter, (uint8_t *)&hzNew);
+        HOST_EepromPowerFail(n);
+        HOST_TestRun(2 * USER_PARAM_FLUSH_DELAY);
+        if (!HOST_EepromPowerFailed())
+            break;
+
+        if (!HOST_CHECK(TEST_Reboot() == 0))
+            break;
+        USER_PARAM_Get(BLK0_setupLowPassFilter, (uint8_t *)&hz);
+        if (!HOST_CHECK((hz == hzOld) || (hz == hzNew)))
+            break;
+        USER_PARAM_Set(BLK0_setupLowPassFilter, (uint8_t *)&hzOld);
+        USER_PARAM_Flush();
+    }
+    HOST_CHECK(n < TEST_MAX_FAIL_BYTES);
+    HOST_CHECK(TEST_Reboot() == 0);
+    USER_PARAM_Get(BLK0_setupLowPassFilter, (uint8_t *)&hz);
+    HOST_CHECK(hz == hzNew);
+    printf("flush: %u loss points\n", (unsigned)n);
+}
+
+static void TEST_FlushCoalesces(void)
+{
+    HOST_tEepromStat one, five;
+    char reply[64];
+    double hz;
+
+    // a known value first, the next command is a change
+    HOST_TestCommand("SETFHZ 3.0", NULL, 0);
+    HOST_TestRun(2 * USER_PARAM_FLUSH_DELAY);
+
+    HOST_EepromClearStat();
+    HOST_TestCommand("SETFHZ 3.5", reply, sizeof(reply));
+    HOST_CHECK(strstr(reply, "OK") != NULL);
+    HOST_TestRun(2 * USER_PARAM_FLUSH_DELAY);
+    HOST_EepromGetStat(&one);
+    HOST_CHECK(one.pagePrograms > 0);
+
+    // five commands in one frame, one commit
+    HOST_EepromClearStat();
+    HOST_TestCommand("SETFHZ 4.5\r\nSETFHZ 6.5\r\nSETFHZ 7.5\r\nSETFHZ 8.5\r\nSETFHZ 2.5", NULL, 0);
+    HOST_TestRun(2 * USER_PARAM_FLUSH_DELAY);
+    HOST_EepromGetStat(&five);
+    HOST_CHECK(five.pagePrograms == one.pagePrograms);
+
+    HOST_CHECK(TEST_Reboot() == 0);
+    USER_PARAM_Get(BLK0_setupLowPassFilter, (uint8_t *)&hz);
+    HOST_CHECK(hz == 2.5);
+    printf("SETFHZ: %u page programs for 1 command, %u for 5\n", (unsigned)one.pagePrograms,
+           (unsigned)five.pagePrograms);
+}
+
+static void TEST_SyncInTransaction(void)
+{
+    HOST_tEepromStat stat;
+    TEST_tCalSet cal;
+
+    TEST_SetCal(&calOld);
+    HOST_EepromClearStat();
+
+    // a reset command between the sets of another caller
+    USER_PARAM_Begin();
+    USER_PARAM_Set(BLK0_zeroCalCounts, (uint8_t *)&calNew.zeroCounts);
+    HOST_CHECK(USER_PARAM_Sync() == USER_PARAM_APP_BUSY);
+    USER_PARAM_Set(BLK0_highCalWeight, (uint8_t *)&calNew.highWeight);
+    HOST_TestRun(2 * USER_PARAM_FLUSH_DELAY);
+    HOST_EepromGetStat(&stat);
+    HOST_CHECK(stat.pagePrograms == 0);
+    HOST_CHECK(USER_PARAM_IsDirty());
+
+    USER_PARAM_Set(BLK0_highCalCounts, (uint8_t *)&calNew.highCounts);
+    USER_PARAM_Commit();
+    HOST_CHECK(USER_PARAM_Sync() == USER_PARAM_OK);
+    HOST_CHECK(!USER_PARAM_IsDirty());
+
+    HOST_CHECK(TEST_Reboot() == 0);
+    TEST_GetCal(&cal);
+    HOST_CHECK(TEST_CalEqual(&cal, &calNew));
+}
+
+int main(void)
+{
+    HOST_TestBoot();
+    TEST_Defaults();
+    TEST_TransactionPowerLoss();
+    TEST_FlushPowerLoss();
+    TEST_FlushCoalesces();
+    TEST_SyncInTransaction();
+
+    printf("%s, %d checks failed\n", HOST_TestFailures() ? "FAILED" : "OK", HOST_TestFailures());
+    return HOST_TestFailures() ? 1 : 0;
+}
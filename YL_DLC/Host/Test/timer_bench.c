@@ -0,0 +1,102 @@
+//==================================================================================================
+//  Cost of RB_Timer.c over the number of pending timers
+//
+//    build/timer_bench
+//
+//  N periodic interrupt level timers with periods of 1..1000 ms, as a protocol stack with many
+//  timeouts would set them. Printed per N: the time of RB_TIMER_Ticker() per tick, averaged over
+//  the callbacks of 10 s, and of a reload, RB_TIMER_SetTimeout() of a pending timer, which cancels
+//  it first. Host time, the ratio between the rows is what carries over to the target. The bench
+//  fails if a reload of BENCH_MAX_TIMERS timers takes more than BENCH_FLAT times the one of 10:
+//  set and cancel unlink an element without a list walk, only the caches may make a difference.
+//==================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "HostTest.h"
+
+#include "RB_Timer.h"
+
+#define BENCH_MAX_TIMERS        10000
+#define BENCH_TICKS             10000uL
+#define BENCH_RELOADS           1000000uL
+#define BENCH_FLAT              3.0
+
+static RB_TIMER_tElement elements[BENCH_MAX_TIMERS];
+static uint32_t period[BENCH_MAX_TIMERS];
+static uint32_t rand32 = 1;
+static uint32_t callbacks;
+
+static uint32_t BENCH_Rand(uint32_t range)
+{
+    rand32 = rand32 * 1664525uL + 1013904223uL;
+    return (rand32 >> 8) % range;
+}
+
+static double BENCH_Seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void BENCH_Callback(void)
+{
+    callbacks++;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : BENCH_Run
+ * Description  : n timers pending, ticks and reloads
+ * \return    	: ns per reload
+ *---------------------------------------------------------------------*/
+static double BENCH_Run(uint32_t n)
+{
+    double t0, tTick, tReload;
+    uint32_t i, k;
+
+    for (i = 0; i < n; i++)
+    {
+        period[i] = 1 + BENCH_Rand(1000);
+        RB_TIMER_SetTimeout(&elements[i], BENCH_Callback, period[i], true, true);
+    }
+
+    callbacks = 0;
+    t0 = BENCH_Seconds();
+    for (i = 0; i < BENCH_TICKS; i++)
+        RB_TIMER_Ticker();
+    tTick = BENCH_Seconds() - t0;
+
+    t0 = BENCH_Seconds();
+    for (i = 0; i < BENCH_RELOADS; i++)
+    {
+        k = BENCH_Rand(n);
+        RB_TIMER_SetTimeout(&elements[k], BENCH_Callback, period[k], true, true);
+    }
+    tReload = BENCH_Seconds() - t0;
+
+    printf("%6u timers  %8.0f ns per tick  %6.1f callbacks per tick  %5.0f ns per reload\n",
+           (unsigned)n, tTick * 1e9 / BENCH_TICKS, (double)callbacks / BENCH_TICKS,
+           tReload * 1e9 / BENCH_RELOADS);
+
+    for (i = 0; i < n; i++)
+        RB_TIMER_CancelTimeout(&elements[i]);
+    return tReload * 1e9 / BENCH_RELOADS;
+}
+
+int main(void)
+{
+    static const uint32_t counts[] = {10, 100, 1000, BENCH_MAX_TIMERS};
+    double reload[sizeof(counts) / sizeof(counts[0])];
+    unsigned i;
+
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+        reload[i] = BENCH_Run(counts[i]);
+    HOST_CHECK(reload[i - 1] < BENCH_FLAT * reload[0]);
+
+    printf("%s, %d checks failed\n", HOST_TestFailures() ? "FAILED" : "OK", HOST_TestFailures());
+    return HOST_TestFailures() ? 1 : 0;
+}
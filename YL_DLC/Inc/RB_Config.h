@@ -0,0 +1,53 @@
+//==================================================================================================
+//                                            Rainbow
+//==================================================================================================
+//
+//! \file		RB_Config.h
+//! \brief		Configuration of the Rainbow modules for the YL_DLC load cell
+//!
+//! Only the modules compiled in YL_DLC.ewp are configured here: RB_OS and RB_Queue for the event
+//! loop (EventLoop.h), the single producer / single consumer queue of RB_Queue. The FreeRTOS kernel
+//! keeps running underneath, the critical sections lock the interrupts with PRIMASK and may be used
+//! by tasks and interrupts. RB_Timer delays the parameter flush of the event loop, its ticker is
+//! called by EVLOOP_Run().
+//
+//==================================================================================================
+
+#ifndef _RB_Config__h
+#define _RB_Config__h
+
+
+//==================================================================================================
+//  I N C L U D E D   F I L E S
+//==================================================================================================
+
+#include "stm32f1xx.h"
+
+
+//==================================================================================================
+//  G L O B A L   D E F I N I T I O N S
+//==================================================================================================
+
+#define RB_CONFIG_YES				1
+#define RB_CONFIG_NO				0
+
+//! RB_OS_TaskTicker() and RB_TIMER_Ticker() are called once per FreeRTOS tick
+#define RB_CONFIG_TICKER_TICKS_PER_SEC	1000
+
+//! There is no debug output channel, the RB_DEBUG_xxx macros expand to nothing and RB_Debug.c is
+//! not linked
+#define RB_ENV_DEBUG_LEVEL			0
+
+//! Critical section, nestable, both macros must be used in the same block
+#define RB_ENTER_CRITICAL_SECTION	{ uint32_t rbPrimask = __get_PRIMASK(); __disable_irq()
+#define RB_LEAVE_CRITICAL_SECTION	__set_PRIMASK(rbPrimask); } do {} while (0)
+
+//! Orders the element copies and the index updates of the lock-free RB_QUEUE_tSpscQueue, a
+//! compiler barrier as well
+#define RB_MEMORY_BARRIER()			__DMB()
+
+//! Busy wait of RB_TIMER_BusyDelay(), delay_us() of main.c
+#define RB_BusyWaitMicroSeconds(us)	delay_us(us)
+
+
+#endif // _RB_Config__h
@@ -65,9 +65,26 @@ extern I2C_HandleTypeDef hi2c1;
 
 /* USER CODE BEGIN Private defines */
 
+#define EE_PAGE_SIZE 64
+#define EE_SIZE             4096            // 24C32
+#define EE_WRITE_CYCLES     1000000UL       // endurance of a page
+#define EE_READ_RETRY       10              // 1 ms apart, covers a 5 ms write cycle
+
+// eeprom traffic since start or the last clear, the wear of each page is kept in i2c.c
+typedef struct
+{
+  uint32_t readCalls;
+  uint32_t readBytes;
+  uint32_t writeCalls;
+  uint32_t pagePrograms;        // write cycles, one per page touched by a write
+  uint32_t writeBytes;
+  uint32_t busTimeUs;           // time spent in EEPROM_Read() and EEPROM_Write()
+  uint32_t startTick;           // HAL_GetTick() of the clear
+} EEPROM_tStat;
 
 HAL_StatusTypeDef  EEPROM_Read(uint16_t address,uint8_t *pData, uint16_t Size, uint32_t Timeout);
 HAL_StatusTypeDef  EEPROM_Write(uint16_t address,uint8_t *pData, uint16_t Size, uint32_t Timeout);
+void EEPROM_GetStat(EEPROM_tStat *pStat, uint16_t *pMaxWear, uint16_t *pMaxPage, uint8_t bReset);
 
 /* USER CODE END Private defines */
 
@@ -54,7 +54,7 @@
 /* Includes ------------------------------------------------------------------*/
 
 /* USER CODE BEGIN Includes */
-
+#include <stdint.h>
 /* USER CODE END Includes */
 
 /* Private define ------------------------------------------------------------*/
@@ -98,6 +98,7 @@
 /* USER CODE BEGIN Private defines */
 
 void delay_us(unsigned int  Number);
+uint32_t get_time_us(void);
 
 /* USER CODE END Private defines */
 
@@ -70,7 +70,7 @@ extern uint16_t usart1_rx_len ;
 extern uint16_t usart1_rx_FIFO_len ;
 extern uint8_t usart1_rx_flag ;
 extern uint8_t usart1_rx_buffer[];
-extern uint8_t usart1_rx_FIFO[];
+extern uint8_t *usart1_rx_FIFO;            // latest frame while usart1_rx_flag is 1
 
 
 extern uint16_t usart2_rx_len ;
@@ -78,6 +78,16 @@ extern uint8_t usart2_rx_flag ;
 extern uint8_t usart2_rx_buffer[];
 extern uint8_t usart2_rx_FIFO[];
 
+#define USART_PORT_NUM  2
+
+extern uint32_t usart_rx_time[];            // get_time_us() when the last frame was accepted
+extern uint32_t usart_tx_time[];            // get_time_us() when the last transmission started
+extern uint16_t usart_rx_drop_frames[];     // COM1: frames replaced by a newer one before they were taken,
+                                            // COM2: frames dropped, previous frame still pending;
+                                            // stays at 0xFFFF
+extern uint32_t usart_rx_drop_bytes[];
+extern uint16_t usart_tx_drop_frames[];     // SendCom() frames dropped, transmitter still busy
+
 /* USER CODE END Private defines */
 
 extern void _Error_Handler(char *, int);
@@ -87,8 +97,10 @@ void MX_USART2_UART_Init(void);
 
 /* USER CODE BEGIN Prototypes */
 
-void SendCom(int Nport,uint8_t *sendstr,int lenth,int timeout);
+HAL_StatusTypeDef SendCom(int Nport,uint8_t *sendstr,int lenth,int timeout);
+HAL_StatusTypeDef SendComDMA(int Nport,uint8_t *sendstr,int lenth);
 void UsartReceive_IDLE(UART_HandleTypeDef *huart);
+uint8_t *UsartTakeFrame1(uint16_t *pLen);
 
 /* USER CODE END Prototypes */
 
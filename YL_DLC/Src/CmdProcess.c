@@ -10,6 +10,19 @@
 
 #include "scale.h"
 #include "UserParam.h"
+#include "usart.h"
+#include "i2c.h"
+#include "ModbusRTUSlave.h"
+#include "MTSICS.h"
+#include "ContOut.h"
+#include "Telemetry.h"
+#include "WarmStart.h"
+#include "BootTime.h"
+#include "Trace.h"
+#include "TaskStat.h"
+#include "EventLoop.h"
+#include "DebugLog.h"
+#include "SimLoad.h"
 
 ///
 //extern osMutexId myIICMutexHandle;
@@ -23,8 +36,6 @@ double adc1_adjustcounts1,adc1_adjustcounts2;
 double adc2_adjustcounts1,adc2_adjustcounts2;
 double adjustk2 = 1.0;
 
-extern void SendCom(int Nport,uint8_t *sendstr,int lenth,int timeout);
-
 void SendOK();
 void SendErr();
 static void SetCapacitiyAndIncr(char *cmdstr,unsigned char cmdlenth);
@@ -37,6 +48,10 @@ static void ReadTestPoint(char *cmdstr,unsigned char cmdlenth);
 static void SetGeoCode(char *cmdstr,unsigned char cmdlenth);
 static void ReadGeoCode(char *cmdstr,unsigned char cmdlenth);
 
+// continuous output assignment of COM1/COM2
+static void SetContOut(char *cmdstr,unsigned char cmdlenth);
+static void ReadContOut(char *cmdstr,unsigned char cmdlenth);
+
 static void SetCalibration(char *cmdstr,unsigned char cmdlenth);
 static void ReadCalibration(char *cmdstr,unsigned char cmdlenth);
 // power up zero or cmd set zero
@@ -66,6 +81,33 @@ static void SetFilterHz(char *cmdstr,unsigned char cmdlenth);
 static void SetFilterPos(char *cmdstr,unsigned char cmdlenth);
 static void ResetSys(char *cmdstr,unsigned char cmdlenth);
 static void ResetParamters(char *cmdstr,unsigned char cmdlenth);
+static void GetModbusDiag(char *cmdstr,unsigned char cmdlenth);
+
+// binary telemetry stream
+static void SetTelemetry(char *cmdstr,unsigned char cmdlenth);
+static void ReadTelemetry(char *cmdstr,unsigned char cmdlenth);
+
+// eeprom traffic and wear
+static void ReadEepromStat(char *cmdstr,unsigned char cmdlenth);
+
+// warm start after reset
+static void ReadWarmStart(char *cmdstr,unsigned char cmdlenth);
+
+// boot timeline
+static void ReadBootTime(char *cmdstr,unsigned char cmdlenth);
+
+// execution time of the hot path stages
+static void ReadTrace(char *cmdstr,unsigned char cmdlenth);
+
+// CPU share, stack and heap headroom of the tasks
+static void ReadTaskStat(char *cmdstr,unsigned char cmdlenth);
+
+// deferred binary event log
+static void ReadLog(char *cmdstr,unsigned char cmdlenth);
+
+// scripted load signal in place of the converters
+static void SetSimLoad(char *cmdstr,unsigned char cmdlenth);
+static void ReadSimLoad(char *cmdstr,unsigned char cmdlenth);
 
 uint8_t machine_addr;
 
@@ -73,45 +115,110 @@ uint8_t machine_addr;
 
 char respsendbuf[200]={0};
 
-CmdStruct SetCmdArry[25] =
+//! command table, MUST be sorted by cmdstr (strcmp order) for the binary search in CmdLookup()
+const CmdStruct SetCmdArry[] =
 {
-    
-    { "SETCI",		5,	SetCapacitiyAndIncr },
-	{ "READCI",		6,	ReadCapacityAndIncr },
-	{ "SETTP",		5,	SetTestPoint },
-	{ "READTP",		6,	ReadTestPoint },
-	{ "SETGEO",		6,	SetGeoCode },
-	{ "READGEO",	7,	ReadGeoCode },
-    { "SETCAL_D",   8,  SetCalibration},
-    { "READCAL_D",  9,  ReadCalibration},
-    { "SETZRANG",   8,  SetZeroRang},
-    { "READZRANG",  9,  ReadZeroRang},
-    {"SETADC",      6,  SetADC},
-    {"READADC",     7,  ReadADC},
-    {"GETWA",        5,  GetWeigt},
-    {"GETWG",        5,  GetWeigtG},
-    {"GETWN",        5,  GetWeigtN},
-    {"GETWT",        5,  GetWeigtT},
+    {"AJUST",       5,  ScaleAdjust},
+    {"CLEARTA",     7,  ClearTare},
     {"GADCV",       5,  GetADCvalue},
+    {"GETWA",       5,  GetWeigt},
+    {"GETWG",       5,  GetWeigtG},
+    {"GETWN",       5,  GetWeigtN},
+    {"GETWT",       5,  GetWeigtT},
+    {"MBDIAG",      6,  GetModbusDiag},
+    {"PRESET",      6,  ResetParamters},
+    {"READADC",     7,  ReadADC},
+    {"READBOOT",    8,  ReadBootTime},
+    {"READCAL_D",   9,  ReadCalibration},
+    {"READCI",      6,  ReadCapacityAndIncr},
+    {"READCONT",    8,  ReadContOut},
+    {"READEE",      6,  ReadEepromStat},
+    {"READGEO",     7,  ReadGeoCode},
+    {"READLOG",     7,  ReadLog},
+    {"READSIM",     7,  ReadSimLoad},
+    {"READTASK",    8,  ReadTaskStat},
+    {"READTLM",     7,  ReadTelemetry},
+    {"READTP",      6,  ReadTestPoint},
+    {"READTRACE",   9,  ReadTrace},
+    {"READWARM",    8,  ReadWarmStart},
+    {"READZRANG",   9,  ReadZeroRang},
+    {"RESET",       5,  ResetSys},
+    {"SETADC",      6,  SetADC},
+    {"SETCAL_D",    8,  SetCalibration},
+    {"SETCI",       5,  SetCapacitiyAndIncr},
+    {"SETCONT",     7,  SetContOut},
+    {"SETFHZ",      6,  SetFilterHz},
+    {"SETFPOLS",    8,  SetFilterPos},
+    {"SETGEO",      6,  SetGeoCode},
+    {"SETSIM",      6,  SetSimLoad},
     {"SETTA",       5,  SetTare},
-	{"CLEARTA",     7,  ClearTare},
+    {"SETTLM",      6,  SetTelemetry},
+    {"SETTP",       5,  SetTestPoint},
+    {"SETZRANG",    8,  SetZeroRang},
     {"ZEROZ",       5,  SetZero},
-    {"AJUST",       5,  ScaleAdjust},
-    {"SETFPOLS",    8,  SetFilterPos},
-    {"SETFHZ",       6,  SetFilterHz},
-    {"RESET",       5,  ResetSys},
-    {"PRESET",      6,  ResetParamters},    //25
 };
 
+#define SETCMD_NUM  (sizeof(SetCmdArry) / sizeof(CmdStruct))
+
+// responses of one received frame are collected and sent with a single SendCom()
+#define CMD_TX_BUF_LEN  512
+
+static char cmdTxBuf[CMD_TX_BUF_LEN];
+static int cmdTxLen = 0;
+
+//---------------------------------------------------------------------------------------------------
+//void CmdReplyFlush(void)
+//---------------------------------------------------------------------------------------------------
+//! \brief		start transmission of the collected responses
+//---------------------------------------------------------------------------------------------------
+void CmdReplyFlush(void)
+{
+    if(cmdTxLen == 0)
+        return;
+    // wait for a continuous output frame on the port
+    SendCom(1, (uint8_t*)cmdTxBuf, cmdTxLen, 20);
+    cmdTxLen = 0;
+}
+
+//---------------------------------------------------------------------------------------------------
+//void CmdReply(const void *data, int lenth)
+//---------------------------------------------------------------------------------------------------
+//! \brief		append a response to the TX batch, flushes when the batch is full
+//---------------------------------------------------------------------------------------------------
+void CmdReply(const void *data, int lenth)
+{
+    const char *ptr = (const char*)data;
+    int part;
+
+    while(lenth > 0)
+    {
+        if(cmdTxLen == 0)
+        {
+            // the buffer may still be sent by the interrupt of the last flush
+            while(huart2.gState == HAL_UART_STATE_BUSY_TX)
+                osDelay(1);
+        }
+        part = CMD_TX_BUF_LEN - cmdTxLen;
+        if(part > lenth)
+            part = lenth;
+        memcpy(cmdTxBuf + cmdTxLen, ptr, part);
+        cmdTxLen += part;
+        ptr += part;
+        lenth -= part;
+        if(cmdTxLen == CMD_TX_BUF_LEN)
+            CmdReplyFlush();
+    }
+}
+
 
 void SendOK(int Nport)
 {
-    SendCom(Nport,"OK\r\n",strlen("OK\r\n"),0);
+    CmdReply("OK\r\n",strlen("OK\r\n"));
 }
 
 void SendErr(int Nport)
 {
-    SendCom(Nport,"CMD error\r\n",strlen("CMD error\r\n"),0);
+    CmdReply("CMD error\r\n",strlen("CMD error\r\n"));
 }
 
 static void SetCapacitiyAndIncr(char *cmdstr,unsigned char cmdlenth)
@@ -129,14 +236,16 @@ static void SetCapacitiyAndIncr(char *cmdstr,unsigned char cmdlenth)
        if(0== CheckIncrIsValid(tmpinr)&&((tmpcap>100*tmpinr)&&(tmpcap<tmpinr*300000)))
        {
            // save these paramters
+          USER_PARAM_Begin();
           USER_PARAM_Set(BLK0_setupRangeOneCapacity, (uint8_t *)(&tmpcap));
           USER_PARAM_Set(BLK0_setupRangeOneIncrement, (uint8_t *)(&tmpinr));
+          USER_PARAM_Commit();
           InitScaleParamters(&g_ScaleData);
           SendOK(1);
        }
         else
         {
-            SendCom(1,"data error\r\n",strlen("data error\r\n"),0);
+            CmdReply("data error\r\n",strlen("data error\r\n"));
         }
     }
     else
@@ -166,7 +275,7 @@ static void SetFilterHz(char *cmdstr,unsigned char cmdlenth)
        }
         else
         {
-            SendCom(1,"data error\r\n",strlen("data error\r\n"),0);
+            CmdReply("data error\r\n",strlen("data error\r\n"));
         }
     }
     else
@@ -201,7 +310,7 @@ static void SetFilterPos(char *cmdstr,unsigned char cmdlenth)
        }
         else
         {
-            SendCom(1,"data error\r\n",strlen("data error\r\n"),0);
+            CmdReply("data error\r\n",strlen("data error\r\n"));
         }
     }
     else
@@ -227,7 +336,7 @@ static void ScaleAdjust(char *cmdstr,unsigned char cmdlenth)
   
     char  *ptrtmp = NULL;
     int tmpint = 0;  //default
-    double precounts1,precounts2 ;
+    double precounts1 = 0, precounts2 = 0;
     ptrtmp = (cmdstr + cmdlenth);    
     int retvalue = sscanf(ptrtmp,"%d",&tmpint);   
     int times = 0;
@@ -252,7 +361,8 @@ static void ScaleAdjust(char *cmdstr,unsigned char cmdlenth)
                 times++;
                 adc1_adjustcounts1+=adcvalue1 ;
                 adc2_adjustcounts1+=adcvalue2 ;
-                SendCom(1,  "#", 1,0);
+                CmdReply("#", 1);
+                CmdReplyFlush();
                    
             }
             osDelay(100); 
@@ -278,7 +388,8 @@ static void ScaleAdjust(char *cmdstr,unsigned char cmdlenth)
                 times++;
                 adc1_adjustcounts2+=adcvalue1 ;
                 adc2_adjustcounts2+=adcvalue2 ;
-                SendCom(1,  "#", 1,0);                   
+                CmdReply("#", 1);
+                CmdReplyFlush();
             }
             osDelay(100); 
         }
@@ -303,9 +414,15 @@ static void ScaleAdjust(char *cmdstr,unsigned char cmdlenth)
     
 }
 
+// RESET      -> cold start
+// RESET WARM -> keep weighing state, zero and tare like after a watchdog reset
 static void ResetSys(char *cmdstr,unsigned char cmdlenth)
 {
-  SendCom(1,  "System will reset!", strlen("System will reset !"),0); 
+  if(0 != strncmp(cmdstr + cmdlenth, " WARM", 5))
+    WARM_Invalidate();
+  CmdReply("System will reset!", strlen("System will reset !")); 
+  CmdReplyFlush();
+  USER_PARAM_Sync();
   osDelay(100);
   HAL_NVIC_SystemReset();
   
@@ -318,7 +435,10 @@ static void ResetParamters(char *cmdstr,unsigned char cmdlenth)
   char tmpchar[21]={0};
   memcpy(tmpchar,"Scale 2",strlen("Scale 2"));
   USER_PARAM_Set(BLK0_setupScaleName, (uint8_t *)tmpchar);
-  SendCom(1,  "System will reset!", strlen("System will reset !"),0); 
+  WARM_Invalidate();
+  CmdReply("System will reset!", strlen("System will reset !")); 
+  CmdReplyFlush();
+  USER_PARAM_Sync();
   osDelay(100);
   HAL_NVIC_SystemReset();
 }
@@ -333,7 +453,7 @@ static void ReadCapacityAndIncr(char *cmdstr,unsigned char cmdlenth)
     USER_PARAM_Get(BLK0_setupRangeOneIncrement, (uint8_t *)(&tmpinr)); 
     memset(respsendbuf,0,sizeof(respsendbuf));
     sprintf(respsendbuf,"%lf,%lf\r\n",tmpcap,tmpinr);
-    SendCom(1,  (uint8_t*)respsendbuf, strlen(respsendbuf),0);
+    CmdReply((uint8_t*)respsendbuf, strlen(respsendbuf));
 }
 
 static void SetTestPoint(char *cmdstr,unsigned char cmdlenth)
@@ -353,7 +473,7 @@ static void SetGeoCode(char *cmdstr,unsigned char cmdlenth)
     {
        if(tempint <0||tempint>31)
        {
-         SendCom(1,"GEO value must 0-31\r\n",strlen("GEO value must 0-31\r\n"),0);
+         CmdReply("GEO value must 0-31\r\n",strlen("GEO value must 0-31\r\n"));
        }
        else
        {
@@ -372,10 +492,62 @@ static void ReadGeoCode(char *cmdstr,unsigned char cmdlenth)
     USER_PARAM_Get(BLK0_usrGeo       , (uint8_t *)(&usergeo)); 
     memset(respsendbuf,0,sizeof(respsendbuf));
     sprintf(respsendbuf,"CalGEO = %d,UserGEO = %d\r\n",calgeo ,usergeo);
-    SendCom(1,  (uint8_t*)respsendbuf, strlen(respsendbuf),0);
+    CmdReply((uint8_t*)respsendbuf, strlen(respsendbuf));
    
     
     
+}
+
+// cmd SETCONT 1 3 1: COM1 continuous output(3), checksum on
+// format 0 none, 1 kingbird, 2 8142, 3 toledo continuous, 4 extended
+static void SetContOut(char *cmdstr,unsigned char cmdlenth)
+{
+    int port, format, checksum;
+    uint8_t tempassign, tempchk;
+    if(3==sscanf((cmdstr+cmdlenth),"%d %d %d",&port,&format,&checksum))
+    {
+       if(port <1||port>2||format<COMASSIGNMENT_NONE||format>COMASSIGNMENT_EXTENDEDCONTINUOUSOUTPUT||checksum<0||checksum>1)
+       {
+         SendErr(1);
+       }
+       else
+       {
+            tempassign = (uint8_t)format;
+            tempchk = (uint8_t)checksum;
+            USER_PARAM_Begin();
+            if(port == 1)
+            {
+                USER_PARAM_Set(BLK1_setupCOM1Assignment, (uint8_t *)(&tempassign));
+                USER_PARAM_Set(BLK1_setupCOM1AssignmentChecksum, (uint8_t *)(&tempchk));
+            }
+            else
+            {
+                USER_PARAM_Set(BLK1_setupCOM2Assignment, (uint8_t *)(&tempassign));
+                USER_PARAM_Set(BLK1_setupCOM2AssignmentChecksum, (uint8_t *)(&tempchk));
+            }
+            USER_PARAM_Commit();
+            SendOK(1);
+            // the frames belong to the weigh task
+            CONT_RequestInit();
+       }
+    }
+    else
+    {
+        SendErr(1);
+    }
+}
+
+static void ReadContOut(char *cmdstr,unsigned char cmdlenth)
+{
+    uint8_t assign1,chk1,assign2,chk2;
+    USER_PARAM_Get(BLK1_setupCOM1Assignment        , (uint8_t *)(&assign1));
+    USER_PARAM_Get(BLK1_setupCOM1AssignmentChecksum, (uint8_t *)(&chk1));
+    USER_PARAM_Get(BLK1_setupCOM2Assignment        , (uint8_t *)(&assign2));
+    USER_PARAM_Get(BLK1_setupCOM2AssignmentChecksum, (uint8_t *)(&chk2));
+    memset(respsendbuf,0,sizeof(respsendbuf));
+    sprintf(respsendbuf,"COM1 = %d,%d,COM2 = %d,%d,TX drops = %u,%u\r\n",assign1,chk1,assign2,chk2,
+            usart_tx_drop_frames[0],usart_tx_drop_frames[1]);
+    CmdReply((uint8_t*)respsendbuf, strlen(respsendbuf));
 }
 // cmd SETCAL_D 0 0:  У׼1 0kgɼcounts
 // CMD SETCAL_D 1 20
@@ -385,7 +557,7 @@ static void SetCalibration(char *cmdstr,unsigned char cmdlenth)
     double calcounts = 0;     // ȡcountsֵ
     double calweight; // У׼
     int times = 0;
-    double precounts ;
+    double precounts = 0;
     if(2==sscanf((cmdstr+cmdlenth),"%d %lf",&testpoint,&calweight))
     {
         //
@@ -401,7 +573,8 @@ static void SetCalibration(char *cmdstr,unsigned char cmdlenth)
                 precounts = dFilerAdcValue ;
                 times++;
                 calcounts+=dFilerAdcValue ;
-                SendCom(1,  "#", 1,0);
+                CmdReply("#", 1);
+                CmdReplyFlush();
                    
             }
             osDelay(100); 
@@ -460,39 +633,37 @@ static void ReadADC(char *cmdstr,unsigned char cmdlenth)
 }
 
 
+// the weight strings are made on demand by SCALE_CopyDisplayString()
+static void ReplyWeightString(SCALE_tWeightString which)
+{
+     char weight[12];
+
+     SCALE_CopyDisplayString(&g_ScaleData, which, weight, sizeof(weight));
+     CmdReply((uint8_t*)weight, strlen(weight));
+     CmdReply("\r\n", 2);
+}
+
 static void GetWeigt(char *cmdstr,unsigned char cmdlenth)
 {
-     SendCom(1,  (uint8_t*)g_ScaleData.grossString, strlen(g_ScaleData.grossString),0);
-     osDelay(5);
-     SendCom(1,  "\r\n", 2,0);
-     SendCom(1,  (uint8_t*)g_ScaleData.netString, strlen(g_ScaleData.netString),0);
-     osDelay(5);
-     SendCom(1,  "\r\n", 2,0);
-     SendCom(1,  (uint8_t*)g_ScaleData.netString, strlen(g_ScaleData.netString),0);
-     osDelay(5);
-     SendCom(1,  "\r\n", 2,0);
+     ReplyWeightString(SCALE_STRING_GROSS);
+     ReplyWeightString(SCALE_STRING_NET);
+     ReplyWeightString(SCALE_STRING_NET);
 }
 
 static void GetWeigtG(char *cmdstr,unsigned char cmdlenth)
 {
-     SendCom(1,  (uint8_t*)g_ScaleData.grossString, strlen(g_ScaleData.grossString),0);
-     osDelay(5);
-     SendCom(1,  "\r\n", 2,0);
+     ReplyWeightString(SCALE_STRING_GROSS);
   
 }
 
 static void GetWeigtN(char *cmdstr,unsigned char cmdlenth)
 {
-     SendCom(1,  (uint8_t*)g_ScaleData.netString, strlen(g_ScaleData.netString),0);
-     osDelay(5);
-     SendCom(1,  "\r\n", 2,0);
+     ReplyWeightString(SCALE_STRING_NET);
 }
 
 static void GetWeigtT(char *cmdstr,unsigned char cmdlenth)
 {
-     SendCom(1,  (uint8_t*)g_ScaleData.tareString, strlen(g_ScaleData.tareString),0);
-     osDelay(5);
-     SendCom(1,  "\r\n", 2,0);
+     ReplyWeightString(SCALE_STRING_TARE);
 }
 
 
@@ -500,13 +671,13 @@ static void GetADCvalue(char *cmdstr,unsigned char cmdlenth)
 {
     
     sprintf(respsendbuf,"%d,%d,%d,%lf,%lf\r\n",adcvalue1 ,adcvalue2,sumvalue,dFilerAdcValue,sFilerAdcValue);
-    SendCom(1,  (uint8_t*)respsendbuf, strlen(respsendbuf),0);
+    CmdReply((uint8_t*)respsendbuf, strlen(respsendbuf));
     
 }
 
 static void SetTare(char *cmdstr,unsigned char cmdlenth)
 {
-    if(*cmdstr == *cmdstr);
+    UNUSED(cmdstr);
   
     g_ScaleData.bTareCommand = 1;
     SendOK(1);
@@ -514,7 +685,7 @@ static void SetTare(char *cmdstr,unsigned char cmdlenth)
 
 static void ClearTare(char *cmdstr,unsigned char cmdlenth)
 {
-    if(*cmdstr == *cmdstr);
+    UNUSED(cmdstr);
   
     g_ScaleData.bClearCommand = 1;
     SendOK(1);
@@ -522,31 +693,348 @@ static void ClearTare(char *cmdstr,unsigned char cmdlenth)
 
 static void SetZero(char *cmdstr,unsigned char cmdlenth)
 {
-    if(*cmdstr == *cmdstr);
+    UNUSED(cmdstr);
   
     g_ScaleData.bZeroCommand = 1;
     SendOK(1);  
 }
 
 
+// MBDIAG      -> rx,busmsg,crcerr,wrongaddr,exception,slavemsg,noresp,dropframes,dropbytes,latency,latencymax
+//                hist bin0..bin9 (latency in us)
+// MBDIAG CLR  -> clear the Modbus channel 0 counters
+static void GetModbusDiag(char *cmdstr,unsigned char cmdlenth)
+{
+    MODBUS_tDiagCounters *pDiag = &g_ModbusDiag[0];
+    int len, i;
+
+    if(0 == strncmp(cmdstr + cmdlenth, " CLR", 4))
+    {
+        ModbusRTU_ClearDiag(0);
+        SendOK(1);
+        return;
+    }
+    len = sprintf(respsendbuf,"%u,%u,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu\r\n",
+                  pDiag->rxFrameCount, pDiag->busMsgCount, pDiag->crcErrCount, pDiag->wrongAddrCount,
+                  pDiag->exceptionCount, pDiag->slaveMsgCount, pDiag->noRespCount, usart_rx_drop_frames[0],
+                  (unsigned long)usart_rx_drop_bytes[0], (unsigned long)pDiag->latencyLast, (unsigned long)pDiag->latencyMax);
+    for (i = 0; i < MODBUS_LATENCY_BINS; i++)
+        len += sprintf(respsendbuf + len, (i < MODBUS_LATENCY_BINS - 1) ? "%u," : "%u\r\n", pDiag->latencyHist[i]);
+    CmdReply((uint8_t*)respsendbuf, len);
+}
 
-void SetCmdProcess(char *recstr,CmdStruct *Ptrcmdstruct)
+// SETTLM 2    -> binary telemetry stream on COM2 (1 = COM1, 0 = off)
+static void SetTelemetry(char *cmdstr,unsigned char cmdlenth)
 {
-     
-     uint8_t i;
-     for (i = 0; i < 25; i++)
-     {
-          if (0 != strncmp(Ptrcmdstruct->cmdstr, recstr,Ptrcmdstruct->cmdstrlenth))
-          {
-              Ptrcmdstruct++;
-              continue;
-          }
-          else
-          {
-              Ptrcmdstruct->cmdproc(recstr,Ptrcmdstruct->cmdstrlenth);
-              break;
+    int port;
 
-          }
-      }
-    
-}
\ No newline at end of file
+    if(1==sscanf((cmdstr+cmdlenth),"%d",&port))
+    {
+        if(port <0||port>2)
+        {
+            CmdReply("data error\r\n",strlen("data error\r\n"));
+        }
+        else
+        {
+            // the OK must not follow the first record on the same port
+            SendOK(1);
+            CmdReplyFlush();
+            TLM_SetPort(port - 1);
+        }
+    }
+    else
+        SendErr(1);
+}
+
+// READTLM     -> port,sent,dropped,interval min,max,mean (us)
+// READTLM CLR -> read and clear the counters
+static void ReadTelemetry(char *cmdstr,unsigned char cmdlenth)
+{
+    TLM_tStat stat;
+    uint32_t mean = 0;
+    int len;
+
+    TLM_GetStat(&stat, 0 == strncmp(cmdstr + cmdlenth, " CLR", 4));
+    if(stat.intervalCount > 0)
+        mean = (uint32_t)(stat.intervalSum / stat.intervalCount);
+    len = sprintf(respsendbuf,"%d,%lu,%lu,%lu,%lu,%lu\r\n", TLM_GetPort() + 1,
+                  (unsigned long)stat.sent, (unsigned long)stat.dropped,
+                  (unsigned long)stat.intervalMin, (unsigned long)stat.intervalMax, (unsigned long)mean);
+    CmdReply((uint8_t*)respsendbuf, len);
+}
+
+// READEE      -> reads,read bytes,writes,page programs,write bytes,bus ms,max page wear,page,minutes,years
+//                years = life of the most worn page at the rate since the clear, 0 = no write
+// READEE CLR  -> read and clear the counters
+static void ReadEepromStat(char *cmdstr,unsigned char cmdlenth)
+{
+    EEPROM_tStat stat;
+    uint16_t maxWear, maxPage;
+    uint32_t elapsed;
+    double years = 0;
+    int len;
+
+    EEPROM_GetStat(&stat, &maxWear, &maxPage, 0 == strncmp(cmdstr + cmdlenth, " CLR", 4));
+    elapsed = HAL_GetTick() - stat.startTick;
+    if(maxWear > 0)
+        years = (double)EE_WRITE_CYCLES / maxWear * elapsed / (1000.0 * 3600 * 24 * 365);
+    len = sprintf(respsendbuf,"%lu,%lu,%lu,%lu,%lu,%lu,%u,%u,%lu,%.1f\r\n",
+                  (unsigned long)stat.readCalls, (unsigned long)stat.readBytes,
+                  (unsigned long)stat.writeCalls, (unsigned long)stat.pagePrograms, (unsigned long)stat.writeBytes,
+                  (unsigned long)(stat.busTimeUs / 1000), maxWear, maxPage, (unsigned long)(elapsed / 60000), years);
+    CmdReply((uint8_t*)respsendbuf, len);
+}
+
+// READWARM    -> result,reset flags,snapshot age ms,warm starts,restore ms,first valid weight ms
+//                result 0 = restored, 1 = power on, 2 = no snapshot, 3 = too old, 4 = setup changed
+//                reset flags = RCC_CSR bits 31..24, times in ms from the reset, 0 = not yet
+static void ReadWarmStart(char *cmdstr,unsigned char cmdlenth)
+{
+    WARM_tStat stat;
+    int len;
+
+    WARM_GetStat(&stat);
+    len = sprintf(respsendbuf,"%d,%02lX,%lu,%lu,%lu.%03lu,%lu.%03lu\r\n", (int)stat.result,
+                  (unsigned long)(stat.resetFlags >> 24), (unsigned long)stat.age, (unsigned long)stat.warmCount,
+                  (unsigned long)(stat.restoreUs / 1000), (unsigned long)(stat.restoreUs % 1000),
+                  (unsigned long)(stat.firstValidUs / 1000), (unsigned long)(stat.firstValidUs % 1000));
+    CmdReply((uint8_t*)respsendbuf, len);
+}
+
+// READBOOT    -> one line per stage: name,end ms from the start of main(),duration ms
+//                name,- for a stage not reached yet
+//                MAIN HAL CLOCK PERIPH PARAM SCALE SCHED ADC WEIGHT
+static void ReadBootTime(char *cmdstr,unsigned char cmdlenth)
+{
+    BOOT_tStage stage;
+    uint32_t us, prevUs = 0;
+    int len;
+
+    for(stage = BOOT_STAGE_MAIN; stage < BOOT_STAGE_NUM; stage++)
+    {
+        if(BOOT_GetStage(stage, &us))
+        {
+            len = sprintf(respsendbuf,"%s,%lu.%03lu,%lu.%03lu\r\n", BOOT_GetStageName(stage),
+                          (unsigned long)(us / 1000), (unsigned long)(us % 1000),
+                          (unsigned long)((us - prevUs) / 1000), (unsigned long)((us - prevUs) % 1000));
+            prevUs = us;
+        }
+        else
+            len = sprintf(respsendbuf,"%s,-\r\n", BOOT_GetStageName(stage));
+        CmdReply((uint8_t*)respsendbuf, len);
+    }
+}
+
+// READTRACE [CLR] -> one line per stage: name,count,min us,mean us,max us,99th percentile us
+//                    CLR restarts the statistics after the output
+//                    SAMPLE ADC FILTER CYCLE STABFILT MOTION ZERO LINEAR TARE FORMAT MBPARSE MBRESP TX1 TX2
+static void ReadTrace(char *cmdstr,unsigned char cmdlenth)
+{
+    TRACE_tStage stage;
+    TRACE_tStat stat;
+    int len;
+
+    for(stage = TRACE_STAGE_SAMPLE; stage < TRACE_STAGE_NUM; stage++)
+    {
+        TRACE_GetStat(stage, &stat);
+        len = sprintf(respsendbuf,"%s,%lu,%lu,%lu,%lu,%lu\r\n", TRACE_GetStageName(stage),
+                      (unsigned long)stat.count, (unsigned long)stat.minUs,
+                      (unsigned long)(stat.count ? stat.sumUs / stat.count : 0),
+                      (unsigned long)stat.maxUs, (unsigned long)TRACE_Percentile(&stat, 990));
+        CmdReply((uint8_t*)respsendbuf, len);
+    }
+    if(0 == strncmp(cmdstr + cmdlenth, " CLR", 4))
+        TRACE_Clear();
+}
+
+// READTASK    -> HEAP,free bytes,lowest free bytes,heap size bytes,CPU load %
+//                heap values 0 = RTOS objects allocated statically, no heap
+//                then one line per task in creation order:
+//                name,priority,CPU %,lowest free stack words
+//                CPU values of the last second, no task line in the first 2 s after the start
+//                SWITCH,context switches since power on
+//                event loop build (APP_EVENT_LOOP 1) then:
+//                LOOP,task calls,idle waits,events posted,events lost,late ticks,longest call us
+static void ReadTaskStat(char *cmdstr,unsigned char cmdlenth)
+{
+    TSTAT_tSummary summary;
+    TSTAT_tTask task;
+#if (APP_EVENT_LOOP == 1)
+    EVLOOP_tStat loop;
+#endif
+    uint32_t i, load;
+    int len;
+
+    TSTAT_GetSummary(&summary);
+    load = (summary.taskCount != 0) ? 1000 - summary.idlePermille : 0;
+    len = sprintf(respsendbuf,"HEAP,%lu,%lu,%lu,%lu.%lu\r\n",
+                  (unsigned long)summary.heapFree, (unsigned long)summary.heapMinFree,
+                  (unsigned long)summary.heapSize, (unsigned long)(load / 10), (unsigned long)(load % 10));
+    CmdReply((uint8_t*)respsendbuf, len);
+    for(i = 0; TSTAT_GetTask(i, &task); i++)
+    {
+        len = sprintf(respsendbuf,"%s,%u,%u.%u,%u\r\n", task.name, task.priority,
+                      task.cpuPermille / 10, task.cpuPermille % 10, task.stackFree);
+        CmdReply((uint8_t*)respsendbuf, len);
+    }
+    len = sprintf(respsendbuf,"SWITCH,%lu\r\n", (unsigned long)summary.switches);
+    CmdReply((uint8_t*)respsendbuf, len);
+#if (APP_EVENT_LOOP == 1)
+    EVLOOP_GetStat(&loop);
+    len = sprintf(respsendbuf,"LOOP,%lu,%lu,%lu,%lu,%lu,%lu\r\n",
+                  (unsigned long)loop.dispatches, (unsigned long)loop.idleWaits,
+                  (unsigned long)loop.posted, (unsigned long)loop.lost,
+                  (unsigned long)loop.lateTicks, (unsigned long)loop.maxDispatchUs);
+    CmdReply((uint8_t*)respsendbuf, len);
+#endif
+}
+
+// READLOG [CLR] -> LOG,records written,message ids,records in the ring
+//                  then one line per record, oldest first, all hex:
+//                  sequence,time us,message id,argument 0,argument 1
+//                  CLR empties the ring after the output
+//                  the text is made by EWARM/dlog_decode.py from the message table in DebugLog.h
+static void ReadLog(char *cmdstr,unsigned char cmdlenth)
+{
+    DLOG_tRecord record;
+    uint32_t i, count;
+    int len;
+
+    count = DLOG_GetCount();
+    len = sprintf(respsendbuf,"LOG,%lu,%u,%lu\r\n", (unsigned long)count, (unsigned)DLOG_ID_NUM,
+                  (unsigned long)((count > DLOG_RECORDS) ? DLOG_RECORDS : count));
+    CmdReply((uint8_t*)respsendbuf, len);
+    for(i = 0; DLOG_GetRecord(i, &record); i++)
+    {
+        len = sprintf(respsendbuf,"%04X,%08lX,%X,%08lX,%08lX\r\n", record.seq,
+                      (unsigned long)record.timeUs, record.id,
+                      (unsigned long)record.arg[0], (unsigned long)record.arg[1]);
+        CmdReply((uint8_t*)respsendbuf, len);
+    }
+    if(0 == strncmp(cmdstr + cmdlenth, " CLR", 4))
+        DLOG_Clear();
+}
+
+// SETSIM STEP 200000,500     -> append: jump to 200000 raw counts, hold 500 samples
+// SETSIM RAMP 0,300          -> append: ramp to 0 raw counts over 300 samples
+// SETSIM CLR                 -> remove all segments
+// SETSIM ON 1234,20,1        -> run the script, seed 1234, noise +-20 counts, 1 = repeat
+// SETSIM OFF                 -> back to the converters
+//                               the script is edited with the simulation off
+static void SetSimLoad(char *cmdstr,unsigned char cmdlenth)
+{
+    char *arg = cmdstr + cmdlenth;
+    unsigned long seed;
+    unsigned int noise, repeat, samples;
+    long level;
+    bool bResult = false;
+
+    if(0 == strncmp(arg, " STEP ", 6) && (2 == sscanf(arg + 6, "%ld,%u", &level, &samples)) && (samples <= 0xFFFF))
+        bResult = SIM_AddSegment(SIM_SEG_STEP, (int32_t)level, (uint16_t)samples);
+    else if(0 == strncmp(arg, " RAMP ", 6) && (2 == sscanf(arg + 6, "%ld,%u", &level, &samples)) && (samples <= 0xFFFF))
+        bResult = SIM_AddSegment(SIM_SEG_RAMP, (int32_t)level, (uint16_t)samples);
+    else if(0 == strncmp(arg, " CLR", 4))
+        bResult = SIM_ClearScript();
+    else if(0 == strncmp(arg, " ON ", 4) && (3 == sscanf(arg + 4, "%lu,%u,%u", &seed, &noise, &repeat)) && (noise <= 0xFFFF))
+        bResult = SIM_Start((uint32_t)seed, (uint16_t)noise, repeat != 0);
+    else if(0 == strncmp(arg, " OFF", 4))
+    {
+        SIM_Stop();
+        bResult = true;
+    }
+
+    if(bResult)
+        SendOK(1);
+    else
+        SendErr(1);
+}
+
+// READSIM     -> on,segments,segment,sample in the segment,samples since ON,level,done
+//                level = raw counts without noise, done 1 = script run through, last level held
+static void ReadSimLoad(char *cmdstr,unsigned char cmdlenth)
+{
+    SIM_tStat stat;
+    int len;
+
+    SIM_GetStat(&stat);
+    len = sprintf(respsendbuf,"%d,%u,%u,%u,%lu,%ld,%d\r\n", stat.bActive, stat.segments, stat.segment,
+                  stat.sample, (unsigned long)stat.total, (long)stat.level, stat.bDone);
+    CmdReply((uint8_t*)respsendbuf, len);
+}
+
+
+//---------------------------------------------------------------------------------------------------
+//static const CmdStruct *CmdLookup(const char *name, int namelen)
+//---------------------------------------------------------------------------------------------------
+//! \brief		binary search for the command named by the first namelen characters of name
+//! \return		command or NULL if not found
+//---------------------------------------------------------------------------------------------------
+static const CmdStruct *CmdLookup(const char *name, int namelen)
+{
+    int low = 0;
+    int high = SETCMD_NUM - 1;
+    int mid, cmp;
+
+    while(low <= high)
+    {
+        mid = (low + high) / 2;
+        cmp = strncmp(name, SetCmdArry[mid].cmdstr, namelen);
+        if((cmp == 0) && (SetCmdArry[mid].cmdstr[namelen] != '\0'))
+            cmp = -1;   // name is a prefix of a longer command
+        if(cmp < 0)
+            high = mid - 1;
+        else if(cmp > 0)
+            low = mid + 1;
+        else
+            return &SetCmdArry[mid];
+    }
+    return NULL;
+}
+
+//---------------------------------------------------------------------------------------------------
+//void SetCmdProcess(char *recbuf, int lenth)
+//---------------------------------------------------------------------------------------------------
+//! \brief		execute all CR/LF separated commands of a received frame, the responses are sent
+//!             in one transmission at the end. MT-SICS commands are handled by MTSICS_ProcessCommand()
+//! attention	recbuf[lenth] must be writable, lines are terminated in place
+//! \param[in]	recbuf: frame, lenth: number of received bytes
+//---------------------------------------------------------------------------------------------------
+void SetCmdProcess(char *recbuf, int lenth)
+{
+    char *line = recbuf;
+    char *end = recbuf + lenth;
+    char *eol;
+    const CmdStruct *pcmd;
+    int namelen;
+
+    while(line < end)
+    {
+        for(eol = line; (eol < end) && (*eol != '\r') && (*eol != '\n') && (*eol != '\0'); eol++)
+            ;
+        *eol = '\0';
+
+        while(*line == ' ')
+            line++;
+        if(MTSICS_ProcessCommand(line))
+        {
+            line = eol + 1;
+            continue;
+        }
+        // the command name ends at the first character other than 'A'..'Z' and '_'
+        for(namelen = 0; ((line[namelen] >= 'A') && (line[namelen] <= 'Z')) || (line[namelen] == '_'); namelen++)
+            ;
+        if(namelen > 0)
+        {
+            pcmd = CmdLookup(line, namelen);
+            if(pcmd != NULL)
+                pcmd->cmdproc(line, pcmd->cmdstrlenth);
+            else
+                SendErr(1);
+        }
+        else if(*line != '\0')
+            SendErr(1);
+
+        line = eol + 1;
+    }
+    CmdReplyFlush();
+}
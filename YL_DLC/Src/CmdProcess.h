@@ -28,8 +28,10 @@ typedef struct _ServerFram
     char checksum;
 }CmdFramStruct;
 
-extern CmdStruct SetCmdArry[];
-void SetCmdProcess(char *recstr,CmdStruct *Ptrcmdstruct);
+extern const CmdStruct SetCmdArry[];
+void SetCmdProcess(char *recbuf, int lenth);
+void CmdReply(const void *data, int lenth);
+void CmdReplyFlush(void);
 
 #ifdef __cplusplus
 }
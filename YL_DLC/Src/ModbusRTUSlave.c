@@ -1,4 +1,3 @@
-
 //#include "sd_index.h"
 //#include "task_ad.h"
 //#include "ServiceManager.h"
@@ -12,259 +11,541 @@
 #include <string.h>
 #include "Scale.h"
 #include "usart.h"
+#include "RB_CRC.h"
+#include "ModbusRTUSlave.h"
+#include "Trace.h"
+#include "TaskStat.h"
+#include "WeightBus.h"
+#include "DebugLog.h"
 
-#define MODBUSRTU_CHANNEL_MAXNUM	1				//ͨ
 #define MODBUSRTU_COMPORT		1
-#define MODBUSRTU_FRAME_MAXNUM		15				//֧֡/д֡ȣ
 
-#define FUNC_CODE_READ	0x03
-#define FUNC_CODE_SET   0x06
-#define FUNC_CODE_ERR   0x80
+#define FUNC_CODE_READ	        0x03
+#define FUNC_CODE_READ_INPUT    0x04
+#define FUNC_CODE_SET           0x06
+#define FUNC_CODE_DIAG          0x08
+#define FUNC_CODE_SET_MULTI     0x10
+#define FUNC_CODE_READ_WRITE    0x17
+#define FUNC_CODE_ERR           0x80
 
 #define FRAME_LEN 0x08
 
+#define BROADCAST_ADDR  0x00    // executed, never answered
+
 #define SLAVEADDR_LEN	0x01
 #define FUNC_LEN 	0x01
 #define SIZE_LEN	0x01
 #define CRC_LEN		0x02
 
-#define PLC_MAX_WT_DIGITS 12
+#define MIN_FRAME_LEN   (SLAVEADDR_LEN + FUNC_LEN + CRC_LEN)
+#define RESP_BUF_LEN    (SLAVEADDR_LEN + FUNC_LEN + SIZE_LEN + MODBUS_MAX_READ_REGS*2 + CRC_LEN)
 
 extern unsigned char ReadAddr();
 
-//0x030x06ȫ֧֣0x10֧4*word
-//Ҫӳ0x10ֱӼӳö
+extern int32_t adcvalue1;
+extern int32_t adcvalue2;
+extern int32_t sumvalue;
 
 typedef union
 {
 	unsigned char byte[2];
 	unsigned short word;
-} CHAR2USHORT;// short char  union 
-
+} CHAR2USHORT;// short char  union
 
 
 typedef union
 {
-	CHAR2USHORT shortvalue[2];
-//    CHAR2USHORT shortvalue2;
-	int         intvalue;
-} Short2int;// double char  union 
+	float       floatvalue;
+	uint32_t    rawvalue;
+} FLOAT2RAW;
 
 
-typedef union
-{
-	unsigned char  byte[8];
-	double         doublevalue;
-} CHAR2double;// double char  union 
+//==================================================================================================
+//  G L O B A L   V A R I A B L E S
+//==================================================================================================
 
+unsigned char g_modbus_address = 0;
 
-typedef union
-{
-	unsigned char  byte[4];
-	int         intvalue;
-} CHAR2int;// double char  union 
+unsigned char g_respbuf[RESP_BUF_LEN];
+
+unsigned short g_modbus_flags = 0;
 
+MODBUS_tDiagCounters g_ModbusDiag[MODBUSRTU_CHANNEL_MAXNUM];
 
+//! channel of the request in progress, selects the diagnostic registers
+static int modbusChannel = 0;
 
+//! read before the first weight cycle: zero weights, power up zero not captured
+static const WBUS_tWeight modbusNoWeight;
+//! weight snapshot of the read request in progress, all weight registers of a request are of
+//! the same weight cycle
+static const WBUS_tWeight *pModbusWeight = &modbusNoWeight;
 
-typedef struct
+int ProcessCommand(char * query, int receivelenth, int nport);
+
+static unsigned short modbus_rtu_CRC(unsigned char *crc_str, int count)
 {
-  char          DevicAddr;   // 豸ַ
-  char          FunCode;    //function code 03 06 
-  CHAR2USHORT   QueryAddr;  // read or write reg address
-  CHAR2USHORT   QueryDataLenth;  // read or write data length
-  CHAR2USHORT   FramCrc;        // CRC 
-}ModbusRTU_SlavequeryFramType;
+    return (unsigned short)RB_CRC_Calculate(crc_str, 0, count, &RB_CRC_16_MODBUS_CFG);
+}
+
+//==================================================================================================
+//  R E G I S T E R   A C C E S S O R S
+//==================================================================================================
 
+static const double decadeTable[] = {1.0, 10.0, 100.0, 1000.0, 10000.0};
 
+// decimal places of the integer weight registers
+static int32_t ModbusGetDp(void)
+{
+    int32_t dp = SCALE_GetDp(pModbusWeight->inc);
 
+    if (dp < 0)
+        dp = 0;
+    else if (dp > CONFIG_MAX_DP)
+        dp = CONFIG_MAX_DP;
+    return dp;
+}
 
+// rounded, saturated to the int32 range, the cast of a larger value is undefined
+static uint32_t ModbusRoundI32(double value)
+{
+    if (value != value)
+        return 0;           // NaN
+    if (value >= 2147483647.0)
+        return (uint32_t)INT32_MAX;
+    if (value <= -2147483648.0)
+        return (uint32_t)INT32_MIN;
+    if (value >= 0.0)
+        value += 0.5;
+    else
+        value -= 0.5;
+    return (uint32_t)(int32_t)value;
+}
 
+static uint32_t ModbusScaleWeight(double weight)
+{
+    return ModbusRoundI32(weight * decadeTable[ModbusGetDp()]);
+}
 
-//==================================================================================================
-//  G L O B A L   V A R I A B L E S
-//==================================================================================================
+static uint32_t ModbusFloatWeight(double weight)
+{
+    FLOAT2RAW tmp;
+    tmp.floatvalue = (float)weight;
+    return tmp.rawvalue;
+}
 
-unsigned char g_modbus_address = 0;
+static uint32_t RegGrossI32(void)   { return ModbusScaleWeight(pModbusWeight->gross); }
+static uint32_t RegNetI32(void)     { return ModbusScaleWeight(pModbusWeight->net); }
+static uint32_t RegTareI32(void)    { return ModbusScaleWeight(pModbusWeight->tare); }
+static uint32_t RegGrossF32(void)   { return ModbusFloatWeight(pModbusWeight->gross); }
+static uint32_t RegNetF32(void)     { return ModbusFloatWeight(pModbusWeight->net); }
+static uint32_t RegTareF32(void)    { return ModbusFloatWeight(pModbusWeight->tare); }
+static uint32_t RegIncrF32(void)    { return ModbusFloatWeight(pModbusWeight->inc); }
+static uint32_t RegDp(void)         { return (uint32_t)ModbusGetDp(); }
+static uint32_t RegRawCounts(void)  { return (uint32_t)sumvalue; }
+static uint32_t RegAdc1Counts(void) { return (uint32_t)adcvalue1; }
+static uint32_t RegAdc2Counts(void) { return (uint32_t)adcvalue2; }
+static uint32_t RegFilteredCounts(void) { return ModbusRoundI32(pModbusWeight->filteredCounts); }
+static uint32_t RegStableCounts(void)   { return ModbusRoundI32(pModbusWeight->stableCounts); }
+static uint32_t RegDiagBusMsg(void)     { return g_ModbusDiag[modbusChannel].busMsgCount; }
+static uint32_t RegDiagCrcErr(void)     { return g_ModbusDiag[modbusChannel].crcErrCount; }
+static uint32_t RegDiagException(void)  { return g_ModbusDiag[modbusChannel].exceptionCount; }
+static uint32_t RegDiagSlaveMsg(void)   { return g_ModbusDiag[modbusChannel].slaveMsgCount; }
+static uint32_t RegDiagWrongAddr(void)  { return g_ModbusDiag[modbusChannel].wrongAddrCount; }
+static uint32_t RegDiagNoResp(void)     { return g_ModbusDiag[modbusChannel].noRespCount; }
+static uint32_t RegDiagOverrun(void)    { return usart_rx_drop_frames[modbusChannel]; }
+static uint32_t RegDiagDropBytes(void)  { return usart_rx_drop_bytes[modbusChannel]; }
+static uint32_t RegDiagLatency(void)    { return g_ModbusDiag[modbusChannel].latencyLast; }
+static uint32_t RegDiagLatencyMax(void) { return g_ModbusDiag[modbusChannel].latencyMax; }
+
+#define REG_LATENCY_HIST(n) \
+static uint32_t RegDiagLatencyHist##n(void) { return g_ModbusDiag[modbusChannel].latencyHist[n]; }
+REG_LATENCY_HIST(0)
+REG_LATENCY_HIST(1)
+REG_LATENCY_HIST(2)
+REG_LATENCY_HIST(3)
+REG_LATENCY_HIST(4)
+REG_LATENCY_HIST(5)
+REG_LATENCY_HIST(6)
+REG_LATENCY_HIST(7)
+REG_LATENCY_HIST(8)
+REG_LATENCY_HIST(9)
+
+static uint32_t RegRtosHeapFree(void)     { TSTAT_tSummary s; TSTAT_GetSummary(&s); return s.heapFree; }
+static uint32_t RegRtosHeapMinFree(void)  { TSTAT_tSummary s; TSTAT_GetSummary(&s); return s.heapMinFree; }
+static uint32_t RegRtosTaskNum(void)      { TSTAT_tSummary s; TSTAT_GetSummary(&s); return s.taskCount; }
+
+static uint32_t RegRtosCpuLoad(void)
+{
+    TSTAT_tSummary summary;
+    TSTAT_GetSummary(&summary);
+    return (summary.taskCount != 0) ? 1000 - summary.idlePermille : 0;
+}
+
+#define REG_RTOS_TASK(n) \
+static uint32_t RegRtosTaskCpu##n(void)   { TSTAT_tTask t; return TSTAT_GetTask(n, &t) ? t.cpuPermille : 0; } \
+static uint32_t RegRtosTaskStack##n(void) { TSTAT_tTask t; return TSTAT_GetTask(n, &t) ? t.stackFree : 0; }
+REG_RTOS_TASK(0)
+REG_RTOS_TASK(1)
+REG_RTOS_TASK(2)
+REG_RTOS_TASK(3)
+REG_RTOS_TASK(4)
+REG_RTOS_TASK(5)
+REG_RTOS_TASK(6)
+REG_RTOS_TASK(7)
+
+static uint32_t RegStatus(void)
+{
+    uint32_t status = 0;
+    uint16_t weightStatus = pModbusWeight->status;
+
+    if (weightStatus & WBUS_STAT_MOTION)
+        status |= MB_STATUS_MOTION;
+    if (weightStatus & WBUS_STAT_NET)
+        status |= MB_STATUS_NET;
+    if (weightStatus & WBUS_STAT_OVER)
+        status |= MB_STATUS_OVERCAPACITY;
+    if (weightStatus & WBUS_STAT_UNDER)
+        status |= MB_STATUS_UNDERZERO;
+    if (weightStatus & WBUS_STAT_COZ)
+        status |= MB_STATUS_CENTER_OF_ZERO;
+    if (!(weightStatus & WBUS_STAT_ZERO_CAPTURED))
+        status |= MB_STATUS_BAD_ZERO;
+    return status;
+}
 
-unsigned char g_ReadModbusRegMapArry[100];
-//unsigned char g_WtieModbusRegMapArry[100];
+static uint8_t RegCmdTare(uint32_t value)
+{
+    if (value != 1)
+        return MODBUS_EX_ILLEGAL_VALUE;
+    g_ScaleData.bTareCommand = 1;
+    return MODBUS_EX_NONE;
+}
 
-unsigned char g_respbuf[110];
+static uint8_t RegCmdZero(uint32_t value)
+{
+    if (value != 1)
+        return MODBUS_EX_ILLEGAL_VALUE;
+    g_ScaleData.bZeroCommand = 1;
+    return MODBUS_EX_NONE;
+}
 
+static uint8_t RegCmdClear(uint32_t value)
+{
+    if (value != 1)
+        return MODBUS_EX_ILLEGAL_VALUE;
+    g_ScaleData.bClearCommand = 1;
+    return MODBUS_EX_NONE;
+}
 
-//#ifdef RB_ENV_BSP_WIN32
-//MODBUSRTU_FRAM_PARSE g_ModbusFramParse[MODBUSRTU_CHANNEL_MAXNUM];
-//INTEGER_REMOTE_IO_MESSAGE g_modbus_mesg;
-//#else
-//MODBUSRTU_FRAM_PARSE g_ModbusFramParse[MODBUSRTU_CHANNEL_MAXNUM]@"LRAM1_MEMORY";
-//INTEGER_REMOTE_IO_MESSAGE g_modbus_mesg@"LRAM1_MEMORY";
-//#endif
-unsigned short g_modbus_flags = 0;
+static uint8_t RegPresetTare(uint32_t value)
+{
+    FLOAT2RAW tmp;
+    tmp.rawvalue = value;
+    // rejects NaN as well
+    if (!(tmp.floatvalue > 0.0f) || (tmp.floatvalue > g_ScaleData.scaleCapacity))
+        return MODBUS_EX_ILLEGAL_VALUE;
+    // taken over by the weigh task, programmableTare is not written here
+    g_ScaleData.presetTareCommand = tmp.floatvalue;
+    return MODBUS_EX_NONE;
+}
 
-int ProcessCommand(char * query, int receivelenth, int nport);
+//! Register map, MUST be sorted by address
+static const MODBUS_tRegEntry ModbusRegMap[] =
+{
+    /* address                  type            flags                           read                write */
+    { MB_REG_GROSS_I32,         MB_TYPE_I32,    MB_FLAG_READ,                   RegGrossI32,        NULL },
+    { MB_REG_NET_I32,           MB_TYPE_I32,    MB_FLAG_READ,                   RegNetI32,          NULL },
+    { MB_REG_TARE_I32,          MB_TYPE_I32,    MB_FLAG_READ,                   RegTareI32,         NULL },
+    { MB_REG_STATUS,            MB_TYPE_U16,    MB_FLAG_READ,                   RegStatus,          NULL },
+    { MB_REG_DP,                MB_TYPE_U16,    MB_FLAG_READ,                   RegDp,              NULL },
+    { MB_REG_GROSS_F32,         MB_TYPE_F32,    MB_FLAG_READ,                   RegGrossF32,        NULL },
+    { MB_REG_NET_F32,           MB_TYPE_F32,    MB_FLAG_READ,                   RegNetF32,          NULL },
+    { MB_REG_TARE_F32,          MB_TYPE_F32,    MB_FLAG_READ,                   RegTareF32,         NULL },
+    { MB_REG_INCR_F32,          MB_TYPE_F32,    MB_FLAG_READ,                   RegIncrF32,         NULL },
+    { MB_REG_RAW_COUNTS,        MB_TYPE_I32,    MB_FLAG_READ,                   RegRawCounts,       NULL },
+    { MB_REG_FILTERED_COUNTS,   MB_TYPE_I32,    MB_FLAG_READ,                   RegFilteredCounts,  NULL },
+    { MB_REG_STABLE_COUNTS,     MB_TYPE_I32,    MB_FLAG_READ,                   RegStableCounts,    NULL },
+    { MB_REG_ADC1_COUNTS,       MB_TYPE_I32,    MB_FLAG_READ,                   RegAdc1Counts,      NULL },
+    { MB_REG_ADC2_COUNTS,       MB_TYPE_I32,    MB_FLAG_READ,                   RegAdc2Counts,      NULL },
+    { MB_REG_DIAG_BUS_MSG,      MB_TYPE_U16,    MB_FLAG_READ,                   RegDiagBusMsg,      NULL },
+    { MB_REG_DIAG_CRC_ERR,      MB_TYPE_U16,    MB_FLAG_READ,                   RegDiagCrcErr,      NULL },
+    { MB_REG_DIAG_EXCEPTION,    MB_TYPE_U16,    MB_FLAG_READ,                   RegDiagException,   NULL },
+    { MB_REG_DIAG_SLAVE_MSG,    MB_TYPE_U16,    MB_FLAG_READ,                   RegDiagSlaveMsg,    NULL },
+    { MB_REG_DIAG_WRONG_ADDR,   MB_TYPE_U16,    MB_FLAG_READ,                   RegDiagWrongAddr,   NULL },
+    { MB_REG_DIAG_NO_RESP,      MB_TYPE_U16,    MB_FLAG_READ,                   RegDiagNoResp,      NULL },
+    { MB_REG_DIAG_OVERRUN,      MB_TYPE_U16,    MB_FLAG_READ,                   RegDiagOverrun,     NULL },
+    { MB_REG_DIAG_DROP_BYTES,   MB_TYPE_U32,    MB_FLAG_READ,                   RegDiagDropBytes,   NULL },
+    { MB_REG_DIAG_LATENCY,      MB_TYPE_U32,    MB_FLAG_READ,                   RegDiagLatency,     NULL },
+    { MB_REG_DIAG_LATENCY_MAX,  MB_TYPE_U32,    MB_FLAG_READ,                   RegDiagLatencyMax,  NULL },
+    { MB_REG_DIAG_LATENCY_HIST,     MB_TYPE_U16, MB_FLAG_READ,                  RegDiagLatencyHist0, NULL },
+    { MB_REG_DIAG_LATENCY_HIST + 1, MB_TYPE_U16, MB_FLAG_READ,                  RegDiagLatencyHist1, NULL },
+    { MB_REG_DIAG_LATENCY_HIST + 2, MB_TYPE_U16, MB_FLAG_READ,                  RegDiagLatencyHist2, NULL },
+    { MB_REG_DIAG_LATENCY_HIST + 3, MB_TYPE_U16, MB_FLAG_READ,                  RegDiagLatencyHist3, NULL },
+    { MB_REG_DIAG_LATENCY_HIST + 4, MB_TYPE_U16, MB_FLAG_READ,                  RegDiagLatencyHist4, NULL },
+    { MB_REG_DIAG_LATENCY_HIST + 5, MB_TYPE_U16, MB_FLAG_READ,                  RegDiagLatencyHist5, NULL },
+    { MB_REG_DIAG_LATENCY_HIST + 6, MB_TYPE_U16, MB_FLAG_READ,                  RegDiagLatencyHist6, NULL },
+    { MB_REG_DIAG_LATENCY_HIST + 7, MB_TYPE_U16, MB_FLAG_READ,                  RegDiagLatencyHist7, NULL },
+    { MB_REG_DIAG_LATENCY_HIST + 8, MB_TYPE_U16, MB_FLAG_READ,                  RegDiagLatencyHist8, NULL },
+    { MB_REG_DIAG_LATENCY_HIST + 9, MB_TYPE_U16, MB_FLAG_READ,                  RegDiagLatencyHist9, NULL },
+    { MB_REG_RTOS_HEAP_FREE,    MB_TYPE_U16,    MB_FLAG_READ,                   RegRtosHeapFree,    NULL },
+    { MB_REG_RTOS_HEAP_MIN_FREE, MB_TYPE_U16,   MB_FLAG_READ,                   RegRtosHeapMinFree, NULL },
+    { MB_REG_RTOS_TASK_NUM,     MB_TYPE_U16,    MB_FLAG_READ,                   RegRtosTaskNum,     NULL },
+    { MB_REG_RTOS_CPU_LOAD,     MB_TYPE_U16,    MB_FLAG_READ,                   RegRtosCpuLoad,     NULL },
+    { MB_REG_RTOS_TASK_CPU,     MB_TYPE_U16,    MB_FLAG_READ,                   RegRtosTaskCpu0,    NULL },
+    { MB_REG_RTOS_TASK_CPU + 1, MB_TYPE_U16,    MB_FLAG_READ,                   RegRtosTaskCpu1,    NULL },
+    { MB_REG_RTOS_TASK_CPU + 2, MB_TYPE_U16,    MB_FLAG_READ,                   RegRtosTaskCpu2,    NULL },
+    { MB_REG_RTOS_TASK_CPU + 3, MB_TYPE_U16,    MB_FLAG_READ,                   RegRtosTaskCpu3,    NULL },
+    { MB_REG_RTOS_TASK_CPU + 4, MB_TYPE_U16,    MB_FLAG_READ,                   RegRtosTaskCpu4,    NULL },
+    { MB_REG_RTOS_TASK_CPU + 5, MB_TYPE_U16,    MB_FLAG_READ,                   RegRtosTaskCpu5,    NULL },
+    { MB_REG_RTOS_TASK_CPU + 6, MB_TYPE_U16,    MB_FLAG_READ,                   RegRtosTaskCpu6,    NULL },
+    { MB_REG_RTOS_TASK_CPU + 7, MB_TYPE_U16,    MB_FLAG_READ,                   RegRtosTaskCpu7,    NULL },
+    { MB_REG_RTOS_TASK_STACK,     MB_TYPE_U16,  MB_FLAG_READ,                   RegRtosTaskStack0,  NULL },
+    { MB_REG_RTOS_TASK_STACK + 1, MB_TYPE_U16,  MB_FLAG_READ,                   RegRtosTaskStack1,  NULL },
+    { MB_REG_RTOS_TASK_STACK + 2, MB_TYPE_U16,  MB_FLAG_READ,                   RegRtosTaskStack2,  NULL },
+    { MB_REG_RTOS_TASK_STACK + 3, MB_TYPE_U16,  MB_FLAG_READ,                   RegRtosTaskStack3,  NULL },
+    { MB_REG_RTOS_TASK_STACK + 4, MB_TYPE_U16,  MB_FLAG_READ,                   RegRtosTaskStack4,  NULL },
+    { MB_REG_RTOS_TASK_STACK + 5, MB_TYPE_U16,  MB_FLAG_READ,                   RegRtosTaskStack5,  NULL },
+    { MB_REG_RTOS_TASK_STACK + 6, MB_TYPE_U16,  MB_FLAG_READ,                   RegRtosTaskStack6,  NULL },
+    { MB_REG_RTOS_TASK_STACK + 7, MB_TYPE_U16,  MB_FLAG_READ,                   RegRtosTaskStack7,  NULL },
+    { MB_REG_CMD_TARE,          MB_TYPE_U16,    MB_FLAG_WRITE,                  NULL,               RegCmdTare },
+    { MB_REG_CMD_ZERO,          MB_TYPE_U16,    MB_FLAG_WRITE,                  NULL,               RegCmdZero },
+    { MB_REG_CMD_CLEAR,         MB_TYPE_U16,    MB_FLAG_WRITE,                  NULL,               RegCmdClear },
+    { MB_REG_PRESET_TARE_F32,   MB_TYPE_F32,    MB_FLAG_READ | MB_FLAG_WRITE,   RegTareF32,         RegPresetTare },
+};
+
+#define MODBUS_REGMAP_SIZE  (sizeof(ModbusRegMap) / sizeof(MODBUS_tRegEntry))
+//! first address behind the last mapped register
+#define MODBUS_REGMAP_END   (MB_REG_PRESET_TARE_F32 + 2)
 
-//
-//static int modebus_readreg(int com,unsigned short regaddr,unsigned short lenth);
-//static int modebus_writereg(int com,unsigned short regaddr,unsigned short lenth);
+//---------------------------------------------------------------------------------------------------
+//static const MODBUS_tRegEntry *ModbusFindReg(unsigned short regaddr)
+//---------------------------------------------------------------------------------------------------
+//! \brief		binary search for the entry covering regaddr
+//! \return		entry or NULL if regaddr is not mapped
+//---------------------------------------------------------------------------------------------------
+static const MODBUS_tRegEntry *ModbusFindReg(unsigned short regaddr)
+{
+    int low = 0;
+    int high = MODBUS_REGMAP_SIZE - 1;
+    int mid;
 
-void FreshRegArry();
+    while (low <= high)
+    {
+        mid = (low + high) / 2;
+        if (regaddr < ModbusRegMap[mid].address)
+            high = mid - 1;
+        else if (regaddr >= ModbusRegMap[mid].address + MB_TYPE_WIDTH(ModbusRegMap[mid].type))
+            low = mid + 1;
+        else
+            return &ModbusRegMap[mid];
+    }
+    return NULL;
+}
 
-static unsigned short modbus_rtu_CRC(unsigned char *crc_str, char count)
+//---------------------------------------------------------------------------------------------------
+//static uint8_t modbus_readregs(unsigned short regaddr, unsigned short count, unsigned char *pOut)
+//---------------------------------------------------------------------------------------------------
+//! \brief		serialize count registers starting at regaddr, big endian
+//! attention	unmapped or write only registers inside the map read as 0. Every 32 bit value is
+//!             sampled once per request so both halves are consistent, all weight registers are
+//!             read from the same weight bus snapshot.
+//! \return		MODBUS_EX_NONE or exception code
+//---------------------------------------------------------------------------------------------------
+static uint8_t modbus_readregs(unsigned short regaddr, unsigned short count, unsigned char *pOut)
 {
-     char i,j;
-     unsigned short CrcValue, temp;  
-     CrcValue = 0xffff;  
-     for(i=0; i<count ;i++,crc_str++)
-     { 
-		temp = (unsigned short)*crc_str & 0x0FF;
-        CrcValue ^= temp ;
-        for (j=0; j<8; j++)
+    const MODBUS_tRegEntry *pEntry = ModbusRegMap;
+    const MODBUS_tRegEntry *pEnd = ModbusRegMap + MODBUS_REGMAP_SIZE;
+    const MODBUS_tRegEntry *pSampled = NULL;
+    uint32_t value = 0;
+    unsigned short word;
+    unsigned long addr;
+
+    if ((count == 0) || (count > MODBUS_MAX_READ_REGS))
+        return MODBUS_EX_ILLEGAL_VALUE;
+    if ((unsigned long)regaddr + count > MODBUS_REGMAP_END)
+        return MODBUS_EX_ILLEGAL_ADDRESS;
+
+    pModbusWeight = WBUS_AcquireLatest();
+    if (pModbusWeight == NULL)
+        pModbusWeight = &modbusNoWeight;
+
+    for (addr = regaddr; addr < (unsigned long)regaddr + count; addr++)
+    {
+        // the map is sorted, so a single forward walk covers the whole block
+        while ((pEntry < pEnd) && ((unsigned long)pEntry->address + MB_TYPE_WIDTH(pEntry->type) <= addr))
+            pEntry++;
+
+        word = 0;
+        if ((pEntry < pEnd) && (pEntry->address <= addr) && (pEntry->flags & MB_FLAG_READ))
         {
-        	if (CrcValue & 0x0001)
-                CrcValue =(CrcValue >> 1) ^ 0x0A001;
+            if (pSampled != pEntry)
+            {
+                value = pEntry->read();
+                pSampled = pEntry;
+            }
+            if ((MB_TYPE_WIDTH(pEntry->type) == 2) && (addr == pEntry->address))
+                word = (unsigned short)(value >> 16);
             else
-                CrcValue = CrcValue >> 1;
-         }
-	  }
-      return CrcValue;
+                word = (unsigned short)value;
+        }
+        *pOut++ = (unsigned char)(word >> 8);
+        *pOut++ = (unsigned char)word;
+    }
+
+    if (pModbusWeight != &modbusNoWeight)
+        WBUS_Release(pModbusWeight);
+    pModbusWeight = &modbusNoWeight;
+    return MODBUS_EX_NONE;
 }
 
-// ʼ regmap
-void FreshRegArry()
-{ 
-    Short2int tempintvalue;  
-    tempintvalue.intvalue = (int)g_ScaleData.roundedNetWeight;
-    g_ReadModbusRegMapArry[0] = tempintvalue.shortvalue[1].byte[1];
-    g_ReadModbusRegMapArry[1] = tempintvalue.shortvalue[1].byte[0];
-    g_ReadModbusRegMapArry[2] = tempintvalue.shortvalue[0].byte[1];
-    g_ReadModbusRegMapArry[3] = tempintvalue.shortvalue[0].byte[0];
-
-    tempintvalue.intvalue = (int)g_ScaleData.roundedGrossWeight;
-    g_ReadModbusRegMapArry[4] = tempintvalue.shortvalue[1].byte[1];
-    g_ReadModbusRegMapArry[5] = tempintvalue.shortvalue[1].byte[0];
-    g_ReadModbusRegMapArry[6] = tempintvalue.shortvalue[0].byte[1];
-    g_ReadModbusRegMapArry[7] = tempintvalue.shortvalue[0].byte[0];
-    
-
-    tempintvalue.intvalue = (int)g_ScaleData.roundedTareWeight;
-    g_ReadModbusRegMapArry[8] = tempintvalue.shortvalue[1].byte[1];
-    g_ReadModbusRegMapArry[9] = tempintvalue.shortvalue[1].byte[0];
-    g_ReadModbusRegMapArry[10] = tempintvalue.shortvalue[0].byte[1];
-    g_ReadModbusRegMapArry[11] = tempintvalue.shortvalue[0].byte[0];
-  
-  
+//---------------------------------------------------------------------------------------------------
+//static uint8_t modbus_writeregs(unsigned short regaddr, unsigned short count, const unsigned char *pData)
+//---------------------------------------------------------------------------------------------------
+//! \brief		write count registers starting at regaddr, big endian
+//! attention	the whole range is validated before the first accessor is called, 32 bit values
+//!             must be written with both registers in one request
+//! \return		MODBUS_EX_NONE or exception code
+//---------------------------------------------------------------------------------------------------
+static uint8_t modbus_writeregs(unsigned short regaddr, unsigned short count, const unsigned char *pData)
+{
+    const MODBUS_tRegEntry *pEntry;
+    unsigned long addr, end;
+    uint32_t value;
+    uint8_t width, exception;
+
+    end = (unsigned long)regaddr + count;
+    for (addr = regaddr; addr < end; addr += width)
+    {
+        pEntry = ModbusFindReg((unsigned short)addr);
+        if ((pEntry == NULL) || !(pEntry->flags & MB_FLAG_WRITE) || (pEntry->address != addr))
+            return MODBUS_EX_ILLEGAL_ADDRESS;
+        width = MB_TYPE_WIDTH(pEntry->type);
+        if (addr + width > end)
+            return MODBUS_EX_ILLEGAL_ADDRESS;
+    }
+
+    for (addr = regaddr; addr < end; addr += width)
+    {
+        pEntry = ModbusFindReg((unsigned short)addr);
+        width = MB_TYPE_WIDTH(pEntry->type);
+        if (width == 2)
+            value = ((uint32_t)pData[0] << 24) | ((uint32_t)pData[1] << 16) | ((uint32_t)pData[2] << 8) | pData[3];
+        else
+            value = ((uint32_t)pData[0] << 8) | pData[1];
+        pData += width * 2;
+
+        exception = pEntry->write(value);
+        if (exception != MODBUS_EX_NONE)
+            return exception;
+    }
+    return MODBUS_EX_NONE;
 }
 
+// true = the reply is queued, false = SendCom() dropped it
+static bool modbus_send(int com, int lenth)
+{
+    CHAR2USHORT tmpshort;
 
-static int modebus_readreg(int com,unsigned short regaddr,unsigned short lenth)
+    tmpshort.word = modbus_rtu_CRC(g_respbuf, lenth);
+    g_respbuf[lenth]   = tmpshort.byte[0];
+    g_respbuf[lenth+1] = tmpshort.byte[1];
+    return (SendCom(com, g_respbuf, lenth + CRC_LEN, 0x50) == HAL_OK);
+}
+
+static bool modbus_exception(int com, unsigned char funcode, uint8_t exception)
 {
-  
-   CHAR2USHORT tmpshort;
-   memset(g_respbuf,0,sizeof(g_respbuf));
-   g_respbuf[0] = g_modbus_address;
-   g_respbuf[1] = 0x03;
-   
-    switch (regaddr)    
+    g_ModbusDiag[com].exceptionCount++;
+    DLOG(DLOG_MB_EXCEPTION, com + 1, ((uint32_t)funcode << 8) | exception);
+    g_respbuf[0] = g_modbus_address;
+    g_respbuf[1] = funcode | FUNC_CODE_ERR;
+    g_respbuf[2] = exception;
+    return modbus_send(com, 3);
+}
+
+//---------------------------------------------------------------------------------------------------
+//static void modbus_latency(int com)
+//---------------------------------------------------------------------------------------------------
+//! \brief		record request (end of frame) to first TX byte time of the response just queued,
+//!             not for a response SendCom() dropped: usart_tx_time is then the one of an older frame
+//---------------------------------------------------------------------------------------------------
+static void modbus_latency(int com)
+{
+    MODBUS_tDiagCounters *pDiag = &g_ModbusDiag[com];
+    uint32_t latency = usart_tx_time[com] - usart_rx_time[com];
+    uint32_t limit = MODBUS_LATENCY_BIN0_US;
+    int bin = 0;
+
+    while ((latency >= limit) && (bin < MODBUS_LATENCY_BINS - 1))
     {
-      
-    case 0:      // 
-    case 4:      
-    case 8:
-      if(lenth>(100-regaddr-1))
-      {
-        tmpshort.word = regaddr;
-        
-        g_respbuf[1]|=0x80;
-        g_respbuf[2]=tmpshort.byte[1];
-        g_respbuf[3]=tmpshort.byte[0];
-        tmpshort.word = lenth;
-        g_respbuf[4]=tmpshort.byte[1];
-        g_respbuf[5]=tmpshort.byte[0];
-        tmpshort.word = modbus_rtu_CRC(g_respbuf,6);
-        g_respbuf[6]=tmpshort.byte[0];
-        g_respbuf[7]=tmpshort.byte[1];     
-        //
-        SendCom(com,g_respbuf,8,0x50);
-          
-      }
-      else
-      {
-        g_respbuf[2] = (unsigned char)lenth;
-        memcpy(g_respbuf+3,g_ReadModbusRegMapArry,lenth);
-        tmpshort.word = modbus_rtu_CRC(g_respbuf,lenth+3);
-        g_respbuf[lenth+3] = tmpshort.byte[0];
-        g_respbuf[lenth+3+1] = tmpshort.byte[1];
-        SendCom(com,g_respbuf,lenth+3+1+1,0x50);
-      }
-      break;
+        bin++;
+        limit <<= 1;
+    }
+    if (pDiag->latencyHist[bin] < 0xFFFF)
+        pDiag->latencyHist[bin]++;
+    pDiag->latencyLast = latency;
+    if (latency > pDiag->latencyMax)
+        pDiag->latencyMax = latency;
+}
+
+static unsigned short modbus_saturate(uint32_t value)
+{
+    return (value > 0xFFFF) ? 0xFFFF : (unsigned short)value;
+}
+
+//---------------------------------------------------------------------------------------------------
+//static uint8_t modbus_diagnostics(int com, unsigned short subfunc, unsigned char *pData)
+//---------------------------------------------------------------------------------------------------
+//! \brief		FC08, pData holds the 2 data bytes of the request and receives the answer
+//! \return		MODBUS_EX_NONE or exception code
+//---------------------------------------------------------------------------------------------------
+static uint8_t modbus_diagnostics(int com, unsigned short subfunc, unsigned char *pData)
+{
+    MODBUS_tDiagCounters *pDiag = &g_ModbusDiag[com];
+    unsigned short value;
+
+    switch(subfunc)
+    {
+    case MB_DIAG_RETURN_QUERY:
+      return MODBUS_EX_NONE;
+    case MB_DIAG_CLEAR_COUNTERS:
+      ModbusRTU_ClearDiag(com);
+      return MODBUS_EX_NONE;
+    case MB_DIAG_BUS_MSG:       value = pDiag->busMsgCount;                             break;
+    case MB_DIAG_BUS_CRC_ERR:   value = pDiag->crcErrCount;                             break;
+    case MB_DIAG_BUS_EXCEPTION: value = pDiag->exceptionCount;                          break;
+    case MB_DIAG_SLAVE_MSG:     value = pDiag->slaveMsgCount;                           break;
+    case MB_DIAG_SLAVE_NO_RESP: value = pDiag->noRespCount;                             break;
+    case MB_DIAG_BUS_OVERRUN:   value = usart_rx_drop_frames[com];                      break;
+    case MB_DIAG_WRONG_ADDR:    value = pDiag->wrongAddrCount;                          break;
+    case MB_DIAG_DROP_BYTES:    value = modbus_saturate(usart_rx_drop_bytes[com]);      break;
+    case MB_DIAG_LATENCY:       value = modbus_saturate(pDiag->latencyLast);            break;
+    case MB_DIAG_LATENCY_MAX:   value = modbus_saturate(pDiag->latencyMax);             break;
     default:
-        tmpshort.word = regaddr;        
-        g_respbuf[1]|=0x80;
-        g_respbuf[2]=tmpshort.byte[1];
-        g_respbuf[3]=tmpshort.byte[0];
-        tmpshort.word = lenth;
-        g_respbuf[4]=tmpshort.byte[1];
-        g_respbuf[5]=tmpshort.byte[0];
-        tmpshort.word = modbus_rtu_CRC(g_respbuf,6);
-        g_respbuf[6]=tmpshort.byte[0];
-        g_respbuf[7]=tmpshort.byte[1];     
-        //
-        SendCom(com,g_respbuf,8,0x50);
+      if((subfunc >= MB_DIAG_LATENCY_HIST) && (subfunc < MB_DIAG_LATENCY_HIST + MODBUS_LATENCY_BINS))
+      {
+        value = pDiag->latencyHist[subfunc - MB_DIAG_LATENCY_HIST];
         break;
+      }
+      return MODBUS_EX_ILLEGAL_FUNCTION;
     }
-    return 0;
+    pData[0] = (unsigned char)(value >> 8);
+    pData[1] = (unsigned char)value;
+    return MODBUS_EX_NONE;
 }
 
-static int modebus_writereg(int com,unsigned short regaddr,unsigned short writedata)
+//---------------------------------------------------------------------------------------------------
+//void ModbusRTU_ClearDiag(int com)
+//---------------------------------------------------------------------------------------------------
+//! \brief		clear the diagnostic counters and latency histogram of a channel
+//---------------------------------------------------------------------------------------------------
+void ModbusRTU_ClearDiag(int com)
 {
-   CHAR2USHORT tmpshort;
-   memset(g_respbuf,0,sizeof(g_respbuf));
-   g_respbuf[0] = g_modbus_address;
-   g_respbuf[1] = 0x06;
-   switch(regaddr)
-   {
-   case 0x0100:
-     if(writedata == 1)
-     {
-        
-        g_ScaleData.bTareCommand = 1;
-        // run tare
-     }
-     else
-     {
-       g_respbuf[1] |= 0x80;
-     }
-     break;
-   case 0x0102:
-      if(writedata == 1)
-     {
-       g_ScaleData.bClearCommand = 1;
-     }
-     else
-     {
-       g_respbuf[1] |= 0x80;
-     }
-     
-     break;
-   default:
-      g_respbuf[1] |= 0x80;
-     break;
-   }
-   
-    tmpshort.word = regaddr;
-    g_respbuf[2] = tmpshort.byte[1];
-    g_respbuf[3] = tmpshort.byte[0];
-    tmpshort.word = writedata;
-    g_respbuf[4] = tmpshort.byte[1];
-    g_respbuf[5] = tmpshort.byte[0];
-    tmpshort.word = modbus_rtu_CRC(g_respbuf,6);
-    g_respbuf[6]=tmpshort.byte[0];
-    g_respbuf[7]=tmpshort.byte[1];     
-        //
-     SendCom(com,g_respbuf,8,0x50);
-        
-  return 0;
+    if((com < 0) || (com >= MODBUSRTU_CHANNEL_MAXNUM))
+        return;
+    memset(&g_ModbusDiag[com], 0, sizeof(MODBUS_tDiagCounters));
+    usart_rx_drop_frames[com] = 0;
+    usart_rx_drop_bytes[com] = 0;
 }
 
 int ProcessCommand(char * query, int receivelenth, int nport)
@@ -274,57 +555,147 @@ int ProcessCommand(char * query, int receivelenth, int nport)
 }
 
 //---------------------------------------------------------------------------------------------------
-//void ModbusRTU_Process(int channel, unsigned char data)//ս֡ͷ
+//int ModbusRTU_Process(int com, unsigned char * rebuf, int receivelenth)
 //---------------------------------------------------------------------------------------------------
-//! \brief		ִ
+//! \brief		һ֡Ӧ, FC03/04/06/08/16/23
 //! attention	
-//! \param[in]	int channel://ͨ
-//! \return		None
+//! \param[in]	int com: ˿ں
+//! \return		0 Ӧѷ, <0 ֡
 //---------------------------------------------------------------------------------------------------
 int  ModbusRTU_Process( int com, unsigned char * rebuf,int receivelenth )//ս֡ͷ
 {
-
-  unsigned short crc;
   CHAR2USHORT rec_crc;
-  CHAR2USHORT regaddr;
-  CHAR2USHORT readlenth;
-  CHAR2USHORT writedate;
+  unsigned short regaddr, count, writeaddr, writecount;
   unsigned char funcode;
- g_modbus_address =  ReadAddr();
-     // һ֡ݣжͷŴ󳤶ȣӵ
-     if(receivelenth!=FRAME_LEN)
+  uint8_t exception = MODBUS_EX_NONE;
+  int resplen = 0;
+  bool bQueued;
+  MODBUS_tDiagCounters *pDiag;
+
+  if((com < 0) || (com >= MODBUSRTU_CHANNEL_MAXNUM))
+    return -1;
+  modbusChannel = com;
+  pDiag = &g_ModbusDiag[com];
+  pDiag->rxFrameCount++;
+
+  g_modbus_address =  ReadAddr();
+     if(receivelenth < MIN_FRAME_LEN)
        return -1;  // ֡
-     if(rebuf[0] != g_modbus_address)   //
-       return -2;
-     
-     crc = modbus_rtu_CRC(rebuf,receivelenth-2);
-     rec_crc.byte[0] = rebuf[6];
-     rec_crc.byte[1] = rebuf[7];
-     if(crc!= rec_crc.word) //crc check error
+
+     rec_crc.byte[0] = rebuf[receivelenth-2];
+     rec_crc.byte[1] = rebuf[receivelenth-1];
+     if(modbus_rtu_CRC(rebuf,receivelenth-2) != rec_crc.word) //crc check error
+     {
+       pDiag->crcErrCount++;
+       DLOG(DLOG_MB_CRC, com + 1, receivelenth);
        return -3;
+     }
+     pDiag->busMsgCount++;
+
+     if((rebuf[0] != g_modbus_address) && (rebuf[0] != BROADCAST_ADDR))   //
+     {
+       pDiag->wrongAddrCount++;
+       return -2;
+     }
+     pDiag->slaveMsgCount++;
+
+     TRACE_START(TRACE_STAGE_MBPARSE);
      funcode = rebuf[1];  //function code
-     regaddr.byte[0] = rebuf[3];  //read reg addr
-     regaddr.byte[1] = rebuf[2];
+     regaddr = ((unsigned short)rebuf[2] << 8) | rebuf[3];
+     count   = ((unsigned short)rebuf[4] << 8) | rebuf[5];
 
+     g_respbuf[0] = g_modbus_address;
+     g_respbuf[1] = funcode;
      switch(funcode)
      {
-     case FUNC_CODE_READ:	
-       readlenth.byte[0] = rebuf[5];
-       readlenth.byte[1] = rebuf[4];
-       modebus_readreg(com,regaddr.word,readlenth.word*2);
+     case FUNC_CODE_READ:
+     case FUNC_CODE_READ_INPUT:
+       if(receivelenth != FRAME_LEN)
+       {
+         resplen = -1;
+         break;
+       }
+       exception = modbus_readregs(regaddr, count, g_respbuf+3);
+       g_respbuf[2] = (unsigned char)(count*2);
+       resplen = SLAVEADDR_LEN + FUNC_LEN + SIZE_LEN + count*2;
        break;
      case FUNC_CODE_SET:
-       writedate.byte[0] = rebuf[5];
-       writedate.byte[1] = rebuf[4];
-       modebus_writereg(com,regaddr.word,writedate.word*2);
+       if(receivelenth != FRAME_LEN)
+       {
+         resplen = -1;
+         break;
+       }
+       exception = modbus_writeregs(regaddr, 1, rebuf+4);
+       memcpy(g_respbuf+2, rebuf+2, 4);     // echo address and value
+       resplen = 6;
+       break;
+     case FUNC_CODE_DIAG:
+       if(receivelenth != FRAME_LEN)
+       {
+         resplen = -1;
+         break;
+       }
+       memcpy(g_respbuf+2, rebuf+2, 4);     // echo sub-function and data
+       exception = modbus_diagnostics(com, regaddr, g_respbuf+4);
+       resplen = 6;
+       break;
+     case FUNC_CODE_SET_MULTI:
+       if(receivelenth < 9 || receivelenth != 9 + rebuf[6])
+       {
+         resplen = -1;
+         break;
+       }
+       if((count == 0) || (count > MODBUS_MAX_WRITE_REGS) || (rebuf[6] != count*2))
+         exception = MODBUS_EX_ILLEGAL_VALUE;
+       else
+         exception = modbus_writeregs(regaddr, count, rebuf+7);
+       memcpy(g_respbuf+2, rebuf+2, 4);     // echo address and quantity
+       resplen = 6;
+       break;
+     case FUNC_CODE_READ_WRITE:
+       if(receivelenth < 13 || receivelenth != 13 + rebuf[10])
+       {
+         resplen = -1;
+         break;
+       }
+       writeaddr  = ((unsigned short)rebuf[6] << 8) | rebuf[7];
+       writecount = ((unsigned short)rebuf[8] << 8) | rebuf[9];
+       if((writecount == 0) || (writecount > MODBUS_MAX_RW_WRITE_REGS) || (rebuf[10] != writecount*2))
+         exception = MODBUS_EX_ILLEGAL_VALUE;
+       else
+         exception = modbus_writeregs(writeaddr, writecount, rebuf+11);
+       // the write is performed before the read
+       if(exception == MODBUS_EX_NONE)
+         exception = modbus_readregs(regaddr, count, g_respbuf+3);
+       g_respbuf[2] = (unsigned char)(count*2);
+       resplen = SLAVEADDR_LEN + FUNC_LEN + SIZE_LEN + count*2;
        break;
      default:
+       exception = MODBUS_EX_ILLEGAL_FUNCTION;
        break;
      }
-     return 0;
-     
+     TRACE_STOP(TRACE_STAGE_MBPARSE);
 
-    
-}
+     if(resplen < 0)
+     {
+       pDiag->noRespCount++;
+       return -1;
+     }
+     // no reply to a broadcast, even with address switches at 0: nothing is sent or timed
+     if(rebuf[0] == BROADCAST_ADDR)
+     {
+       pDiag->noRespCount++;
+       return 0;
+     }
 
+     TRACE_START(TRACE_STAGE_MBRESP);
+     if(exception != MODBUS_EX_NONE)
+       bQueued = modbus_exception(com, funcode, exception);
+     else
+       bQueued = modbus_send(com, resplen);
+     TRACE_STOP(TRACE_STAGE_MBRESP);
+     if(bQueued)
+       modbus_latency(com);
+     return 0;
+}
 
@@ -0,0 +1,153 @@
+#ifndef __MODBUSRTUSLAVE_H
+#define __MODBUSRTUSLAVE_H
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+//==================================================================================================
+//  F R A M E   L I M I T S
+//==================================================================================================
+#define MODBUS_MAX_READ_REGS        125     // FC03/FC04, 250 data bytes per response
+#define MODBUS_MAX_WRITE_REGS       123     // FC16
+#define MODBUS_MAX_RW_WRITE_REGS    121     // write part of FC23
+
+#define MODBUSRTU_CHANNEL_MAXNUM    1       // channels, index is the SendCom() port
+
+//==================================================================================================
+//  E X C E P T I O N   C O D E S
+//==================================================================================================
+#define MODBUS_EX_NONE              0x00
+#define MODBUS_EX_ILLEGAL_FUNCTION  0x01
+#define MODBUS_EX_ILLEGAL_ADDRESS   0x02
+#define MODBUS_EX_ILLEGAL_VALUE     0x03
+#define MODBUS_EX_DEVICE_FAILURE    0x04
+
+//==================================================================================================
+//  R E G I S T E R   M A P
+//==================================================================================================
+// 32 bit values occupy two registers, high word first.
+// Integer weights are scaled by 10^MB_REG_DP, i.e. 12.34 kg with dp 2 reads 1234.
+#define MB_REG_GROSS_I32            0x0000
+#define MB_REG_NET_I32              0x0002
+#define MB_REG_TARE_I32             0x0004
+#define MB_REG_STATUS               0x0006
+#define MB_REG_DP                   0x0007
+#define MB_REG_GROSS_F32            0x0008
+#define MB_REG_NET_F32              0x000A
+#define MB_REG_TARE_F32             0x000C
+#define MB_REG_INCR_F32             0x000E
+#define MB_REG_RAW_COUNTS           0x0010  // sum of both ADC channels
+#define MB_REG_FILTERED_COUNTS      0x0012  // after execute_filter()
+#define MB_REG_STABLE_COUNTS        0x0014  // after FilterWeight()
+#define MB_REG_ADC1_COUNTS          0x0016
+#define MB_REG_ADC2_COUNTS          0x0018
+#define MB_REG_DIAG_BUS_MSG         0x0020  // frames on the bus with valid CRC
+#define MB_REG_DIAG_CRC_ERR         0x0021
+#define MB_REG_DIAG_EXCEPTION       0x0022
+#define MB_REG_DIAG_SLAVE_MSG       0x0023  // frames addressed to this slave
+#define MB_REG_DIAG_WRONG_ADDR      0x0024  // frames with valid CRC for another slave
+#define MB_REG_DIAG_NO_RESP         0x0025  // frames addressed to this slave, not answered
+#define MB_REG_DIAG_OVERRUN         0x0026  // frames replaced by a newer one before they were processed
+#define MB_REG_DIAG_DROP_BYTES      0x0028  // u32, bytes of the dropped frames
+#define MB_REG_DIAG_LATENCY         0x002A  // u32, last request to first TX byte [us]
+#define MB_REG_DIAG_LATENCY_MAX     0x002C  // u32 [us]
+#define MB_REG_DIAG_LATENCY_HIST    0x0030  // MODBUS_LATENCY_BINS registers
+#define MB_REG_RTOS_HEAP_FREE       0x0040  // [bytes], 0 = no RTOS heap
+#define MB_REG_RTOS_HEAP_MIN_FREE   0x0041  // lowest free heap since power on [bytes]
+#define MB_REG_RTOS_TASK_NUM        0x0042  // tasks in the task registers, 0 = no data yet
+#define MB_REG_RTOS_CPU_LOAD        0x0043  // all tasks except idle, last second [0.1 %]
+#define MB_REG_RTOS_TASK_CPU        0x0048  // MB_RTOS_TASKS registers, creation order [0.1 %]
+#define MB_REG_RTOS_TASK_STACK      0x0050  // MB_RTOS_TASKS registers, lowest free stack [words]
+#define MB_REG_CMD_TARE             0x0100  // write 1
+#define MB_REG_CMD_ZERO             0x0101  // write 1
+#define MB_REG_CMD_CLEAR            0x0102  // write 1
+#define MB_REG_PRESET_TARE_F32      0x0104
+
+// MB_REG_STATUS bits
+#define MB_STATUS_MOTION            0x0001
+#define MB_STATUS_NET               0x0002
+#define MB_STATUS_OVERCAPACITY      0x0004
+#define MB_STATUS_UNDERZERO         0x0008
+#define MB_STATUS_CENTER_OF_ZERO    0x0010
+#define MB_STATUS_BAD_ZERO          0x0020  // power up zero not captured yet
+
+typedef enum
+{
+    MB_TYPE_U16 = 0,
+    MB_TYPE_I32,
+    MB_TYPE_U32,
+    MB_TYPE_F32
+} MODBUS_tRegType;
+
+//==================================================================================================
+//  D I A G N O S T I C S   ( F C 0 8 )
+//==================================================================================================
+#define MB_DIAG_RETURN_QUERY        0x0000
+#define MB_DIAG_CLEAR_COUNTERS      0x000A
+#define MB_DIAG_BUS_MSG             0x000B
+#define MB_DIAG_BUS_CRC_ERR         0x000C
+#define MB_DIAG_BUS_EXCEPTION       0x000D
+#define MB_DIAG_SLAVE_MSG           0x000E
+#define MB_DIAG_SLAVE_NO_RESP       0x000F
+#define MB_DIAG_BUS_OVERRUN         0x0012
+// vendor specific, 16 bit values saturate
+#define MB_DIAG_WRONG_ADDR          0x0040
+#define MB_DIAG_DROP_BYTES          0x0041
+#define MB_DIAG_LATENCY             0x0042  // [us]
+#define MB_DIAG_LATENCY_MAX         0x0043  // [us]
+#define MB_DIAG_LATENCY_HIST        0x0050  // + bin
+
+//! Latency histogram, bin 0 counts < MODBUS_LATENCY_BIN0_US, every further bin doubles the
+//! limit, the last bin counts everything above (>= 64 ms)
+#define MODBUS_LATENCY_BINS         10
+#define MODBUS_LATENCY_BIN0_US      250
+
+//! Task registers, same as TSTAT_MAX_TASKS, unused registers read 0
+#define MB_RTOS_TASKS               8
+
+//! Number of 16 bit registers used by a register type
+#define MB_TYPE_WIDTH(type)         (((type) == MB_TYPE_U16) ? 1 : 2)
+
+#define MB_FLAG_READ                0x01
+#define MB_FLAG_WRITE               0x02
+
+//! Read accessor, returns the raw register value (IEEE754 bits for MB_TYPE_F32)
+typedef uint32_t (*MODBUS_tRegRead)(void);
+//! Write accessor, returns MODBUS_EX_NONE or an exception code
+typedef uint8_t (*MODBUS_tRegWrite)(uint32_t value);
+
+typedef struct
+{
+    uint16_t            address;
+    uint8_t             type;       // MODBUS_tRegType
+    uint8_t             flags;
+    MODBUS_tRegRead     read;
+    MODBUS_tRegWrite    write;
+} MODBUS_tRegEntry;
+
+typedef struct
+{
+    uint16_t rxFrameCount;      // all frames passed to ModbusRTU_Process()
+    uint16_t busMsgCount;
+    uint16_t crcErrCount;
+    uint16_t exceptionCount;
+    uint16_t slaveMsgCount;
+    uint16_t wrongAddrCount;
+    uint16_t noRespCount;
+    uint32_t latencyLast;       // [us]
+    uint32_t latencyMax;        // [us]
+    uint16_t latencyHist[MODBUS_LATENCY_BINS];
+} MODBUS_tDiagCounters;
+
+extern MODBUS_tDiagCounters g_ModbusDiag[MODBUSRTU_CHANNEL_MAXNUM];
+
+int ModbusRTU_Process(int com, unsigned char *rebuf, int receivelenth);
+void ModbusRTU_ClearDiag(int com);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __MODBUSRTUSLAVE_H */
@@ -173,9 +173,12 @@ void CAL_AdjustCalParams(SCALE *pScale, int testpoint, double addLoad, int32_t c
 //			}
             
             chardouble.tempd = addLoad;
+            // weight and counts of a span point are valid together only
+            USER_PARAM_Begin();
             USER_PARAM_Set(BLK0_highCalWeight, (uint8_t *)(chardouble.ucdoubel)); 
 //            HAL_Delay(50);
             USER_PARAM_Set(BLK0_highCalCounts, (uint8_t *)(&calCounts)); 
+            USER_PARAM_Commit();
             
             pScale->highCalCounts = calCounts; 
 			pScale->highCalWeight = addLoad; 
@@ -6,11 +6,17 @@
 //! \ingroup	IND245_scale
 //! \brief		process Continuous Output
 //!
+//! One frame per weight cycle is sent with DMA on each COM port assigned to a continuous output
+//! format (BLK1_setupCOM1Assignment -> USART1, BLK1_setupCOM2Assignment -> USART2). The frame
+//! rate is the rate of the weight cycle, 10 Hz (osDelay(100) of WeighProcessTask).
+//! The frame of a channel is kept between cycles, only fields whose source changed are formatted
+//! again and the checksum is updated with the changed bytes.
+//!
 //! (c) Copyright 2004-2006 Mettler-Toledo Laboratory & Weighing Technologies. All Rights Reserved.
 //! \author Liang XiuWen
 //
 // $Date: 		2010/04/09
-// $State: 
+// $State:
 // $Revision: 0.1
 //
 //==================================================================================================
@@ -18,167 +24,82 @@
 //  I N C L U D E D   F I L E S
 //==================================================================================================
 #include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "usart.h"
 #include "RB_ASCII.h"
-#include "RB_IncludeAll.h"
+#include "RB_String.h"
 #include "ScaleConfig.h"
-#include "menu.h"
 #include "Scale.h"
-#include "ApplMain.h"
-#include "ApplConfig.h"
 #include "ContOut.h"
 #include "UserParam.h"
-#include "RB_UART.h"
-#include "DiscreteIO.h"
-#include "GUIDisplayProcess.h"
-#include "dynamic.h"
-#include "Ethernet.h"
-#include "CheckTime.h"
-
+#include "WeightBus.h"
 
-extern char BTconnectflag;        //Bluetooth connection flag
-extern unsigned char WgtDataOK;  // weight data ok flag
-extern bool conoutfalg;
+//==================================================================================================
+//  L O C A L   D E F I N I T I O N S
+//==================================================================================================
 
-//void continuousOutput_Process(void);
-void ContinusOutPutProcess(void);
+// frame layout without checksum, the checksum byte follows at [len]
+#define CONT_STD_FRAME_LEN      17      // STX, SWA, SWB, SWC, net[6], tare[6], CR
+#define CONT_STD_NET_POS        4
+#define CONT_STD_TARE_POS       10
+#define CONT_STD_FIELD_LEN      6
 
+#define CONT_EXT_FRAME_LEN      24      // SOH, addr, status[4], net[9], tare[8], CR
+#define CONT_EXT_NET_POS        6
+#define CONT_EXT_NET_LEN        9
+#define CONT_EXT_TARE_POS       15
+#define CONT_EXT_TARE_LEN       8
+#define CONT_EXT_ADDRESS        0x31
 
+#define CONT_FRAME_MAXLEN       (CONT_EXT_FRAME_LEN + 1)
 
-static void FormatOutputWeightString(char *pSrcString, char *pDestString, int maxLen, bool sign,bool decimal);
-static void FormatOutputWeightString8142(char *pSrcString, char *pDestString, int maxLen, bool sign,bool decimal);
-static void FormatOutputWeightStringKingbird(char *pSrcString, char *pDestString, int maxLen, bool16 sign,bool16 decimal);
+typedef struct
+{
+    uint8_t  assignment;                        // SETUP_COMASSIGNMENT, COMASSIGNMENT_NONE = off
+    bool     bChecksum;
+    uint8_t  frameLen;                          // without checksum
+    uint8_t  sum;                               // sum of frame[0..frameLen-1]
+    char     frame[CONT_FRAME_MAXLEN];          // kept up to date between the cycles
+    char     netSource[12];                     // net string the net field was made of
+    char     tareSource[12];
+    int32_t  validLen;                          // Kingbird, digits of capacity + dp
+    char     txBuf[2][CONT_FRAME_MAXLEN];       // DMA double buffer
+    uint8_t  txLen[2];
+    volatile int8_t txActive;                   // buffer sent by the DMA, -1 = none
+    volatile int8_t txPending;                  // buffer waiting for the transmitter, -1 = none
+} CONT_tChannel;
 
-static void buildAnimalTotalAndTare(SCALE *pScale, char *pOutString);
-static void buildNormalNetAndTare(SCALE *pScale, char *pString);
-static void buildNormalNetAndTare8142(SCALE *pScale, char *pString);
-static void buildNormalNetAndTareKingbird(SCALE *pScale, char *pString);
+static CONT_tChannel contChannel[CONT_CHANNEL_NUM];
 
-static void buildMultiContinous1OutputString(SCALE *pScale, char *pOutString, CON1_DATA_TYPE type); 
-static void buildMultiContinous2OutputString(SCALE *pScale, char *pOutString, CON1_DATA_TYPE type); 
+// every weight cycle while a channel is assigned
+static WBUS_tSubscriber weightSub;
 
-static int caculatevalidlenth(void);
+// CONT_Init() requested by another task, carried out by CONT_Process()
+static volatile bool bContInitRequest = false;
 
-static void CONT_BuildContinousOutputString(SCALE *this, char *pOutString);
-static void CONT8142_BuildContinousOutputString(SCALE *this, char *pOutString);
-static void CONTKingbird_BuildContinousOutputString(SCALE *pScale, char *pOutString);
-static void CONT_BuildContinuousExtendedOutputString(SCALE *pScale, char *pOutString, char addr);
+static const USER_PARAM_tIdent contAssignmentParam[CONT_CHANNEL_NUM] = {BLK1_setupCOM1Assignment, BLK1_setupCOM2Assignment};
+static const USER_PARAM_tIdent contChecksumParam[CONT_CHANNEL_NUM]   = {BLK1_setupCOM1AssignmentChecksum, BLK1_setupCOM2AssignmentChecksum};
 
 
-static void COM1ContinusOutPutProcess(void);
-static void COM2ContinusOutPutProcess(void);
-static void EthernetCountinusOutPutProcess(void);
-static void EthernetPrintClintCoutProcess(void);
-static void USBContinusOutPutProcess(void);
-static void BluetoothContinusOutPutProcess(void);
+static void FormatOutputWeightString(char *pSrcString, char *pDestString, int maxLen, bool sign,bool decimal);
+static void FormatOutputWeightString8142(char *pSrcString, char *pDestString, int maxLen, bool sign,bool decimal);
+static void FormatOutputWeightStringKingbird(char *pSrcString, char *pDestString, int maxLen, bool sign,bool decimal, int32_t validlen);
 
+static int32_t caculatevalidlenth(SCALE *pScale);
 
-//--------------------------------------------------------------------------------------------
-// Continus Out Put Process
-//--------------------------------------------------------------------------------------------
-void ContinusOutPutProcess(void)
-{
-  //condition check, then processs g_setupMode||(WgtDataOK != 0)||loadtypematch == false || 
-  if(conoutfalg == false||g_setupMode)
-    return ;
-  COM1ContinusOutPutProcess();
-  COM2ContinusOutPutProcess();
-  USBContinusOutPutProcess();
-  EthernetCountinusOutPutProcess();  
-  EthernetPrintClintCoutProcess();
-  BluetoothContinusOutPutProcess();
-  
-  g_bPrintRequest = 0;    // reset the print flag
-}
+static void buildStatusWord(SCALE *pScale, char* pString);
+static void buildExtendedStatus(SCALE *pScale, char* pString);
 
+static void CONT_SetBytes(CONT_tChannel *pCh, int pos, const char *pSrc, int len);
+static void CONT_UpdateFrame(CONT_tChannel *pCh, SCALE *pScale, const WBUS_tWeight *pWeight);
+static void CONT_Send(int port);
 
-/**---------------------------------------------------------------------
- * Name         : continuousOutput_Process
- * Description  : Continuous output process
- * Prototype in : 
- * \param       : none
- * \return      : none
- *---------------------------------------------------------------------*/
 
-/**---------------------------------------------------------------------
- * Name         : buildAnimalTotalAndTare
- * Description  : Build MT standard continuous output string, total size is 18 bytes, including checksum bytes
- * Prototype in : 
- * \param       : pScale  stand scale struct;    pOutString  the out str
- * \return      : none
- *---------------------------------------------------------------------*/
-void buildAnimalTotalAndTare(SCALE *pScale, char *pOutString)
-{
-    DYNAMICAPPLET_STATUS currentStatus;
-    char totalString[12] = {0};
-    char tareString[12]  = {0}; 
-    char string[10] = {0}; 
-    int32_t dp = SCALE_GetDp(scale.currInc); 
-    uint8_t i = 0; 
-    char animaltring[15] = {0}; 
-    
-    if (dp < 1)
-        dp = 0; 
-    if (m_DynamicApplet_Status == DYNAMICAPPLET_ENTERDATA || m_DynamicApplet_Status == DYNAMICAPPLET_ENTERID)
-        currentStatus = m_PreviousDynamicApplet_Status;
-    else
-        currentStatus = m_DynamicApplet_Status;
-
-    switch (currentStatus)
-    {   
-        case DYNAMICAPPLET_NONE:
-        case DYNAMICAPPLET_ENTERANIMALNUMBER:
-        case DYNAMICAPPLET_START:
-        case DYNAMICAPPLET_WAITTOEND:
-        {
-            buildNormalNetAndTare(pScale, pOutString);
-            break;
-        }
-        
-        case DYNAMICAPPLET_WORKING:
-        {
-            buildNormalNetAndTare(pScale, (char *)animaltring); 
-            for (i = 0; i < 6; i++)
-            {
-                if (animaltring[i] != ' ')
-                    animaltring[i] = '*'; 
-            }
-            for (i = 0; i < 6; i++)
-            {
-                if (animaltring[i + 6] != ' ')
-                    animaltring[i + 6] = '0'; 
-            }
-            RB_STRING_strncpymax(pOutString, (char *)animaltring, 12 + 1);
-//            string[0] = 0x2a;
-//            string[1] = '\0';
-//            RB_STRING_AlignRight(string, 6);
-//            RB_STRING_strncpymax(pOutString, string, 6 + 1);
-//            pOutString += 6;
-//            string[0] = '0';
-//            string[1] = '\0';
-//            RB_STRING_AlignRight(string, 6);
-//            RB_STRING_strncpymax(pOutString, string, 6 + 1);
-            break;
-        }
-        
-        case DYNAMICAPPLET_SHOWAVEWEIGHT:
-        {
-            RB_FORMAT_Double(string, dp, (float64)(g_DynamicWeighing.totalWeight), 10);
-            FormatOutputWeightString(string, totalString, 6, false, false);
-            FormatOutputWeightString(pScale->tareString, tareString, 6, false,false);
-            RB_STRING_strncpymax(pOutString, totalString, 7);
-            pOutString += 6;
-            RB_STRING_strncpymax(pOutString, tareString, 7);
-            break;
-        }
-        
-        default:
-            break;
-    }
-}
 /**---------------------------------------------------------------------
 * Name         :  buildStatusWord
 * Description  :  build WORDA WORDB WORDC
-* Prototype in : 
+* Prototype in :
 * \param       : pScale  stand scale struct;    pOutString  the out str
 * \return      : none
 *---------------------------------------------------------------------*/
@@ -188,423 +109,215 @@ static void buildStatusWord(SCALE *pScale, char* pString)
     uint8_t      wordA, wordB, wordC;
     bool       bUnderZero, bMotion, bPowerUpZero;
     UNIT_tSymbol unit;
-    
-    wordA       =  buildContinuousOutputWordA(pScale); 
+
+    wordA       =  buildContinuousOutputWordA(pScale);
     *pString++  =  wordA;
 
     // Build status word B
     wordB = 0x20;       // B.5 always 1
     // B.0 Gross = 0, Net = 1
-    netMode = TARE_GetTareMode(&(pScale->tare));
+    netMode = TARE_GetTareMode(pScale->tare);
     if (netMode == 'N')
         wordB |= 0x01;
     // B.1 Sign: Positive = 0, Negative = 1
     if (((netMode == 'G') && (pScale->roundedGrossWeight < 0)) || ((netMode == 'N') && (pScale->roundedNetWeight < 0)))
         wordB |= 0x02;
     // B.2 Out of range = 1 (Over or under)
-    bUnderZero = ZERO_GetUnderZero(&(pScale->zero));
+    bUnderZero = ZERO_GetUnderZero(pScale->zero);
     if (pScale->bOverCapacity || bUnderZero)
         wordB |= 0x04;
     // B.3 Motion = 1
-    bMotion = MOTION_GetMotion(&(pScale->motion));
+    bMotion = MOTION_GetMotion(pScale->motion);
     if (bMotion)
         wordB |= 0x08;
     // B.4 Unit: lb = 0, kg = 1 (see SWC, 0-2)
-    unit = UNIT_GetUnit(&(pScale->unit), pScale->unit.currUnitType);
+    unit = UNIT_GetUnit(pScale->unit, pScale->unit->currUnitType);
     if (unit == UNIT_kg)
         wordB |= 0x10;
     // B.6 In Power up = 1 (Zero Not Captured)
-    bPowerUpZero = ZERO_GetPowerUpZeroCaptured(&(pScale->zero));
+    bPowerUpZero = ZERO_GetPowerUpZeroCaptured(pScale->zero);
     if (!bPowerUpZero)
         wordB |= 0x40;
     *pString++ = wordB;
-    
+
     // Build status word C
     wordC = 0x20;      // C.5 always 1
     // C.0 C.1 C.2 current unit besides kg and lb (see SWB.4)
     switch (unit)
     {
-        case UNIT_g:    
-            wordC |= 0x01; 
+        case UNIT_g:
+            wordC |= 0x01;
             break;
-            
-        case UNIT_t:    
+
+        case UNIT_t:
             wordC |= 0x02;
             break;
-            
+
         case UNIT_kg:
-        case UNIT_lb:   
-            wordC &= ~0x03; 
+        case UNIT_lb:
+            wordC &= ~0x03;
             break;
-        
+
         case UNIT_oz:
             wordC |= 0x03;
-            break; 
-                
-        case UNIT_ton:  
-            wordC |= 0x06; 
+            break;
+
+        case UNIT_ton:
+            wordC |= 0x06;
             break;
         case UNIT_newton:
 			wordC |= 0x07;
 			break;
-        default: 
+        default:
             break;
     }
-    // Print request = 1
-    if (g_bPrintRequest)
-        wordC |= 0x08;
+    // C.3 print request is not used, there is no print key
     // Expand X10 = 1
     if (pScale->bExpandDisplay)
         wordC |= 0x10;
     *pString++ = wordC;
 }
-/**---------------------------------------------------------------------
-* Name         :  buildChecksum
-* Description  :  work the checksum
-* Prototype in : 
-* \param       :  pOutString  the out str
-* \return      :  none
-*---------------------------------------------------------------------*/
-static void buildChecksum(char *pOutString)
-{
-    uint8_t i, checksum;
-    char *  pString;
-    checksum = 0;
-    pString  = pOutString;
-    for (i = 0; i < 17; i++)
-    {
-        checksum -= *pString;
-        pString++;
-    }
-    *pString++ = (checksum & 0x7F); 
-    // add terminating zero
-    *pString = '\0';
-}
-
-/**---------------------------------------------------------------------
-* Name         :  buildNormalNetAndTare
-* Description  :  build the field of Net and tare in normal mode
-* Prototype in : 
-* \param       :  pScale  stand scale struct;    pOutString  the out str
-* \return      :  none
-*---------------------------------------------------------------------*/
-static void buildNormalNetAndTare(SCALE *pScale, char *pString)
-{
-    char netString[12] = {0}, tareString[12] = {0};
-    FormatOutputWeightString(pScale->netString,  netString,  6, false,false);
-    FormatOutputWeightString(pScale->tareString, tareString, 6, false,false);
-    RB_STRING_strncpymax(pString, netString, 7);
-    pString += 6;
-    RB_STRING_strncpymax(pString, tareString, 7);
-}
-
-static void buildNormalNetAndTare8142(SCALE *pScale, char *pString)
-{
-    char netString[12] = {0}, tareString[12] = {0};
-    FormatOutputWeightString8142(pScale->netString,  netString,  6, false,false);
-    FormatOutputWeightString8142(pScale->tareString, tareString, 6, false,false);
-    RB_STRING_strncpymax(pString, netString, 7);
-    pString += 6;
-    RB_STRING_strncpymax(pString, tareString, 7);
-}
 
-static void buildNormalNetAndTareKingbird(SCALE *pScale, char *pString)
-{
-    char netString[12] = {0}, tareString[12] = {0};
-    FormatOutputWeightStringKingbird(pScale->netString,  netString,  6, false,false);
-    FormatOutputWeightStringKingbird(pScale->tareString, tareString, 6, false,false);
-    RB_STRING_strncpymax(pString, netString, 7);
-    pString += 6;
-    RB_STRING_strncpymax(pString, tareString, 7);
-}
 /**---------------------------------------------------------------------
- * Name         : CONT_BuildContinousOutputString
- * Description  :  Build MT standard continuous output string, total size is 18 bytes, including checksum bytes
- * Prototype in : 
- * \param         : pScale  stand scale struct;    pOutString  the out str
+ * Name         : buildExtendedStatus
+ * Description  : build status byte1..byte4 of the extended format
+ * Prototype in :
+ * \param       : pScale   pString
  * \return      : none
  *---------------------------------------------------------------------*/
-static void CONT_BuildContinousOutputString(SCALE *pScale, char *pOutString)
+static void buildExtendedStatus(SCALE *pScale, char* pString)
 {
-    char *pString; 
-    
-    pString = pOutString; 
-    *pString++ = RB_ASCII_STX; 
-    buildStatusWord(pScale, pString); 
-    pString += 3; 
-    // Format output weight string
-    switch (selectedApplet)
-    {
-        case APPLCONFIG_APPL_DYNAMICWEIGHING:
-        {
-            buildAnimalTotalAndTare(pScale, pString);
-            break;
-        }
-        
-        default:
-        {
-            buildNormalNetAndTare(pScale, pString);
-            break;
-        }
-    }
-    pString += 12;
-    // add CR
-    *pString++ = RB_ASCII_CR;
-    buildChecksum(pOutString);
-    
-}
-
-static void CONT8142_BuildContinousOutputString(SCALE *pScale, char *pOutString)
-{
-    char *pString; 
-    
-    pString = pOutString; 
-    *pString++ = RB_ASCII_STX; 
-    buildStatusWord(pScale, pString); 
-    pString += 3; 
-    // Format output weight string
-    switch (selectedApplet)
-    {
-        case APPLCONFIG_APPL_DYNAMICWEIGHING:
-        {
-            buildAnimalTotalAndTare(pScale, pString);
-            break;
-        }
-        
-        default:
-        {
-            buildNormalNetAndTare8142(pScale, pString);
-            break;
-        }
-    }
-    pString += 12;
-    // add CR
-    *pString++ = RB_ASCII_CR;
-    buildChecksum(pOutString);
-    
-}
-//kingbird continuous output,Ч
-static void CONTKingbird_BuildContinousOutputString(SCALE *pScale, char *pOutString)
-{
-    char *pString; 
-    
-    pString = pOutString; 
-    *pString++ = RB_ASCII_STX; 
-    buildStatusWord(pScale, pString); 
-    pString += 3; 
-    // Format output weight string
-    switch (selectedApplet)
-    {
-        case APPLCONFIG_APPL_DYNAMICWEIGHING:
-        {
-            buildAnimalTotalAndTare(pScale, pString);
-            break;
-        }
-        
-        default:
-        {
-            buildNormalNetAndTareKingbird(pScale, pString);
-            break;
-        }
-    }
-    pString += 12;
-    // add CR
-    *pString++ = RB_ASCII_CR;
-    buildChecksum(pOutString);
-    
-}
-
-/**---------------------------------------------------------------------
- * Name         : CONT_BuildContinuousExtendedOutputString
- * Description  : process MT extend continous output format
- * Prototype in : 
- * \param         : pScale   pOutString     addr:end flag
- * \return      : none
- *---------------------------------------------------------------------*/
-
-static void CONT_BuildContinuousExtendedOutputString(SCALE *pScale, char *pOutString, char addr)
-{
-    char netString[10], tareString[9];
-    unsigned char i, checksum;
     unsigned char byte1, byte2, byte3, byte4;
     UNIT_tSymbol unit;
     bool bCOZ, bMotion, bUnderZero, bPowerUpZero;
     unsigned char netMode;
-    char *pString;
     unsigned char *pTareSource;
-    
-    pString = pOutString;
-    *pString++ = RB_ASCII_SOH;
-    *pString++ = addr;
-    
+
     // build status byte1
     byte1 = 0x20;
-    
-    unit = UNIT_GetUnit(&(pScale->unit), pScale->unit.currUnitType);
+
+    unit = UNIT_GetUnit(pScale->unit, pScale->unit->currUnitType);
     switch (unit)
     {
         case UNIT_lb:
             byte1 |= 0x01;
             break;
-            
+
         case UNIT_kg:
             byte1 |= 0x02;
             break;
-            
+
         case UNIT_g:
             byte1 |= 0x03;
             break;
-            
+
         case UNIT_t:
             byte1 |= 0x04;
             break;
-            
+
         case UNIT_ton:
             byte1 |= 0x05;
             break;
-            
+
         case UNIT_oz:
             byte1 |= 0x08;
             break;
         case UNIT_newton:
 			byte1 |= 0x09;
 			break;
-   //     case UNIT_ozt:
-    //        byte1 |= 0x06;
-     //       break;
-     //   case UNIT_dwt:
-     //       byte1 |= 0x07;
-     //       break;
-     //   case UNIT_oz:
-     //       byte1 |= 0x08;
-     //       break;
-//        case UNIT_cus:
-//            byte1 |= 0x09;
-//            break;
         default:
             break;
     }
-    
-    bCOZ = ZERO_GetCenterOfZero(&(pScale->zero));
+
+    bCOZ = ZERO_GetCenterOfZero(pScale->zero);
     if (bCOZ == 1)
         byte1 |= 0x10;
-    
-    bMotion = MOTION_GetMotion(&(pScale->motion));
+
+    bMotion = MOTION_GetMotion(pScale->motion);
     if (bMotion)
         byte1 |= 0x40;
 
     *pString++ = byte1;
-    
+
     // build status byte2
     byte2 = 0x20;
 
-    netMode = TARE_GetTareMode(&(pScale->tare));
+    netMode = TARE_GetTareMode(pScale->tare);
     if (netMode == 'N')
     {
         byte2 |= 0x01;
-    
-        // to do, get tare source
-        pTareSource = TARE_GetTareSource(&(pScale->tare));
+
+        pTareSource = TARE_GetTareSource(pScale->tare);
         switch (*pTareSource)
         {
             case PUSHBUTTON_TARE:
             case AUTO_TARE:
                 byte2 |= 0x02;
                 break;
-                
+
             case KEYBOARD_TARE:
                 byte2 |= 0x04;
                 break;
-                
+
             case TARE_MEMORY:
                 byte2 |= 0x06;
                 break;
-                
+
             default:
                 break;
         }
     }
-    
+
     // weight range
-    if (pScale->numberRanges == TWO_RANGES) //|| pScale->numberRanges == TWO_INTERVALS
+    if (pScale->numberRanges == TWO_RANGES)
     {
         if (pScale->currentRange == 1)
-            byte2 |= 0x10; 
+            byte2 |= 0x10;
         else
-            byte2 |= 0x08; 
+            byte2 |= 0x08;
     }
-    
-    
+
     // Expand X10 = 1
     if (pScale->bExpandDisplay)
         byte2 |= 0x40;
 
     *pString++ = byte2;
 
-    // build status byte3
+    // build status byte3, bit0 (not in weighing mode) is never set, there is no setup mode
     byte3 = 0x20;
-    
-    if (g_scaleProcessState != 1)
-        byte3 |= 0x01;
-        
-    bUnderZero = ZERO_GetUnderZero(&(pScale->zero));
+
+    bUnderZero = ZERO_GetUnderZero(pScale->zero);
     if (bUnderZero)
         byte3 |= 0x02;
 
     if (pScale->bOverCapacity)
         byte3 |= 0x04;
-    
-    bPowerUpZero = ZERO_GetPowerUpZeroCaptured(&(pScale->zero));
+
+    bPowerUpZero = ZERO_GetPowerUpZeroCaptured(pScale->zero);
     if (!bPowerUpZero)
         byte3 |= 0x08;
-    
-    if (g_bPrintRequest)
-        byte3 |= 0x10;
 
     // to do, function of bit6(Below MinWeigh threshold) is not used
 
     *pString++ = byte3;
-    
+
     // build status byte4, to do, application bits is not used here
     byte4 = 0x20;
 
     *pString++ = byte4;
-    
-    // build display weight
-    FormatOutputWeightString(pScale->netString, netString, 9, true,true);
-    FormatOutputWeightString(pScale->tareString, tareString, 8, true,true);
-    RB_STRING_strncpymax(pString, netString, 10);
-    pString += 9;
-    RB_STRING_strncpymax(pString, tareString, 9);
-    pString += 8;
-
-    // add CR
-    *pString++ = RB_ASCII_CR;
-    
-    // add checksum byte
-    checksum = 0;
-    pString = pOutString;
-    for (i = 0; i < 24; i++)
-    {
-        checksum -= *pString;
-        pString++;
-    }
-    *pString++ = (checksum & 0x7F); 
-    // add terminating zero
-    *pString = '\0';
 }
 
 /**---------------------------------------------------------------------
  * Name         : buildContinuousOutputWordA
  * Description  : build continuous output status word A
- * Prototype in : 
+ * Prototype in : ContOut.h
  * \param       : pScale---scale struct
  * \return      : status word
  *---------------------------------------------------------------------*/
 uint8_t buildContinuousOutputWordA(SCALE *pScale)
 {
     uint8_t word_A = 0x20;
-    int32_t incrIndex; 
+    int32_t incrIndex;
     float tmpIncr;
 
     if (pScale->bExpandDisplay)
@@ -615,11 +328,11 @@ uint8_t buildContinuousOutputWordA(SCALE *pScale)
         incrIndex = SCALE_GetIncrIndex(pScale->currInc);
         if (incrIndex >= 0)
         {
-            word_A |= ((CONFIG_MAX_DP + 2) - incrIndex / 3) & 0x07; 
+            word_A |= ((CONFIG_MAX_DP + 2) - incrIndex / 3) & 0x07;
         }
         else
         {
-            
+
             if (pScale->roundedNetWeight < 9.999999)
             {
                 //output format:x.xxxxx
@@ -647,7 +360,7 @@ uint8_t buildContinuousOutputWordA(SCALE *pScale)
 /**---------------------------------------------------------------------
  * Name         : FormatOutputWeightString
  * Description  : // Remove decimal point and negtive sign (if disable) in weight string, then align right
- * Prototype in : 
+ * Prototype in :
  * \param         : pSrcString   pDestString  maxLen  sign  decimal
  * \return      : none
  *---------------------------------------------------------------------*/
@@ -657,7 +370,7 @@ static void FormatOutputWeightString(char *pSrcString, char *pDestString, int ma
     int32_t i;
     char ch;
     char *pString;
-    
+
     pString = pDestString;
 	for (i = 0; i < 12; i++)
 	{
@@ -669,7 +382,7 @@ static void FormatOutputWeightString(char *pSrcString, char *pDestString, int ma
 			pString++;
 		}
 		else if (ch == '.')
-		{if (decimal==false)//Feb_09_09  lxw to add the decimal in contimuous_extanded output 
+		{if (decimal==false)//Feb_09_09  lxw to add the decimal in contimuous_extanded output
 			{pSrcString++;
 		       }
 		else
@@ -694,716 +407,343 @@ static void FormatOutputWeightString(char *pSrcString, char *pDestString, int ma
 			pSrcString++;
 	}
     *pString = '\0';
-    
+
     RB_STRING_AlignRight(pDestString, maxLen);
 }
 
 static void FormatOutputWeightString8142(char *pSrcString, char *pDestString, int maxLen, bool sign,bool decimal)
 {
-    int32_t i;
-    char ch;
     char *pString;
-    
-    pString = pDestString;
-	for (i = 0; i < 12; i++)
-	{
-	    ch = *pSrcString;
-		if (ch >= '0' && ch <= '9')
-		{
-			*pString = ch;
-			pSrcString++;
-			pString++;
-		}
-		else if (ch == '.')
-		{
-            if (decimal==false)//Feb_09_09  lxw to add the decimal in contimuous_extanded output 
-            {
-                pSrcString++;
-            }
-             else
-            {
-              *pString = ch;
-              pSrcString++;
-              pString++;
-            }
-		}
-		else if (ch == '-')
-		{
-		    if (sign)
-		    {
-		        *pString = ch;
-		        pString++;
-		    }
-		    pSrcString++;
-		}
-		else if (ch == '\0')
-			break;
-		else
-			pSrcString++;
-	}
-    *pString = '\0';
-    
-    RB_STRING_AlignRight(pDestString, maxLen);
-	
+
+    FormatOutputWeightString(pSrcString, pDestString, maxLen, sign, decimal);
+
 		pString = pDestString;
 		while((*pString) == ' ')
 		{
-			*pString = '0'; 
-			pString++; 
+			*pString = '0';
+			pString++;
 		}
 
 }
 //Чȣ
-static int caculatevalidlenth(void)
+static int32_t caculatevalidlenth(SCALE *pScale)
 {
-  int  dp;
-  char tmp[12]={0};  
-  unsigned char len;
-  dp = SCALE_GetDp(scale.currInc);
+  int32_t  dp;
+  int32_t  len;
+  uint32_t capacity;
+
+  dp = SCALE_GetDp(pScale->currInc);
     if (dp < 1)
-        dp = 0;  //С    
-    sprintf(tmp,"%d",(unsigned int )scale.scaleCapacity);
-    len = strlen(tmp) + dp;
-    return len;    
-  
+        dp = 0;  //С
+    // digits of the integer capacity, counted instead of sprintf() to keep the stack of WeighProcessTask small
+    capacity = (uint32_t)pScale->scaleCapacity;
+    len = 1;
+    while (capacity >= 10)
+    {
+        capacity /= 10;
+        len++;
+    }
+    return len + dp;
+
 }
 
-static void FormatOutputWeightStringKingbird(char *pSrcString, char *pDestString, int maxLen, bool16 sign,bool16 decimal)
+static void FormatOutputWeightStringKingbird(char *pSrcString, char *pDestString, int maxLen, bool sign,bool decimal, int32_t validlen)
 {
     int32_t i;
-    char ch;
     char temp[7]={0};
-    char *pString;
-    unsigned int validlen = 0;
-    unsigned int templen = 0;
-    pString = pDestString;
-	for (i = 0; i < 12; i++)
-	{
-	    ch = *pSrcString;
-		if (ch >= '0' && ch <= '9')
-		{
-			*pString = ch;
-			pSrcString++;
-			pString++;
-		}
-		else if (ch == '.')
-		{
-            if (decimal==false)//Feb_09_09  lxw to add the decimal in contimuous_extanded output 
-            {
-                pSrcString++;
-            }
-             else
-            {
-              *pString = ch;
-              pSrcString++;
-              pString++;
-            }
-		}
-		else if (ch == '-')
-		{
-		    if (sign)
-		    {
-		        *pString = ch;
-		        pString++;
-		    }
-		    pSrcString++;
-		}
-		else if (ch == '\0')
-			break;
-		else
-			pSrcString++;
-	}
-    *pString = '\0';
-    validlen = caculatevalidlenth();
+    int32_t templen = 0;
+
+    FormatOutputWeightString(pSrcString, pDestString, 0, sign, decimal);
     templen = strlen(pDestString);
     if((validlen > templen)&&((validlen - templen)<6))
     {
       for(i=0; i<(validlen - templen);i++)
         temp[i] = '0';
     }
-    strcat(temp,pDestString);
+    RB_STRING_strncatmax(temp, pDestString, sizeof(temp));
     RB_STRING_strncpymax(pDestString,temp,7);
     RB_STRING_AlignRight(pDestString, maxLen);
-//	
-//		pString = pDestString;
-//		while((*pString) == ' ')
-//		{
-//			*pString = '0'; 
-//			pString++; 
-//		}
-
 }
 
 /**---------------------------------------------------------------------
- * Name         : buildMultiContinous1OutputString
- * Description  : Build MT muti continuous 1 output string, 
- *                total size is 18 bytes, including checksum bytes
- * Prototype in : 
- * \param       : pScale  stand scale struct;    pOutString  the out str
+ * Name         : CONT_SetBytes
+ * Description  : copy a field into the frame, the sum is corrected for
+ *                the changed bytes only
+ * Prototype in :
+ * \param       : pCh  pos  pSrc  len
  * \return      : none
  *---------------------------------------------------------------------*/
-static void buildMultiContinous1OutputString(SCALE *pScale, char *pOutString, CON1_DATA_TYPE type)
+static void CONT_SetBytes(CONT_tChannel *pCh, int pos, const char *pSrc, int len)
 {
-    char string[10] = {0}; 
-    char fieldValueString[10] = {0}; 
-    char tareString[10] = {0}; 
-    char *pString;
-    int32_t dp = SCALE_GetDp(scale.currInc); 
-    
-    if (dp < 1)
-        dp = 0; 
-    pString = pOutString;
-    *pString++ = (char)type;
-    buildStatusWord(pScale, pString);
-    pString += 3; 
-    
-    switch (type)
+    int i;
+
+    for (i = 0; i < len; i++)
     {
-        case ASCII_QUANTITY_OF_ANIMAL:
-        {
-            //to number of animal field, the increment should be x1 and unit should be custom unit
-            pString -= 3; 
-            *pString = 0x2A; 
-            pString += 2; 
-            *pString |= 0x07; 
-            pString += 1; 
-            RB_FORMAT_ULong(string, g_DynamicWeighing.animalNumber, 6); 
-            RB_STRING_AlignRight(string, 6); 
-            
-            RB_STRING_strncpymax(pString, string, 7); 
-            break;
-        }
-        
-        case ASCII_AVERAGE_WEIGHT_PER_ANIMAL:
+        if (pCh->frame[pos + i] != pSrc[i])
         {
-            if (m_DynamicApplet_Status == DYNAMICAPPLET_SHOWAVEWEIGHT || m_DynamicApplet_Status == DYNAMICAPPLET_WAITTOEND)
-            {
-                RB_FORMAT_Double(string, dp, (float64)(g_DynamicWeighing.averageWeight), 10);
-                FormatOutputWeightString(string, fieldValueString, 6, false, false);
-                RB_STRING_strncpymax(pString, fieldValueString, 7);
-            }
-            else
-            {
-                RB_STRING_strncpymax(pString, "      ", 7);
-            }
-            break;
-        }
-        
-        case ASCII_AVERAGE_TOTAL_WEIGHT:
-        {
-            if (m_DynamicApplet_Status == DYNAMICAPPLET_SHOWAVEWEIGHT || m_DynamicApplet_Status == DYNAMICAPPLET_WAITTOEND)
-            {
-                RB_FORMAT_Double(string, dp, (float64)(g_DynamicWeighing.totalWeight), 10);
-                FormatOutputWeightString(string, fieldValueString, 6, false, false);
-                RB_STRING_strncpymax(pString, fieldValueString, 7);
-            }
-            else
-            {
-                RB_STRING_strncpymax(pString, "      ", 7);
-            }
-            break;
+            pCh->sum += (uint8_t)pSrc[i] - (uint8_t)pCh->frame[pos + i];
+            pCh->frame[pos + i] = pSrc[i];
         }
     }
-    pString += 6;
-    FormatOutputWeightString(pScale->tareString, tareString, 6, false, false);
-    RB_STRING_strncpymax(pString, tareString, 7);
-    pString += 6;
-    *pString++ = RB_ASCII_CR;
-    buildChecksum(pOutString);
 }
 
 /**---------------------------------------------------------------------
- * Name         : buildMultiContinous2OutputString
- * Description  : Build MT muti continuous 1 output string, 
- *                total size is 18 bytes, including checksum bytes
- * Prototype in : 
- * \param       : pScale  stand scale struct;    pOutString  the out str
+ * Name         : CONT_UpdateFrame
+ * Description  : bring the frame of a channel up to date with this
+ *                weight cycle
+ * Prototype in :
+ * \param       : pCh  pScale
+ * \param       : pWeight---snapshot of this cycle with the display strings
  * \return      : none
  *---------------------------------------------------------------------*/
-static void buildMultiContinous2OutputString(SCALE *pScale, char *pOutString, CON1_DATA_TYPE type)
+static void CONT_UpdateFrame(CONT_tChannel *pCh, SCALE *pScale, const WBUS_tWeight *pWeight)
 {
-    char * pString = pOutString; 
-    char string[10] = {0}; 
-    char fieldValueString[10] = {0}; 
-    char tareString[10] = {0}; 
-    uint8_t wordC = 0x20; 
-    int32_t dp = SCALE_GetDp(scale.currInc); 
-    
-    if (dp < 1)
-        dp = 0; 
-    CONT_BuildContinousOutputString(&scale, pString); 
-    if (type == ASCII_QUANTITY_OF_ANIMAL)
-        *(pString + 1) = 0x2A; 
-    pString += 3; 
-    memset(pString, 0, 15); 
-    
-    if (SCALE_CheckScaleStatus(&scale) == SCALE_IN_EXPAND)
-        wordC |= 0x10; 
-    if (g_bPrintRequest)
-        wordC |= 0x04; 
-    switch (type)
+    char status[4];
+    char field[12];
+    // FormatOutputWeightString() takes a modifiable source
+    char net[12];
+    char tare[12];
+    int32_t validLen;
+
+    RB_STRING_strncpymax(net, pWeight->netString, sizeof(net));
+    RB_STRING_strncpymax(tare, pWeight->tareString, sizeof(tare));
+
+    if (pCh->assignment == COMASSIGNMENT_EXTENDEDCONTINUOUSOUTPUT)
     {
-        case ASCII_QUANTITY_OF_ANIMAL:
+        buildExtendedStatus(pScale, status);
+        CONT_SetBytes(pCh, 2, status, 4);
+
+        if (strcmp(pCh->netSource, net) != 0)
         {
-            wordC |= 0x01; 
-            *pString++ = wordC; 
-            RB_FORMAT_ULong(string, g_DynamicWeighing.animalNumber, 6); 
-            RB_STRING_AlignRight(string, 6); 
-            RB_STRING_strncpymax(pString, string, 7); 
-            break;
+            FormatOutputWeightString(net, field, CONT_EXT_NET_LEN, true, true);
+            CONT_SetBytes(pCh, CONT_EXT_NET_POS, field, CONT_EXT_NET_LEN);
+            RB_STRING_strncpymax(pCh->netSource, net, sizeof(pCh->netSource));
         }
-        
-        case ASCII_AVERAGE_WEIGHT_PER_ANIMAL:
+        if (strcmp(pCh->tareSource, tare) != 0)
         {
-            wordC |= 0x02; 
-            *pString++ = wordC; 
-            if (m_DynamicApplet_Status == DYNAMICAPPLET_SHOWAVEWEIGHT 
-                    || (m_PreviousDynamicApplet_Status == DYNAMICAPPLET_SHOWAVEWEIGHT && (m_DynamicApplet_Status == DYNAMICAPPLET_ENTERDATA || m_DynamicApplet_Status == DYNAMICAPPLET_ENTERID)))
+            FormatOutputWeightString(tare, field, CONT_EXT_TARE_LEN, true, true);
+            CONT_SetBytes(pCh, CONT_EXT_TARE_POS, field, CONT_EXT_TARE_LEN);
+            RB_STRING_strncpymax(pCh->tareSource, tare, sizeof(pCh->tareSource));
+        }
+    }
+    else
+    {
+        buildStatusWord(pScale, status);
+        CONT_SetBytes(pCh, 1, status, 3);
+
+        if (pCh->assignment == COMASSIGNMENT_KINGBIRDCONTINUOUSOUTPUT)
+        {
+            // the leading zeros follow capacity and increment
+            validLen = caculatevalidlenth(pScale);
+            if (validLen != pCh->validLen)
             {
-                RB_FORMAT_Double(string, dp, (float64)(g_DynamicWeighing.averageWeight), 10);
-                FormatOutputWeightString(string, fieldValueString, 6, false, false);
-                RB_STRING_strncpymax(pString, fieldValueString, 7);
+                pCh->validLen = validLen;
+                pCh->netSource[0] = '\0';
+                pCh->tareSource[0] = '\0';
             }
+        }
+        if (strcmp(pCh->netSource, net) != 0)
+        {
+            if (pCh->assignment == COMASSIGNMENT_8142CONTINUOUSOUTPUT)
+                FormatOutputWeightString8142(net, field, CONT_STD_FIELD_LEN, false, false);
+            else if (pCh->assignment == COMASSIGNMENT_KINGBIRDCONTINUOUSOUTPUT)
+                FormatOutputWeightStringKingbird(net, field, CONT_STD_FIELD_LEN, false, false, pCh->validLen);
             else
-            {
-                RB_STRING_strncpymax(pString, "      ", 7);
-            }
-            break;
+                FormatOutputWeightString(net, field, CONT_STD_FIELD_LEN, false, false);
+            CONT_SetBytes(pCh, CONT_STD_NET_POS, field, CONT_STD_FIELD_LEN);
+            RB_STRING_strncpymax(pCh->netSource, net, sizeof(pCh->netSource));
         }
-        
-        case ASCII_AVERAGE_TOTAL_WEIGHT:
+        if (strcmp(pCh->tareSource, tare) != 0)
         {
-            wordC |= 0x03; 
-            *pString++ = wordC; 
-            if (m_DynamicApplet_Status == DYNAMICAPPLET_SHOWAVEWEIGHT 
-                    || (m_PreviousDynamicApplet_Status == DYNAMICAPPLET_SHOWAVEWEIGHT && (m_DynamicApplet_Status == DYNAMICAPPLET_ENTERDATA || m_DynamicApplet_Status == DYNAMICAPPLET_ENTERID)))
-            {
-                RB_FORMAT_Double(string, dp, (float64)(g_DynamicWeighing.totalWeight), 10);
-                FormatOutputWeightString(string, fieldValueString, 6, false, false);
-                RB_STRING_strncpymax(pString, fieldValueString, 7);
-            }
+            if (pCh->assignment == COMASSIGNMENT_8142CONTINUOUSOUTPUT)
+                FormatOutputWeightString8142(tare, field, CONT_STD_FIELD_LEN, false, false);
+            else if (pCh->assignment == COMASSIGNMENT_KINGBIRDCONTINUOUSOUTPUT)
+                FormatOutputWeightStringKingbird(tare, field, CONT_STD_FIELD_LEN, false, false, pCh->validLen);
             else
-            {
-                RB_STRING_strncpymax(pString, "      ", 7);
-            }
-            break;
+                FormatOutputWeightString(tare, field, CONT_STD_FIELD_LEN, false, false);
+            CONT_SetBytes(pCh, CONT_STD_TARE_POS, field, CONT_STD_FIELD_LEN);
+            RB_STRING_strncpymax(pCh->tareSource, tare, sizeof(pCh->tareSource));
         }
     }
-    
-    pString += 6; 
-    FormatOutputWeightString(pScale->tareString, tareString, 6, false,false);
-    RB_STRING_strncpymax(pString, tareString, 7);
-    pString += 6;
-    *pString++ = RB_ASCII_CR;
-    buildChecksum(pOutString);
+    // checksum: 2's complement of the 7 bit sum of all bytes before it
+    pCh->frame[pCh->frameLen] = (char)((uint8_t)(0 - pCh->sum) & 0x7F);
 }
 
-/****************************************************************************
-New continus out put process
-
-*****************************************************************************/
-//--------------------------------------------------------------------------------------------
-// Com1 Continus out put
-//--------------------------------------------------------------------------------------------
-static void COM1ContinusOutPutProcess(void)
-{  
-  
-   char outBuf[30] = {0};
-   int  sendlenth = 0;
-   if ( scale.setupCOM1Assignment == COMASSIGNMENT_CONTINUOUSOUTPUT ) 
-   {
-       CONT_BuildContinousOutputString(&scale, outBuf);
-       sendlenth = 17; 
-   }
-   if ( scale.setupCOM1Assignment == COMASSIGNMENT_8142CONTINUOUSOUTPUT )
-   {
-       CONT8142_BuildContinousOutputString(&scale, outBuf);
-       sendlenth = 17;
-   }
-   if ( scale.setupCOM1Assignment == COMASSIGNMENT_KINGBIRDCONTINUOUSOUTPUT )
-   {
-       CONTKingbird_BuildContinousOutputString(&scale, outBuf);
-       sendlenth = 17;
-   }
-   if ( scale.setupCOM1Assignment == COMASSIGNMENT_EXTENDEDCONTINUOUSOUTPUT )
-   {
-       CONT_BuildContinuousExtendedOutputString(&scale, outBuf, 0x31);
-       sendlenth = 24;
-   }   
-
-  //confirm the send string lenth
-   if( scale.setupCOM1AssignmentChecksum &&(sendlenth != 0))
-       sendlenth += 1; // have checksum, string lenth +1;
- ///////////////////////////////////////////////////////////////////////////////
- // animal output process ,it is different compare with the above 
-   if (scale.setupCOM1Assignment == COMASSIGNMENT_MULTI1)
-   {
-     static CON1_DATA_TYPE multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous1OutputString(&scale, outBuf, multiCon1type);
-     sendlenth = 18;
-     multiCon1type++; 
-     if (multiCon1type > ASCII_AVERAGE_TOTAL_WEIGHT)
-         multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     
-   }
-   
-   if(scale.setupCOM1Assignment == COMASSIGNMENT_MULTI2)
-   {
-     static CON1_DATA_TYPE multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous2OutputString(&scale, outBuf, multiCon2type); 
-     sendlenth = 18;
-     multiCon2type++; 
-     if (multiCon2type > ASCII_AVERAGE_TOTAL_WEIGHT)
-     multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-   }
-   
-   if(sendlenth == 0)   // no continus out put return
-     return ;
-   
-  // then config the IO status ,via COM1 slect rs422 rs232 rs485
-  //if RS485 , set IO pin output
-   if( scale.setupCOM1InterFace == 2) //485
-   {
-       RB_GPIO_SetPin(RB_CONFIG_GPIO_422_RX_EN,1);  // RS485 receiving disable
-       RB_GPIO_SetPin(RB_CONFIG_GPIO_422_TX_EN,1);  //
-   }
-   else
-   {
-       RB_GPIO_SetPin(RB_CONFIG_GPIO_422_RX_EN,0);  // RS485 receiving enable
-	   RB_GPIO_SetPin(RB_CONFIG_GPIO_422_TX_EN,1);  //RS422  send enable
-   }
-   if ( RB_DEVICE_GetUsedSendBufferSpace(hostChannels[0]) == 0 )     // no more characters in send buffer
-       RB_DEVICE_Send(hostChannels[0], outBuf, sendlenth);
-   
-   
-}
-//--------------------------------------------------------------------------------------------
-//COM2 Continus out put
-//--------------------------------------------------------------------------------------------
-static void COM2ContinusOutPutProcess(void)
+/**---------------------------------------------------------------------
+ * Name         : CONT_Send
+ * Description  : hand the frame of this cycle to the DMA, a frame still
+ *                waiting for the transmitter is replaced by the new one
+ * Prototype in :
+ * \param       : port---SendCom() port
+ * \return      : none
+ *---------------------------------------------------------------------*/
+static void CONT_Send(int port)
 {
-  
-   char outBuf[30] = {0};
-   int  sendlenth = 0;
-   if ( scale.setupCOM2Assignment == COMASSIGNMENT_CONTINUOUSOUTPUT ) 
-   {
-       CONT_BuildContinousOutputString(&scale, outBuf);
-       sendlenth = 17; 
-   }
-   if ( scale.setupCOM2Assignment == COMASSIGNMENT_8142CONTINUOUSOUTPUT )
-   {
-       CONT8142_BuildContinousOutputString(&scale, outBuf);
-       sendlenth = 17;
-   }
-   if ( scale.setupCOM2Assignment == COMASSIGNMENT_KINGBIRDCONTINUOUSOUTPUT )
-   {
-       CONTKingbird_BuildContinousOutputString(&scale, outBuf);
-       sendlenth = 17;
-   }
-   if ( scale.setupCOM2Assignment == COMASSIGNMENT_EXTENDEDCONTINUOUSOUTPUT )
-   {
-       CONT_BuildContinuousExtendedOutputString(&scale, outBuf, 0x31);
-       sendlenth = 24;
-   }
-  //confirm the send string lenth
-   if( scale.setupCOM2AssignmentChecksum &&(sendlenth != 0))
-       sendlenth += 1; // have checksum, string lenth +1;
-   ///////////////////////////////////////////////////////////////////////////////
- // animal output process ,it is different compare with the above 
-   if (scale.setupCOM2Assignment == COMASSIGNMENT_MULTI1)
-   {
-     static CON1_DATA_TYPE multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous1OutputString(&scale, outBuf, multiCon1type);
-     sendlenth = 18;
-     multiCon1type++; 
-     if (multiCon1type > ASCII_AVERAGE_TOTAL_WEIGHT)
-         multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     
-   }
-   if(scale.setupCOM2Assignment == COMASSIGNMENT_MULTI2)
-   {
-     static CON1_DATA_TYPE multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous2OutputString(&scale, outBuf, multiCon2type); 
-     sendlenth = 18;
-     multiCon2type++; 
-     if (multiCon2type > ASCII_AVERAGE_TOTAL_WEIGHT)
-     multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-   }
-   
-    if(sendlenth == 0)   // no continus out put return
-     return ;
-   
-  // then config the IO status ,via COM1 slect  rs232 rs485
-  //if RS485 , set IO pin output
-   if( scale.setupCOM2InterFace == 1) //485
-   {
-       RB_GPIO_SetPin(RB_CONFIG_GPIO_RS485_EN,1);
-   }
-   if ( RB_DEVICE_GetUsedSendBufferSpace(hostChannels[1]) == 0 )     // no more characters in send buffer
-       RB_DEVICE_Send(hostChannels[1], outBuf, sendlenth);
-   
-   
+    CONT_tChannel *pCh = &contChannel[port];
+    int8_t buf;
+
+    taskENTER_CRITICAL();
+    pCh->txPending = -1;
+    buf = (pCh->txActive == 0) ? 1 : 0;
+    taskEXIT_CRITICAL();
+
+    // neither sent nor pending, the interrupt does not touch it
+    pCh->txLen[buf] = pCh->frameLen + (pCh->bChecksum ? 1 : 0);
+    memcpy(pCh->txBuf[buf], pCh->frame, pCh->txLen[buf]);
+
+    taskENTER_CRITICAL();
+    if ((pCh->txActive < 0) && (SendComDMA(port, (uint8_t *)pCh->txBuf[buf], pCh->txLen[buf]) == HAL_OK))
+        pCh->txActive = buf;
+    else
+        pCh->txPending = buf;       // started by CONT_TxComplete()
+    taskEXIT_CRITICAL();
 }
-//--------------------------------------------------------------------------------------------
-//Ethernet Continus out put,include WIFI
-//--------------------------------------------------------------------------------------------
-static void EthernetCountinusOutPutProcess(void)
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : CONT_Init
+ * Description  : read the COM assignments and prepare the frames,
+ *                called by main() and by CONT_Process() after
+ *                CONT_RequestInit()
+ * Prototype in : ContOut.h
+ * \param       : none
+ * \return      : none
+ *---------------------------------------------------------------------*/
+void CONT_Init(void)
 {
-  
-  char outBuf[30] = {0};
-  int  sendlenth = 0;
-  if( (OPTION2 != APPL_CONFIG_OPRIONBOARD_ETHERNET)&&(OPTION2 != APPL_CONFIG_OPRIONBOARD_WIFI) )  //no ethernet option board
-      return ;
-  if ( scale.setupEthernetAssignment == COMASSIGNMENT_CONTINUOUSOUTPUT )
-  {
-     CONT_BuildContinousOutputString(&scale, outBuf);
-     sendlenth = 17;
-  }
-  if ( scale.setupEthernetAssignment == COMASSIGNMENT_8142CONTINUOUSOUTPUT )
-  {
-    CONT8142_BuildContinousOutputString(&scale, outBuf);
-    sendlenth = 17;
-  }
-   if ( scale.setupEthernetAssignment == COMASSIGNMENT_KINGBIRDCONTINUOUSOUTPUT )
-   {
-       CONTKingbird_BuildContinousOutputString(&scale, outBuf);
-       sendlenth = 17;
-   }
-  if ( scale.setupEthernetAssignment == COMASSIGNMENT_EXTENDEDCONTINUOUSOUTPUT )
-  {
-     CONT_BuildContinuousExtendedOutputString(&scale, outBuf, 0x31);  
-     sendlenth = 24;
-  }
-  if (scale.setupEthernetChecksum &&(sendlenth != 0)) 
-    sendlenth++; // have checksum, string lenth +1;
-   ///////////////////////////////////////////////////////////////////////////////
- // animal output process ,it is different compare with the above 
-   if (scale.setupEthernetAssignment == COMASSIGNMENT_MULTI1)
-   {
-     static CON1_DATA_TYPE multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous1OutputString(&scale, outBuf, multiCon1type);
-     sendlenth = 18;
-     multiCon1type++; 
-     if (multiCon1type > ASCII_AVERAGE_TOTAL_WEIGHT)
-         multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     
-   }
-   if(scale.setupEthernetAssignment == COMASSIGNMENT_MULTI2)
-   {
-     static CON1_DATA_TYPE multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous2OutputString(&scale, outBuf, multiCon2type); 
-     sendlenth = 18;
-     multiCon2type++; 
-     if (multiCon2type > ASCII_AVERAGE_TOTAL_WEIGHT)
-     multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-   }
-   //
-   if(sendlenth == 0)   // no continus out put return
-     return ;
-   if (ethernetCheckSocketConnection())
-   {
-        if (RB_DEVICE_GetUsedSendBufferSpace(hostChannels[3]) == 0)
+    CONT_tChannel *pCh;
+    uint8_t assignment, checksum;
+    bool bAssigned = false;
+    int port, i;
+
+    for (port = 0; port < CONT_CHANNEL_NUM; port++)
+    {
+        pCh = &contChannel[port];
+        assignment = COMASSIGNMENT_NONE;
+        checksum = 0;
+        USER_PARAM_Get(contAssignmentParam[port], &assignment);
+        USER_PARAM_Get(contChecksumParam[port], &checksum);
+
+        switch (assignment)
         {
-            if ( resetSocket )
-            {
-                ResetSocketFunCancel();
-            }            
-            RB_DEVICE_Send(hostChannels[3], outBuf, sendlenth);      
+            case COMASSIGNMENT_CONTINUOUSOUTPUT:
+            case COMASSIGNMENT_8142CONTINUOUSOUTPUT:
+            case COMASSIGNMENT_KINGBIRDCONTINUOUSOUTPUT:
+            case COMASSIGNMENT_EXTENDEDCONTINUOUSOUTPUT:
+                break;
+            default:
+                assignment = COMASSIGNMENT_NONE;
+                break;
         }
-   }
-    else
-        showErrorMessage((char *)getTextString(TID_NO_SOCKET_CONNECTION), NORMAL_INTERVAL); 
 
-}
+        // stop the output while the frame is rebuilt, a running DMA frame is finished
+        pCh->assignment = COMASSIGNMENT_NONE;
+        pCh->txPending = -1;
+        if (assignment == COMASSIGNMENT_NONE)
+            continue;
 
-//--------------------------------------------------------------------------------------------
-//EternetPrintClint continus output process
-//-------------------------------------------------------------------------------------------
-static void EthernetPrintClintCoutProcess(void)
-{
-  
-    char outBuf[30] = {0};
-  int  sendlenth = 0;
-  if( (OPTION2 != APPL_CONFIG_OPRIONBOARD_ETHERNET)&&(OPTION2 != APPL_CONFIG_OPRIONBOARD_WIFI) )  //no ethernet option board
-      return ;
-  if ( scale.setupEthernetPrintClientAssignment == COMASSIGNMENT_CONTINUOUSOUTPUT )
-  {
-     CONT_BuildContinousOutputString(&scale, outBuf);
-     sendlenth = 17;
-  }
-  if ( scale.setupEthernetPrintClientAssignment == COMASSIGNMENT_8142CONTINUOUSOUTPUT )
-  {
-    CONT8142_BuildContinousOutputString(&scale, outBuf);
-    sendlenth = 17;
-  }
-   if ( scale.setupEthernetPrintClientAssignment == COMASSIGNMENT_KINGBIRDCONTINUOUSOUTPUT )
-   {
-       CONTKingbird_BuildContinousOutputString(&scale, outBuf);
-       sendlenth = 17;
-   }
-  if ( scale.setupEthernetPrintClientAssignment == COMASSIGNMENT_EXTENDEDCONTINUOUSOUTPUT )
-  {
-     CONT_BuildContinuousExtendedOutputString(&scale, outBuf, 0x31);  
-     sendlenth = 24;
-  }
-  if (scale.setupEthernetPrintClientChecksum &&(sendlenth != 0)) 
-    sendlenth++; // have checksum, string lenth +1;
-   ///////////////////////////////////////////////////////////////////////////////
- // animal output process ,it is different compare with the above 
-   if (scale.setupEthernetPrintClientAssignment == COMASSIGNMENT_MULTI1)
-   {
-     static CON1_DATA_TYPE multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous1OutputString(&scale, outBuf, multiCon1type);
-     sendlenth = 18;
-     multiCon1type++; 
-     if (multiCon1type > ASCII_AVERAGE_TOTAL_WEIGHT)
-         multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     
-   }
-   if(scale.setupEthernetPrintClientAssignment == COMASSIGNMENT_MULTI2)
-   {
-     static CON1_DATA_TYPE multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous2OutputString(&scale, outBuf, multiCon2type); 
-     sendlenth = 18;
-     multiCon2type++; 
-     if (multiCon2type > ASCII_AVERAGE_TOTAL_WEIGHT)
-     multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-   }
-   //
-   if(sendlenth == 0)   // no continus out put return
-     return ;
-   if (ethernetCheckSocketConnection())
-   {
-        if (RB_DEVICE_GetUsedSendBufferSpace(hostChannels[3]) == 0)
+        memset(pCh->frame, ' ', sizeof(pCh->frame));
+        if (assignment == COMASSIGNMENT_EXTENDEDCONTINUOUSOUTPUT)
         {
-            if ( resetSocket )
-            {
-                ResetSocketFunCancel();
-            }            
-            RB_DEVICE_Send(hostChannels[3], outBuf, sendlenth);      
+            pCh->frameLen = CONT_EXT_FRAME_LEN;
+            pCh->frame[0] = RB_ASCII_SOH;
+            pCh->frame[1] = CONT_EXT_ADDRESS;
         }
-   }
+        else
+        {
+            pCh->frameLen = CONT_STD_FRAME_LEN;
+            pCh->frame[0] = RB_ASCII_STX;
+        }
+        pCh->frame[pCh->frameLen - 1] = RB_ASCII_CR;
+        pCh->sum = 0;
+        for (i = 0; i < pCh->frameLen; i++)
+            pCh->sum += (uint8_t)pCh->frame[i];
+
+        // the fields are formatted in the first cycle
+        pCh->netSource[0] = '\0';
+        pCh->tareSource[0] = '\0';
+        pCh->validLen = -1;
+        pCh->bChecksum = (checksum != 0);
+        pCh->assignment = assignment;
+        bAssigned = true;
+    }
+
+    // no work in the weight cycles without a continuous output
+    if (bAssigned)
+        WBUS_Subscribe(&weightSub, "CONT", 1, WBUS_SUB_STRINGS);
     else
-        showErrorMessage((char *)getTextString(TID_NO_SOCKET_CONNECTION), NORMAL_INTERVAL); 
-   
+        WBUS_Unsubscribe(&weightSub);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : CONT_RequestInit
+ * Description  : the assignment parameters changed, CONT_Process() calls
+ *                CONT_Init() in the next weight cycle. For the tasks
+ *                other than WeighProcessTask, which owns the frames
+ * Prototype in : ContOut.h
+ * \param       : none
+ * \return      : none
+ *---------------------------------------------------------------------*/
+void CONT_RequestInit(void)
+{
+    bContInitRequest = true;
 }
-//--------------------------------------------------------------------------------------------
-//USB COM Continus Out put
-//--------------------------------------------------------------------------------------------
-static void USBContinusOutPutProcess(void)
+
+/**---------------------------------------------------------------------
+ * Name         : CONT_Process
+ * Description  : send one frame on every continuous output port, called
+ *                by WeighProcessTask after SCALE_PostProcess()
+ * Prototype in : ContOut.h
+ * \param       : none
+ * \return      : none
+ *---------------------------------------------------------------------*/
+void CONT_Process(void)
 {
-  
-  char outBuf[30] = {0};
-  int  sendlenth = 0;
-  if((OPTION1 != APPL_CONFIG_OPRIONBOARD_USB)&&(OPTION1 != APPL_CONFIG_OPRIONBOARD_USB_DIO)) //no USB option board
-    return ;
-  if ( scale.setupUSBAssignment == COMASSIGNMENT_CONTINUOUSOUTPUT )
-  {
-      CONT_BuildContinousOutputString(&scale, outBuf);
-      sendlenth = 17;
-  }
-  if(scale.setupUSBAssignment == COMASSIGNMENT_8142CONTINUOUSOUTPUT)
-  {
-      CONT8142_BuildContinousOutputString(&scale, outBuf);
-      sendlenth = 17;
-  }
-   if ( scale.setupUSBAssignment == COMASSIGNMENT_KINGBIRDCONTINUOUSOUTPUT )
-   {
-       CONTKingbird_BuildContinousOutputString(&scale, outBuf);
-       sendlenth = 17;
-   }
-  if(scale.setupUSBAssignment == COMASSIGNMENT_EXTENDEDCONTINUOUSOUTPUT)
-  {
-     CONT_BuildContinuousExtendedOutputString(&scale, outBuf, 0x31);
-     sendlenth = 24;
-  }
-   if (scale.setupUSBAssignmentChecksum &&(sendlenth != 0))
-     sendlenth++;
-      
-     ///////////////////////////////////////////////////////////////////////////////
- // animal output process ,it is different compare with the above 
-   if (scale.setupUSBAssignment == COMASSIGNMENT_MULTI1)
-   {
-     static CON1_DATA_TYPE multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous1OutputString(&scale, outBuf, multiCon1type);
-     sendlenth = 18;
-     multiCon1type++; 
-     if (multiCon1type > ASCII_AVERAGE_TOTAL_WEIGHT)
-         multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     
-   }
-   if(scale.setupUSBAssignment == COMASSIGNMENT_MULTI2)
-   {
-     static CON1_DATA_TYPE multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous2OutputString(&scale, outBuf, multiCon2type); 
-     sendlenth = 18;
-     multiCon2type++; 
-     if (multiCon2type > ASCII_AVERAGE_TOTAL_WEIGHT)
-     multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-   } 
-    if(sendlenth == 0)   // no continus out put return
-      return ;
-  if (RB_DEVICE_GetUsedSendBufferSpace(hostChannels[1]) == 0)     // no more characters in send buffer
-     RB_DEVICE_Send(hostChannels[1], outBuf, sendlenth);
-  
+    const WBUS_tWeight *pWeight;
+    int port;
+
+    if (bContInitRequest)
+    {
+        bContInitRequest = false;
+        CONT_Init();
+    }
+    pWeight = WBUS_Take(&weightSub);
+    if (pWeight == NULL)
+        return;
+    for (port = 0; port < CONT_CHANNEL_NUM; port++)
+    {
+        if (contChannel[port].assignment == COMASSIGNMENT_NONE)
+            continue;
+        CONT_UpdateFrame(&contChannel[port], &g_ScaleData, pWeight);
+        CONT_Send(port);
+    }
+    WBUS_Release(pWeight);
 }
-//-------------------------------------------------------------------------------------------- 
-//bluetooth continus out put
-//--------------------------------------------------------------------------------------------
-static void BluetoothContinusOutPutProcess()
+
+/**---------------------------------------------------------------------
+ * Name         : CONT_TxComplete
+ * Description  : transmission on a port finished, start the pending
+ *                frame, called by HAL_UART_TxCpltCallback()
+ * Prototype in : ContOut.h
+ * \param       : port---SendCom() port
+ * \return      : none
+ *---------------------------------------------------------------------*/
+void CONT_TxComplete(int port)
 {
-  
-  char outBuf[30] = {0};
-  int  sendlenth = 0;
-  if(OPTION2 != APPL_CONFIG_OPRIONBOARD_BLUETOOTH) //no Blutooth board
-    return ;
-  
-  if ( scale.setupBTAssignment == COMASSIGNMENT_CONTINUOUSOUTPUT )
-  {
-      CONT_BuildContinousOutputString(&scale, outBuf);
-      sendlenth = 17;
-  }
-  if ( scale.setupBTAssignment == COMASSIGNMENT_8142CONTINUOUSOUTPUT )
-  {
-    CONT8142_BuildContinousOutputString(&scale, outBuf);
-    sendlenth = 17;
-  }
-   if ( scale.setupBTAssignment == COMASSIGNMENT_KINGBIRDCONTINUOUSOUTPUT )
-   {
-       CONTKingbird_BuildContinousOutputString(&scale, outBuf);
-       sendlenth = 17;
-   }
-  if ( scale.setupBTAssignment == COMASSIGNMENT_EXTENDEDCONTINUOUSOUTPUT)
-  {
-    CONT_BuildContinuousExtendedOutputString(&scale, outBuf, 0x31);
-    sendlenth = 24;
-  }
-  if (scale.setupBTAssignmentChecksum &&(sendlenth != 0))
-    sendlenth++;
-       ///////////////////////////////////////////////////////////////////////////////
- // animal output process ,it is different compare with the above 
-   if (scale.setupBTAssignment == COMASSIGNMENT_MULTI1)
-   {
-     static CON1_DATA_TYPE multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous1OutputString(&scale, outBuf, multiCon1type);
-     sendlenth = 18;
-     multiCon1type++; 
-     if (multiCon1type > ASCII_AVERAGE_TOTAL_WEIGHT)
-         multiCon1type = ASCII_QUANTITY_OF_ANIMAL; 
-     
-   }
-   if(scale.setupBTAssignment == COMASSIGNMENT_MULTI2)
-   {
-     static CON1_DATA_TYPE multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-     buildMultiContinous2OutputString(&scale, outBuf, multiCon2type); 
-     sendlenth = 18;
-     multiCon2type++; 
-     if (multiCon2type > ASCII_AVERAGE_TOTAL_WEIGHT)
-     multiCon2type = ASCII_QUANTITY_OF_ANIMAL; 
-   } 
-   if(sendlenth == 0)   // no continus out put, return
-     return ;
-  if ((RB_DEVICE_GetUsedSendBufferSpace(hostChannels[2]) == 0) && BTconnectflag)     // no more characters in send buffer
-     RB_DEVICE_Send(hostChannels[2], outBuf, sendlenth);
-  
+    CONT_tChannel *pCh;
+    int8_t buf;
+
+    if ((port < 0) || (port >= CONT_CHANNEL_NUM))
+        return;
+    pCh = &contChannel[port];
+    pCh->txActive = -1;
+    buf = pCh->txPending;
+    if ((buf >= 0) && (SendComDMA(port, (uint8_t *)pCh->txBuf[buf], pCh->txLen[buf]) == HAL_OK))
+    {
+        pCh->txActive = buf;
+        pCh->txPending = -1;
+    }
 }
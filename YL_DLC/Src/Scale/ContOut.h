@@ -1,17 +1,15 @@
 #ifndef _CONT_OUT_H
 #define _CONT_OUT_H
 
-#include "RB_Type.h"
-typedef enum
-{
-    ASCII_QUANTITY_OF_ANIMAL  = 1,    
-    ASCII_AVERAGE_WEIGHT_PER_ANIMAL,
-    ASCII_AVERAGE_TOTAL_WEIGHT,
-}CON1_DATA_TYPE;
+#include "Scale.h"
 
+//! continuous output channels, indexed like the SendCom() port: 0 = COM1 (USART1), 1 = COM2 (USART2)
+#define CONT_CHANNEL_NUM        2
 
-//extern void continuousOutput_Process(void);
-extern void ContinusOutPutProcess(void);
+extern void CONT_Init(void);
+extern void CONT_RequestInit(void);
+extern void CONT_Process(void);
+extern void CONT_TxComplete(int port);
 extern uint8_t buildContinuousOutputWordA(SCALE *pScale);
 
 #endif
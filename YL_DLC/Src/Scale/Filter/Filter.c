@@ -50,9 +50,11 @@
 //#include "sd_index.h"
 
 #include "UserParam.h"
+#include "filter.h"
 #include <stdint.h>
+#include <string.h>
 
-#define MAX_NOTCH_SAMPLE	40  // ݲﻬƽ峤ȣ֪ͨͲƵʹã
+#define MAX_NOTCH_SAMPLE	FILTER_NOTCH_SAMPLES  // ݲﻬƽ峤ȣ֪ͨͲƵʹã
 #define MAX_FILTER_NO		28   //
 
 // *****************************************
@@ -126,7 +128,7 @@ low pass filters provided. Index 0 = no filter, higher indicies provide
 stiffer filters. Cutoff frequency in Hz is provided in the comments,
 assuming a sampling frequency of 366.0 Hz.
 ***********************************************************************/
-extern const float filt_pct_choices[MAX_FILTER_NO+1]
+const float filt_pct_choices[MAX_FILTER_NO+1]
 = {
 	  10.00,    /*  0  no filter, but 32X gain included. */
 	   7.96,    /*  1  29.13 Hz */
@@ -504,4 +506,41 @@ double lowpass_filter( double x)
 }
 
 
+//***************************************************************************
+// filter history for the warm start
+//
+//	get_filter_state	copy the history, call between two execute_filter()
+//	set_filter_state	continue with a saved history, the settings of
+//						initialize_filter() must be the same
+//
+//returns       1 = history restored, 0 = other filter settings
+//***************************************************************************
+void get_filter_state(FILTER_STATE *pState)
+{
+	memcpy(pState->prev_y, prev_y, sizeof(prev_y));
+	memcpy(pState->prev_v, prev_v, sizeof(prev_v));
+	memcpy(pState->notchFifo, notchFifo, sizeof(notchFifo));
+	pState->notch_sum = notch_sum;
+	pState->head_ptr = head_ptr;
+	pState->tail_ptr = tail_ptr;
+	pState->filtno = filtno;
+	pState->halfpoles = halfpoles;
+	pState->notch_filter_type = notch_filter_type;
+	pState->notchSample = notchSample;
+}
 
+int set_filter_state(const FILTER_STATE *pState)
+{
+	if ((pState->filtno != filtno) || (pState->halfpoles != halfpoles)
+		|| (pState->notch_filter_type != notch_filter_type) || (pState->notchSample != notchSample)
+		|| (pState->head_ptr >= MAX_NOTCH_SAMPLE) || (pState->tail_ptr >= MAX_NOTCH_SAMPLE))
+		return 0;
+
+	memcpy(prev_y, pState->prev_y, sizeof(prev_y));
+	memcpy(prev_v, pState->prev_v, sizeof(prev_v));
+	memcpy(notchFifo, pState->notchFifo, sizeof(notchFifo));
+	notch_sum = pState->notch_sum;
+	head_ptr = pState->head_ptr;
+	tail_ptr = pState->tail_ptr;
+	return 1;
+}
@@ -23,45 +23,8 @@
 //#define MAX_FILTER_NO		            28
 //#define DEFAULT_NOTCH_FILTER_FREQ		30.0
 
-/***********************************************************************
-filter percent choices is an indexed table, which gives the approximate
-cutoff frequency in percent (cutoff_freq/sampling_freq) for each of the
-low pass filters provided. Index 0 = no filter, higher indicies provide
-stiffer filters. Cutoff frequency in Hz is provided in the comments,
-assuming a sampling frequency of 366.0 Hz.
-***********************************************************************/
-const float filt_pct_choices[MAX_FILTER_NO+1] =
-{
-	  10.00,    /*  0  no filter, but 32X gain included. */
-	   7.96,    /*  1  29.13 Hz */
-	   6.96,    /*  2  25.47 Hz */
-	   5.97,    /*  3  21.85 Hz */
-	   4.97,    /*  4  18.19 Hz */
-	   4.48,    /*  5  16.40 Hz */
-	   3.98,    /*  6  14.57 Hz */
-	   3.48,    /*  7  12.74 Hz */
-	   2.98,    /*  8  10.91 Hz */
-	   2.49,    /*  9   9.11 Hz */
-	   2.24,    /* 10   8.20 Hz */
-	   1.99,    /* 11   7.28 Hz */
-	   1.74,    /* 12   6.39 Hz */
-	   1.49,    /* 13   5.45 Hz */
-	   1.24,    /* 14   4.54 Hz */
-	   1.12,    /* 15   4.10 Hz */
-	   0.99,    /* 16   3.62 Hz */
-	   0.87,    /* 17   3.18 Hz */
-	   0.75,    /* 18   2.75 Hz */
-	   0.62,    /* 19   2.27 Hz */
-	   0.56,    /* 20   2.05 Hz */
-	   0.50,    /* 21   1.83 Hz */
-	   0.44,    /* 22   1.61 Hz */
-	   0.37,    /* 23   1.35 Hz */
-	   0.31,    /* 24   1.13 Hz */
-	   0.25,    /* 25   0.92 Hz */
-	   0.19,    /* 26   0.70 Hz */
-	   0.12,    /* 27   0.44 Hz */
-	   0.06     /* 28   0.22 Hz */
-};
+// filter percent choices, the table of Filter.c
+extern const float filt_pct_choices[MAX_FILTER_NO+1];
 
 //==================================================================================================
 //  L O C A L   V A R I A B L E S
@@ -643,7 +606,7 @@ static void lowpass_filter(FILTER *this)
     // add rounding: filcnt = op1 + .5
 	// addround(&filcnt, &filcnt);
     this->filcnt.df = this->filcnt.df + 0x8000;
-    if (this->filcnt.df < this->filcnt.df)
+    if (this->filcnt.df < 0x8000)
         this->filcnt.ul++;
 }
 
@@ -1,7 +1,26 @@
 #ifndef H_FILTER2
 #define H_FILTER2
 
+#define FILTER_NOTCH_SAMPLES	40
+
+//! history of the low pass and notch filter, see get_filter_state()
+typedef struct
+{
+	double prev_y[5];
+	double prev_v[5];
+	double notchFifo[FILTER_NOTCH_SAMPLES];
+	double notch_sum;
+	unsigned char head_ptr, tail_ptr;
+	// settings of initialize_filter() the history belongs to
+	char filtno;
+	char halfpoles;
+	unsigned char notch_filter_type;
+	unsigned char notchSample;
+} FILTER_STATE;
+
 extern void initialize_filter(void);
 extern double execute_filter(unsigned long ATDreading);
+extern void get_filter_state(FILTER_STATE *pState);
+extern int set_filter_state(const FILTER_STATE *pState);
 
-#endif 
+#endif
@@ -206,7 +206,7 @@ void MOTION_Calibrate(MOTION *this, float countsPerD)
  *---------------------------------------------------------------------*/
 void MOTION_ProcessMotion(MOTION *this, long counts)
 {
-	bool oldMotion;
+	bool oldMotion = this->inMotionFlag;
 	long maxReading, minReading;
 	int  i;
 
@@ -31,14 +31,23 @@
 
 //#include "Tare.h"
 #include "UserParam.h"
+#include "Trace.h"
+#include "WeightBus.h"
+#include "DebugLog.h"
 
 #include "stm32f1xx_hal.h"
+#include "cmsis_os.h"
 #include "RB_Format.h"
 #include "RB_String.h"
 //==================================================================================================
 //  M A C R O   D E F I N E
 //==================================================================================================
 #define ERROR 0.0000001
+
+// the display strings are formatted by the task that reads them, the weigh task must not change
+// the weights meanwhile. The scheduler is locked only, interrupts stay enabled.
+#define SCALE_STRING_LOCK()     vTaskSuspendAll()
+#define SCALE_STRING_UNLOCK()   ((void)xTaskResumeAll())
 //==================================================================================================
 //  G L O B A L   V A R I A B L E S
 //==================================================================================================
@@ -117,6 +126,8 @@ const double geoTable[] =
 
 static const uint8_t noMotionInterval[] = {3, 5, 7, 10}; 
 
+static const char *SCALE_RefreshDisplayString(SCALE *this, SCALE_tWeightString which);
+
 //==================================================================================================
 //  G L O B A L   F U N C T I O N    D E C L A R A T I O N
 //==================================================================================================
@@ -129,7 +140,7 @@ extern void caculateprecentageload();
 //==================================================================================================
 //  S T A T I C   F U N C T I O N    D E C L A R A T I O N
 //==================================================================================================
-static uint8_t SCALE_CalcWeightStringLength(char *stringPtr);
+static uint8_t SCALE_CalcWeightStringLength(const char *stringPtr);
 //==================================================================================================
 //  G L O B A L   F U N C T I O N    I M P L E M E N T A T I O N
 //==================================================================================================
@@ -272,6 +283,7 @@ void SCALE_Init(SCALE *Pscale)
 	Pscale->bZeroCommand = 0;
 	Pscale->bTareCommand = 0;
 	Pscale->programmableTare = -1.0;
+	Pscale->presetTareCommand = 0.0f;
 	Pscale->numberRanges = ONE_RANGE;
 	Pscale->currentRange = 0;
     // 
@@ -371,6 +383,7 @@ void SCALE_PostProcess(SCALE *this, long filteredCounts)
     SCALESTATUS scaleStatus; 
     
     
+	TRACE_START(TRACE_STAGE_MOTION);
 	/* process unit switch command*/
 	SCALE_SwitchUnits(this);
 	
@@ -381,7 +394,9 @@ void SCALE_PostProcess(SCALE *this, long filteredCounts)
 	/*motion process*/
 	MOTION_ProcessMotion((this->motion), filteredCounts);
 	bMotion = MOTION_GetMotion((this->motion));
+	TRACE_STOP(TRACE_STAGE_MOTION);
     
+	TRACE_START(TRACE_STAGE_ZERO);
 	/*power up zero capture*/
 	ZERO_ProcessPowerupZero((this->zero), filteredCounts,bMotion);
     
@@ -406,6 +421,7 @@ void SCALE_PostProcess(SCALE *this, long filteredCounts)
 	            this->increaseZeroCommandCounter();
 	        zeroCommandSource = COMMAND_NONE; 
 			this->bZeroCommand = 0;//2009-4-1 14:07 lxw add to make the 3s in motion valid
+			DLOG(DLOG_ZERO, this->zero->zeroScaleStatus, filteredCounts);
 			if (this->zero->underzeroWait && (this->zero->zeroScaleStatus == ZERO_SUCCESS))
 			    this->zero->underzeroWait = false; 
 	    }
@@ -422,8 +438,10 @@ void SCALE_PostProcess(SCALE *this, long filteredCounts)
     
  	/*adjust counts for current zero, include AZM, zero subtraction, COZ and under zero process*/
 	relCounts = ZERO_ProcessZero((this->zero), filteredCounts, netMode, this->currentRange,bMotion);
+	TRACE_STOP(TRACE_STAGE_ZERO);
     
 	
+	TRACE_START(TRACE_STAGE_LINEAR);
     /*linearity compensation*/
 	switch (this->upScaleTestPoint)
 	{
@@ -444,7 +462,9 @@ void SCALE_PostProcess(SCALE *this, long filteredCounts)
 		this->fineGrossWeight = UNIT_ConvertUnitType((this->unit), this->unit->calUnitType, this->unit->currUnitType, this->fineGrossWeight);		    
 	}
 	this->roundedGrossWeight = SCALE_RoundedWeight(this->fineGrossWeight, this->currInc);
+	TRACE_STOP(TRACE_STAGE_LINEAR);
     
+	TRACE_START(TRACE_STAGE_TARE);
     // over capacity check
 	if ((this->fineGrossWeight > this->overCapWeight) || (this->fineGrossWeight > SCALECAPACITYLIMIT))
 	{
@@ -511,9 +531,16 @@ void SCALE_PostProcess(SCALE *this, long filteredCounts)
 			displayTareOperationErrorMessage(); 
 			this->bTareCommand = 0; 
 			tareCommandSource = COMMAND_NONE; 
+			DLOG(DLOG_TARE, this->tare->tareScaleStatus, filteredCounts);
 		}
 	}
     
+	// the preset tare is only written here, the interfaces set the command
+	if (this->presetTareCommand > 0.0f)
+	{
+	    this->programmableTare = this->presetTareCommand;
+	    this->presetTareCommand = 0.0f;
+	}
 	if (this->programmableTare > 0.0)
 	{
 	    if (this->market == MARKET_ARGENTINA)
@@ -607,22 +634,19 @@ void SCALE_PostProcess(SCALE *this, long filteredCounts)
     //    if (currWeight > peakWeight)
     //        accessBRAMParameters(STATISTICSPEAKWEIGHTADDRESS, (uint8_t *)&currWeight, 4, WRITEOPERATION); 
 	
+	TRACE_STOP(TRACE_STAGE_TARE);
+	
 	/* autoprint process*/
     //	AUTOPRINT_AutoPrint(&(this->autoPrint), this->roundedGrossWeight, this->unit.currUnitType,bMotion);
 	
-	// Make display strings of weights
-    //	currUnit = UNIT_GetUnit(&(this->unit), this->unit.currUnitType); 
-    //	SCALE_FormatDisplayWeight(this->grossString, &(this->roundedGrossWeight), this->currInc, this->currMiniDisplayInc, currUnit);
-    SCALE_FormatDisplayWeight(this->grossString, &(this->roundedGrossWeight), this);
-    //	if(scale.numberRanges == TWO_INTERVALS)
-    //	  SCALE_FormatDisplayTare(this->tareString, &(this->roundedTareWeight), oldroundincr);
-    //	else
-    //	 SCALE_FormatDisplayWeight(this->tareString, &(this->roundedTareWeight), this->currInc, this->currMiniDisplayInc, currUnit);
-    SCALE_FormatDisplayWeight(this->tareString, &(this->roundedTareWeight), this);
-	
-    //	SCALE_FormatDisplayWeight(this->netString, &(this->roundedNetWeight), this->currInc, this->currMiniDisplayInc, currUnit);
-    SCALE_FormatDisplayWeight(this->netString, &(this->roundedNetWeight), this);
+	// Display strings of weights are made by SCALE_CopyDisplayString() when they are read,
+	// only the tare string is checked here, it is formatted again only if the tare changed
+	TRACE_START(TRACE_STAGE_FORMAT);
 	SCALE_AffirmWeightString(this); 
+	TRACE_STOP(TRACE_STAGE_FORMAT);
+
+	// snapshot of this weight cycle for the outputs
+	WBUS_Publish(this);
 	//caculate precentage of each loadcell
     //XHT_2018
     //	caculateprecentageload();
@@ -1210,6 +1234,26 @@ int32_t SCALE_GetIncrIndex(float incr)
     return -1;
 }
 
+/**---------------------------------------------------------------------
+* Name         : SCALE_WeightMantissa
+* Description  : scale the weight to an integer with dp decimal places,
+*				  rounded half away from zero like RB_FORMAT_Double()
+* Prototype in : Scale.c
+* \param    	: weight---weight value
+* \param    	: dp---decimal places, 0..CONFIG_MAX_WT_DIGITS
+* \return    	: weight * 10^dp
+*---------------------------------------------------------------------*/
+static int64_t SCALE_WeightMantissa(double weight, int dp)
+{
+    double scaled = fabs(weight);
+    int64_t mantissa;
+
+    while (dp-- > 0)
+        scaled *= 10.0;
+    mantissa = (int64_t)floor(scaled + 0.5);
+    return (weight < 0.0) ? -mantissa : mantissa;
+}
+
 /**---------------------------------------------------------------------
 * Name         : SCALE_FormatDisplayWeight
 * Description  : Format the weight value to string to display according
@@ -1287,7 +1331,9 @@ void SCALE_FormatDisplayWeight(char *pWeightString, double *pWeight, SCALE *Ptrs
     		}
     		// sprintf (weightFormat, "%%%bd.%bdf", j, i);
     		// sprintf(weightString, weightFormat, *weightPtr);
-            RB_FORMAT_Double((char *)pWeightString, i, *pWeight, j);
+            // the weight is already rounded to the increment, the digits are written from the
+            // scaled integer without the float digit loop of RB_FORMAT_Double()
+            RB_FORMAT_Fixed((char *)pWeightString, SCALE_WeightMantissa(*pWeight, i), i, j);
             
             // MT_ftoa(*weightPtr, weightString, i);
     	}
@@ -1366,9 +1412,9 @@ void SCALE_FormatDisplayTare(char *pWeightString, double *pWeight, double currIn
 * \param    	: *stringPtr---pointer to weight string
 * \return    	: string length
 *---------------------------------------------------------------------*/
-static uint8_t SCALE_CalcWeightStringLength(char *stringPtr)
+static uint8_t SCALE_CalcWeightStringLength(const char *stringPtr)
 {
-    char * weightString = stringPtr; 
+    const char * weightString = stringPtr; 
     uint8_t length = 0; 
     
     while(*weightString == ' ')
@@ -1380,55 +1426,95 @@ static uint8_t SCALE_CalcWeightStringLength(char *stringPtr)
 
 /**---------------------------------------------------------------------
 * Name         : SCALE_AffirmWeightString
-* Description  : judge if the weight string too long to display
+* Description  : judge if the tare string too long to display, the tare
+*                is cleared then. Gross and net strings are not made
+*                here, nobody may read them.
 * Prototype in : 
 * \param    	: *this---pointer to SCALE struct
-* \return    	: none
+* \return    	: true if the tare string is too long
 *---------------------------------------------------------------------*/
 bool SCALE_AffirmWeightString(SCALE *this)
 {
-    bool error = false;
-    bool weightStringInvalid ;
-    uint8_t length = 0, limit;
+    bool weightStringInvalid = false;
+    uint8_t length = 0;
     
-    length = SCALE_CalcWeightStringLength(this->tareString);
+    SCALE_STRING_LOCK();
+    length = SCALE_CalcWeightStringLength(SCALE_RefreshDisplayString(this, SCALE_STRING_TARE));
+    SCALE_STRING_UNLOCK();
     if (length > 7)
-        error = true;
-    if (error)
     {
         weightStringInvalid = true;
         this->bClearCommand = 1;
-        //        return weightStringInvalid ;
     }    
     
-    length = SCALE_CalcWeightStringLength(this->grossString); 
-    if (this->roundedGrossWeight > -NEAR_ZERO)
-        limit = 7;
-    else
-        limit = 8;
-    if (length > limit)
-        error = true;
-    if (error)
+    return weightStringInvalid;
+}
+
+/**---------------------------------------------------------------------
+* Name         : SCALE_RefreshDisplayString
+* Description  : format a display string again if its weight, the
+*                increment, the unit or the expand display changed
+*                since it was made, SCALE_STRING_LOCK() must be held
+* Prototype in : 
+* \param    	: *this---pointer to SCALE struct
+* \param    	: which---gross, net or tare string
+* \return    	: the string
+*---------------------------------------------------------------------*/
+static const char *SCALE_RefreshDisplayString(SCALE *this, SCALE_tWeightString which)
+{
+    SCALE_tStringKey *pKey = &this->stringKey[which];
+    UNIT_tType unitType = this->unit->currUnitType;
+    double *pWeight;
+    char *pString;
+
+    switch (which)
     {
-        weightStringInvalid = true;
-        //        return weightStringInvalid;
+        case SCALE_STRING_NET:
+            pWeight = &(this->roundedNetWeight);
+            pString = this->netString;
+            break;
+        case SCALE_STRING_TARE:
+            pWeight = &(this->roundedTareWeight);
+            pString = this->tareString;
+            break;
+        default:
+            pWeight = &(this->roundedGrossWeight);
+            pString = this->grossString;
+            break;
     }
-    
-    length = SCALE_CalcWeightStringLength(this->netString); 
-    if (this->roundedNetWeight > -NEAR_ZERO)
-        limit = 7;
-    else
-        limit = 8;
-    if (length > limit)
-        error = true;
-    if (error)
+
+    if (!pKey->bValid || (pKey->weight != *pWeight) || (pKey->inc != this->currInc)
+        || (pKey->miniInc != this->currMiniDisplayInc) || (pKey->unitType != unitType)
+        || (pKey->bExpand != this->bExpandDisplay))
     {
-        weightStringInvalid = true;
-        //        return weightStringInvalid;
+        SCALE_FormatDisplayWeight(pString, pWeight, this);
+        pKey->weight   = *pWeight;
+        pKey->inc      = this->currInc;
+        pKey->miniInc  = this->currMiniDisplayInc;
+        pKey->unitType = unitType;
+        pKey->bExpand  = this->bExpandDisplay;
+        pKey->bValid   = true;
     }
-    
-    //    weightStringInvalid = false;
-    return weightStringInvalid;
+    return pString;
+}
+
+/**---------------------------------------------------------------------
+* Name         : SCALE_CopyDisplayString
+* Description  : copy the display string of the gross, net or tare
+*                weight of the latest weight cycle, it is formatted only
+*                if the cached string is out of date
+* Prototype in : Scale.h
+* \param    	: *this---pointer to SCALE struct
+* \param    	: which---gross, net or tare string
+* \param    	: *pDest---destination, size---size of pDest
+* \return    	: pDest
+*---------------------------------------------------------------------*/
+char *SCALE_CopyDisplayString(SCALE *this, SCALE_tWeightString which, char *pDest, size_t size)
+{
+    SCALE_STRING_LOCK();
+    RB_STRING_strncpymax(pDest, SCALE_RefreshDisplayString(this, which), size);
+    SCALE_STRING_UNLOCK();
+    return pDest;
 }
 
 /**---------------------------------------------------------------------
@@ -1564,6 +1650,13 @@ void SCALE_GetWeight(SCALE *this, WEIGHT *pWeight)
 *---------------------------------------------------------------------*/
 void SCALE_GetWeightString(SCALE *this, WEIGHT_STRING *pWeightString)
 {
+	// the strings stay valid until another task makes them again, use SCALE_CopyDisplayString()
+	// outside of the weigh task
+	SCALE_STRING_LOCK();
+	SCALE_RefreshDisplayString(this, SCALE_STRING_GROSS);
+	SCALE_RefreshDisplayString(this, SCALE_STRING_NET);
+	SCALE_RefreshDisplayString(this, SCALE_STRING_TARE);
+	SCALE_STRING_UNLOCK();
 	pWeightString->pGrossString = this->grossString;
 	pWeightString->pNetString   = this->netString;
 	pWeightString->pTareString  = this->tareString;
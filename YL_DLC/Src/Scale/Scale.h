@@ -32,6 +32,26 @@ typedef enum
   CAL_INITSPAN
 } INIT_MODE; 
 
+//! display weight strings, formatted on demand by SCALE_CopyDisplayString()
+typedef enum
+{
+    SCALE_STRING_GROSS = 0,
+    SCALE_STRING_NET,
+    SCALE_STRING_TARE,
+    SCALE_STRING_NUM
+} SCALE_tWeightString;
+
+//! values a cached display string was formatted with
+typedef struct
+{
+    double     weight;
+    double     inc;
+    double     miniInc;
+    UNIT_tType unitType;
+    bool       bExpand;
+    bool       bValid;
+} SCALE_tStringKey;
+
 
 
 typedef union
@@ -102,6 +122,8 @@ typedef struct ScaleData
 	double oneD[3];
 	double overCapWeight;
 	double programmableTare;
+	float presetTareCommand;            // > 0 = preset tare of a remote interface, a single store that
+	                                    // SCALE_PostProcess() takes over into programmableTare
 
 	#if CONFIG_MAX_UPSCALE_TEST_POINT == 1
     double countsPerCalUnit[1];
@@ -152,6 +174,7 @@ typedef struct ScaleData
 	char      grossString[12];    // printable gross weight string.	    
 	char      netString[12];      // printable net weight string.
 	char      tareString[12];     // printable tare weight string.
+	SCALE_tStringKey stringKey[SCALE_STRING_NUM]; // cache key of grossString, netString, tareString
 
 	double   linearityFactor[CONFIG_MAX_UPSCALE_TEST_POINT-1];    // second-order linearity
 							// adjustment factor.
@@ -296,6 +319,7 @@ int32_t SCALE_GetIncrIndex(float incr);
 int32_t SCALE_GetDp(float incr);
 void SCALE_GetWeight(SCALE *this, WEIGHT *pWeight);
 void SCALE_GetWeightString(SCALE *this, WEIGHT_STRING *pWeightString);
+char *SCALE_CopyDisplayString(SCALE *this, SCALE_tWeightString which, char *pDest, size_t size);
 extern SCALESTATUS SCALE_CheckScaleStatus(SCALE *this); 
 extern void SCALE_ShowScaleStatus(SCALESTATUS scaleStatus); 
 
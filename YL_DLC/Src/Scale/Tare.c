@@ -353,7 +353,9 @@ TARE_SCALE_tStatus TARE_TakeTare(TARE *this, double weight)
 //    	    this->fineTareWeight = SCALE_RoundedWeight(weight, SCALE_GetIncrementByWeight(this->pScale, weight));
     }
     else
+    {
     	this->fineTareWeight = weight;
+    }
 	this->tareChangedFlag = 5;
 	/*Save current tare parameters for restart   03-march-09  lxw*/
 	 this->pScale->currentTareWeight = this->fineTareWeight;//save for next power up lxw
@@ -403,7 +405,7 @@ TARE_SCALE_tStatus Pre_TARE_TakeTare(TARE *this, double weight)
 	}
     this->tareTakenFlag = 1;
     this->tareMode = 'N';
-    if (this->pScale->market == MARKET_CANADA && this->pScale->bLegalForTrade || (this->pScale->market == MARKET_USA_NTEP) ) 
+    if ((this->pScale->market == MARKET_CANADA && this->pScale->bLegalForTrade) || (this->pScale->market == MARKET_USA_NTEP) ) 
     {   // in Canada, tare must be rounded to nearest increment 
 //        if (selectedApplet == APPLCONFIG_APPL_COUNTINGWEIGHING)
 //            this->fineTareWeight = weight; 
@@ -413,7 +415,9 @@ TARE_SCALE_tStatus Pre_TARE_TakeTare(TARE *this, double weight)
 //		}
     }
     else
+    {
     	this->fineTareWeight = weight;
+    }
 	this->tareChangedFlag = 5;
 	/*Save current tare parameters for restart   03-march-09  lxw*/
 	 this->pScale->currentTareWeight = this->fineTareWeight;
@@ -818,6 +822,9 @@ void TARE_SetKeyboardTare(TARE *this, int type, double weight, double incr)
 			case TARING_WHEN_POWER_UP_ZERO_NOT_CAPTURED:
 
 			    break;
+
+			default:
+			    break;
 	    }
 	}
 }
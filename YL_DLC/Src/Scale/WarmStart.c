@@ -0,0 +1,337 @@
+//==================================================================================================
+//                                          Rainbow
+//==================================================================================================
+//
+//! \file			IND245/scale/WarmStart.c
+//! \ingroup	IND245_scale
+//! \brief		keep the weighing state across a reset without power loss
+//!
+//! The snapshot is taken by ADC_ProcessTask between two execute_filter() calls, the scheduler is
+//! suspended while the state of the weight cycle is copied. WARM_Init() runs before HAL_Init(),
+//! when the TIM1 tick has not yet overwritten the time of the reset in warmAliveTick. The slots
+//! are checked by WARM_Restore() with the full clock.
+//!
+//==================================================================================================
+//==================================================================================================
+//  I N C L U D E D   F I L E S
+//==================================================================================================
+#include <stddef.h>
+#include <string.h>
+#include "stm32f1xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "RB_CRC.h"
+#include "Scale.h"
+#include "WarmStart.h"
+#include "BootTime.h"
+
+//==================================================================================================
+//  L O C A L   D E F I N I T I O N S
+//==================================================================================================
+
+#define WARM_MAGIC              0x57534E50UL    // "WSNP"
+
+#ifdef __ICCARM__
+#define WARM_NO_INIT            __no_init
+#else
+#define WARM_NO_INIT            __attribute__((section(".noinit")))
+#endif
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t size;
+    uint16_t seq;                               // newer slot has the higher number
+    uint32_t tick;                              // WARM_GetTick() of the snapshot
+    double   filteredCounts;                    // last result of execute_filter()
+    FILTER_STATE filter;
+    JFILTER_STATE stabilityFilter;
+    long     motionBuffer[MOTION_ENTRIES];
+    uint16_t motionWritePointer;
+    uint8_t  bMotion;
+    uint8_t  zeroStatus;
+    uint8_t  powerupZeroStatus;
+    uint8_t  tareMode;
+    uint8_t  tareSource;
+    uint8_t  tareTakenFlag;
+    uint8_t  unitType;                          // unit of the tare weights
+    int32_t  calibratedZeroCounts;              // snapshot of another calibration is not restored
+    int32_t  powerUpZeroCounts;
+    int32_t  currentZeroCounts;
+    uint32_t powerUpZeroDelayCycles;
+    double   fineTareWeight;
+    double   fineStoredWeight;
+    double   currentTareWeight;
+    uint16_t crc;                               // CRC-16/CCITT of all bytes before
+} WARM_tSnapshot;
+
+// not cleared by the startup code, see do not initialize { section .noinit } in the icf file
+static WARM_NO_INIT WARM_tSnapshot warmSnapshot[2];
+static WARM_NO_INIT volatile uint32_t warmAliveTick;
+static WARM_NO_INIT uint32_t warmCount;
+
+static uint32_t warmResetTick = 0;              // warmAliveTick at the reset
+static uint32_t warmTickBase = 0;               // the ticks continue over warm starts
+static uint8_t warmActive = 0;                  // slot of the latest snapshot
+static uint16_t warmSeq = 0;
+static uint8_t warmSaveCount = 0;
+static volatile bool bWarmSaveOff = false;
+static WARM_tStat warmStat;
+
+/**---------------------------------------------------------------------
+ * Name         : WARM_Crc
+ * Description  : CRC of a slot
+ * Prototype in : WarmStart.c
+ * \return    	: CRC-16/CCITT of the bytes before the crc member
+ *---------------------------------------------------------------------*/
+static uint16_t WARM_Crc(const WARM_tSnapshot *p)
+{
+    return (uint16_t)RB_CRC_Calculate((const uint8_t *)p, 0, offsetof(WARM_tSnapshot, crc), &RB_CRC_16_CCITT_CFG);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WARM_IsValid
+ * Description  : check a slot
+ * Prototype in : WarmStart.c
+ * \return    	: true, if the slot holds a complete snapshot
+ *---------------------------------------------------------------------*/
+static bool WARM_IsValid(const WARM_tSnapshot *p)
+{
+    return (p->magic == WARM_MAGIC) && (p->size == sizeof(WARM_tSnapshot)) && (p->crc == WARM_Crc(p));
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WARM_GetTick
+ * Description  : ms time that goes on over warm starts
+ * Prototype in : WarmStart.c
+ * \return    	: ms since the last cold start
+ *---------------------------------------------------------------------*/
+static uint32_t WARM_GetTick(void)
+{
+    return warmTickBase + HAL_GetTick();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WARM_Discard
+ * Description  : mark both slots invalid
+ * Prototype in : WarmStart.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void WARM_Discard(void)
+{
+    warmSnapshot[0].magic = 0;
+    warmSnapshot[1].magic = 0;
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : WARM_Init
+ * Description  : read and clear the reset flags, keep the time of the
+ *                reset. Called first in main(), before HAL_Init()
+ * Prototype in : WarmStart.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void WARM_Init(void)
+{
+    warmStat.resetFlags = RCC->CSR;
+    __HAL_RCC_CLEAR_RESET_FLAGS();
+    warmResetTick = warmAliveTick;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WARM_Restore
+ * Description  : continue with the newest valid snapshot, or discard
+ *                the snapshots for a cold start. Called after the scale
+ *                and the filters are initialized, before the scheduler
+ *                is started
+ * Prototype in : WarmStart.h
+ * \param    	: pFilteredCounts---receives the last filtered counts
+ * \return    	: true, if restored
+ *---------------------------------------------------------------------*/
+bool WARM_Restore(double *pFilteredCounts)
+{
+    SCALE *pScale = &g_ScaleData;
+    const WARM_tSnapshot *p;
+    bool bValid0, bValid1;
+
+    bValid0 = WARM_IsValid(&warmSnapshot[0]);
+    bValid1 = WARM_IsValid(&warmSnapshot[1]);
+    if (bValid0 && bValid1)
+        warmActive = ((int16_t)(warmSnapshot[1].seq - warmSnapshot[0].seq) > 0) ? 1 : 0;
+    else
+        warmActive = bValid1 ? 1 : 0;
+    p = &warmSnapshot[warmActive];
+
+    if (warmStat.resetFlags & RCC_CSR_PORRSTF)
+    {
+        warmStat.result = WARM_POWER_ON;
+        warmCount = 0;
+    }
+    else if (!bValid0 && !bValid1)
+    {
+        warmStat.result = WARM_NO_SNAPSHOT;
+    }
+    else
+    {
+        warmStat.age = warmResetTick - p->tick;
+        if (warmStat.age > WARM_MAX_AGE)
+            warmStat.result = WARM_TOO_OLD;
+        // set_filter_state() checks the filter settings before anything is taken over
+        else if ((p->calibratedZeroCounts != pScale->zero->calibratedZeroCounts) || !set_filter_state(&p->filter))
+            warmStat.result = WARM_SETUP_CHANGED;
+        else
+            warmStat.result = WARM_RESTORED;
+    }
+
+    if (warmStat.result != WARM_RESTORED)
+    {
+        WARM_Discard();
+        return false;
+    }
+
+    // the ticks of the new snapshots continue from the reset
+    warmSeq = p->seq;
+    warmTickBase = warmResetTick;
+
+    StabilityFilterSetState(&p->stabilityFilter);
+    *pFilteredCounts = p->filteredCounts;
+
+    memcpy(pScale->motion->readingsBuffer, p->motionBuffer, sizeof(p->motionBuffer));
+    pScale->motion->bufferWritePointer = (p->motionWritePointer < MOTION_ENTRIES) ? p->motionWritePointer : 0;
+    pScale->motion->inMotionFlag = (bool)p->bMotion;
+
+    ZERO_SetPowerUpZero(pScale->zero, p->powerUpZeroCounts);
+    ZERO_SetCurrentZero(pScale->zero, p->currentZeroCounts);
+    pScale->zero->zeroStatus = (ZERO_tStatus)p->zeroStatus;
+    pScale->zero->powerupZeroStatus = (POWERUP_ZERO_tStatus)p->powerupZeroStatus;
+    pScale->zero->powerUpZeroDelayCycles = p->powerUpZeroDelayCycles;
+
+    // the unit is not kept, the tare is dropped if it was taken in the other unit
+    if ((p->tareMode == 'N') && (p->unitType == (uint8_t)pScale->unit->currUnitType))
+    {
+        pScale->tare->tareMode = p->tareMode;
+        pScale->tare->fineTareWeight = p->fineTareWeight;
+        pScale->tare->fineStoredWeight = p->fineStoredWeight;
+        pScale->tare->tareTakenFlag = p->tareTakenFlag;
+        pScale->tare->tareChangedFlag = 5;
+        pScale->currentTareWeight = p->currentTareWeight;
+        TARE_SetTareSource(pScale->tare, p->tareSource);
+    }
+
+    warmCount++;
+    warmStat.restoreUs = get_time_us();
+    return true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WARM_Tick
+ * Description  : keep the time of a reset, called by the 1 ms tick
+ * Prototype in : WarmStart.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void WARM_Tick(void)
+{
+    warmAliveTick = WARM_GetTick();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WARM_Save
+ * Description  : write a snapshot every WARM_SAVE_SAMPLES calls, called
+ *                by ADC_ProcessTask after execute_filter()
+ * Prototype in : WarmStart.h
+ * \param    	: filteredCounts---result of execute_filter()
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void WARM_Save(double filteredCounts)
+{
+    SCALE *pScale = &g_ScaleData;
+    WARM_tSnapshot *p;
+
+    if (bWarmSaveOff || (++warmSaveCount < WARM_SAVE_SAMPLES))
+        return;
+    warmSaveCount = 0;
+
+    // the older slot, invalid until the CRC is written
+    p = &warmSnapshot[warmActive ^ 1];
+    p->magic = 0;
+
+    // zero, tare and the stability filter are changed by the weight cycle and the commands
+    vTaskSuspendAll();
+    p->tick = WARM_GetTick();
+    p->filteredCounts = filteredCounts;
+    get_filter_state(&p->filter);
+    StabilityFilterGetState(&p->stabilityFilter);
+    memcpy(p->motionBuffer, pScale->motion->readingsBuffer, sizeof(p->motionBuffer));
+    p->motionWritePointer = pScale->motion->bufferWritePointer;
+    p->bMotion = pScale->motion->inMotionFlag;
+    p->zeroStatus = (uint8_t)pScale->zero->zeroStatus;
+    p->powerupZeroStatus = (uint8_t)pScale->zero->powerupZeroStatus;
+    p->calibratedZeroCounts = pScale->zero->calibratedZeroCounts;
+    p->powerUpZeroCounts = pScale->zero->powerUpZeroCounts;
+    p->currentZeroCounts = pScale->zero->currentZeroCounts;
+    p->powerUpZeroDelayCycles = pScale->zero->powerUpZeroDelayCycles;
+    p->tareMode = pScale->tare->tareMode;
+    p->tareSource = pScale->tare->tareSource;
+    p->tareTakenFlag = pScale->tare->tareTakenFlag;
+    p->unitType = (uint8_t)pScale->unit->currUnitType;
+    p->fineTareWeight = pScale->tare->fineTareWeight;
+    p->fineStoredWeight = pScale->tare->fineStoredWeight;
+    p->currentTareWeight = pScale->currentTareWeight;
+    xTaskResumeAll();
+
+    p->size = sizeof(WARM_tSnapshot);
+    p->seq = ++warmSeq;
+    p->magic = WARM_MAGIC;
+    p->crc = WARM_Crc(p);
+    if (!bWarmSaveOff)
+        warmActive ^= 1;
+    else
+        p->magic = 0;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WARM_Invalidate
+ * Description  : next start is a cold start, called before a reset
+ *                that must run the power up sequence
+ * Prototype in : WarmStart.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void WARM_Invalidate(void)
+{
+    bWarmSaveOff = true;
+    WARM_Discard();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WARM_WeightCycle
+ * Description  : record the time of the first valid weight, called by
+ *                WeighProcessTask after SCALE_PostProcess()
+ * Prototype in : WarmStart.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void WARM_WeightCycle(void)
+{
+    if ((warmStat.firstValidUs == 0) && ZERO_GetPowerUpZeroCaptured(g_ScaleData.zero)
+        && !MOTION_GetMotion(g_ScaleData.motion))
+    {
+        warmStat.firstValidUs = get_time_us();
+        BOOT_Stamp(BOOT_STAGE_WEIGHT);
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WARM_GetStat
+ * Description  : result of the last start
+ * Prototype in : WarmStart.h
+ * \param    	: pStat---destination
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void WARM_GetStat(WARM_tStat *pStat)
+{
+    *pStat = warmStat;
+    pStat->warmCount = warmCount;
+}
@@ -0,0 +1,48 @@
+#ifndef _WARM_START_H
+#define _WARM_START_H
+
+#include "comm.h"
+
+//==================================================================================================
+//  Warm start after a reset without power loss (watchdog, reset pin, software reset)
+//
+//  ADC_ProcessTask keeps a snapshot of the filter histories, the motion buffer, the current zero,
+//  the power up zero state and the tare in RAM that is not initialized by the startup code. Two
+//  slots are written alternately, a reset during a save leaves the other slot valid. After a reset
+//  the newest slot with valid CRC is restored if it was not older than WARM_MAX_AGE at the reset,
+//  the weight is valid in the first weight cycle instead of after the power up zero delay.
+//==================================================================================================
+
+//! ADC samples between two snapshots
+#define WARM_SAVE_SAMPLES       8
+//! ms from the last snapshot to the reset, older snapshots are not restored
+#define WARM_MAX_AGE            500
+
+typedef enum
+{
+    WARM_RESTORED = 0,
+    WARM_POWER_ON,                  // RAM contents lost
+    WARM_NO_SNAPSHOT,               // no slot with valid CRC, or invalidated before the reset
+    WARM_TOO_OLD,                   // last snapshot older than WARM_MAX_AGE at the reset
+    WARM_SETUP_CHANGED              // other calibrated zero or filter setting
+} WARM_tResult;
+
+typedef struct
+{
+    uint32_t resetFlags;            // RCC->CSR of the reset
+    WARM_tResult result;
+    uint32_t age;                   // ms from the snapshot to the reset
+    uint32_t warmCount;             // warm starts since power on
+    uint32_t restoreUs;             // get_time_us() of the restore
+    uint32_t firstValidUs;          // get_time_us() of the first stable weight with zero captured, 0 = none yet
+} WARM_tStat;
+
+void WARM_Init(void);
+bool WARM_Restore(double *pFilteredCounts);
+void WARM_Tick(void);
+void WARM_Save(double filteredCounts);
+void WARM_Invalidate(void);
+void WARM_WeightCycle(void);
+void WARM_GetStat(WARM_tStat *pStat);
+
+#endif
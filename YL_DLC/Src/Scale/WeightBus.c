@@ -0,0 +1,356 @@
+#include "main.h"
+#include "cmsis_os.h"
+
+#include "WeightBus.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+// CONT_Init() subscribes before the scheduler runs, taskENTER_CRITICAL() would leave the
+// interrupts masked until then
+#define WBUS_LOCK()             do { if (osKernelRunning()) taskENTER_CRITICAL(); } while (0)
+#define WBUS_UNLOCK()           do { if (osKernelRunning()) taskEXIT_CRITICAL(); } while (0)
+
+//! the snapshot MUST be the first member, WBUS_Release() gets the slot from it
+typedef struct
+{
+    WBUS_tWeight weight;
+    uint8_t      refCount;          // latest + pending + held, 0 = free
+} WBUS_tSlot;
+
+static WBUS_tSlot slot[WBUS_SLOTS];
+static WBUS_tSubscriber *subscriber[WBUS_MAX_SUBSCRIBERS];
+// latest snapshot, holds a reference, NULL before the first weight cycle
+static WBUS_tSlot *pLatest = NULL;
+static uint32_t publishSeq = 0;
+// counts of the weight cycle, set before SCALE_PostProcess()
+static double cycleFilteredCounts = 0.0;
+static double cycleStableCounts = 0.0;
+
+/**---------------------------------------------------------------------
+ * Name         : WBUS_Unref
+ * Description  : give back one reference of a slot, called locked
+ * Prototype in : WeightBus.c
+ * \param    	: pWeight---snapshot, NULL is ignored
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void WBUS_Unref(const WBUS_tWeight *pWeight)
+{
+    WBUS_tSlot *pSlot = (WBUS_tSlot *)pWeight;
+
+    if ((pSlot != NULL) && (pSlot->refCount > 0))
+        pSlot->refCount--;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WBUS_Changed
+ * Description  : WBUS_SUB_ON_CHANGE: compare with the last due snapshot
+ *                of the subscriber and remember the new one, called
+ *                locked
+ * Prototype in : WeightBus.c
+ * \param    	: pSub---subscriber
+ *                pWeight---new snapshot
+ * \return    	: true = changed or first snapshot
+ *---------------------------------------------------------------------*/
+static bool WBUS_Changed(WBUS_tSubscriber *pSub, const WBUS_tWeight *pWeight)
+{
+    if (pSub->bLastValid
+        && (pSub->lastNet == pWeight->net)
+        && (pSub->lastTare == pWeight->tare)
+        && (pSub->lastInc == pWeight->inc)
+        && (pSub->lastUnitType == pWeight->unitType)
+        && (pSub->lastStatus == pWeight->status))
+        return false;
+
+    pSub->lastNet = pWeight->net;
+    pSub->lastTare = pWeight->tare;
+    pSub->lastInc = pWeight->inc;
+    pSub->lastUnitType = pWeight->unitType;
+    pSub->lastStatus = pWeight->status;
+    pSub->bLastValid = true;
+    return true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WBUS_GetStatus
+ * Description  : WBUS_STAT_xxx of the scale
+ * Prototype in : WeightBus.c
+ * \param    	: pScale---scale
+ * \return    	: status bits
+ *---------------------------------------------------------------------*/
+static uint16_t WBUS_GetStatus(SCALE *pScale)
+{
+    uint16_t status = 0;
+
+    if (MOTION_GetMotion(pScale->motion))
+        status |= WBUS_STAT_MOTION;
+    if (TARE_GetTareMode(pScale->tare) == 'N')
+        status |= WBUS_STAT_NET;
+    if (pScale->bOverCapacity)
+        status |= WBUS_STAT_OVER;
+    if (ZERO_GetUnderZero(pScale->zero))
+        status |= WBUS_STAT_UNDER;
+    if (ZERO_GetCenterOfZero(pScale->zero))
+        status |= WBUS_STAT_COZ;
+    if (ZERO_GetPowerUpZeroCaptured(pScale->zero))
+        status |= WBUS_STAT_ZERO_CAPTURED;
+    if (pScale->bExpandDisplay)
+        status |= WBUS_STAT_EXPAND;
+    if (pScale->bZeroCommand || pScale->bTareCommand || pScale->bClearCommand)
+        status |= WBUS_STAT_COMMAND;
+    return status;
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : WBUS_Subscribe
+ * Description  : subscribe to the weight updates, or change the rate
+ *                of a subscriber; the first due snapshot is the one of
+ *                the next weight cycle
+ * Prototype in : WeightBus.h
+ * \param    	: pSub---control block, static, owned by the subscriber
+ *                name---for the diagnostics
+ *                decimation---every n-th weight cycle, 0 is taken as 1
+ *                flags---WBUS_SUB_xxx
+ * \return    	: false = WBUS_MAX_SUBSCRIBERS reached
+ *---------------------------------------------------------------------*/
+bool WBUS_Subscribe(WBUS_tSubscriber *pSub, const char *name, uint16_t decimation, uint16_t flags)
+{
+    int i, freeIndex = -1;
+    bool bResult = true;
+
+    WBUS_LOCK();
+    for (i = 0; i < WBUS_MAX_SUBSCRIBERS; i++)
+    {
+        if (subscriber[i] == pSub)
+            break;
+        if ((subscriber[i] == NULL) && (freeIndex < 0))
+            freeIndex = i;
+    }
+    if (i == WBUS_MAX_SUBSCRIBERS)
+    {
+        // new subscriber
+        if (freeIndex < 0)
+        {
+            bResult = false;
+        }
+        else
+        {
+            pSub->pPending = NULL;
+            pSub->delivered = 0;
+            pSub->replaced = 0;
+            subscriber[freeIndex] = pSub;
+        }
+    }
+    if (bResult)
+    {
+        pSub->name = name;
+        pSub->decimation = (decimation == 0) ? 1 : decimation;
+        pSub->flags = flags;
+        pSub->cycles = 0;
+        pSub->bLastValid = false;
+    }
+    WBUS_UNLOCK();
+    return bResult;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WBUS_Unsubscribe
+ * Description  : stop the weight updates, a pending snapshot is given
+ *                back; a snapshot taken before must still be released
+ * Prototype in : WeightBus.h
+ * \param    	: pSub---subscriber, not subscribed is ignored
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void WBUS_Unsubscribe(WBUS_tSubscriber *pSub)
+{
+    int i;
+
+    WBUS_LOCK();
+    for (i = 0; i < WBUS_MAX_SUBSCRIBERS; i++)
+    {
+        if (subscriber[i] == pSub)
+        {
+            subscriber[i] = NULL;
+            WBUS_Unref(pSub->pPending);
+            pSub->pPending = NULL;
+        }
+    }
+    WBUS_UNLOCK();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WBUS_SetCounts
+ * Description  : counts of this weight cycle for the next snapshot,
+ *                called by the weighing task before SCALE_PostProcess()
+ * Prototype in : WeightBus.h
+ * \param    	: filteredCounts---counts of the ADC filter
+ *                stableCounts---counts after the stability filter
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void WBUS_SetCounts(double filteredCounts, double stableCounts)
+{
+    cycleFilteredCounts = filteredCounts;
+    cycleStableCounts = stableCounts;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WBUS_Publish
+ * Description  : publish the weights of this weight cycle, called by
+ *                SCALE_PostProcess() after the weights are rounded
+ * Prototype in : WeightBus.h
+ * \param    	: pScale---scale
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void WBUS_Publish(SCALE *pScale)
+{
+    WBUS_tSubscriber *due[WBUS_MAX_SUBSCRIBERS];
+    WBUS_tSubscriber *pSub;
+    WBUS_tSlot *pSlot = NULL;
+    WBUS_tWeight *pWeight;
+    bool bStrings = false;
+    int i;
+
+    // one free slot is always there if every subscriber releases what it takes
+    WBUS_LOCK();
+    for (i = 0; i < WBUS_SLOTS; i++)
+    {
+        if (slot[i].refCount == 0)
+        {
+            pSlot = &slot[i];
+            pSlot->refCount = 1;
+            break;
+        }
+    }
+    WBUS_UNLOCK();
+    publishSeq++;
+    if (pSlot == NULL)
+        return;
+
+    pWeight = &pSlot->weight;
+    pWeight->seq = publishSeq;
+    pWeight->timeUs = get_time_us();
+    pWeight->gross = pScale->roundedGrossWeight;
+    pWeight->net = pScale->roundedNetWeight;
+    pWeight->tare = pScale->roundedTareWeight;
+    pWeight->inc = pScale->currInc;
+    pWeight->filteredCounts = cycleFilteredCounts;
+    pWeight->stableCounts = cycleStableCounts;
+    pWeight->unitType = UNIT_GetCurrentUnitType(pScale->unit);
+    pWeight->status = WBUS_GetStatus(pScale);
+    pWeight->netString[0] = '\0';
+    pWeight->tareString[0] = '\0';
+
+    WBUS_LOCK();
+    for (i = 0; i < WBUS_MAX_SUBSCRIBERS; i++)
+    {
+        due[i] = NULL;
+        pSub = subscriber[i];
+        if (pSub == NULL)
+            continue;
+        // an on change subscriber stays due until the weight changes
+        if (pSub->cycles < pSub->decimation)
+            pSub->cycles++;
+        if (pSub->cycles < pSub->decimation)
+            continue;
+        if ((pSub->flags & WBUS_SUB_ON_CHANGE) && !WBUS_Changed(pSub, pWeight))
+            continue;
+        pSub->cycles = 0;
+        due[i] = pSub;
+        if (pSub->flags & WBUS_SUB_STRINGS)
+            bStrings = true;
+    }
+    WBUS_UNLOCK();
+
+    // nobody reads the slot yet, the strings are copied unlocked
+    if (bStrings)
+    {
+        SCALE_CopyDisplayString(pScale, SCALE_STRING_NET, pWeight->netString,
+                                sizeof(pWeight->netString));
+        SCALE_CopyDisplayString(pScale, SCALE_STRING_TARE, pWeight->tareString,
+                                sizeof(pWeight->tareString));
+    }
+
+    WBUS_LOCK();
+    for (i = 0; i < WBUS_MAX_SUBSCRIBERS; i++)
+    {
+        pSub = due[i];
+        // unsubscribed in the meantime
+        if ((pSub == NULL) || (subscriber[i] != pSub))
+            continue;
+        if (pSub->pPending != NULL)
+        {
+            WBUS_Unref(pSub->pPending);
+            pSub->replaced++;
+        }
+        pSub->pPending = pWeight;
+        pSlot->refCount++;
+        pSub->delivered++;
+    }
+    if (pLatest != NULL)
+        WBUS_Unref(&pLatest->weight);
+    pLatest = pSlot;
+    WBUS_UNLOCK();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WBUS_Take
+ * Description  : take the due snapshot of a subscriber
+ * Prototype in : WeightBus.h
+ * \param    	: pSub---subscriber
+ * \return    	: snapshot, to release with WBUS_Release(); NULL = not due
+ *---------------------------------------------------------------------*/
+const WBUS_tWeight *WBUS_Take(WBUS_tSubscriber *pSub)
+{
+    WBUS_tWeight *pWeight;
+
+    // the reference of the pending snapshot goes to the caller
+    WBUS_LOCK();
+    pWeight = pSub->pPending;
+    pSub->pPending = NULL;
+    WBUS_UNLOCK();
+    return pWeight;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WBUS_AcquireLatest
+ * Description  : hold the snapshot of the last weight cycle, for a
+ *                reader without subscription
+ * Prototype in : WeightBus.h
+ * \return    	: snapshot, to release with WBUS_Release(); NULL before
+ *                the first weight cycle
+ *---------------------------------------------------------------------*/
+const WBUS_tWeight *WBUS_AcquireLatest(void)
+{
+    WBUS_tWeight *pWeight = NULL;
+
+    WBUS_LOCK();
+    if ((pLatest != NULL) && (pLatest->refCount < 0xFF))
+    {
+        pLatest->refCount++;
+        pWeight = &pLatest->weight;
+    }
+    WBUS_UNLOCK();
+    return pWeight;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : WBUS_Release
+ * Description  : give back a snapshot of WBUS_Take() or
+ *                WBUS_AcquireLatest()
+ * Prototype in : WeightBus.h
+ * \param    	: pWeight---snapshot, NULL is ignored
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void WBUS_Release(const WBUS_tWeight *pWeight)
+{
+    if (pWeight == NULL)
+        return;
+    WBUS_LOCK();
+    WBUS_Unref(pWeight);
+    WBUS_UNLOCK();
+}
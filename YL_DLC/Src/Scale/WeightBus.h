@@ -0,0 +1,89 @@
+#ifndef _WEIGHT_BUS_H
+#define _WEIGHT_BUS_H
+
+#include "Scale.h"
+
+//==================================================================================================
+//  Weight update topic
+//
+//  SCALE_PostProcess() publishes every weight cycle a snapshot of the weights and the scale status
+//  in a slot of a small pool. The slots are reference counted and handed out by pointer, a reader
+//  never copies a snapshot and never sees it change.
+//
+//  An output subscribes once with its own rate: every n-th cycle, optionally only if the weight,
+//  the unit, the increment or the status changed. WBUS_Take() returns the latest due snapshot or
+//  NULL, an output that was not due does no work at all. A snapshot not taken before the next due
+//  one is replaced. A reader without subscription, e.g. a Modbus request, holds the latest
+//  snapshot with WBUS_AcquireLatest(). Every snapshot received must be given back with
+//  WBUS_Release().
+//
+//  The filtered and the stable counts are doubles, on the Cortex-M3 two loads each: a reader in
+//  another task takes them from the snapshot, never from the globals of the weighing task.
+//
+//  The display strings cost a copy in the weighing task and are only filled in for a subscriber
+//  with WBUS_SUB_STRINGS, they are empty in all other snapshots.
+//==================================================================================================
+
+//! subscribers at the same time
+#define WBUS_MAX_SUBSCRIBERS    4
+//! latest + pending and taken snapshot of every subscriber + WBUS_AcquireLatest() readers
+#define WBUS_SLOTS              (2 * WBUS_MAX_SUBSCRIBERS + 3)
+
+// WBUS_tWeight.status
+#define WBUS_STAT_MOTION        0x0001
+#define WBUS_STAT_NET           0x0002      // tare taken, net mode
+#define WBUS_STAT_OVER          0x0004      // over capacity
+#define WBUS_STAT_UNDER         0x0008      // under zero
+#define WBUS_STAT_COZ           0x0010      // center of zero
+#define WBUS_STAT_ZERO_CAPTURED 0x0020      // power up zero captured
+#define WBUS_STAT_EXPAND        0x0040      // expanded display
+#define WBUS_STAT_COMMAND       0x0080      // zero, tare or clear command in progress
+
+// WBUS_Subscribe() flags
+#define WBUS_SUB_ON_CHANGE      0x0001      // only if weights, unit, increment or status changed
+#define WBUS_SUB_STRINGS        0x0002      // netString and tareString are needed
+
+typedef struct
+{
+    uint32_t   seq;                 // weight cycle, from 1
+    uint32_t   timeUs;              // get_time_us() of the publish
+    double     gross;               // rounded weights in the current unit
+    double     net;
+    double     tare;
+    double     inc;                 // current increment
+    double     filteredCounts;      // raw counts of the weight cycle, WBUS_SetCounts()
+    double     stableCounts;        // after the stability filter
+    UNIT_tType unitType;
+    uint16_t   status;              // WBUS_STAT_xxx
+    char       netString[12];       // display strings, "" without WBUS_SUB_STRINGS
+    char       tareString[12];
+} WBUS_tWeight;
+
+//! subscriber control block, owned by the subscriber
+typedef struct
+{
+    const char   *name;
+    uint16_t     decimation;        // every n-th weight cycle, 1 = every cycle
+    uint16_t     flags;             // WBUS_SUB_xxx
+    uint16_t     cycles;            // weight cycles since the last due one
+    WBUS_tWeight *pPending;         // due snapshot not taken yet
+    // WBUS_SUB_ON_CHANGE: values of the last due snapshot
+    double       lastNet;
+    double       lastTare;
+    double       lastInc;
+    UNIT_tType   lastUnitType;
+    uint16_t     lastStatus;
+    bool         bLastValid;
+    uint32_t     delivered;         // due snapshots
+    uint32_t     replaced;          // due snapshots replaced before they were taken
+} WBUS_tSubscriber;
+
+bool WBUS_Subscribe(WBUS_tSubscriber *pSub, const char *name, uint16_t decimation, uint16_t flags);
+void WBUS_Unsubscribe(WBUS_tSubscriber *pSub);
+void WBUS_SetCounts(double filteredCounts, double stableCounts);
+void WBUS_Publish(SCALE *pScale);
+const WBUS_tWeight *WBUS_Take(WBUS_tSubscriber *pSub);
+const WBUS_tWeight *WBUS_AcquireLatest(void);
+void WBUS_Release(const WBUS_tWeight *pWeight);
+
+#endif
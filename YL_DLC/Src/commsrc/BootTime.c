@@ -0,0 +1,108 @@
+#include "stm32f1xx_hal.h"
+
+#include "BootTime.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+static const char * const stageName[BOOT_STAGE_NUM] =
+{
+    "MAIN", "HAL", "CLOCK", "PERIPH", "PARAM", "SCALE", "SCHED", "ADC", "WEIGHT"
+};
+
+static uint32_t stageUs[BOOT_STAGE_NUM];    // us from the start of main()
+static uint32_t stageDone = 0;              // bit per stage
+
+// last stamp, start of the next interval
+static uint32_t lastCycles;
+static uint32_t lastUs;
+static uint32_t lastTick;
+static uint32_t lastMHz;
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : BOOT_Init
+ * Description  : start the cycle counter, first statement of main()
+ * Prototype in : BootTime.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void BOOT_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    lastCycles = 0;
+    lastUs = 0;
+    lastTick = HAL_GetTick();
+    lastMHz = SystemCoreClock / 1000000;
+    stageUs[BOOT_STAGE_MAIN] = 0;
+    stageDone = 1 << BOOT_STAGE_MAIN;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : BOOT_Stamp
+ * Description  : store the end of a stage, only the first call counts,
+ *                callable from any task
+ * Prototype in : BootTime.h
+ * \param    	: stage---BOOT_STAGE_xxx
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void BOOT_Stamp(BOOT_tStage stage)
+{
+    uint32_t primask, cycles, tick;
+
+    if ((stage >= BOOT_STAGE_NUM) || (stageDone & (1 << stage)))
+        return;
+
+    // the scheduler may not run yet, taskENTER_CRITICAL() would leave the interrupts masked
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (!(stageDone & (1 << stage)))
+    {
+        cycles = DWT->CYCCNT;
+        tick = HAL_GetTick();
+        if (tick - lastTick > BOOT_WRAP_MS)
+            lastUs += (tick - lastTick) * 1000;
+        else
+            lastUs += (cycles - lastCycles) / lastMHz;
+        lastCycles = cycles;
+        lastTick = tick;
+        lastMHz = SystemCoreClock / 1000000;
+        stageUs[stage] = lastUs;
+        stageDone |= 1 << stage;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : BOOT_GetStage
+ * Description  : time of a stage
+ * Prototype in : BootTime.h
+ * \param    	: stage---BOOT_STAGE_xxx, pUs---us from the start of main()
+ * \return    	: false = stage not reached yet
+ *---------------------------------------------------------------------*/
+bool BOOT_GetStage(BOOT_tStage stage, uint32_t *pUs)
+{
+    if ((stage >= BOOT_STAGE_NUM) || !(stageDone & (1 << stage)))
+        return false;
+    *pUs = stageUs[stage];
+    return true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : BOOT_GetStageName
+ * Description  : name of a stage for the command output
+ * Prototype in : BootTime.h
+ * \return    	: name, "" = invalid stage
+ *---------------------------------------------------------------------*/
+const char *BOOT_GetStageName(BOOT_tStage stage)
+{
+    if (stage >= BOOT_STAGE_NUM)
+        return "";
+    return stageName[stage];
+}
@@ -0,0 +1,36 @@
+#ifndef _BOOT_TIME_H
+#define _BOOT_TIME_H
+
+#include "comm.h"
+
+//==================================================================================================
+//  Boot timeline
+//
+//  The DWT cycle counter is started at the top of main(). Every stage stores the time from there
+//  to its end once, the cycles of an interval are converted with the core clock at its start.
+//  Intervals longer than BOOT_WRAP_MS (the counter wraps after 59 s at 72 MHz) are taken from
+//  the HAL tick instead.
+//==================================================================================================
+
+#define BOOT_WRAP_MS            30000
+
+typedef enum
+{
+    BOOT_STAGE_MAIN = 0,            // main() entered
+    BOOT_STAGE_HAL,                 // HAL_Init()
+    BOOT_STAGE_CLOCK,               // SystemClock_Config(), PLL running
+    BOOT_STAGE_PERIPH,              // GPIO, DMA, USART, I2C
+    BOOT_STAGE_PARAM,               // parameter blocks loaded from the eeprom
+    BOOT_STAGE_SCALE,               // scale, filters, continuous output
+    BOOT_STAGE_SCHED,               // first task running
+    BOOT_STAGE_ADC,                 // first filtered ADC sample
+    BOOT_STAGE_WEIGHT,              // first stable weight with power up zero captured
+    BOOT_STAGE_NUM
+} BOOT_tStage;
+
+void BOOT_Init(void);
+void BOOT_Stamp(BOOT_tStage stage);
+bool BOOT_GetStage(BOOT_tStage stage, uint32_t *pUs);
+const char *BOOT_GetStageName(BOOT_tStage stage);
+
+#endif
@@ -0,0 +1,137 @@
+#include "stm32f1xx_hal.h"
+#include "main.h"
+
+#include "DebugLog.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+#define DLOG_MAGIC              0x444C4F47UL    // "DLOG"
+
+#ifdef __ICCARM__
+#define DLOG_NO_INIT            __no_init
+#else
+#define DLOG_NO_INIT            __attribute__((section(".noinit")))
+#endif
+
+typedef struct
+{
+    uint32_t     magic;
+    uint32_t     size;
+    uint32_t     count;                         // records written since the ring was cleared
+    DLOG_tRecord record[DLOG_RECORDS];          // record n in [n % DLOG_RECORDS]
+} DLOG_tRing;
+
+#if DLOG_ENABLE
+
+// not cleared by the startup code, see do not initialize { section .noinit } in the icf file
+static DLOG_NO_INIT DLOG_tRing dlogRing;
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : DLOG_Init
+ * Description  : keep the records from before the reset or clear the
+ *                ring after power on. Called in main() before the first
+ *                DLOG()
+ * Prototype in : DebugLog.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void DLOG_Init(void)
+{
+    if ((dlogRing.magic != DLOG_MAGIC) || (dlogRing.size != sizeof(DLOG_tRing)))
+    {
+        dlogRing.count = 0;
+        dlogRing.size = sizeof(DLOG_tRing);
+        dlogRing.magic = DLOG_MAGIC;
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : DLOG_Write
+ * Description  : store one record, use the DLOG() macro. Callable from
+ *                any task and interrupt, also before the scheduler runs
+ * Prototype in : DebugLog.h
+ * \param    	: id---DLOG_xxx of DLOG_MESSAGES
+ * \param    	: arg0, arg1---arguments of the message text
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void DLOG_Write(DLOG_tId id, uint32_t arg0, uint32_t arg1)
+{
+    DLOG_tRecord *pRecord;
+    uint32_t primask, timeUs;
+
+    timeUs = get_time_us();
+    // the scheduler may not run yet, taskENTER_CRITICAL() would leave the interrupts masked
+    primask = __get_PRIMASK();
+    __disable_irq();
+    pRecord = &dlogRing.record[dlogRing.count & (DLOG_RECORDS - 1)];
+    pRecord->timeUs = timeUs;
+    pRecord->id = (uint16_t)id;
+    pRecord->seq = (uint16_t)dlogRing.count;
+    pRecord->arg[0] = arg0;
+    pRecord->arg[1] = arg1;
+    dlogRing.count++;
+    __set_PRIMASK(primask);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : DLOG_GetCount
+ * Description  : records written since the ring was cleared
+ * Prototype in : DebugLog.h
+ * \return    	: count, the last DLOG_RECORDS of them are in the ring
+ *---------------------------------------------------------------------*/
+uint32_t DLOG_GetCount(void)
+{
+    return dlogRing.count;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : DLOG_GetRecord
+ * Description  : copy a record of the ring
+ * Prototype in : DebugLog.h
+ * \param    	: index---0 = oldest record in the ring
+ * \param    	: pRecord---destination
+ * \return    	: false, if there is no record with this index
+ *---------------------------------------------------------------------*/
+bool DLOG_GetRecord(uint32_t index, DLOG_tRecord *pRecord)
+{
+    uint32_t primask, count, first;
+    bool bResult = false;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    count = dlogRing.count;
+    first = (count > DLOG_RECORDS) ? count - DLOG_RECORDS : 0;
+    if (index < count - first)
+    {
+        *pRecord = dlogRing.record[(first + index) & (DLOG_RECORDS - 1)];
+        bResult = true;
+    }
+    __set_PRIMASK(primask);
+    return bResult;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : DLOG_Clear
+ * Description  : remove all records, the sequence numbers start at 0
+ * Prototype in : DebugLog.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void DLOG_Clear(void)
+{
+    dlogRing.count = 0;
+}
+
+#else
+
+void DLOG_Init(void) {}
+void DLOG_Write(DLOG_tId id, uint32_t arg0, uint32_t arg1) {}
+uint32_t DLOG_GetCount(void) { return 0; }
+bool DLOG_GetRecord(uint32_t index, DLOG_tRecord *pRecord) { return false; }
+void DLOG_Clear(void) {}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef _DEBUG_LOG_H
+#define _DEBUG_LOG_H
+
+#include "comm.h"
+
+//==================================================================================================
+//  Deferred binary event log
+//
+//  DLOG(id, arg0, arg1) stores a record of the message id, two 32 bit arguments, get_time_us() and
+//  a sequence number in a ring in RAM. Nothing is formatted on the target: a call costs a few tens
+//  of cycles with the interrupts locked and may stay in the weighing loop and in interrupts.
+//
+//  The text of the messages is only in DLOG_MESSAGES below. READLOG dumps the ring in hex, the host
+//  tool EWARM/dlog_decode.py reads the message table from this file and prints the text:
+//
+//      python dlog_decode.py ..\Src\commsrc\DebugLog.h capture.txt
+//
+//  The ring is not cleared by a reset, the records before a watchdog or software reset are kept.
+//  A full ring overwrites the oldest record, the gaps in the sequence numbers show the lost ones.
+//
+//  DLOG_ENABLE 0 removes all call sites and the ring.
+//==================================================================================================
+
+#define DLOG_ENABLE             1
+
+//! records in the ring, power of two
+#define DLOG_RECORDS            64
+
+//! message id, text for the host with up to two printf conversions of the arguments: %d is
+//! signed, %u and %X unsigned. Append new messages at the end, the id is the position.
+#define DLOG_MESSAGES(X) \
+    X(DLOG_BOOT,            "boot, reset flags 0x%08X") \
+    X(DLOG_ZERO,            "zero command done, status %d, counts %d") \
+    X(DLOG_TARE,            "tare command done, status %d, counts %d") \
+    X(DLOG_COM_DROP,        "COM%u frame dropped, previous not processed, %u bytes") \
+    X(DLOG_MB_CRC,          "Modbus COM%u CRC error, %u bytes") \
+    X(DLOG_MB_EXCEPTION,    "Modbus COM%u exception 0x%X, function in the high byte") \
+    X(DLOG_COM_TX_DROP,     "COM%u reply dropped, transmitter busy, %u bytes")
+
+#define DLOG_ID(id, text)       id,
+
+typedef enum
+{
+    DLOG_MESSAGES(DLOG_ID)
+    DLOG_ID_NUM
+} DLOG_tId;
+
+typedef struct
+{
+    uint32_t timeUs;                // get_time_us()
+    uint16_t id;                    // DLOG_tId
+    uint16_t seq;                   // +1 per record since the ring was cleared
+    uint32_t arg[2];
+} DLOG_tRecord;
+
+#if DLOG_ENABLE
+#define DLOG(id, arg0, arg1)    DLOG_Write(id, (uint32_t)(arg0), (uint32_t)(arg1))
+#else
+#define DLOG(id, arg0, arg1)
+#endif
+
+void DLOG_Init(void);
+void DLOG_Write(DLOG_tId id, uint32_t arg0, uint32_t arg1);
+uint32_t DLOG_GetCount(void);
+bool DLOG_GetRecord(uint32_t index, DLOG_tRecord *pRecord);
+void DLOG_Clear(void);
+
+#endif
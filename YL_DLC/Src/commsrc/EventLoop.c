@@ -0,0 +1,274 @@
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "main.h"
+#include "RB_Config.h"
+#include "RB_OS.h"
+#include "RB_Timer.h"
+
+#include "EventLoop.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+// periods of the FreeRTOS build [ms]
+#define EVLOOP_ADC_PERIOD       10
+#define EVLOOP_WEIGH_PERIOD     100
+#define EVLOOP_SICS_PERIOD      20
+// USER_PARAM_FLUSH_DELAY, UserParam.h includes comm.h
+#define EVLOOP_FLUSH_DELAY      100
+
+// RB_OS priorities, 0 = highest: the sampling first, the eeprom last
+#define EVLOOP_PRIO_ADC         50
+#define EVLOOP_PRIO_WEIGH       60
+#define EVLOOP_PRIO_COM1        100
+#define EVLOOP_PRIO_COM2        110
+#define EVLOOP_PRIO_SICS        120
+#define EVLOOP_PRIO_FLUSH       RB_OS_TASK_BACKGROUND_PRIO
+
+// message source
+#define EVLOOP_SRC_ISR          1
+#define EVLOOP_SRC_TASK         2
+#define EVLOOP_SRC_TIMER        3
+
+static RB_OS_tTask adcTask, weighTask, com1Task, com2Task, sicsTask, flushTask;
+static RB_OS_tMsgQueue msgQueue[EVLOOP_QUEUE_NUM];
+static RB_OS_tMessage msgBuffer[EVLOOP_QUEUE_NUM][EVLOOP_QUEUE_SIZE];
+static const char * const queueName[EVLOOP_QUEUE_NUM] = { "COM1", "COM2", "PARAM" };
+
+// woken by EVLOOP_Post(), NULL before EVLOOP_Run()
+static TaskHandle_t loopTask = NULL;
+// changes received, the flush is delayed by flushTimer
+static RB_TIMER_tElement flushTimer;
+static bool bFlushTimer = false;
+// flushTimer ran out, set by the ticker of EVLOOP_Run()
+static bool bFlushDue = false;
+static EVLOOP_tStat loopStat;
+
+/**---------------------------------------------------------------------
+ * Name         : EVLOOP_Delay
+ * Description  : delay the running task, same period as osDelay(ms):
+ *                the ticker makes a task ready one tick after its
+ *                delay ran out
+ * Prototype in : EventLoop.c
+ * \param    	: ms---period, >= 1
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void EVLOOP_Delay(uint32_t ms)
+{
+    RB_OS_TaskDelay(RB_OS_GetTask(), ms - 1);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : EVLOOP_IdleTicks
+ * Description  : ticks the loop may wait when no task is ready: up to
+ *                the first delayed task, every tick while flushTimer
+ *                runs; an event wakes the loop earlier
+ * Prototype in : EventLoop.c
+ * \return    	: ticks, portMAX_DELAY = until an event
+ *---------------------------------------------------------------------*/
+static TickType_t EVLOOP_IdleTicks(void)
+{
+    uint32_t delay;
+
+    if (bFlushTimer)
+        return 1;
+    delay = RB_OS_TaskGetNextDelay();
+    if (delay == UINT32_MAX)
+        return portMAX_DELAY;
+    return pdMS_TO_TICKS(delay) + 1;
+}
+
+static void EVLOOP_AdcTask(const void *pArg)
+{
+    APP_AdcPoll();
+    EVLOOP_Delay(EVLOOP_ADC_PERIOD);
+}
+
+static void EVLOOP_WeighTask(const void *pArg)
+{
+    APP_WeighCycle();
+    EVLOOP_Delay(EVLOOP_WEIGH_PERIOD);
+}
+
+static void EVLOOP_Com1Task(const void *pArg)
+{
+    RB_OS_tMessage msg;
+
+    if (RB_OS_MsgQueuePend(&msgQueue[EVLOOP_QUEUE_COM1], &msg) == RB_OS_OK)
+        APP_Com1Frame();
+}
+
+static void EVLOOP_Com2Task(const void *pArg)
+{
+    RB_OS_tMessage msg;
+
+    if (RB_OS_MsgQueuePend(&msgQueue[EVLOOP_QUEUE_COM2], &msg) == RB_OS_OK)
+        APP_Com2Frame();
+}
+
+static void EVLOOP_SicsTask(const void *pArg)
+{
+    APP_SicsPoll();
+    EVLOOP_Delay(EVLOOP_SICS_PERIOD);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : EVLOOP_FlushTimeout
+ * Description  : flushTimer ran out, wakes the flush task. A full queue
+ *                wakes it as well
+ * Prototype in : EventLoop.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void EVLOOP_FlushTimeout(void)
+{
+    bFlushDue = true;
+    RB_OS_MsgQueuePostEvent(&msgQueue[EVLOOP_QUEUE_PARAM], EVLOOP_SRC_TIMER,
+                            (RB_OS_tEvent)EVLOOP_QUEUE_PARAM);
+}
+
+static void EVLOOP_FlushTask(const void *pArg)
+{
+    RB_OS_tMessage msg;
+
+    if (RB_OS_MsgQueuePend(&msgQueue[EVLOOP_QUEUE_PARAM], &msg) != RB_OS_OK)
+        return;
+    while (RB_OS_MsgQueueAccept(&msgQueue[EVLOOP_QUEUE_PARAM], &msg) == RB_OS_OK)
+        ;
+    if (bFlushDue)
+    {
+        // also the changes received meanwhile
+        bFlushDue = false;
+        bFlushTimer = false;
+        APP_ParamFlush();
+    }
+    else if (!bFlushTimer)
+    {
+        // the parameters of one command are written with one flush
+        bFlushTimer = true;
+        RB_TIMER_SetTimeout(&flushTimer, EVLOOP_FlushTimeout, EVLOOP_FLUSH_DELAY, false, true);
+    }
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : EVLOOP_Init
+ * Description  : create the queues and the tasks, called by
+ *                MX_FREERTOS_Init()
+ * Prototype in : EventLoop.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void EVLOOP_Init(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < EVLOOP_QUEUE_NUM; i++)
+        RB_OS_MsgQueueCreate(&msgQueue[i], msgBuffer[i], EVLOOP_QUEUE_SIZE, queueName[i]);
+
+    RB_OS_TaskCreate(&adcTask, EVLOOP_AdcTask, NULL, EVLOOP_PRIO_ADC, "ADC");
+    RB_OS_TaskCreate(&weighTask, EVLOOP_WeighTask, NULL, EVLOOP_PRIO_WEIGH, "Weigh");
+    RB_OS_TaskCreate(&com1Task, EVLOOP_Com1Task, NULL, EVLOOP_PRIO_COM1, "COM1");
+    RB_OS_TaskCreate(&com2Task, EVLOOP_Com2Task, NULL, EVLOOP_PRIO_COM2, "COM2");
+    RB_OS_TaskCreate(&sicsTask, EVLOOP_SicsTask, NULL, EVLOOP_PRIO_SICS, "SICS");
+    RB_OS_TaskCreate(&flushTask, EVLOOP_FlushTask, NULL, EVLOOP_PRIO_FLUSH, "Flush");
+}
+
+/**---------------------------------------------------------------------
+ * Name         : EVLOOP_Post
+ * Description  : post an event and wake the loop, from a task or an
+ *                interrupt up to configMAX_SYSCALL_INTERRUPT_PRIORITY
+ * Prototype in : EventLoop.h
+ * \param    	: queue---queue of the handler
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void EVLOOP_Post(EVLOOP_tQueue queue)
+{
+    BaseType_t bWoken = pdFALSE;
+    bool bIsr = (__get_IPSR() != 0);
+    RB_OS_tStatus status;
+
+    status = RB_OS_MsgQueuePostEvent(&msgQueue[queue], bIsr ? EVLOOP_SRC_ISR : EVLOOP_SRC_TASK,
+                                     (RB_OS_tEvent)queue);
+    RB_ENTER_CRITICAL_SECTION;
+    if (status == RB_OS_OK)
+        loopStat.posted++;
+    else
+        loopStat.lost++;
+    RB_LEAVE_CRITICAL_SECTION;
+
+    if (loopTask == NULL)
+        return;
+    if (bIsr)
+    {
+        vTaskNotifyGiveFromISR(loopTask, &bWoken);
+        portYIELD_FROM_ISR(bWoken);
+    }
+    else
+    {
+        xTaskNotifyGive(loopTask);
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : EVLOOP_Run
+ * Description  : call the ready tasks until none is ready, then wait
+ *                for an event or the tick a delayed task is ready in;
+ *                never returns
+ * Prototype in : EventLoop.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void EVLOOP_Run(void)
+{
+    TickType_t tick, now, wait = 1;
+    uint32_t start, us;
+
+    loopTask = xTaskGetCurrentTaskHandle();
+    tick = xTaskGetTickCount();
+    for (;;)
+    {
+        // the delays count all ticks since the last pass, also after a long task call
+        now = xTaskGetTickCount();
+        if ((TickType_t)(now - tick) > wait)
+            loopStat.lateTicks += now - tick - wait;
+        wait = 1;
+        while (tick != now)
+        {
+            RB_OS_TaskTicker();
+            RB_TIMER_Ticker();
+            tick++;
+        }
+
+        start = get_time_us();
+        RB_OS_TaskReschedule();
+        if (RB_OS_GetTask() == NULL)
+        {
+            // no task was ready
+            loopStat.idleWaits++;
+            wait = EVLOOP_IdleTicks();
+            ulTaskNotifyTake(pdTRUE, wait);
+            continue;
+        }
+        us = get_time_us() - start;
+        loopStat.dispatches++;
+        if (us > loopStat.maxDispatchUs)
+            loopStat.maxDispatchUs = us;
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : EVLOOP_GetStat
+ * Description  : counters since power on
+ * Prototype in : EventLoop.h
+ * \param    	: pStat---destination
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void EVLOOP_GetStat(EVLOOP_tStat *pStat)
+{
+    RB_ENTER_CRITICAL_SECTION;
+    *pStat = loopStat;
+    RB_LEAVE_CRITICAL_SECTION;
+}
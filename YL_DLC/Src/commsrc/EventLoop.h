@@ -0,0 +1,69 @@
+#ifndef _EVENT_LOOP_H
+#define _EVENT_LOOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==================================================================================================
+//  Run-to-completion event loop on RB_OS
+//
+//  With APP_EVENT_LOOP 1 the application runs in WeighProcessTask alone instead of five FreeRTOS
+//  tasks: the ADC poll, the weight cycle, the Modbus slave, the command interface, the SICS poll
+//  and the eeprom flush are RB_OS tasks called one after the other by EVLOOP_Run() on its stack.
+//  A task function handles one event or one period and returns, a periodic task delays itself, an
+//  event task pends on its queue. The USART idle interrupts and the parameter module post their events
+//  with EVLOOP_Post(), which also wakes the loop.
+//
+//  The handlers are the APP_xxx functions of freertos.c, the same in both builds. The kernel stays
+//  underneath for the tick, the UART TX semaphore and the eeprom mutex. All tasks are created in the
+//  USER CODE sections of freertos.c, not by CubeMX: APP_EVENT_LOOP selects them, and the stack of
+//  WeighProcessTask is the sum of the five task stacks. READTASK shows the CPU and stack of the
+//  tasks and the loop statistics, READTRACE the stage times, the map file the RAM.
+//
+//  The flush waits for flushTimer of RB_Timer, its callback runs in the ticker of EVLOOP_Run().
+//  With no task ready the loop sleeps until the first delayed task is due, every tick only while
+//  flushTimer runs, and counts the ticks it slept when it wakes.
+//  EventLoop.c is the only user of RB_OS and RB_Timer: RB_Typedefs.h and comm.h define the same
+//  types and are not included together.
+//==================================================================================================
+
+//! 0 = one FreeRTOS task per handler, 1 = all handlers in the event loop task
+#ifndef APP_EVENT_LOOP
+#define APP_EVENT_LOOP          0
+#endif
+
+//! messages per queue, frames are not queued: a USART has one frame buffer
+#define EVLOOP_QUEUE_SIZE       4
+
+typedef enum
+{
+    EVLOOP_QUEUE_COM1 = 0,          // Modbus frame in usart1_rx_FIFO
+    EVLOOP_QUEUE_COM2,              // command frame in usart2_rx_FIFO
+    EVLOOP_QUEUE_PARAM,             // parameter change to write to the eeprom
+    EVLOOP_QUEUE_NUM
+} EVLOOP_tQueue;
+
+typedef struct
+{
+    uint32_t dispatches;            // task function calls
+    uint32_t idleWaits;             // no task ready, waited for an event or a delayed task
+    uint32_t posted;                // events posted
+    uint32_t lost;                  // events not posted, queue full
+    uint32_t lateTicks;             // ticks counted late because a task call was longer than a tick
+    uint32_t maxDispatchUs;         // longest task call
+} EVLOOP_tStat;
+
+void EVLOOP_Init(void);
+void EVLOOP_Post(EVLOOP_tQueue queue);
+void EVLOOP_Run(void);
+void EVLOOP_GetStat(EVLOOP_tStat *pStat);
+
+// handlers of both builds, freertos.c
+void APP_AdcPoll(void);
+void APP_WeighCycle(void);
+void APP_Com1Frame(void);
+void APP_Com2Frame(void);
+void APP_SicsPoll(void);
+void APP_ParamFlush(void);
+
+#endif
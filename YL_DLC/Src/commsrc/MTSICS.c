@@ -0,0 +1,602 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "stm32f1xx_hal.h"
+
+#include "MTSICS.h"
+#include "Scale.h"
+#include "WeightBus.h"
+#include "CmdProcess.h"
+#include "RB_String.h"
+
+extern COMMANDSOURCE tareCommandSource;
+extern COMMANDSOURCE zeroCommandSource;
+
+//==================================================================================================
+//  L O C A L   T Y P E S
+//==================================================================================================
+
+//! commands answered by MTSICS_Poll() after one or more weight cycles
+typedef enum
+{
+    MTSICS_PENDING_S = 0,
+    MTSICS_PENDING_Z,
+    MTSICS_PENDING_ZI,
+    MTSICS_PENDING_T,
+    MTSICS_PENDING_TA,
+    MTSICS_PENDING_TAC,
+    MTSICS_PENDING_NUM
+} MTSICS_tPending;
+
+//! SICS lines of one weight snapshot
+typedef struct
+{
+    char weightLine[MTSICS_LINE_LEN];   // "S S    123.45 kg", "S D    123.45 kg", "S +", "S -" or "S I"
+    char tareField[MTSICS_LINE_LEN];    // "    100.00 kg"
+} MTSICS_tSnapshot;
+
+typedef void (*MTSICS_tCmdProc)(char *param);
+
+typedef struct
+{
+    const char      *cmdstr;
+    MTSICS_tCmdProc cmdproc;
+} MTSICS_tCmd;
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+static void MTSICS_Reset(char *param);
+static void MTSICS_I4(char *param);
+static void MTSICS_S(char *param);
+static void MTSICS_SI(char *param);
+static void MTSICS_SIR(char *param);
+static void MTSICS_T(char *param);
+static void MTSICS_TA(char *param);
+static void MTSICS_TAC(char *param);
+static void MTSICS_Z(char *param);
+static void MTSICS_ZI(char *param);
+
+static const MTSICS_tCmd MTSICS_CmdTable[] =
+{
+    {"@",   MTSICS_Reset},
+    {"I4",  MTSICS_I4},
+    {"S",   MTSICS_S},
+    {"SI",  MTSICS_SI},
+    {"SIR", MTSICS_SIR},
+    {"T",   MTSICS_T},
+    {"TA",  MTSICS_TA},
+    {"TAC", MTSICS_TAC},
+    {"Z",   MTSICS_Z},
+    {"ZI",  MTSICS_ZI},
+};
+
+#define MTSICS_CMD_NUM  (sizeof(MTSICS_CmdTable) / sizeof(MTSICS_tCmd))
+
+static const char * const pendingName[MTSICS_PENDING_NUM] = {"S", "Z", "ZI", "T", "TA", "TAC"};
+
+// every weight cycle with the display strings, only while SIR runs or a command is pending
+static WBUS_tSubscriber weightSub;
+static bool bSubscribed = false;
+
+// remaining weight cycles of a pending command, 0 = not pending
+static uint16_t pendingWait[MTSICS_PENDING_NUM];
+static bool bSirActive = false;
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_Reply
+ * Description  : queue one response line, CR LF is appended
+ * Prototype in : MTSICS.c
+ * \param    	: pStr---response without line end
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void MTSICS_Reply(const char *pStr)
+{
+    CmdReply(pStr, strlen(pStr));
+    CmdReply("\r\n", 2);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_Reply2
+ * Description  : queue "<cmd> <status>" or "<cmd> <status> <field>"
+ * Prototype in : MTSICS.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void MTSICS_Reply2(const char *pCmd, const char *pStatus, const char *pField)
+{
+    char buff[MTSICS_LINE_LEN + 8];
+
+    RB_STRING_strncpymax(buff, pCmd, sizeof(buff));
+    RB_STRING_strncatmax(buff, " ", sizeof(buff));
+    RB_STRING_strncatmax(buff, pStatus, sizeof(buff));
+    if (pField != NULL)
+    {
+        RB_STRING_strncatmax(buff, " ", sizeof(buff));
+        RB_STRING_strncatmax(buff, pField, sizeof(buff));
+    }
+    MTSICS_Reply(buff);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_FormatWeight
+ * Description  : make the SICS weight field "    123.45 kg" of a display
+ *                weight string
+ * Prototype in : MTSICS.c
+ * \param    	: pField---destination, size---size of pField
+ * \param    	: pWeightString---net or tare display string
+ * \param    	: pUnit---unit text
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void MTSICS_FormatWeight(char *pField, size_t size, const char *pWeightString, const char *pUnit)
+{
+    char value[MTSICS_WEIGHT_FIELD + 1];
+    size_t len;
+
+    while (*pWeightString == ' ')
+        pWeightString++;
+    RB_STRING_strncpymax(value, pWeightString, sizeof(value));
+    len = strlen(value);
+    while ((len > 0) && (value[len - 1] == ' '))
+        value[--len] = '\0';
+    RB_STRING_AlignRight(value, MTSICS_WEIGHT_FIELD);
+
+    RB_STRING_strncpymax(pField, value, size);
+    RB_STRING_strncatmax(pField, " ", size);
+    RB_STRING_strncatmax(pField, pUnit, size);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_MakeSnapshot
+ * Description  : make the SICS lines of a weight snapshot
+ * Prototype in : MTSICS.c
+ * \param    	: pSnap---destination
+ * \param    	: pWeight---snapshot of the weight bus, NULL before the
+ *                first weight cycle
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void MTSICS_MakeSnapshot(MTSICS_tSnapshot *pSnap, const WBUS_tWeight *pWeight)
+{
+    const char *pUnit;
+
+    pSnap->tareField[0] = '\0';
+    if (pWeight == NULL)
+    {
+        RB_STRING_strncpymax(pSnap->weightLine, "S I", MTSICS_LINE_LEN);
+        return;
+    }
+    pUnit = UNIT_GetUnitStringbyUnitType(g_ScaleData.unit, pWeight->unitType);
+
+    if ((pWeight->status & WBUS_STAT_COMMAND) || !(pWeight->status & WBUS_STAT_ZERO_CAPTURED))
+        RB_STRING_strncpymax(pSnap->weightLine, "S I", MTSICS_LINE_LEN);
+    else if (pWeight->status & WBUS_STAT_OVER)
+        RB_STRING_strncpymax(pSnap->weightLine, "S +", MTSICS_LINE_LEN);
+    else if (pWeight->status & WBUS_STAT_UNDER)
+        RB_STRING_strncpymax(pSnap->weightLine, "S -", MTSICS_LINE_LEN);
+    else
+    {
+        RB_STRING_strncpymax(pSnap->weightLine, (pWeight->status & WBUS_STAT_MOTION) ? "S D " : "S S ",
+                             MTSICS_LINE_LEN);
+        MTSICS_FormatWeight(&pSnap->weightLine[4], MTSICS_LINE_LEN - 4, pWeight->netString, pUnit);
+    }
+    MTSICS_FormatWeight(pSnap->tareField, MTSICS_LINE_LEN, pWeight->tareString, pUnit);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_GetSnapshot
+ * Description  : SICS lines of the last weight cycle
+ * Prototype in : MTSICS.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void MTSICS_GetSnapshot(MTSICS_tSnapshot *pSnap)
+{
+    const WBUS_tWeight *pWeight = WBUS_AcquireLatest();
+
+    MTSICS_MakeSnapshot(pSnap, pWeight);
+    WBUS_Release(pWeight);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_UpdateSubscription
+ * Description  : subscribe to the weight cycles while SIR runs or a
+ *                command is pending, else not: the display strings are
+ *                formatted only for a subscriber that reads them
+ * Prototype in : MTSICS.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void MTSICS_UpdateSubscription(void)
+{
+    bool bNeeded = bSirActive;
+    int i;
+
+    for (i = 0; i < MTSICS_PENDING_NUM; i++)
+    {
+        if (pendingWait[i] != 0)
+            bNeeded = true;
+    }
+    if (bNeeded == bSubscribed)
+        return;
+    if (bNeeded)
+        bSubscribed = WBUS_Subscribe(&weightSub, "SICS", 1, WBUS_SUB_STRINGS);
+    else
+    {
+        WBUS_Unsubscribe(&weightSub);
+        bSubscribed = false;
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_StartPending
+ * Description  : start a pending command, "<cmd> I" if it is pending already
+ * Prototype in : MTSICS.c
+ * \return    	: true if started
+ *---------------------------------------------------------------------*/
+static bool MTSICS_StartPending(MTSICS_tPending pending)
+{
+    if (pendingWait[pending] != 0)
+    {
+        MTSICS_Reply2(pendingName[pending], "I", NULL);
+        return false;
+    }
+    pendingWait[pending] = MTSICS_PENDING_CYCLES;
+    return true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_CheckPending
+ * Description  : answer a pending command if its scale command is finished
+ * Prototype in : MTSICS.c
+ * \param    	: pending---command, pSnap---snapshot of this weight cycle
+ * \return    	: true if answered
+ *---------------------------------------------------------------------*/
+static bool MTSICS_CheckPending(MTSICS_tPending pending, const MTSICS_tSnapshot *pSnap)
+{
+    const char *pName = pendingName[pending];
+
+    switch (pending)
+    {
+    case MTSICS_PENDING_S:
+        // answered on the first stable cycle, "S +" and "S -" are final as well
+        if ((pSnap->weightLine[2] == 'D') || (pSnap->weightLine[2] == 'I'))
+            return false;
+        MTSICS_Reply(pSnap->weightLine);
+        break;
+
+    case MTSICS_PENDING_Z:
+    case MTSICS_PENDING_ZI:
+        if (g_ScaleData.bZeroCommand)
+            return false;
+        switch (g_ScaleData.zero->zeroScaleStatus)
+        {
+        case ZERO_SUCCESS:
+            MTSICS_Reply2(pName, (pending == MTSICS_PENDING_Z) ? "A" : "S", NULL);
+            break;
+        case SCALE_OUT_OF_POSITIVEZEROING_RANGE:
+            MTSICS_Reply2(pName, "+", NULL);
+            break;
+        case SCALE_OUT_OF_NEGATIVEZEROING_RANGE:
+            MTSICS_Reply2(pName, "-", NULL);
+            break;
+        default:
+            MTSICS_Reply2(pName, "I", NULL);
+            break;
+        }
+        break;
+
+    case MTSICS_PENDING_T:
+        if (g_ScaleData.bTareCommand)
+            return false;
+        switch (g_ScaleData.tare->tareScaleStatus)
+        {
+        case TARE_SUCCESS:
+            MTSICS_Reply2(pName, "S", pSnap->tareField);
+            break;
+        case TARING_OVER_CAPACITY:
+        case TARE_VALUE_EXCEEDS_LIMIT:
+            MTSICS_Reply2(pName, "+", NULL);
+            break;
+        case TARING_UNDER_ZERO:
+        case TARE_VALUE_TOO_SMALL:
+            MTSICS_Reply2(pName, "-", NULL);
+            break;
+        default:
+            MTSICS_Reply2(pName, "I", NULL);
+            break;
+        }
+        break;
+
+    case MTSICS_PENDING_TA:
+        // SCALE_PostProcess() takes the command over and resets programmableTare when the preset
+        // tare is taken or refused
+        if ((g_ScaleData.presetTareCommand > 0.0f) || (g_ScaleData.programmableTare > 0.0))
+            return false;
+        if (g_ScaleData.tare->tareScaleStatus == TARE_SUCCESS)
+            MTSICS_Reply2(pName, "A", pSnap->tareField);
+        else
+            MTSICS_Reply2(pName, "I", NULL);
+        break;
+
+    case MTSICS_PENDING_TAC:
+        if (g_ScaleData.bClearCommand)
+            return false;
+        MTSICS_Reply2(pName, "A", NULL);
+        break;
+
+    default:
+        break;
+    }
+    return true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_WithdrawCommand
+ * Description  : withdraw the scale command of a pending command that
+ *                was not executed yet
+ * Prototype in : MTSICS.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void MTSICS_WithdrawCommand(MTSICS_tPending pending)
+{
+    switch (pending)
+    {
+    case MTSICS_PENDING_Z:
+    case MTSICS_PENDING_ZI:
+        g_ScaleData.bZeroCommand = 0;
+        zeroCommandSource = COMMAND_NONE;
+        break;
+    case MTSICS_PENDING_T:
+        g_ScaleData.bTareCommand = 0;
+        tareCommandSource = COMMAND_NONE;
+        break;
+    case MTSICS_PENDING_TA:
+        // a preset tare already taken over by the weigh task is finished there
+        g_ScaleData.presetTareCommand = 0.0f;
+        break;
+    case MTSICS_PENDING_TAC:
+        g_ScaleData.bClearCommand = 0;
+        break;
+    default:
+        break;
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_CancelPending
+ * Description  : pending command timed out, withdraw the scale command
+ * Prototype in : MTSICS.c
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void MTSICS_CancelPending(MTSICS_tPending pending)
+{
+    MTSICS_WithdrawCommand(pending);
+    MTSICS_Reply2(pendingName[pending], "I", NULL);
+}
+
+//==================================================================================================
+//  C O M M A N D S
+//==================================================================================================
+
+// @  -> reset, stops SIR and pending commands, replies like I4
+static void MTSICS_Reset(char *param)
+{
+    int i;
+
+    // a zero or tare of SICS must not execute after the reset
+    for (i = 0; i < MTSICS_PENDING_NUM; i++)
+    {
+        if (pendingWait[i] != 0)
+            MTSICS_WithdrawCommand((MTSICS_tPending)i);
+    }
+    memset(pendingWait, 0, sizeof(pendingWait));
+    MTSICS_I4(param);
+}
+
+// I4 -> I4 A "<scale name>", the scale name is the only per unit identifier in the parameters
+static void MTSICS_I4(char *param)
+{
+    char buff[sizeof(g_ScaleData.scaleName) + 8];
+
+    RB_STRING_strncpymax(buff, "I4 A \"", sizeof(buff));
+    RB_STRING_strncatmax(buff, g_ScaleData.scaleName, sizeof(buff));
+    RB_STRING_strncatmax(buff, "\"", sizeof(buff));
+    MTSICS_Reply(buff);
+}
+
+// S  -> stable net weight, answered on the first stable weight cycle
+static void MTSICS_S(char *param)
+{
+    MTSICS_StartPending(MTSICS_PENDING_S);
+}
+
+// SI -> net weight immediately, stable or dynamic
+static void MTSICS_SI(char *param)
+{
+    MTSICS_tSnapshot snap;
+
+    MTSICS_GetSnapshot(&snap);
+    MTSICS_Reply(snap.weightLine);
+}
+
+// SIR -> SI, then one line per weight cycle until the next command
+static void MTSICS_SIR(char *param)
+{
+    MTSICS_SI(param);
+    bSirActive = true;
+}
+
+// T  -> tare on the next stable weight, T S <tare> <unit>
+static void MTSICS_T(char *param)
+{
+    if (g_ScaleData.bTareCommand)
+    {
+        MTSICS_Reply("T I");
+        return;
+    }
+    if (MTSICS_StartPending(MTSICS_PENDING_T))
+    {
+        tareCommandSource = COMMAND_REMOTE;
+        g_ScaleData.bTareCommand = 1;
+    }
+}
+
+// TA               -> TA A <tare> <unit>
+// TA <value> [unit] -> preset tare in the current unit
+static void MTSICS_TA(char *param)
+{
+    MTSICS_tSnapshot snap;
+    const char *pUnit;
+    char *pEnd;
+    size_t len;
+    double value;
+
+    if (*param == '\0')
+    {
+        MTSICS_GetSnapshot(&snap);
+        MTSICS_Reply2("TA", "A", snap.tareField);
+        return;
+    }
+
+    value = strtod(param, &pEnd);
+    while (*pEnd == ' ')
+        pEnd++;
+    len = strlen(pEnd);
+    while ((len > 0) && (pEnd[len - 1] == ' '))
+        pEnd[--len] = '\0';
+    pUnit = UNIT_GetUnitStringbyUnitType(g_ScaleData.unit, g_ScaleData.unit->currUnitType);
+
+    // rejects NaN as well
+    if ((pEnd == param) || !(value > 0.0) || (value > g_ScaleData.scaleCapacity)
+        || ((len > 0) && (strcmp(pEnd, pUnit) != 0)))
+    {
+        MTSICS_Reply("TA L");
+        return;
+    }
+    if (MTSICS_StartPending(MTSICS_PENDING_TA))
+    {
+        tareCommandSource = COMMAND_REMOTE;
+        g_ScaleData.presetTareCommand = (float)value;
+    }
+}
+
+// TAC -> clear tare
+static void MTSICS_TAC(char *param)
+{
+    if (MTSICS_StartPending(MTSICS_PENDING_TAC))
+        g_ScaleData.bClearCommand = 1;
+}
+
+// Z  -> zero on the next stable weight
+static void MTSICS_Z(char *param)
+{
+    if (g_ScaleData.bZeroCommand)
+    {
+        MTSICS_Reply("Z I");
+        return;
+    }
+    if (MTSICS_StartPending(MTSICS_PENDING_Z))
+    {
+        zeroCommandSource = COMMAND_REMOTE;
+        g_ScaleData.bZeroCommand = 1;
+    }
+}
+
+// ZI -> zero immediately, refused while in motion as zeroing a dynamic weight is not legal for trade
+static void MTSICS_ZI(char *param)
+{
+    if (g_ScaleData.bZeroCommand || MOTION_GetMotion(g_ScaleData.motion))
+    {
+        MTSICS_Reply("ZI I");
+        return;
+    }
+    if (MTSICS_StartPending(MTSICS_PENDING_ZI))
+    {
+        zeroCommandSource = COMMAND_REMOTE;
+        g_ScaleData.bZeroCommand = 1;
+    }
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_ProcessCommand
+ * Description  : execute one line if it is a MT-SICS command, any
+ *                command stops a running SIR
+ * Prototype in : MTSICS.h
+ * \param    	: cmdline---zero terminated line without leading spaces,
+ *                parameters may be modified
+ * \return    	: true if it was a MT-SICS command
+ *---------------------------------------------------------------------*/
+bool MTSICS_ProcessCommand(char *cmdline)
+{
+    size_t namelen;
+    unsigned int i;
+
+    namelen = strcspn(cmdline, " ");
+    for (i = 0; i < MTSICS_CMD_NUM; i++)
+    {
+        if ((strlen(MTSICS_CmdTable[i].cmdstr) == namelen)
+            && (strncmp(cmdline, MTSICS_CmdTable[i].cmdstr, namelen) == 0))
+        {
+            cmdline += namelen;
+            while (*cmdline == ' ')
+                cmdline++;
+            bSirActive = false;
+            MTSICS_CmdTable[i].cmdproc(cmdline);
+            MTSICS_UpdateSubscription();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_Init
+ * Description  : no SIR and no pending command, no subscription until
+ *                a command needs the weight cycles, called by main()
+ * Prototype in : MTSICS.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void MTSICS_Init(void)
+{
+    bSirActive = false;
+    memset(pendingWait, 0, sizeof(pendingWait));
+    MTSICS_UpdateSubscription();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : MTSICS_Poll
+ * Description  : stream SIR and answer pending commands once per new
+ *                weight snapshot, called by Uart2_ProcessTask; a weight
+ *                cycle not seen in time is skipped
+ * Prototype in : MTSICS.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void MTSICS_Poll(void)
+{
+    const WBUS_tWeight *pWeight;
+    MTSICS_tSnapshot snap;
+    int i;
+
+    pWeight = WBUS_Take(&weightSub);
+    if (pWeight == NULL)
+        return;
+    MTSICS_MakeSnapshot(&snap, pWeight);
+    WBUS_Release(pWeight);
+
+    if (bSirActive)
+        MTSICS_Reply(snap.weightLine);
+
+    for (i = 0; i < MTSICS_PENDING_NUM; i++)
+    {
+        if (pendingWait[i] == 0)
+            continue;
+        if (MTSICS_CheckPending((MTSICS_tPending)i, &snap))
+            pendingWait[i] = 0;
+        else if (--pendingWait[i] == 0)
+            MTSICS_CancelPending((MTSICS_tPending)i);
+    }
+    MTSICS_UpdateSubscription();
+    CmdReplyFlush();
+}
@@ -0,0 +1,31 @@
+#ifndef _MTSICS_H
+#define _MTSICS_H
+
+#include "comm.h"
+
+//==================================================================================================
+//  MT-SICS level 0/1 server on the USART2 command port
+//
+//  S, SI, SIR, Z, ZI, T, TA, TAC, @, I4
+//
+//  The weights come from the weight bus (WeightBus.h), one snapshot per weight cycle while SIR
+//  runs or a command is pending; an idle SICS port does not subscribe and costs the weight cycle
+//  no display strings. SI and TA take the latest snapshot.
+//  MTSICS_ProcessCommand() and MTSICS_Poll() run in Uart2_ProcessTask, so all USART2
+//  transmissions stay in one task.
+//==================================================================================================
+
+//! weight cycles a pending S, Z, T, TA or TAC waits before "x I" is replied (10s at 10Hz)
+#define MTSICS_PENDING_CYCLES       100
+
+//! weight value field width, right aligned
+#define MTSICS_WEIGHT_FIELD         10
+
+//! "S S " + weight field + " " + unit
+#define MTSICS_LINE_LEN             24
+
+void MTSICS_Init(void);
+bool MTSICS_ProcessCommand(char *cmdline);
+void MTSICS_Poll(void);
+
+#endif
@@ -0,0 +1,219 @@
+#include <string.h>
+
+#include "cmsis_os.h"
+
+#include "SimLoad.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+#if SIM_ENABLE
+
+static SIM_tSegment script[SIM_SEGMENTS];
+static uint8_t scriptLen = 0;
+
+static volatile bool bSimActive = false;
+static bool bSimRepeat = false;
+static uint16_t simNoise = 0;
+static uint32_t simRandom = 1;
+static uint8_t simSegment = 0;
+static uint16_t simSample = 0;
+static int32_t startLevel = 0;          // level at the start of the current segment
+static int32_t simLevel = 0;
+static uint32_t simTotal = 0;
+static bool bSimDone = false;
+
+/**---------------------------------------------------------------------
+ * Name         : SIM_Random
+ * Description  : xorshift32, the same sequence for the same seed
+ * Prototype in : SimLoad.c
+ * \return    	: next value, never 0
+ *---------------------------------------------------------------------*/
+static uint32_t SIM_Random(void)
+{
+    simRandom ^= simRandom << 13;
+    simRandom ^= simRandom >> 17;
+    simRandom ^= simRandom << 5;
+    return simRandom;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : SIM_NextLevel
+ * Description  : level of the next sample of the script, advances the
+ *                position
+ * Prototype in : SimLoad.c
+ * \return    	: raw counts without noise
+ *---------------------------------------------------------------------*/
+static int32_t SIM_NextLevel(void)
+{
+    const SIM_tSegment *pSeg;
+
+    if (bSimDone)
+        return simLevel;
+
+    pSeg = &script[simSegment];
+    simSample++;
+    if (pSeg->type == SIM_SEG_RAMP)
+        simLevel = startLevel + (int32_t)((int64_t)(pSeg->level - startLevel) * simSample / pSeg->samples);
+    else
+        simLevel = pSeg->level;
+
+    if (simSample >= pSeg->samples)
+    {
+        startLevel = simLevel;
+        simSample = 0;
+        if (++simSegment >= scriptLen)
+        {
+            simSegment = 0;
+            bSimDone = !bSimRepeat;
+        }
+    }
+    return simLevel;
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : SIM_AddSegment
+ * Description  : append a segment to the script
+ * Prototype in : SimLoad.h
+ * \param    	: type---SIM_SEG_STEP or SIM_SEG_RAMP
+ *                level---raw counts at the end of the segment
+ *                samples---length of the segment
+ * \return    	: false = simulation on, script full or samples 0
+ *---------------------------------------------------------------------*/
+bool SIM_AddSegment(SIM_tSegType type, int32_t level, uint16_t samples)
+{
+    if (bSimActive || (scriptLen >= SIM_SEGMENTS) || (samples == 0))
+        return false;
+    script[scriptLen].type = type;
+    script[scriptLen].level = level;
+    script[scriptLen].samples = samples;
+    scriptLen++;
+    return true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : SIM_ClearScript
+ * Description  : remove all segments
+ * Prototype in : SimLoad.h
+ * \return    	: false = simulation on
+ *---------------------------------------------------------------------*/
+bool SIM_ClearScript(void)
+{
+    if (bSimActive)
+        return false;
+    scriptLen = 0;
+    return true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : SIM_Start
+ * Description  : run the script from the first segment, the samples of
+ *                the converters are ignored until SIM_Stop()
+ * Prototype in : SimLoad.h
+ * \param    	: seed---of the noise, 0 is taken as 1
+ *                noise---peak counts of the uniform noise, 0 = none
+ *                bRepeat---restart the script at its end, else hold
+ *                the last level
+ * \return    	: false = script empty
+ *---------------------------------------------------------------------*/
+bool SIM_Start(uint32_t seed, uint16_t noise, bool bRepeat)
+{
+    if (scriptLen == 0)
+        return false;
+
+    taskENTER_CRITICAL();
+    simRandom = (seed == 0) ? 1 : seed;
+    simNoise = noise;
+    bSimRepeat = bRepeat;
+    simSegment = 0;
+    simSample = 0;
+    startLevel = 0;
+    simLevel = 0;
+    simTotal = 0;
+    bSimDone = false;
+    bSimActive = true;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : SIM_Stop
+ * Description  : back to the converters
+ * Prototype in : SimLoad.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void SIM_Stop(void)
+{
+    bSimActive = false;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : SIM_IsActive
+ * Description  : simulation on
+ * Prototype in : SimLoad.h
+ * \return    	: true = APP_AdcPoll() takes SIM_Sample()
+ *---------------------------------------------------------------------*/
+bool SIM_IsActive(void)
+{
+    return bSimActive;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : SIM_Sample
+ * Description  : next sample of both channels, called by APP_AdcPoll()
+ *                instead of reading the converters
+ * Prototype in : SimLoad.h
+ * \param    	: pRaw1, pRaw2---raw counts of channel 1 and 2
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void SIM_Sample(int32_t *pRaw1, int32_t *pRaw2)
+{
+    int32_t level, noise = 0;
+
+    taskENTER_CRITICAL();
+    level = SIM_NextLevel();
+    if (simNoise > 0)
+        noise = (int32_t)(SIM_Random() % (2 * (uint32_t)simNoise + 1)) - simNoise;
+    simTotal++;
+    taskEXIT_CRITICAL();
+
+    *pRaw1 = level / 2 + noise;
+    *pRaw2 = level - level / 2;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : SIM_GetStat
+ * Description  : state of the simulation
+ * Prototype in : SimLoad.h
+ * \param    	: pStat---destination
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void SIM_GetStat(SIM_tStat *pStat)
+{
+    taskENTER_CRITICAL();
+    pStat->bActive = bSimActive;
+    pStat->segments = scriptLen;
+    pStat->segment = simSegment;
+    pStat->sample = simSample;
+    pStat->total = simTotal;
+    pStat->level = simLevel;
+    pStat->bDone = bSimDone;
+    taskEXIT_CRITICAL();
+}
+
+#else
+
+bool SIM_AddSegment(SIM_tSegType type, int32_t level, uint16_t samples) { return false; }
+bool SIM_ClearScript(void) { return false; }
+bool SIM_Start(uint32_t seed, uint16_t noise, bool bRepeat) { return false; }
+void SIM_Stop(void) {}
+bool SIM_IsActive(void) { return false; }
+void SIM_Sample(int32_t *pRaw1, int32_t *pRaw2) {}
+void SIM_GetStat(SIM_tStat *pStat) { memset(pStat, 0, sizeof(SIM_tStat)); }
+
+#endif
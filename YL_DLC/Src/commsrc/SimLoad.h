@@ -0,0 +1,58 @@
+#ifndef _SIM_LOAD_H
+#define _SIM_LOAD_H
+
+#include "comm.h"
+
+//==================================================================================================
+//  Scripted load signal in place of the converters
+//
+//  With the simulation on, APP_AdcPoll() takes its samples from a script instead of the ADS1230:
+//  the filter, the weight cycle, the outputs, Modbus and the command interface run unchanged above
+//  it, without a load cell and with the same input in every run. The script is a list of segments,
+//  each a step to a level held for n samples or a ramp to a level over n samples, with uniform
+//  noise of a seeded generator on top. It is indexed by the sample, not by the time: the same seed
+//  gives the same samples, READTRACE, READTASK and MBDIAG show what the pipeline made of them.
+//
+//  The level is the raw sum adcvalue1 + adcvalue2 of the weighing, split evenly on the two
+//  channels (corner adjustment adjutk2 = 1). The script is edited with the simulation off, SETSIM
+//  and READSIM are the commands. SIM_ENABLE 0 removes the simulation.
+//==================================================================================================
+
+#define SIM_ENABLE              1
+
+//! segments of the script
+#define SIM_SEGMENTS            16
+
+typedef enum
+{
+    SIM_SEG_STEP = 0,               // jump to the level and hold it
+    SIM_SEG_RAMP                    // linear from the previous level to the level
+} SIM_tSegType;
+
+typedef struct
+{
+    SIM_tSegType type;
+    int32_t      level;             // raw counts at the end of the segment
+    uint16_t     samples;           // length, 1..65535
+} SIM_tSegment;
+
+typedef struct
+{
+    bool     bActive;
+    uint8_t  segments;              // in the script
+    uint8_t  segment;               // current
+    uint16_t sample;                // in the current segment
+    uint32_t total;                 // samples since SIM_Start()
+    int32_t  level;                 // last level without noise
+    bool     bDone;                 // script run through, the last level is held
+} SIM_tStat;
+
+bool SIM_AddSegment(SIM_tSegType type, int32_t level, uint16_t samples);
+bool SIM_ClearScript(void);
+bool SIM_Start(uint32_t seed, uint16_t noise, bool bRepeat);
+void SIM_Stop(void);
+bool SIM_IsActive(void);
+void SIM_Sample(int32_t *pRaw1, int32_t *pRaw2);
+void SIM_GetStat(SIM_tStat *pStat);
+
+#endif
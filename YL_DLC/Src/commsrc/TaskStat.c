@@ -0,0 +1,154 @@
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "TaskStat.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+// kernel snapshot and result in progress, static: too large for the stack of WeighProcessTask
+static TaskStatus_t taskStatus[TSTAT_MAX_TASKS];
+static TSTAT_tTask newList[TSTAT_MAX_TASKS];
+
+// run time counters at the start of the window, same order as taskList
+static uint32_t prevRunTime[TSTAT_MAX_TASKS];
+static UBaseType_t prevTaskNumber[TSTAT_MAX_TASKS];
+static uint32_t prevTotalRunTime = 0;
+static bool bBaseline = false;
+
+// result of the last window, written by TSTAT_Update() in a critical section
+static TSTAT_tTask taskList[TSTAT_MAX_TASKS];
+static uint16_t taskCount = 0;
+static uint16_t idlePermille = 0;
+static uint32_t windowUs = 0;
+
+// traceTASK_SWITCHED_IN() of FreeRTOSConfig.h, written in the switch only
+void * volatile tstatLastTask = NULL;
+volatile uint32_t tstatSwitches = 0;
+
+/**---------------------------------------------------------------------
+ * Name         : TSTAT_SortByNumber
+ * Description  : sort the kernel snapshot in creation order
+ * Prototype in : TaskStat.c
+ * \param    	: n---entries in taskStatus[]
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+static void TSTAT_SortByNumber(UBaseType_t n)
+{
+    TaskStatus_t tmp;
+    UBaseType_t i, j;
+
+    for (i = 1; i < n; i++)
+    {
+        tmp = taskStatus[i];
+        for (j = i; (j > 0) && (taskStatus[j - 1].xTaskNumber > tmp.xTaskNumber); j--)
+            taskStatus[j] = taskStatus[j - 1];
+        taskStatus[j] = tmp;
+    }
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : TSTAT_Update
+ * Description  : close the window, called once per second by
+ *                WeighProcessTask
+ * Prototype in : TaskStat.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void TSTAT_Update(void)
+{
+    TaskHandle_t idle = xTaskGetIdleTaskHandle();
+    uint32_t totalRunTime, window, run;
+    uint16_t idleShare = 0;
+    UBaseType_t n, i;
+
+    // the kernel suspends the scheduler while the tasks are listed and their stacks are checked
+    n = uxTaskGetSystemState(taskStatus, TSTAT_MAX_TASKS, &totalRunTime);
+    TSTAT_SortByNumber(n);
+
+    window = totalRunTime - prevTotalRunTime;
+    for (i = 0; i < n; i++)
+    {
+        // the counters wrap after 71 minutes of run time, the difference is still right
+        run = taskStatus[i].ulRunTimeCounter - prevRunTime[i];
+        if (prevTaskNumber[i] != taskStatus[i].xTaskNumber)
+            run = 0;        // new task in this slot
+        newList[i].name = taskStatus[i].pcTaskName;
+        newList[i].priority = (uint16_t)taskStatus[i].uxCurrentPriority;
+        newList[i].cpuPermille = (window != 0) ? (uint16_t)(((uint64_t)run * 1000 + window / 2) / window) : 0;
+        newList[i].stackFree = taskStatus[i].usStackHighWaterMark;
+        if (taskStatus[i].xHandle == idle)
+            idleShare = newList[i].cpuPermille;
+
+        prevRunTime[i] = taskStatus[i].ulRunTimeCounter;
+        prevTaskNumber[i] = taskStatus[i].xTaskNumber;
+    }
+    prevTotalRunTime = totalRunTime;
+
+    // the first window starts at reset and would count the start up time for the first task
+    if (!bBaseline)
+    {
+        bBaseline = true;
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    memcpy(taskList, newList, n * sizeof(TSTAT_tTask));
+    taskCount = (uint16_t)n;
+    idlePermille = idleShare;
+    windowUs = window;
+    taskEXIT_CRITICAL();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TSTAT_GetTask
+ * Description  : copy the values of one task of the last window
+ * Prototype in : TaskStat.h
+ * \param    	: index---0 = first task created
+ * \param    	: pTask---destination
+ * \return    	: false if there is no task with this index
+ *---------------------------------------------------------------------*/
+bool TSTAT_GetTask(uint32_t index, TSTAT_tTask *pTask)
+{
+    bool bValid;
+
+    taskENTER_CRITICAL();
+    bValid = (index < taskCount);
+    if (bValid)
+        *pTask = taskList[index];
+    taskEXIT_CRITICAL();
+    return bValid;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TSTAT_GetSummary
+ * Description  : task count and idle share of the last window, heap
+ *                values and context switches now
+ * Prototype in : TaskStat.h
+ * \param    	: pSummary---destination
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void TSTAT_GetSummary(TSTAT_tSummary *pSummary)
+{
+    taskENTER_CRITICAL();
+    pSummary->taskCount = taskCount;
+    pSummary->idlePermille = idlePermille;
+    pSummary->windowUs = windowUs;
+    pSummary->switches = tstatSwitches;
+    taskEXIT_CRITICAL();
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+    pSummary->heapSize = configTOTAL_HEAP_SIZE;
+    pSummary->heapFree = xPortGetFreeHeapSize();
+    pSummary->heapMinFree = xPortGetMinimumEverFreeHeapSize();
+#else
+    pSummary->heapSize = 0;
+    pSummary->heapFree = 0;
+    pSummary->heapMinFree = 0;
+#endif
+}
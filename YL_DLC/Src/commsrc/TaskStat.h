@@ -0,0 +1,49 @@
+#ifndef _TASK_STAT_H
+#define _TASK_STAT_H
+
+#include "comm.h"
+
+//==================================================================================================
+//  CPU share, stack and heap headroom of the FreeRTOS tasks
+//
+//  The kernel adds the get_time_us() time of every time slice to the run time of the task
+//  (configGENERATE_RUN_TIME_STATS). WeighProcessTask calls TSTAT_Update() once per second, the CPU
+//  share of a task is its run time in the last window. The first window starts with the first
+//  call, no task is listed before the second call.
+//
+//  The stack value is the high-water mark of the kernel: the smallest free stack since the task was
+//  created. The heap values are read live from heap_4, all 0 without dynamic allocation: the RTOS
+//  objects are static (configSUPPORT_DYNAMIC_ALLOCATION 0), their RAM is in the map file.
+//
+//  Tasks are listed in creation order, the list index is the slot of the Modbus task registers.
+//  The context switches since power on are counted by traceTASK_SWITCHED_IN() of FreeRTOSConfig.h,
+//  a switch back to the same task is not counted.
+//==================================================================================================
+
+//! tasks listed, more tasks are ignored
+#define TSTAT_MAX_TASKS         8
+
+typedef struct
+{
+    const char *name;
+    uint16_t priority;
+    uint16_t cpuPermille;           // run time in the last window [0.1 %]
+    uint16_t stackFree;             // lowest free stack [words]
+} TSTAT_tTask;
+
+typedef struct
+{
+    uint16_t taskCount;             // tasks listed
+    uint16_t idlePermille;          // CPU share of the idle task [0.1 %]
+    uint32_t windowUs;              // length of the last window
+    uint32_t heapSize;              // configTOTAL_HEAP_SIZE [bytes]
+    uint32_t heapFree;              // free heap now [bytes]
+    uint32_t heapMinFree;           // lowest free heap since power on [bytes]
+    uint32_t switches;              // context switches since power on
+} TSTAT_tSummary;
+
+void TSTAT_Update(void);
+bool TSTAT_GetTask(uint32_t index, TSTAT_tTask *pTask);
+void TSTAT_GetSummary(TSTAT_tSummary *pSummary);
+
+#endif
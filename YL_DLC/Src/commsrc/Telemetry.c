@@ -0,0 +1,223 @@
+#include <string.h>
+#include <math.h>
+
+#include "stm32f1xx_hal.h"
+#include "cmsis_os.h"
+
+#include "main.h"
+#include "usart.h"
+#include "Telemetry.h"
+#include "WeightBus.h"
+#include "RB_CRC.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+// SendComDMA() port, -1 = stream off
+static volatile int tlmPort = -1;
+
+// the DMA reads txBuf[txActive], the next record is built in the other buffer
+static uint8_t txBuf[2][TLM_FRAME_LEN];
+static uint8_t txActive = 0;
+
+static uint16_t tlmSeq = 0;
+static uint32_t lastSampleTime = 0;
+static bool bFirstSample = true;
+static TLM_tStat tlmStat;
+
+/**---------------------------------------------------------------------
+ * Name         : TLM_Put
+ * Description  : store the low n bytes of a value, little endian
+ * Prototype in : Telemetry.c
+ * \return    	: pointer behind the value
+ *---------------------------------------------------------------------*/
+static uint8_t *TLM_Put(uint8_t *p, uint32_t value, int n)
+{
+    while (n-- > 0)
+    {
+        *p++ = (uint8_t)value;
+        value >>= 8;
+    }
+    return p;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TLM_PutFloat
+ * Description  : store a float32, little endian
+ * Prototype in : Telemetry.c
+ * \return    	: pointer behind the value
+ *---------------------------------------------------------------------*/
+static uint8_t *TLM_PutFloat(uint8_t *p, double value)
+{
+    float32 f = (float32)value;
+    uint32_t bits;
+
+    memcpy(&bits, &f, sizeof(bits));
+    return TLM_Put(p, bits, 4);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TLM_Status
+ * Description  : status byte of a weight cycle
+ * Prototype in : Telemetry.c
+ * \param    	: pWeight---snapshot of the weight bus
+ * \return    	: TLM_STATUS_xxx bits
+ *---------------------------------------------------------------------*/
+static uint8_t TLM_Status(const WBUS_tWeight *pWeight)
+{
+    uint8_t status = 0;
+
+    if (pWeight->status & WBUS_STAT_MOTION)
+        status |= TLM_STATUS_MOTION;
+    if (pWeight->status & WBUS_STAT_NET)
+        status |= TLM_STATUS_NET;
+    if (pWeight->status & WBUS_STAT_COZ)
+        status |= TLM_STATUS_CENTER_ZERO;
+    if (pWeight->status & WBUS_STAT_OVER)
+        status |= TLM_STATUS_OVER_CAPACITY;
+    if (pWeight->status & WBUS_STAT_UNDER)
+        status |= TLM_STATUS_UNDER_ZERO;
+    if (!(pWeight->status & WBUS_STAT_ZERO_CAPTURED))
+        status |= TLM_STATUS_NO_POWERUP_ZERO;
+    return status;
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+/**---------------------------------------------------------------------
+ * Name         : TLM_SetPort
+ * Description  : start the stream on a port or stop it, the statistics
+ *                and the sequence number restart
+ * Prototype in : Telemetry.h
+ * \param    	: port---0 = COM1, 1 = COM2, -1 = off
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void TLM_SetPort(int port)
+{
+    if ((port < -1) || (port > 1))
+        port = -1;
+
+    taskENTER_CRITICAL();
+    tlmPort = -1;
+    memset(&tlmStat, 0, sizeof(tlmStat));
+    tlmSeq = 0;
+    bFirstSample = true;
+    tlmPort = port;
+    taskEXIT_CRITICAL();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TLM_GetPort
+ * Description  : port of the stream
+ * Prototype in : Telemetry.h
+ * \return    	: 0 = COM1, 1 = COM2, -1 = off
+ *---------------------------------------------------------------------*/
+int TLM_GetPort(void)
+{
+    return tlmPort;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TLM_Sample
+ * Description  : send the record of one ADC sample, called by
+ *                ADC_ProcessTask after the filter
+ * Prototype in : Telemetry.h
+ * \param    	: raw1, raw2---counts of the ADC channels
+ * \param    	: filtered---filtered counts
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void TLM_Sample(int32_t raw1, int32_t raw2, double filtered)
+{
+    uint8_t *pFrame;
+    uint8_t *p;
+    const WBUS_tWeight *pWeight;
+    uint16_t crc;
+    uint32_t now, interval;
+    uint8_t buf;
+    int port = tlmPort;
+
+    if (port < 0)
+        return;
+
+    now = get_time_us();
+
+    // txBuf[txActive] may still be read by the DMA, a new record is started only on an idle port
+    buf = txActive ^ 1;
+    pFrame = txBuf[buf];
+    p = pFrame;
+    *p++ = TLM_SYNC1;
+    *p++ = TLM_SYNC2;
+    p = TLM_Put(p, tlmSeq++, 2);
+    p = TLM_Put(p, now, 4);
+    p = TLM_Put(p, (uint32_t)raw1, 3);
+    p = TLM_Put(p, (uint32_t)raw2, 3);
+    p = TLM_Put(p, (uint32_t)(int32_t)floor(filtered + 0.5), 4);
+    // the weights are written by WeighProcessTask, a consistent set only from the weight bus
+    pWeight = WBUS_AcquireLatest();
+    if (pWeight != NULL)
+    {
+        p = TLM_PutFloat(p, pWeight->gross);
+        p = TLM_PutFloat(p, pWeight->net);
+        *p++ = TLM_Status(pWeight);
+        WBUS_Release(pWeight);
+    }
+    else
+    {
+        // no weight cycle yet
+        p = TLM_PutFloat(p, 0.0);
+        p = TLM_PutFloat(p, 0.0);
+        *p++ = TLM_STATUS_NO_POWERUP_ZERO;
+    }
+    crc = (uint16_t)RB_CRC_Calculate(pFrame, 0, TLM_FRAME_LEN - 2, &RB_CRC_16_CCITT_CFG);
+    *p++ = (uint8_t)(crc >> 8);
+    *p++ = (uint8_t)crc;
+
+    // statistics are reset by the command task, the check of the port state and the DMA start
+    // must not be split by a TX complete interrupt
+    taskENTER_CRITICAL();
+    if (!bFirstSample)
+    {
+        interval = now - lastSampleTime;
+        if ((tlmStat.intervalMin == 0) || (interval < tlmStat.intervalMin))
+            tlmStat.intervalMin = interval;
+        if (interval > tlmStat.intervalMax)
+            tlmStat.intervalMax = interval;
+        tlmStat.intervalSum += interval;
+        tlmStat.intervalCount++;
+    }
+    bFirstSample = false;
+    lastSampleTime = now;
+
+    if (SendComDMA(port, pFrame, TLM_FRAME_LEN) == HAL_OK)
+    {
+        txActive = buf;
+        tlmStat.sent++;
+    }
+    else
+    {
+        tlmStat.dropped++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TLM_GetStat
+ * Description  : copy the statistics of the stream
+ * Prototype in : Telemetry.h
+ * \param    	: pStat---destination, bReset---restart the statistics
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void TLM_GetStat(TLM_tStat *pStat, bool bReset)
+{
+    taskENTER_CRITICAL();
+    *pStat = tlmStat;
+    if (bReset)
+    {
+        memset(&tlmStat, 0, sizeof(tlmStat));
+        bFirstSample = true;
+    }
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,53 @@
+#ifndef _TELEMETRY_H
+#define _TELEMETRY_H
+
+#include "comm.h"
+
+//==================================================================================================
+//  Binary telemetry stream, one record per ADC sample
+//
+//  The record is sent with DMA on COM1 or COM2 by ADC_ProcessTask. A record that finds the port
+//  busy is dropped, its sequence number is used anyway so the receiver sees the gap. Weights and
+//  status are those of the last weight cycle on the weight bus, they change at 10 Hz.
+//
+//  offset  size  content (multi byte values little endian)
+//   0      2     sync 0xA5 0x5A
+//   2      2     sequence number, +1 per ADC sample
+//   4      4     get_time_us() of the sample
+//   8      3     raw counts ADC channel 1, signed
+//  11      3     raw counts ADC channel 2, signed
+//  14      4     filtered counts, signed
+//  18      4     gross weight, float32
+//  22      4     net weight, float32
+//  26      1     status, TLM_STATUS_xxx
+//  27      2     CRC-16/CCITT (poly 0x1021, init 0xFFFF) of bytes 0..26, high byte first
+//==================================================================================================
+
+#define TLM_SYNC1                   0xA5
+#define TLM_SYNC2                   0x5A
+#define TLM_FRAME_LEN               29
+
+#define TLM_STATUS_MOTION           0x01
+#define TLM_STATUS_NET              0x02
+#define TLM_STATUS_CENTER_ZERO      0x04
+#define TLM_STATUS_OVER_CAPACITY    0x08
+#define TLM_STATUS_UNDER_ZERO       0x10
+#define TLM_STATUS_NO_POWERUP_ZERO  0x20
+
+//! sender side statistics, the sample interval shows the jitter of ADC_ProcessTask
+typedef struct
+{
+    uint32_t sent;                  // records started on the port
+    uint32_t dropped;               // records dropped, port busy
+    uint32_t intervalMin;           // us between two samples
+    uint32_t intervalMax;
+    uint32_t intervalCount;
+    uint64_t intervalSum;
+} TLM_tStat;
+
+void TLM_SetPort(int port);
+int TLM_GetPort(void);
+void TLM_Sample(int32_t raw1, int32_t raw2, double filtered);
+void TLM_GetStat(TLM_tStat *pStat, bool bReset);
+
+#endif
@@ -0,0 +1,195 @@
+#include <string.h>
+
+#ifdef __ICCARM__
+#include "stm32f1xx_hal.h"
+#else
+#include <time.h>
+#endif
+
+#include "Trace.h"
+
+//==================================================================================================
+//  L O C A L   F U N C T I O N S   A N D   D A T A
+//==================================================================================================
+
+#ifdef __ICCARM__
+#define TRACE_TICKS_PER_US      (SystemCoreClock / 1000000)
+#else
+#define TRACE_TICKS_PER_US      1000        // TRACE_HostNow() counts ns
+#endif
+
+static const char * const stageName[TRACE_STAGE_NUM] =
+{
+    "SAMPLE", "ADC", "FILTER", "CYCLE", "STABFILT", "MOTION", "ZERO",
+    "LINEAR", "TARE", "FORMAT", "MBPARSE", "MBRESP", "TX1", "TX2"
+};
+
+static TRACE_tStat traceStat[TRACE_STAGE_NUM];
+// set by TRACE_Clear(), the statistics are cleared by the recording task
+static volatile bool bClearRequest[TRACE_STAGE_NUM];
+
+/**---------------------------------------------------------------------
+ * Name         : TRACE_Bin
+ * Description  : histogram bin of a duration
+ * Prototype in : Trace.c
+ * \return    	: 0..TRACE_HIST_BINS-1
+ *---------------------------------------------------------------------*/
+static uint32_t TRACE_Bin(uint32_t us)
+{
+    uint32_t n = 0;
+
+    if (us < 2)
+        return 0;
+    while ((us >> (n + 1)) != 0)
+        n++;
+    // n = floor(log2(us)), the next lower bit selects the half octave
+    n = 2 * n + ((us >> (n - 1)) & 1);
+    return (n < TRACE_HIST_BINS) ? n : TRACE_HIST_BINS - 1;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TRACE_BinLimit
+ * Description  : upper limit of a histogram bin
+ * Prototype in : Trace.c
+ * \return    	: us
+ *---------------------------------------------------------------------*/
+static uint32_t TRACE_BinLimit(uint32_t bin)
+{
+    uint32_t n = bin / 2;
+
+    if (bin == 0)
+        return 2;
+    if (bin & 1)
+        return 2UL << n;
+    return 3UL << (n - 1);
+}
+
+//==================================================================================================
+//  G L O B A L   F U N C T I O N S
+//==================================================================================================
+
+#if TRACE_ENABLE && !defined(__ICCARM__)
+/**---------------------------------------------------------------------
+ * Name         : TRACE_HostNow
+ * Description  : time base of TRACE_START/TRACE_STOP on a host build
+ * Prototype in : Trace.h
+ * \return    	: ns of the monotonic clock, modulo 2^32
+ *---------------------------------------------------------------------*/
+uint32_t TRACE_HostNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+/**---------------------------------------------------------------------
+ * Name         : TRACE_Record
+ * Description  : add one execution of a stage, called by TRACE_STOP
+ * Prototype in : Trace.h
+ * \param    	: stage---TRACE_STAGE_xxx
+ * \param    	: ticks---duration in cycles (ns on a host build)
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void TRACE_Record(TRACE_tStage stage, uint32_t ticks)
+{
+    TRACE_tStat *pStat;
+    uint32_t us, bin, i;
+
+    if (stage >= TRACE_STAGE_NUM)
+        return;
+
+    pStat = &traceStat[stage];
+    if (bClearRequest[stage])
+    {
+        memset(pStat, 0, sizeof(TRACE_tStat));
+        bClearRequest[stage] = false;
+    }
+
+    us = ticks / TRACE_TICKS_PER_US;
+    if ((pStat->count == 0) || (us < pStat->minUs))
+        pStat->minUs = us;
+    if (us > pStat->maxUs)
+        pStat->maxUs = us;
+    pStat->sumUs += us;
+    pStat->count++;
+
+    // a full bin halves the histogram, the percentiles stay
+    bin = TRACE_Bin(us);
+    if (pStat->hist[bin] == 0xFFFF)
+    {
+        for (i = 0; i < TRACE_HIST_BINS; i++)
+            pStat->hist[i] >>= 1;
+    }
+    pStat->hist[bin]++;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TRACE_GetStat
+ * Description  : copy the statistics of a stage
+ * Prototype in : Trace.h
+ * \param    	: stage---TRACE_STAGE_xxx, pStat---destination
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void TRACE_GetStat(TRACE_tStage stage, TRACE_tStat *pStat)
+{
+    if ((stage >= TRACE_STAGE_NUM) || bClearRequest[stage])
+        memset(pStat, 0, sizeof(TRACE_tStat));
+    else
+        *pStat = traceStat[stage];
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TRACE_Percentile
+ * Description  : percentile from the histogram, upper limit of the bin
+ *                limited to the maximum
+ * Prototype in : Trace.h
+ * \param    	: pStat---statistics, permille---990 = 99th percentile
+ * \return    	: us, 0 = no samples
+ *---------------------------------------------------------------------*/
+uint32_t TRACE_Percentile(const TRACE_tStat *pStat, uint32_t permille)
+{
+    uint32_t total = 0, sum = 0, target, i;
+
+    for (i = 0; i < TRACE_HIST_BINS; i++)
+        total += pStat->hist[i];
+    if (total == 0)
+        return 0;
+
+    target = (total * permille + 999) / 1000;
+    for (i = 0; i < TRACE_HIST_BINS - 1; i++)
+    {
+        sum += pStat->hist[i];
+        if (sum >= target)
+            break;
+    }
+    return (TRACE_BinLimit(i) < pStat->maxUs) ? TRACE_BinLimit(i) : pStat->maxUs;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TRACE_Clear
+ * Description  : restart the statistics of all stages
+ * Prototype in : Trace.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void TRACE_Clear(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < TRACE_STAGE_NUM; i++)
+        bClearRequest[i] = true;
+}
+
+/**---------------------------------------------------------------------
+ * Name         : TRACE_GetStageName
+ * Description  : name of a stage for the command output
+ * Prototype in : Trace.h
+ * \return    	: name, "" = invalid stage
+ *---------------------------------------------------------------------*/
+const char *TRACE_GetStageName(TRACE_tStage stage)
+{
+    if (stage >= TRACE_STAGE_NUM)
+        return "";
+    return stageName[stage];
+}
@@ -0,0 +1,85 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include "comm.h"
+
+//==================================================================================================
+//  Execution time of the hot path stages
+//
+//  TRACE_START(stage) ... TRACE_STOP(stage) measure a stage with the DWT cycle counter (started by
+//  BOOT_Init()), on a host build with the monotonic clock. Every stage keeps count, min, max, sum
+//  and a histogram with two bins per octave of us for the 99th percentile.
+//
+//  The interrupts are not disabled: every stage is recorded by one task only, the statistics are
+//  cleared by that task on request. A copy taken by TRACE_GetStat() may mix two samples.
+//
+//  TRACE_ENABLE 0 removes all hooks.
+//==================================================================================================
+
+#define TRACE_ENABLE            1
+
+//! histogram bins, bin 2n counts [2^n, 1.5 * 2^n) us, bin 2n+1 [1.5 * 2^n, 2^(n+1)) us
+#define TRACE_HIST_BINS         32
+
+typedef enum
+{
+    TRACE_STAGE_SAMPLE = 0,         // ADC_ProcessTask, one sample from read to snapshot
+    TRACE_STAGE_ADC,                // read both ADS1230
+    TRACE_STAGE_FILTER,             // execute_filter()
+    TRACE_STAGE_CYCLE,              // WeighProcessTask, one weight cycle
+    TRACE_STAGE_STABFILT,           // FilterWeight()
+    TRACE_STAGE_MOTION,             // SCALE_PostProcess(): unit switch, range, motion
+    TRACE_STAGE_ZERO,               // power up zero, zero command, zero tracking
+    TRACE_STAGE_LINEAR,             // linearity, unit conversion, rounding
+    TRACE_STAGE_TARE,               // over capacity, tare, net and gross weight
+    TRACE_STAGE_FORMAT,             // weight strings
+    TRACE_STAGE_MBPARSE,            // ModbusRTU_Process() up to the response
+    TRACE_STAGE_MBRESP,             // Modbus CRC and send
+    TRACE_STAGE_TX1,                // SendCom() on COM1, wait for the port and start
+    TRACE_STAGE_TX2,                // SendCom() on COM2
+    TRACE_STAGE_NUM
+} TRACE_tStage;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t sumUs;
+    uint16_t hist[TRACE_HIST_BINS];
+} TRACE_tStat;
+
+#if TRACE_ENABLE
+
+#ifdef __ICCARM__
+#include "stm32f1xx.h"
+#define TRACE_NOW()             (DWT->CYCCNT)
+#else
+#define TRACE_NOW()             TRACE_HostNow()
+uint32_t TRACE_HostNow(void);
+#endif
+
+//! start a stage, use only paired with TRACE_STOP in the same block
+#define TRACE_START(stage) \
+    { \
+        uint32_t traceStart_##stage = TRACE_NOW() /* force trailing semicolon */
+
+//! stop a stage
+#define TRACE_STOP(stage) \
+        TRACE_Record(stage, TRACE_NOW() - traceStart_##stage); \
+    } do {} while (0) /* force trailing semicolon */
+
+#else
+
+#define TRACE_START(stage)
+#define TRACE_STOP(stage)
+
+#endif
+
+void TRACE_Record(TRACE_tStage stage, uint32_t ticks);
+void TRACE_GetStat(TRACE_tStage stage, TRACE_tStat *pStat);
+uint32_t TRACE_Percentile(const TRACE_tStat *pStat, uint32_t permille);
+void TRACE_Clear(void);
+const char *TRACE_GetStageName(TRACE_tStage stage);
+
+#endif
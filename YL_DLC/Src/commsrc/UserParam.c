@@ -1,13 +1,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 
 #include "main.h"
 #include "stm32F1xx_hal.h"
 #include "stm32f1xx_hal_i2c.h"
 #include "i2c.h"
+#include "cmsis_os.h"
 
 #include "UserParam.h"
+#include "EventLoop.h"
+#include "RB_CRC.h"
 
 
 // Block storage type
@@ -16,20 +20,93 @@ const uint16_t blockStorageType[MAX_BLOCK_NUM] = {
 };
 
 // Parameter table, i.e. definition list of all parameters
+#define USER_PARAM_ENTRY(ident, size)   {ident, size},
 const USER_PARAM_tTableEntry USER_PARAM_Table[] = {
     USER_PARAM_DEFINITIONS
 };
+#undef USER_PARAM_ENTRY
 
 //! Size of parameter table
 const int USER_PARAM_TableSize = sizeof(USER_PARAM_Table) / sizeof(USER_PARAM_tTableEntry);
 
+// Byte layout of all parameters in table order, the compiler sums up the offsets
+#define USER_PARAM_ENTRY(ident, size)   uint8_t ident[size];
+typedef struct
+{
+    USER_PARAM_DEFINITIONS
+} USER_PARAM_tLayout;
+#undef USER_PARAM_ENTRY
+
+// the parameters must fit into the eeprom images
+typedef char USER_PARAM_tLayoutCheck[(sizeof(USER_PARAM_tLayout) <= MAX_APP_PARAM_SIZE + MAX_MFG_PARAM_SIZE) ? 1 : -1];
+
+// Parameter index, offset and size of every identifier without a table search
+#define USER_PARAM_ENTRY(ident, size)   [ident] = {offsetof(USER_PARAM_tLayout, ident), size},
+static const USER_PARAM_tIndexEntry paramIndex[USER_PARAM_IDENT_NUM] = {
+    USER_PARAM_DEFINITIONS
+};
+#undef USER_PARAM_ENTRY
+
 static USER_PARAM_tBlockInfo blockInfo[MAX_BLOCK_NUM];
+// offset of the first parameter of each storage type in USER_PARAM_tLayout
+static uint16_t storageBase[2];
 static uint8_t eeAppMap[MAX_APP_PARAM_SIZE];
 static uint8_t eeMfgMap[MAX_MFG_PARAM_SIZE];
 
+// Write-behind of the application storage: USER_PARAM_Set() changes eeAppMap only, the flush task
+// commits each changed block as a record, header and block data, to the next free pages of the
+// ring. The record of the last commit of every block is never overwritten, a reset during a
+// commit leaves it valid. A record written in part fails its CRC.
+typedef struct
+{
+  uint32_t seq;             // counts all records, the greater one is the newer record
+  uint16_t block;           // block index
+  uint16_t crc;             // CRC-16/CCITT of the block data, sequence number and block index
+} USER_PARAM_tRecordHeader;
+
+#define USER_PARAM_RING_PAGES               ((EE_SIZE - EE_RING_BASE) / EE_PAGE_SIZE)
+#define USER_PARAM_RECORD_ADDR(page)        (EE_RING_BASE + (page) * EE_PAGE_SIZE)
+#define USER_PARAM_RECORD_PAGES(block)      ((sizeof(USER_PARAM_tRecordHeader) + blockInfo[block].blockSize + EE_PAGE_SIZE - 1) / EE_PAGE_SIZE)
+#define USER_PARAM_NO_RECORD                0xFF
+
+static uint8_t recordPage[MAX_BLOCK_NUM];           // ring page of the last record of a block
+static uint8_t ringHead;                            // ring page after the last record written
+static uint32_t ringSeq;                            // sequence number of the last record written
+static uint8_t pendingBlocks;                       // bit n = block n changed since its last commit
+static uint8_t transactionDepth;                    // > 0: USER_PARAM_Begin() without commit
+
+// time in ms USER_PARAM_Sync() waits for the transaction of another task
+#define USER_PARAM_SYNC_WAIT    USER_PARAM_FLUSH_DELAY
+
+// the ring takes the records of all blocks and leaves room to write the largest one once more
+typedef char USER_PARAM_tRingCheck[(USER_PARAM_RING_PAGES * EE_PAGE_SIZE >= 2 * MAX_APP_PARAM_SIZE) && (USER_PARAM_RING_PAGES < USER_PARAM_NO_RECORD) ? 1 : -1];
+
+// created in freertos.c
+extern osMutexId eeMutexHandle;
+#if (APP_EVENT_LOOP == 0)
+extern osSemaphoreId eeFlushSemHandle;
+#endif
+
+// Before the scheduler runs there is neither a flush task nor a second caller, the parameters are
+// written at once and without locks
+#define USER_PARAM_LOCK()       do { if (osKernelRunning()) vTaskSuspendAll(); } while (0)
+#define USER_PARAM_UNLOCK()     do { if (osKernelRunning()) xTaskResumeAll(); } while (0)
+#define USER_PARAM_IO_LOCK()    do { if (osKernelRunning()) osMutexWait(eeMutexHandle, osWaitForever); } while (0)
+#define USER_PARAM_IO_UNLOCK()  do { if (osKernelRunning()) osMutexRelease(eeMutexHandle); } while (0)
+
 
 //static USER_PARAM_tStatus RestoreBackupBlock(int32_t blockIndex, uint8_t *param);
 static uint16_t USER_PARAM_CalcBlockChecksum(int32_t blockIndex, uint8_t *pBlock);
+static uint16_t USER_PARAM_CalcLegacyChecksum(int32_t blockIndex, uint8_t *pBlock);
+static bool USER_PARAM_CheckBlockChecksum(int32_t blockIndex, uint8_t *pBlock);
+static uint16_t USER_PARAM_Lookup(USER_PARAM_tIdent ident, int32_t *pOffset);
+static void USER_PARAM_MarkDirty(int32_t blockIndex);
+static USER_PARAM_tStatus USER_PARAM_Schedule(void);
+static void USER_PARAM_ScanRing(const uint32_t *pBound, uint8_t *pPage, uint32_t *pSeq);
+static bool USER_PARAM_LoadAppBlock(int32_t blockIndex, uint8_t page, uint32_t seq);
+static int32_t USER_PARAM_FindRecordPlace(int32_t pages);
+static USER_PARAM_tStatus USER_PARAM_CommitBlock(int32_t blockIndex);
+static uint16_t USER_PARAM_CalcRecordCrc(int32_t blockIndex, const uint8_t *pBlock, const USER_PARAM_tRecordHeader *pHeader);
 
 /*---------------------------------------------------------------------*
  * Name         : USER_PARAM_Initialize
@@ -43,6 +120,8 @@ int USER_PARAM_Initialize(void)
 {
     int i, offsetApp, offsetMfg, size, blockIndex, blockError;
     USER_PARAM_tStatus readStatus;
+    uint32_t bound[MAX_BLOCK_NUM], seq[MAX_BLOCK_NUM];
+    uint8_t page[MAX_BLOCK_NUM];
     
     for (i = 0; i < MAX_BLOCK_NUM; i++)
     {
@@ -84,13 +163,27 @@ int USER_PARAM_Initialize(void)
     }
     blockInfo[blockIndex].endIndex  = i;    // the last block info
     blockInfo[blockIndex].blockSize = size; // the last block info
+
+    // blocks of the application storage are ahead of the manufacture storage blocks
+    storageBase[STORAGE_APP] = 0;
+    storageBase[STORAGE_MFG] = offsetApp;
     
+    pendingBlocks = 0;
+    transactionDepth = 0;
+    ringHead = 0;
+    ringSeq = 0;
+    memset(recordPage, USER_PARAM_NO_RECORD, sizeof(recordPage));
+
+    // the newest record of every block from one pass over the ring
+    memset(bound, 0xFF, sizeof(bound));
+    USER_PARAM_ScanRing(bound, page, seq);
+
     blockError = 0;    
     // for (i = 0; i < MAX_BLOCK_NUM; i++)
     for (i = 0; i < EEPROM_USEDBLOCKS; i++)
     {
         if (blockStorageType[i] == STORAGE_APP)
-            readStatus = USER_PARAM_GetBlock(i, &eeAppMap[blockInfo[i].blockOffset]);
+            readStatus = USER_PARAM_LoadAppBlock(i, page[i], seq[i]) ? USER_PARAM_OK : USER_PARAM_APP_BLOCK_CHECKSUM_ERROR;
         else
             readStatus = USER_PARAM_GetBlock(i, &eeMfgMap[blockInfo[i].blockOffset]);
         
@@ -103,9 +196,30 @@ int USER_PARAM_Initialize(void)
     return blockError;
 }
 
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_Lookup
+ * Description  : Find offset and size of a parameter in the parameter index
+ * Paremeter    : ident:the parameter identifier
+ *                pOffset:offset of the parameter in its storage
+ * Return value : size of the parameter, 0 = identifier not found
+ *---------------------------------------------------------------------*/
+static uint16_t USER_PARAM_Lookup(USER_PARAM_tIdent ident, int32_t *pOffset)
+{
+    const USER_PARAM_tIndexEntry *pEntry;
+
+    if ((uint32_t)ident >= USER_PARAM_IDENT_NUM)
+        return 0;
+
+    pEntry = &paramIndex[ident];
+    if (pEntry->dataSize != 0)
+        *pOffset = pEntry->offset - storageBase[blockStorageType[ident / 100]];
+    return pEntry->dataSize;
+}
+
 USER_PARAM_tStatus USER_PARAM_Get(USER_PARAM_tIdent ident, uint8_t* param)
 {
-    int32_t i, offset, blockIndex;
+    int32_t offset, blockIndex;
+    uint16_t dataSize;
     HAL_StatusTypeDef readStatus;
     USER_PARAM_tStorageType storageType;
     
@@ -114,26 +228,20 @@ USER_PARAM_tStatus USER_PARAM_Get(USER_PARAM_tIdent ident, uint8_t* param)
     if (blockIndex >= MAX_BLOCK_NUM)
         return USER_PARAM_TOO_MUCH_BLOCK;
     
-    offset = blockInfo[blockIndex].blockOffset;
     // Get the parameter offset
-    for (i = blockInfo[blockIndex].startIndex; i < blockInfo[blockIndex].endIndex; i++)
-    {
-        if (USER_PARAM_Table[i].paramId == ident)
-            break;
-        
-        offset += USER_PARAM_Table[i].dataSize;
-    }
-    
-    if (i < blockInfo[blockIndex].endIndex)     // found parameter ID
+    dataSize = USER_PARAM_Lookup(ident, &offset);
+    if (dataSize != 0)      // found parameter ID
     {
         storageType = (USER_PARAM_tStorageType)blockStorageType[blockIndex];
         
         if (storageType == STORAGE_APP)       // get single parameter from eeprom immage
-            memcpy(param, &eeAppMap[offset], USER_PARAM_Table[i].dataSize);
+            memcpy(param, &eeAppMap[offset], dataSize);
         else if (storageType == STORAGE_MFG)
         {
 
-           readStatus =  EEPROM_Read(EE_MFG_BASE+offset, param,USER_PARAM_Table[i].dataSize, 4000);
+            USER_PARAM_IO_LOCK();
+           readStatus =  EEPROM_Read(EE_MFG_BASE+offset, param, dataSize, 4000);
+            USER_PARAM_IO_UNLOCK();
             if (readStatus != HAL_OK)
                 return USER_PARAM_MFG_READ_ERROR;
         }
@@ -154,7 +262,8 @@ USER_PARAM_tStatus USER_PARAM_Get(USER_PARAM_tIdent ident, uint8_t* param)
  *---------------------------------------------------------------------*/
 USER_PARAM_tStatus USER_PARAM_Set(USER_PARAM_tIdent ident, uint8_t* param)
 {
-    int32_t i, j, offset, blockIndex, paramOffset, checksumOffset;
+    int32_t i, blockIndex, paramOffset, checksumOffset;
+    uint16_t dataSize;
     HAL_StatusTypeDef status1;
     USER_PARAM_tStorageType storageType;
     uint16_t checksum;
@@ -165,65 +274,37 @@ USER_PARAM_tStatus USER_PARAM_Set(USER_PARAM_tIdent ident, uint8_t* param)
     if (blockIndex >= MAX_BLOCK_NUM)
         return USER_PARAM_TOO_MUCH_BLOCK;
   
-    offset = blockInfo[blockIndex].blockOffset;
     // Get the parameter offset
-    for (i = blockInfo[blockIndex].startIndex; i < blockInfo[blockIndex].endIndex; i++)
-    {
-        if (USER_PARAM_Table[i].paramId == ident)
-        {
-            paramOffset = offset;
-            j = i;
-        }
-        offset += USER_PARAM_Table[i].dataSize;
-    }
+    dataSize = USER_PARAM_Lookup(ident, &paramOffset);
 
     checksumOffset = blockInfo[blockIndex].blockOffset + blockInfo[blockIndex].blockSize - 2;
     storageType = (USER_PARAM_tStorageType)blockStorageType[blockIndex];
-    if (j < blockInfo[blockIndex].endIndex)
+    if (dataSize != 0)
     {
         if (storageType == STORAGE_APP)
         {
-          /*to check if the parameter changed*/
-          for (i = 0; i < USER_PARAM_Table[j].dataSize; i++)
-          {
-            if (param[i] != eeAppMap[paramOffset+i])
-                break;
-          }
-          if (i == USER_PARAM_Table[j].dataSize)
-          {
-            checksum = USER_PARAM_CalcBlockChecksum(blockIndex, &eeAppMap[blockInfo[blockIndex].blockOffset]);
-            pChecksum = (uint8_t *)&checksum;
-            /* There is no change for parameter, no need to write*/
-            if ((pChecksum[0] == eeAppMap[checksumOffset]) && (pChecksum[1] == eeAppMap[checksumOffset+1]))
-                return USER_PARAM_OK;       
-          }
-          
-
-          status1 = EEPROM_Write(EE_APP_BASE+paramOffset, param,USER_PARAM_Table[j].dataSize, 4000);
-             if (status1 == HAL_OK)
-          {
-//             HAL_Delay(20); 
-              EEPROM_Read(EE_APP_BASE+paramOffset, param, USER_PARAM_Table[j].dataSize, 4000);
-              memcpy(&eeAppMap[paramOffset], param, USER_PARAM_Table[j].dataSize);
-              /*Recalculate the block checksum*/
-              checksum = USER_PARAM_CalcBlockChecksum(blockIndex, &eeAppMap[blockInfo[blockIndex].blockOffset]);
-             
-             status1 = EEPROM_Write(EE_APP_BASE+checksumOffset, (uint8_t *)&checksum, 2, 4000);
-//             HAL_Delay(20); 
-          }
-   
-          
-          if (status1 != HAL_OK)
-              return USER_PARAM_APP_WRITE_ERROR;
+            USER_PARAM_LOCK();
+            /*to check if the parameter changed*/
+            if (memcmp(param, &eeAppMap[paramOffset], dataSize) == 0)
+            {
+                /* There is no change for parameter, no need to write*/
+                USER_PARAM_UNLOCK();
+                return USER_PARAM_OK;
+            }
+            memcpy(&eeAppMap[paramOffset], param, dataSize);
+            USER_PARAM_MarkDirty(blockIndex);
+            USER_PARAM_UNLOCK();
+
+            return USER_PARAM_Schedule();
         }
         else if (storageType == STORAGE_MFG)
         {
-            for (i = 0; i < USER_PARAM_Table[j].dataSize; i++)
+            for (i = 0; i < dataSize; i++)
             {
                 if (param[i] != eeMfgMap[paramOffset+i])
                     break;
             }
-            if (i == USER_PARAM_Table[j].dataSize)
+            if (i == dataSize)
             {
                 checksum = USER_PARAM_CalcBlockChecksum(blockIndex, &eeMfgMap[blockInfo[blockIndex].blockOffset]);
                 pChecksum = (uint8_t *)&checksum;
@@ -232,16 +313,19 @@ USER_PARAM_tStatus USER_PARAM_Set(USER_PARAM_tIdent ident, uint8_t* param)
                     return USER_PARAM_OK;       
             }
 
-            status1 = EEPROM_Write(EE_MFG_BASE+paramOffset, param, USER_PARAM_Table[j].dataSize, 0xFFFF);
+            // manufacture parameters are rarely written and read back from the eeprom, no write-behind
+            USER_PARAM_IO_LOCK();
+            status1 = EEPROM_Write(EE_MFG_BASE+paramOffset, param, dataSize, 0xFFFF);
 //            HAL_Delay(20); 
             if (status1 == HAL_OK)
             {
-                memcpy(&eeMfgMap[paramOffset], param, USER_PARAM_Table[j].dataSize);
+                memcpy(&eeMfgMap[paramOffset], param, dataSize);
                 /*Recalculate the block checksum*/
                 checksum = USER_PARAM_CalcBlockChecksum(blockIndex, &eeMfgMap[blockInfo[blockIndex].blockOffset]);
                 status1 = EEPROM_Write(EE_MFG_BASE+checksumOffset, (uint8_t *)&checksum,2, 0xFFFF);
 //                HAL_Delay(20); 
             }
+            USER_PARAM_IO_UNLOCK();
                   
             if (status1 != HAL_OK)
                 return USER_PARAM_MFG_WRITE_ERROR;           
@@ -255,45 +339,28 @@ USER_PARAM_tStatus USER_PARAM_Set(USER_PARAM_tIdent ident, uint8_t* param)
 
 USER_PARAM_tStatus USER_PARAM_GetBlock(int32_t blockIndex, uint8_t *param)
 {
-    uint16_t checksumCalc = 0;
-    int32_t  checksumOffset;
-    // uint16_t *pChecksumGet;
-    uint8_t *pChecksum;
     USER_PARAM_tStorageType storageType;
     HAL_StatusTypeDef readStatus;
     
-    /*Get the start address of block checksum stored in EEPROM*/
-    checksumOffset = blockInfo[blockIndex].blockSize-2;
-    
     storageType = (USER_PARAM_tStorageType)blockStorageType[blockIndex];
     if (storageType == STORAGE_APP)
     {
-        /*Read all block parameters back,including the 2 checksum bytes*/
-
-        readStatus = EEPROM_Read( EE_APP_BASE+blockInfo[blockIndex].blockOffset, param, blockInfo[blockIndex].blockSize, 4000);
-        if (readStatus == HAL_OK)
-        {
-            /* calculate block checksum*/
-            checksumCalc = USER_PARAM_CalcBlockChecksum(blockIndex, param);
-            pChecksum = (uint8_t *)&checksumCalc;
-            if ((pChecksum[0] != (uint8_t)param[checksumOffset]) || (pChecksum[1] != (uint8_t)param[checksumOffset+1]))
-                return USER_PARAM_APP_BLOCK_CHECKSUM_ERROR; 
-        }
-        else
-            return USER_PARAM_APP_READ_ERROR;            
-      
+        // the records were checked by USER_PARAM_Initialize(), eeAppMap holds the newest values
+        USER_PARAM_LOCK();
+        memcpy(param, &eeAppMap[blockInfo[blockIndex].blockOffset], blockInfo[blockIndex].blockSize);
+        USER_PARAM_UNLOCK();
     }
     else if (storageType == STORAGE_MFG)
     {
 //        readStatus = RB_EEPROM_Read(RB_CONFIG_I2C_DEV_EEPROM_MAIN, EE_MFG_BASE+blockInfo[blockIndex].blockOffset, param, blockInfo[blockIndex].blockSize);
 //        readStatus = HAL_I2C_Master_Receive(&hi2c1, EE_MFG_BASE+blockInfo[blockIndex].blockOffset, param, blockInfo[blockIndex].blockSize, 200);
+        USER_PARAM_IO_LOCK();
         readStatus = EEPROM_Read(EE_MFG_BASE+blockInfo[blockIndex].blockOffset, param, blockInfo[blockIndex].blockSize, 4000);
+        USER_PARAM_IO_UNLOCK();
         if (readStatus == HAL_OK)
         {
             /* calculate block checksum*/
-            checksumCalc = USER_PARAM_CalcBlockChecksum(blockIndex, param);
-            pChecksum = (uint8_t *)&checksumCalc;
-            if ((pChecksum[0] != (uint8_t)param[checksumOffset]) || (pChecksum[1] != (uint8_t)param[checksumOffset+1]))
+            if (!USER_PARAM_CheckBlockChecksum(blockIndex, param))
                 return USER_PARAM_MFG_BLOCK_CHECKSUM_ERROR;
         }
         else
@@ -318,18 +385,19 @@ USER_PARAM_tStatus USER_PARAM_SetBlock(int32_t blockIndex, uint8_t* param)
     storageType = (USER_PARAM_tStorageType)blockStorageType[blockIndex];
     if (storageType == STORAGE_APP)
     {
-        status1 = EEPROM_Write(EE_APP_BASE+blockInfo[blockIndex].blockOffset, param, blockInfo[blockIndex].blockSize, 0XFFFF);
-        if (status1 == HAL_OK)
-            memcpy(&eeAppMap[blockInfo[blockIndex].blockOffset], param, blockInfo[blockIndex].blockSize);
-
-        
-        if (status1 != HAL_OK)
-            return USER_PARAM_APP_WRITE_ERROR;
+        USER_PARAM_LOCK();
+        memcpy(&eeAppMap[blockInfo[blockIndex].blockOffset], param, blockInfo[blockIndex].blockSize);
+        USER_PARAM_MarkDirty(blockIndex);
+        USER_PARAM_UNLOCK();
 
+        // a whole block is written synchronously as before
+        return USER_PARAM_Sync();
     }
     else if (storageType == STORAGE_MFG)
     {      
+        USER_PARAM_IO_LOCK();
           status1 = EEPROM_Write(EE_MFG_BASE+blockInfo[blockIndex].blockOffset, param, blockInfo[blockIndex].blockSize, 0XFFFF);
+        USER_PARAM_IO_UNLOCK();
 
         if (status1 != HAL_OK)
             return USER_PARAM_MFG_WRITE_ERROR;            
@@ -338,10 +406,382 @@ USER_PARAM_tStatus USER_PARAM_SetBlock(int32_t blockIndex, uint8_t* param)
     return USER_PARAM_OK;
 }
 
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_Flush
+ * Prototype in : UserParam.h
+ * Description  : Commit the changed blocks of the application storage,
+ *                called by the flush task. Nothing is written while a
+ *                transaction is open.
+ * Return value : USER_PARAM_OK, USER_PARAM_APP_WRITE_ERROR or
+ *                USER_PARAM_APP_BUSY, the blocks not written stay pending
+ *---------------------------------------------------------------------*/
+USER_PARAM_tStatus USER_PARAM_Flush(void)
+{
+    int32_t i;
+    USER_PARAM_tStatus blockStatus;
+    USER_PARAM_tStatus status = USER_PARAM_OK;
 
+    USER_PARAM_IO_LOCK();
+    for (i = 0; i < MAX_BLOCK_NUM; i++)
+    {
+        if (pendingBlocks & (1 << i))
+        {
+            blockStatus = USER_PARAM_CommitBlock(i);
+            if ((blockStatus != USER_PARAM_OK) && (status != USER_PARAM_APP_WRITE_ERROR))
+                status = blockStatus;
+        }
+    }
+    USER_PARAM_IO_UNLOCK();
 
+    return status;
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_Sync
+ * Prototype in : UserParam.h
+ * Description  : Write barrier: all parameters set before the call are in
+ *                the eeprom at return. The transaction of another task is
+ *                waited for up to USER_PARAM_SYNC_WAIT ms, a transaction
+ *                of the caller is never closed. Used before a reset and
+ *                by callers which need the parameters durable.
+ * Return value : USER_PARAM_OK = no block pending,
+ *                USER_PARAM_APP_WRITE_ERROR, USER_PARAM_APP_BUSY
+ *---------------------------------------------------------------------*/
+USER_PARAM_tStatus USER_PARAM_Sync(void)
+{
+    USER_PARAM_tStatus status;
+    int32_t wait = 0;
+
+    for (;;)
+    {
+        status = USER_PARAM_Flush();
+        if (status == USER_PARAM_APP_WRITE_ERROR)
+            return status;
+        if (!USER_PARAM_IsDirty())
+            return USER_PARAM_OK;
+        // before the scheduler runs the transaction is the caller's own
+        if (!osKernelRunning() || (wait >= USER_PARAM_SYNC_WAIT))
+            return USER_PARAM_APP_BUSY;
+        osDelay(1);
+        wait++;
+    }
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_Begin
+ * Prototype in : UserParam.h
+ * Description  : Open a transaction, the parameters set until
+ *                USER_PARAM_Commit() are written together. Parameters of
+ *                one block, e.g. a calibration set, are valid all or none
+ *                after a reset. Every USER_PARAM_Begin() needs its
+ *                USER_PARAM_Commit().
+ *---------------------------------------------------------------------*/
+void USER_PARAM_Begin(void)
+{
+    USER_PARAM_LOCK();
+    transactionDepth++;
+    USER_PARAM_UNLOCK();
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_Commit
+ * Prototype in : UserParam.h
+ * Description  : Close the transaction of USER_PARAM_Begin(). The flush
+ *                task writes its changes when the last transaction is
+ *                closed, USER_PARAM_Sync() waits for them.
+ * Return value : see USER_PARAM_Schedule
+ *---------------------------------------------------------------------*/
+USER_PARAM_tStatus USER_PARAM_Commit(void)
+{
+    bool bClosed;
+
+    USER_PARAM_LOCK();
+    if (transactionDepth > 0)
+        transactionDepth--;
+    bClosed = (transactionDepth == 0) && (pendingBlocks != 0);
+    USER_PARAM_UNLOCK();
+
+    if (!bClosed)
+        return USER_PARAM_OK;
+    return USER_PARAM_Schedule();
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_IsDirty
+ * Prototype in : UserParam.h
+ * Description  : Check for changes not yet written to the eeprom
+ *---------------------------------------------------------------------*/
+bool USER_PARAM_IsDirty(void)
+{
+    return (pendingBlocks != 0);
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_FindRecordPlace
+ * Description  : First pages from the ring head on which a record fits
+ *                without overwriting the last record of a block. A record
+ *                does not wrap, the pages at the end of the ring too few
+ *                for it are skipped. Called with USER_PARAM_IO_LOCK.
+ * Return value : ring page, -1 = no room
+ *---------------------------------------------------------------------*/
+static int32_t USER_PARAM_FindRecordPlace(int32_t pages)
+{
+    int32_t i, block, first, end;
+    int32_t page = ringHead;
+
+    for (i = 0; i <= USER_PARAM_RING_PAGES; i++)
+    {
+        if (page + pages > USER_PARAM_RING_PAGES)
+            page = 0;
+        // the end of a record in the way, if any
+        end = page;
+        for (block = 0; block < MAX_BLOCK_NUM; block++)
+        {
+            if (recordPage[block] == USER_PARAM_NO_RECORD)
+                continue;
+            first = recordPage[block];
+            if ((first < page + pages) && (page < first + (int32_t)USER_PARAM_RECORD_PAGES(block)))
+            {
+                end = first + USER_PARAM_RECORD_PAGES(block);
+                break;
+            }
+        }
+        if (end == page)
+            return page;
+        page = end;
+    }
+    return -1;
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_CommitBlock
+ * Description  : Write a block as a new record to the ring, which makes
+ *                it the last record of the block. The data is written in
+ *                pieces of a page, a change during the write restarts the
+ *                commit. A transaction opened meanwhile stops it, the
+ *                block stays pending until the transaction is committed.
+ *                Called with USER_PARAM_IO_LOCK.
+ *---------------------------------------------------------------------*/
+static USER_PARAM_tStatus USER_PARAM_CommitBlock(int32_t blockIndex)
+{
+    int32_t retry, page, pages, offset, size;
+    uint16_t address;
+    uint8_t buf[EE_PAGE_SIZE];
+    USER_PARAM_tRecordHeader header;
+    int32_t blockOffset = blockInfo[blockIndex].blockOffset;
+    int32_t blockSize = blockInfo[blockIndex].blockSize;
+    HAL_StatusTypeDef status = HAL_OK;
+
+    pages = USER_PARAM_RECORD_PAGES(blockIndex);
+    for (retry = 0; retry < 3; retry++)
+    {
+        page = USER_PARAM_FindRecordPlace(pages);
+        if (page < 0)
+            return USER_PARAM_APP_WRITE_ERROR;
+
+        USER_PARAM_LOCK();
+        if (transactionDepth > 0)
+        {
+            // USER_PARAM_Begin() takes no IO lock, the block may be half updated
+            USER_PARAM_UNLOCK();
+            return USER_PARAM_APP_BUSY;
+        }
+        pendingBlocks &= ~(1 << blockIndex);
+        header.seq = ringSeq + 1;
+        header.block = blockIndex;
+        header.crc = USER_PARAM_CalcRecordCrc(blockIndex, &eeAppMap[blockOffset], &header);
+        // the first page holds the header and the start of the block
+        size = EE_PAGE_SIZE - sizeof(header);
+        if (size > blockSize)
+            size = blockSize;
+        memcpy(buf, &header, sizeof(header));
+        memcpy(&buf[sizeof(header)], &eeAppMap[blockOffset], size);
+        USER_PARAM_UNLOCK();
+
+        // the pages are written now, a retry takes the next ones
+        ringSeq = header.seq;
+        ringHead = page + pages;
+        address = USER_PARAM_RECORD_ADDR(page);
+        status = EEPROM_Write(address, buf, sizeof(header) + size, 4000);
+        offset = size;
+        address += EE_PAGE_SIZE;
+        while ((status == HAL_OK) && (offset < blockSize))
+        {
+            size = blockSize - offset;
+            if (size > EE_PAGE_SIZE)
+                size = EE_PAGE_SIZE;
+            USER_PARAM_LOCK();
+            memcpy(buf, &eeAppMap[blockOffset + offset], size);
+            USER_PARAM_UNLOCK();
+            status = EEPROM_Write(address, buf, size, 4000);
+            offset += size;
+            address += EE_PAGE_SIZE;
+        }
+
+        USER_PARAM_LOCK();
+        if (status != HAL_OK)
+        {
+            USER_PARAM_MarkDirty(blockIndex);
+            USER_PARAM_UNLOCK();
+            return USER_PARAM_APP_WRITE_ERROR;
+        }
+        if (pendingBlocks & (1 << blockIndex))
+        {
+            // changed during the write, the CRC may not fit the data
+            USER_PARAM_UNLOCK();
+            continue;
+        }
+        recordPage[blockIndex] = page;
+        USER_PARAM_UNLOCK();
+        return USER_PARAM_OK;
+    }
+
+    // still pending, the change that restarted the last retry has woken the flush task again
+    return USER_PARAM_APP_BUSY;
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_ScanRing
+ * Description  : Read the record headers of the ring, the newest record
+ *                of every application block below a sequence number.
+ *                The data is not checked.
+ * Paremeter    : pBound:per block, the records from this sequence number
+ *                on are skipped
+ *                pPage:per block, ring page of the record found,
+ *                USER_PARAM_NO_RECORD = none
+ *                pSeq:per block, sequence number of the record found
+ *---------------------------------------------------------------------*/
+static void USER_PARAM_ScanRing(const uint32_t *pBound, uint8_t *pPage, uint32_t *pSeq)
+{
+    USER_PARAM_tRecordHeader header;
+    int32_t page, block;
+
+    memset(pPage, USER_PARAM_NO_RECORD, MAX_BLOCK_NUM);
+    for (page = 0; page < USER_PARAM_RING_PAGES; page++)
+    {
+        if (EEPROM_Read(USER_PARAM_RECORD_ADDR(page), (uint8_t *)&header, sizeof(header), 4000) != HAL_OK)
+            continue;
+        block = header.block;
+        if ((block >= EEPROM_USEDBLOCKS) || (blockStorageType[block] != STORAGE_APP))
+            continue;
+        if ((page + USER_PARAM_RECORD_PAGES(block) > USER_PARAM_RING_PAGES) || (header.seq >= pBound[block]))
+            continue;
+        if ((pPage[block] == USER_PARAM_NO_RECORD) || (header.seq > pSeq[block]))
+        {
+            pPage[block] = page;
+            pSeq[block] = header.seq;
+        }
+    }
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_LoadAppBlock
+ * Description  : Read the newest valid record of a block into eeAppMap.
+ *                An older record is looked for only if the CRC fails. A
+ *                block without a valid record is read in place as written
+ *                by former firmware versions.
+ * Paremeter    : page, seq:the newest record of the block in the ring
+ * Return value : true = block valid
+ *---------------------------------------------------------------------*/
+static bool USER_PARAM_LoadAppBlock(int32_t blockIndex, uint8_t page, uint32_t seq)
+{
+    USER_PARAM_tRecordHeader header;
+    uint32_t bound[MAX_BLOCK_NUM], found[MAX_BLOCK_NUM];
+    uint8_t pages[MAX_BLOCK_NUM];
+    int32_t blockOffset = blockInfo[blockIndex].blockOffset;
+    int32_t blockSize = blockInfo[blockIndex].blockSize;
+    uint8_t *pBlock = &eeAppMap[blockOffset];
+
+    memset(bound, 0xFF, sizeof(bound));
+    while (page != USER_PARAM_NO_RECORD)
+    {
+        header.seq = seq;
+        header.block = blockIndex;
+        if ((EEPROM_Read(USER_PARAM_RECORD_ADDR(page) + offsetof(USER_PARAM_tRecordHeader, crc), (uint8_t *)&header.crc, sizeof(header.crc), 4000) == HAL_OK)
+            && (EEPROM_Read(USER_PARAM_RECORD_ADDR(page) + sizeof(header), pBlock, blockSize, 4000) == HAL_OK)
+            && (header.crc == USER_PARAM_CalcRecordCrc(blockIndex, pBlock, &header)))
+        {
+            recordPage[blockIndex] = page;
+            if (seq > ringSeq)
+            {
+                // the newest record of all, the next one follows it
+                ringSeq = seq;
+                ringHead = page + USER_PARAM_RECORD_PAGES(blockIndex);
+            }
+            return true;
+        }
+
+        // written in part, the record before
+        bound[blockIndex] = seq;
+        USER_PARAM_ScanRing(bound, pages, found);
+        page = pages[blockIndex];
+        seq = found[blockIndex];
+    }
+
+    // former layout, in place with the checksum at the end of the block
+    if ((EEPROM_Read(EE_APP_BASE+blockOffset, pBlock, blockSize, 4000) == HAL_OK)
+        && USER_PARAM_CheckBlockChecksum(blockIndex, pBlock))
+        return true;
+
+    // no valid record, main() writes the defaults
+    return false;
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_MarkDirty
+ * Description  : Mark a block of eeAppMap for the next commit, called
+ *                with USER_PARAM_LOCK
+ *---------------------------------------------------------------------*/
+static void USER_PARAM_MarkDirty(int32_t blockIndex)
+{
+    pendingBlocks |= 1 << blockIndex;
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_Schedule
+ * Description  : Wake the flush task, before the scheduler runs the
+ *                changes are written at once, those of a transaction by
+ *                USER_PARAM_Commit()
+ *---------------------------------------------------------------------*/
+static USER_PARAM_tStatus USER_PARAM_Schedule(void)
+{
+    if (!osKernelRunning())
+        return (transactionDepth > 0) ? USER_PARAM_OK : USER_PARAM_Flush();
+
+#if (APP_EVENT_LOOP == 1)
+    EVLOOP_Post(EVLOOP_QUEUE_PARAM);
+#else
+    osSemaphoreRelease(eeFlushSemHandle);
+#endif
+    return USER_PARAM_OK;
+}
 
 static uint16_t USER_PARAM_CalcBlockChecksum(int32_t blockIndex, uint8_t *pBlock)
+{
+    return (uint16_t)RB_CRC_Calculate(pBlock, 0, blockInfo[blockIndex].blockSize-2, &RB_CRC_16_CCITT_CFG);
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_CalcRecordCrc
+ * Description  : CRC of a record, covers the block data without the
+ *                checksum at the end, the sequence number and the block
+ *                index
+ *---------------------------------------------------------------------*/
+static uint16_t USER_PARAM_CalcRecordCrc(int32_t blockIndex, const uint8_t *pBlock, const USER_PARAM_tRecordHeader *pHeader)
+{
+    RB_CRC_tCRC crc;
+
+    crc = RB_CRC_InitialValue(&RB_CRC_16_CCITT_CFG);
+    crc = RB_CRC_UpdateValue(&RB_CRC_16_CCITT_CFG, crc, pBlock, blockInfo[blockIndex].blockSize-2);
+    crc = RB_CRC_UpdateValue(&RB_CRC_16_CCITT_CFG, crc, (const uint8_t *)pHeader, offsetof(USER_PARAM_tRecordHeader, crc));
+    return (uint16_t)RB_CRC_FinalizeValue(&RB_CRC_16_CCITT_CFG, crc);
+}
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_CalcLegacyChecksum
+ * Description  : Additive checksum written by former firmware versions
+ *---------------------------------------------------------------------*/
+static uint16_t USER_PARAM_CalcLegacyChecksum(int32_t blockIndex, uint8_t *pBlock)
 {
     int32_t i;
     uint16_t checksum = 0;
@@ -351,3 +791,20 @@ static uint16_t USER_PARAM_CalcBlockChecksum(int32_t blockIndex, uint8_t *pBlock
         
     return checksum;
 }
+
+/*---------------------------------------------------------------------*
+ * Name         : USER_PARAM_CheckBlockChecksum
+ * Description  : Check the checksum stored at the end of a block. Blocks
+ *                still carrying the legacy additive checksum are accepted,
+ *                they get a CRC with the next write to the block.
+ *---------------------------------------------------------------------*/
+static bool USER_PARAM_CheckBlockChecksum(int32_t blockIndex, uint8_t *pBlock)
+{
+    int32_t checksumOffset = blockInfo[blockIndex].blockSize-2;
+    uint16_t checksumGet;
+
+    checksumGet = (uint16_t)pBlock[checksumOffset] | ((uint16_t)pBlock[checksumOffset+1] << 8);
+    if (checksumGet == USER_PARAM_CalcBlockChecksum(blockIndex, pBlock))
+        return true;
+    return (checksumGet == USER_PARAM_CalcLegacyChecksum(blockIndex, pBlock));
+}
@@ -8,9 +8,13 @@
 #define MAX_APP_PARAM_SIZE  1024  //256   --21-nov-08 920
 #define MAX_MFG_PARAM_SIZE  64
 
+// The application blocks are written as records to the ring of pages from EE_RING_BASE to the end
+// of the eeprom, each commit to the next free pages, so the writes of a busy parameter spread over
+// the ring. The newest valid record of a block is used. A block without a record is read in place
+// at EE_APP_BASE, as written by former firmware versions. All bases are page aligned.
 #define EE_APP_BASE         0
-#define EE_BAK_BASE         0
 #define EE_MFG_BASE         1024
+#define EE_RING_BASE        1088
 //<<<<<<< UserParam.h
 //#define EE_MFG_BASE         256
 //
@@ -60,7 +64,8 @@ typedef enum
 	USER_PARAM_APP_BLOCK_CHECKSUM_ERROR,
 	USER_PARAM_BAK_BLOCK_CHECKSUM_ERROR,
 	USER_PARAM_BOTH_BLOCK_CHECKSUM_ERROR,
-	USER_PARAM_MFG_BLOCK_CHECKSUM_ERROR
+	USER_PARAM_MFG_BLOCK_CHECKSUM_ERROR,
+	USER_PARAM_APP_BUSY				//!< Changes not written, a transaction is open or the block changed during every retry
 } USER_PARAM_tStatus;
 
 typedef enum 
@@ -83,6 +88,13 @@ typedef struct
   uint16_t blockSize;
 } USER_PARAM_tBlockInfo;
 
+//! Entry of the parameter index, indexed by USER_PARAM_tIdent and built at compile time
+typedef struct 
+{
+  uint16_t offset;          // offset from the first parameter of the table
+  uint8_t  dataSize;        // 0 = identifier not in the table
+} USER_PARAM_tIndexEntry;
+
 //! Parameter Id's, which are used in getting or setting the parameters
 typedef enum 
 {
@@ -429,318 +441,320 @@ typedef enum
 	BLOCK5 = 500,
 	BLK5_sdWasPresent,
 	BLK5_setupMaintenanceRestorefromSDCard,
-	BLK5_checksum = 599
+	BLK5_checksum = 599,
+	USER_PARAM_IDENT_NUM
 } USER_PARAM_tIdent;
 
 
 //! WARNING C-Syntax: NO character is allowed after the backspace '\' !!!  toleranceType
-//! Parameter definitions, which are used in the parameter table
+//! Parameter definitions, which are used in the parameter table and the parameter index.
+//! The user of the list defines USER_PARAM_ENTRY(paramId, dataSize) before expanding it.
 #define USER_PARAM_DEFINITIONS						\
 	/* paramId              dataSize */          	\
 	/* Scale block start */                      	\
-	{BLK0_MACAddress,                       12},    \
-	/*{BLK0_setupSerialNumber,				16},	*/\
-	{BLK0_boardInfoReserved,                36},    \
+	USER_PARAM_ENTRY(BLK0_MACAddress,                       12)    \
+	/*USER_PARAM_ENTRY(BLK0_setupSerialNumber,				16)	*/\
+	USER_PARAM_ENTRY(BLK0_boardInfoReserved,                36)    \
 	/*F1.1*/										\
-	{BLK0_setupScaleName,					21},	\
-	{BLK0_setupApproval,					1},		\
-	{BLK0_setupCertificateNo,				21},	\
+	USER_PARAM_ENTRY(BLK0_setupScaleName,					21)	\
+	USER_PARAM_ENTRY(BLK0_setupApproval,					1)		\
+	USER_PARAM_ENTRY(BLK0_setupCertificateNo,				21)	\
 	/*F1.2 Capacity and Increment*/						\
-	{BLK0_setupPrimaryUnit,					1},		\
-	{BLK0_setupRanges,						1},		\
-	{BLK0_setupRangeOneCapacity,			8},		\
-	{BLK0_setupRangeOneIncrement,			8},		\
-	{BLK0_setupRangeTwoCapacity,			8},		\
-	{BLK0_setupRangeTwoIncrement,			8},		\
-	{BLK0_setupBlankoverCapacity,			1},		\
+	USER_PARAM_ENTRY(BLK0_setupPrimaryUnit,					1)		\
+	USER_PARAM_ENTRY(BLK0_setupRanges,						1)		\
+	USER_PARAM_ENTRY(BLK0_setupRangeOneCapacity,			8)		\
+	USER_PARAM_ENTRY(BLK0_setupRangeOneIncrement,			8)		\
+	USER_PARAM_ENTRY(BLK0_setupRangeTwoCapacity,			8)		\
+	USER_PARAM_ENTRY(BLK0_setupRangeTwoIncrement,			8)		\
+	USER_PARAM_ENTRY(BLK0_setupBlankoverCapacity,			1)		\
 	/*F1.3*/											\
-	{BLK0_calGeo,							1},		\
-	{BLK0_usrGeo,							1},		\
-	{BLK0_setupLinearity,					1},		\
-	{BLK0_zeroCalCounts,					4},		\
-	{BLK0_highCalWeight,					8},		\
-	{BLK0_highCalCounts,					4},		\
-	{BLK0_midCalWeight,						8},		\
-	{BLK0_midCalCounts,						4},		\
-	{BLK0_lowCalWeight,						8},		\
-	{BLK0_lowCalCounts,						4},		\
-	{BLK0_calibrationDate,                  12},    \
-    {BLK0_ADJUST_K2,                        8},    \
+	USER_PARAM_ENTRY(BLK0_calGeo,							1)		\
+	USER_PARAM_ENTRY(BLK0_usrGeo,							1)		\
+	USER_PARAM_ENTRY(BLK0_setupLinearity,					1)		\
+	USER_PARAM_ENTRY(BLK0_zeroCalCounts,					4)		\
+	USER_PARAM_ENTRY(BLK0_highCalWeight,					8)		\
+	USER_PARAM_ENTRY(BLK0_highCalCounts,					4)		\
+	USER_PARAM_ENTRY(BLK0_midCalWeight,						8)		\
+	USER_PARAM_ENTRY(BLK0_midCalCounts,						4)		\
+	USER_PARAM_ENTRY(BLK0_lowCalWeight,						8)		\
+	USER_PARAM_ENTRY(BLK0_lowCalCounts,						4)		\
+	USER_PARAM_ENTRY(BLK0_calibrationDate,                  12)    \
+    USER_PARAM_ENTRY(BLK0_ADJUST_K2,                        8)    \
 	/*F1.4 Zero*/										\
-	{BLK0_setupAutoZero,					1},		\
-	{BLK0_setupAutoZeroRange,				1},		\
-	{BLK0_setupUnderZeroBlanking,			1},		\
-	{BLK0_setupCenterofZero,				1},		\
-	{BLK0_setupPowerupZero,					1},		\
-	{BLK0_setupPushButtonZero,				1},		\
+	USER_PARAM_ENTRY(BLK0_setupAutoZero,					1)		\
+	USER_PARAM_ENTRY(BLK0_setupAutoZeroRange,				1)		\
+	USER_PARAM_ENTRY(BLK0_setupUnderZeroBlanking,			1)		\
+	USER_PARAM_ENTRY(BLK0_setupCenterofZero,				1)		\
+	USER_PARAM_ENTRY(BLK0_setupPowerupZero,					1)		\
+	USER_PARAM_ENTRY(BLK0_setupPushButtonZero,				1)		\
 	/*F1.5 Tare*/										\
-	{BLK0_setupPushButtonTare,				1},		\
-	{BLK0_setupKeyboardTare,				1},		\
-	{BLK0_setupNetSignCorrection,			1},		\
-	{BLK0_setupAutoTare,					1},		\
-	{BLK0_setupAutoTareThreshold,			8},		\
-	{BLK0_setupAutoTareResetThreshold,		8},		\
-	{BLK0_setupAutoTareMotionCheck,			1},		\
-	{BLK0_setupAutoClearTare,           	1},		\
-	{BLK0_setupClearafterPrint,           	1},		\
-	{BLK0_setupAutoClearTareThreshold,		8},		\
-	{BLK0_setupAutoClearTareMotionCheck,	1},		\
-	{BLK0_setupClearTareonZero,				1},		\
-	{BLK0_setupTareInterlock,				1},		\
+	USER_PARAM_ENTRY(BLK0_setupPushButtonTare,				1)		\
+	USER_PARAM_ENTRY(BLK0_setupKeyboardTare,				1)		\
+	USER_PARAM_ENTRY(BLK0_setupNetSignCorrection,			1)		\
+	USER_PARAM_ENTRY(BLK0_setupAutoTare,					1)		\
+	USER_PARAM_ENTRY(BLK0_setupAutoTareThreshold,			8)		\
+	USER_PARAM_ENTRY(BLK0_setupAutoTareResetThreshold,		8)		\
+	USER_PARAM_ENTRY(BLK0_setupAutoTareMotionCheck,			1)		\
+	USER_PARAM_ENTRY(BLK0_setupAutoClearTare,           	1)		\
+	USER_PARAM_ENTRY(BLK0_setupClearafterPrint,           	1)		\
+	USER_PARAM_ENTRY(BLK0_setupAutoClearTareThreshold,		8)		\
+	USER_PARAM_ENTRY(BLK0_setupAutoClearTareMotionCheck,	1)		\
+	USER_PARAM_ENTRY(BLK0_setupClearTareonZero,				1)		\
+	USER_PARAM_ENTRY(BLK0_setupTareInterlock,				1)		\
 	/*F1.6 Second Unit*/								\
-	{BLK0_setupSecondUnit,					1},		\
+	USER_PARAM_ENTRY(BLK0_setupSecondUnit,					1)		\
 	 /*F1.7 Filter*/									\
-	{BLK0_setupLowPassFilter,				8},		\
-	{BLK0_setupStabilityFilter,				1},		\
+	USER_PARAM_ENTRY(BLK0_setupLowPassFilter,				8)		\
+	USER_PARAM_ENTRY(BLK0_setupStabilityFilter,				1)		\
 	/*F1.8 Motion and Stability*/						\
-	{BLK0_setupMotionRange,					1},		\
-	{BLK0_setupnoMotionInterval,			1},		\
-	{BLK0_setupMotionTimeout,				1},		\
+	USER_PARAM_ENTRY(BLK0_setupMotionRange,					1)		\
+	USER_PARAM_ENTRY(BLK0_setupnoMotionInterval,			1)		\
+	USER_PARAM_ENTRY(BLK0_setupMotionTimeout,				1)		\
 	/*F1.9 Log or Print*/								\
-	{BLK0_setupMinimumWeight,				8},		\
-	{BLK0_setupPrintInterLock,				1},		\
-	{BLK0_setupFilterPols,					1},		\
-	{BLK0_setupResetOn,						1},		\
-	{BLK0_setupResetOnReturnWeight,			8},		\
-	{BLK0_setupResetOnDeviationWeight,		8},		\
-	{BLK0_setupThresholdWeight,				8},		\
-	{BLK0_setupPrintMotionCheck,			1},		\
-	{BLK0_upScaleTestPoint,					1},		\
-	{BLK0_cellCapacity,						8},		\
-	{BLK0_cellCapUnit,						8},		\
-	{BLK0_preload,							8},		\
-	{BLK0_preloadUnit,						4},		\
-	{BLK0_checksum,							2},		\
+	USER_PARAM_ENTRY(BLK0_setupMinimumWeight,				8)		\
+	USER_PARAM_ENTRY(BLK0_setupPrintInterLock,				1)		\
+	USER_PARAM_ENTRY(BLK0_setupFilterPols,					1)		\
+	USER_PARAM_ENTRY(BLK0_setupResetOn,						1)		\
+	USER_PARAM_ENTRY(BLK0_setupResetOnReturnWeight,			8)		\
+	USER_PARAM_ENTRY(BLK0_setupResetOnDeviationWeight,		8)		\
+	USER_PARAM_ENTRY(BLK0_setupThresholdWeight,				8)		\
+	USER_PARAM_ENTRY(BLK0_setupPrintMotionCheck,			1)		\
+	USER_PARAM_ENTRY(BLK0_upScaleTestPoint,					1)		\
+	USER_PARAM_ENTRY(BLK0_cellCapacity,						8)		\
+	USER_PARAM_ENTRY(BLK0_cellCapUnit,						8)		\
+	USER_PARAM_ENTRY(BLK0_preload,							8)		\
+	USER_PARAM_ENTRY(BLK0_preloadUnit,						4)		\
+	USER_PARAM_ENTRY(BLK0_checksum,							2)		\
 	/*Block 1 start*/								\
 	/*--COM1--*/                                    \
-	{BLK1_setupCOM1Assignment,       		1},		\
-	{BLK1_setupCOM1Template,       			1},		\
-	{BLK1_setupCOM1AssignmentChecksum,      1},		\
-	{BLK1_setupCOM1Assignment2,             1},		\
-	{BLK1_setupCOM1Template2,               1},		\
-	{BLK1_setupCOM1Assignment3,             1},		\
-	{BLK1_setupCOM1Template3,               1},		\
+	USER_PARAM_ENTRY(BLK1_setupCOM1Assignment,       		1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM1Template,       			1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM1AssignmentChecksum,      1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM1Assignment2,             1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM1Template2,               1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM1Assignment3,             1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM1Template3,               1)		\
 	/*--COM2--*/                                    \
-	{BLK1_setupCOM2Assignment,       		1},		\
-	{BLK1_setupCOM2Template,       			1},		\
-	{BLK1_setupCOM2AssignmentChecksum,      1},		\
-    {BLK1_setupCOM2Assignment2,            1},		\
-	{BLK1_setupCOM2Template2,               1},		\
-	{BLK1_setupCOM2Assignment3,             1},		\
-	{BLK1_setupCOM2Template3,               1},		\
+	USER_PARAM_ENTRY(BLK1_setupCOM2Assignment,       		1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM2Template,       			1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM2AssignmentChecksum,      1)		\
+    USER_PARAM_ENTRY(BLK1_setupCOM2Assignment2,            1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM2Template2,               1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM2Assignment3,             1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM2Template3,               1)		\
 	/*--Ethernet--*/                                \
-	{BLK1_setupEthernetAssignment,       	1},		\
-	{BLK1_setupEthernetTemplate,       		1},		\
-    {BLK1_setupEthernetAssignment2,	        1},		\
-	{BLK1_setupEthernetTemplate2,	        1},		\
-	{BLK1_setupEthernetAssignment3,	        1},		\
-	{BLK1_setupEthernetTemplate3,	        1},		\
-	{BLK1_setupEthernetPrintClientAssignment,   1},    \
-	{BLK1_setupEthernetPrintClientTemplate,	    1},    \
-	{BLK1_setupEthernetPrintClientAssignment2,	1},    \
-	{BLK1_setupEthernetPrintClientTemplate2,	1},    \
-	{BLK1_setupEthernetPrintClientAssignment3,	1},    \
-	{BLK1_setupEthernetPrintClientTemplate3,	1},    \
-	{BLK1_setupEthernetPrintClientChecksum,	    1},    \
-	{BLK1_setupEthernetChecksum,				1},	\
+	USER_PARAM_ENTRY(BLK1_setupEthernetAssignment,       	1)		\
+	USER_PARAM_ENTRY(BLK1_setupEthernetTemplate,       		1)		\
+    USER_PARAM_ENTRY(BLK1_setupEthernetAssignment2,	        1)		\
+	USER_PARAM_ENTRY(BLK1_setupEthernetTemplate2,	        1)		\
+	USER_PARAM_ENTRY(BLK1_setupEthernetAssignment3,	        1)		\
+	USER_PARAM_ENTRY(BLK1_setupEthernetTemplate3,	        1)		\
+	USER_PARAM_ENTRY(BLK1_setupEthernetPrintClientAssignment,   1)    \
+	USER_PARAM_ENTRY(BLK1_setupEthernetPrintClientTemplate,	    1)    \
+	USER_PARAM_ENTRY(BLK1_setupEthernetPrintClientAssignment2,	1)    \
+	USER_PARAM_ENTRY(BLK1_setupEthernetPrintClientTemplate2,	1)    \
+	USER_PARAM_ENTRY(BLK1_setupEthernetPrintClientAssignment3,	1)    \
+	USER_PARAM_ENTRY(BLK1_setupEthernetPrintClientTemplate3,	1)    \
+	USER_PARAM_ENTRY(BLK1_setupEthernetPrintClientChecksum,	    1)    \
+	USER_PARAM_ENTRY(BLK1_setupEthernetChecksum,				1)	\
   	/*--COM1--*/                                    \
-	{BLK1_setupCOM1BaudRate,       			1},		\
-	{BLK1_setupCOM1DateBits,       			1},		\
-	{BLK1_setupCOM1Parity,					1},		\
-	{BLK1_setupCOM1FlowControl,				1},		\
+	USER_PARAM_ENTRY(BLK1_setupCOM1BaudRate,       			1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM1DateBits,       			1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM1Parity,					1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM1FlowControl,				1)		\
 	/*--COM2--*/                                    \
-	{BLK1_setupCOM2BaudRate,       			1},		\
-	{BLK1_setupCOM2DateBits,       			1},		\
-	{BLK1_setupCOM2Parity,					1},		\
-	{BLK1_setupCOM2FlowControl,				1},		\
-	{BLK1_setupCOM2InterFace,				1},		\
-	{BLK1_setupCOM2Address,                 1},   \
+	USER_PARAM_ENTRY(BLK1_setupCOM2BaudRate,       			1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM2DateBits,       			1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM2Parity,					1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM2FlowControl,				1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM2InterFace,				1)		\
+	USER_PARAM_ENTRY(BLK1_setupCOM2Address,                 1)   \
 	/*++++++++++++Network+++++++++++*/              \
 	/*--Ethernet--*/                                \
-	{BLK1_setupIPDHCPClient,  				1},		\
-	{BLK1_setupIPAddressSeg1, 				1},		\
-	{BLK1_setupIPAddressSeg2, 				1},		\
-	{BLK1_setupIPAddressSeg3, 				1},		\
-	{BLK1_setupIPAddressSeg4, 				1},		\
-	{BLK1_setupSubnetMaskSeg1,				1},		\
-	{BLK1_setupSubnetMaskSeg2,				1},		\
-	{BLK1_setupSubnetMaskSeg3,				1},		\
-	{BLK1_setupSubnetMaskSeg4,				1},		\
-	{BLK1_setupGateway1,      				1},		\
-	{BLK1_setupGateway2,      				1},		\
-	{BLK1_setupGateway3,      				1},		\
-	{BLK1_setupGateway4,      				1},		\
+	USER_PARAM_ENTRY(BLK1_setupIPDHCPClient,  				1)		\
+	USER_PARAM_ENTRY(BLK1_setupIPAddressSeg1, 				1)		\
+	USER_PARAM_ENTRY(BLK1_setupIPAddressSeg2, 				1)		\
+	USER_PARAM_ENTRY(BLK1_setupIPAddressSeg3, 				1)		\
+	USER_PARAM_ENTRY(BLK1_setupIPAddressSeg4, 				1)		\
+	USER_PARAM_ENTRY(BLK1_setupSubnetMaskSeg1,				1)		\
+	USER_PARAM_ENTRY(BLK1_setupSubnetMaskSeg2,				1)		\
+	USER_PARAM_ENTRY(BLK1_setupSubnetMaskSeg3,				1)		\
+	USER_PARAM_ENTRY(BLK1_setupSubnetMaskSeg4,				1)		\
+	USER_PARAM_ENTRY(BLK1_setupGateway1,      				1)		\
+	USER_PARAM_ENTRY(BLK1_setupGateway2,      				1)		\
+	USER_PARAM_ENTRY(BLK1_setupGateway3,      				1)		\
+	USER_PARAM_ENTRY(BLK1_setupGateway4,      				1)		\
 	/*--PrintClient--*/                             \
-	{BLK1_setupServerIPAddressSeg1,			1},		\
-	{BLK1_setupServerIPAddressSeg2,			1},		\
-	{BLK1_setupServerIPAddressSeg3,			1},		\
-	{BLK1_setupServerIPAddressSeg4,			1},		\
-	{BLK1_setupServerPort,					4},		\
+	USER_PARAM_ENTRY(BLK1_setupServerIPAddressSeg1,			1)		\
+	USER_PARAM_ENTRY(BLK1_setupServerIPAddressSeg2,			1)		\
+	USER_PARAM_ENTRY(BLK1_setupServerIPAddressSeg3,			1)		\
+	USER_PARAM_ENTRY(BLK1_setupServerIPAddressSeg4,			1)		\
+	USER_PARAM_ENTRY(BLK1_setupServerPort,					4)		\
 	/*--WiFi--*/                                    \
-	{BLK1_setupWIFISSIDName,                21},    \
-	{BLK1_setupWIFIWST0,                     1},    \
-	{BLK1_setupWIFIWLPP,                    27},    \
-    {BLK1_setupWIFIWLKI,                     1},    \
-	{BLK1_setupWIFIReset,					 1},	\
-	{BLK1_checksum,					        2},		\
+	USER_PARAM_ENTRY(BLK1_setupWIFISSIDName,                21)    \
+	USER_PARAM_ENTRY(BLK1_setupWIFIWST0,                     1)    \
+	USER_PARAM_ENTRY(BLK1_setupWIFIWLPP,                    27)    \
+    USER_PARAM_ENTRY(BLK1_setupWIFIWLKI,                     1)    \
+	USER_PARAM_ENTRY(BLK1_setupWIFIReset,					 1)	\
+	USER_PARAM_ENTRY(BLK1_checksum,					        2)		\
 	/* Serial block start */						\
-    {BLK2_applicationType,					1},		\
-    {BLK2_setupOutputTemplateFormat,        1},		\
-    {BLK2_setupOutputTemplateScaleName,		1},		\
-	{BLK2_setupScreenSave,      	1},		\
-	{BLK2_setupBackLightTimeOut,	1},		\
-	{BLK2_setupAutoOffTimer,    	1},		\
-	{BLK2_setupSystemline,      	1},		\
-	{BLK2_setupTareDisplay,      	1},		\
-	{BLK2_setupTimeFormat,         	1},		\
-	{BLK2_setupDateFormat,         	1},		\
-	{BLK2_setupDateFieldSeparator, 	1},		\
-	{BLK2_setupMenuLanguage,    	1},		\
-	{BLK2_setupSetupLanguage,    	1},		\
-	{BLK2_setupTransactionCounter, 	1},		\
-	{BLK2_setupEditCounter,         1},		\
-  	{BLK2_setupProtection,          1},		\
-	{BLK2_setupAdminPassword,     	7},		\
-  	{BLK2_setupAlibiMemoryAccess,	1},		\
-  	{BLK2_setupContrastAdjustAccess,1},		\
-	{BLK2_setupTransCounterAccess,	1},		\
-	{BLK2_setupTimeDateAccess,		1},		\
-	{BLK2_setupTotalMemoryAccess,   1},		\
-	{BLK2_setupExpandAccess,        1},     \
-	{BLK2_setupIDTotalAccess,		1},		\
-	{BLK2_setupSerialTest,			1},		\
-    {BLK2_KEYTIMEOUT,               1},     \
-	{BLK2_setuppoweroffcontrol,		1},		\
-	{BLK2_setupBlueToothReset,		1},		\
+    USER_PARAM_ENTRY(BLK2_applicationType,					1)		\
+    USER_PARAM_ENTRY(BLK2_setupOutputTemplateFormat,        1)		\
+    USER_PARAM_ENTRY(BLK2_setupOutputTemplateScaleName,		1)		\
+	USER_PARAM_ENTRY(BLK2_setupScreenSave,      	1)		\
+	USER_PARAM_ENTRY(BLK2_setupBackLightTimeOut,	1)		\
+	USER_PARAM_ENTRY(BLK2_setupAutoOffTimer,    	1)		\
+	USER_PARAM_ENTRY(BLK2_setupSystemline,      	1)		\
+	USER_PARAM_ENTRY(BLK2_setupTareDisplay,      	1)		\
+	USER_PARAM_ENTRY(BLK2_setupTimeFormat,         	1)		\
+	USER_PARAM_ENTRY(BLK2_setupDateFormat,         	1)		\
+	USER_PARAM_ENTRY(BLK2_setupDateFieldSeparator, 	1)		\
+	USER_PARAM_ENTRY(BLK2_setupMenuLanguage,    	1)		\
+	USER_PARAM_ENTRY(BLK2_setupSetupLanguage,    	1)		\
+	USER_PARAM_ENTRY(BLK2_setupTransactionCounter, 	1)		\
+	USER_PARAM_ENTRY(BLK2_setupEditCounter,         1)		\
+  	USER_PARAM_ENTRY(BLK2_setupProtection,          1)		\
+	USER_PARAM_ENTRY(BLK2_setupAdminPassword,     	7)		\
+  	USER_PARAM_ENTRY(BLK2_setupAlibiMemoryAccess,	1)		\
+  	USER_PARAM_ENTRY(BLK2_setupContrastAdjustAccess,1)		\
+	USER_PARAM_ENTRY(BLK2_setupTransCounterAccess,	1)		\
+	USER_PARAM_ENTRY(BLK2_setupTimeDateAccess,		1)		\
+	USER_PARAM_ENTRY(BLK2_setupTotalMemoryAccess,   1)		\
+	USER_PARAM_ENTRY(BLK2_setupExpandAccess,        1)     \
+	USER_PARAM_ENTRY(BLK2_setupIDTotalAccess,		1)		\
+	USER_PARAM_ENTRY(BLK2_setupSerialTest,			1)		\
+    USER_PARAM_ENTRY(BLK2_KEYTIMEOUT,               1)     \
+	USER_PARAM_ENTRY(BLK2_setuppoweroffcontrol,		1)		\
+	USER_PARAM_ENTRY(BLK2_setupBlueToothReset,		1)		\
 	/*--Bluetooth connection--*/								\
-	{BLK2_setupBTAssignment,       		1},		\
-	{BLK2_setupBTTemplate,       			1},		\
-	{BLK2_setupBTAssignmentChecksum,      1},		\
-	{BLK2_setupBTAssignment2,             1},		\
-	{BLK2_setupBTTemplate2,               1},		\
-	{BLK2_setupBTAssignment3,             1},		\
-	{BLK2_setupBTTemplate3,               1},		\
+	USER_PARAM_ENTRY(BLK2_setupBTAssignment,       		1)		\
+	USER_PARAM_ENTRY(BLK2_setupBTTemplate,       			1)		\
+	USER_PARAM_ENTRY(BLK2_setupBTAssignmentChecksum,      1)		\
+	USER_PARAM_ENTRY(BLK2_setupBTAssignment2,             1)		\
+	USER_PARAM_ENTRY(BLK2_setupBTTemplate2,               1)		\
+	USER_PARAM_ENTRY(BLK2_setupBTAssignment3,             1)		\
+	USER_PARAM_ENTRY(BLK2_setupBTTemplate3,               1)		\
 	/*--BlueTooth--*/                              \
-    {BLK2_setupBlueToothName,               11},    \
-	{BLK2_setupBlueToothPIN,      			11},    \
-    {BLK2_setupBlueToothUARTBAUDRATE,		1},		\
-	{BLK2_setupBlueToothUARTSTOP,			1},		\
-	{BLK2_setupBlueToothUARTPARITY,			1},		\
-	{BLK2_setupLabelPrintBarcodePrefixlen,	1},		\
-	{BLK2_setupLabelPrintBarcodeSuffixlen,	1},		\
-	{BLK2_setupLabelPrintBarcodeDatalen,	1},		\
-	{BLK2_setupLabelPrintBarcodeEndchar,	1},		\
-	{BLK2_setupPrintLanguage,				1},		\
-	{BLK2_setupTFTPserverIP,				4},		\
-    {BLK2_setupAlibiTransactionPW,            8},     \
-	{BLK2_checksum,                 2},		\
-	{BLK3_AlibiMemoryEnable,        1},		\
-	{BLK3_setupIDExpand,			1},		\
-	{BLK3_setupTotalizationMode,         			1},		\
-	{BLK3_setupTotalizationClearGT,           		1},		\
-	{BLK3_setupTotalizationSubTotal,         		1},		\
-	{BLK3_setupTotalizationClearST,            		1},		\
-	{BLK3_setupTotalizationConvertWeight,			1},		\
-	{BLK3_setupInput1Polarity,						1},		\
-	{BLK3_setupInput1Assignment,      				1},		\
-	{BLK3_setupInput2Polarity,       				1},		\
-	{BLK3_setupInput2Assignment,       				1},		\
-	{BLK3_setupOutput1Assignment,					1},		\
-	{BLK3_setupOutput2Assignment,       			1},		\
-	{BLK3_setupOutput3Assignment,       			1},		\
-	{BLK3_setupOutput4Assignment,       			1},		\
-	{BLK3_setupFunctionkeyAssignment,       		1},		\
-	{BLK3_setupFunctionAutoStart,                   1},		\
-	{BLK3_setupAnimalWeighingOperationMode,         1},     \
-	{BLK3_setupAnimalWeighingSamplingTime,          4},     \
-	{BLK3_setupAnimalWeighingAutoStart,             1},     \
-	{BLK3_setupAnimalWeighingdisplayLine2,          1},     \
-	{BLK3_setupAnimalWeighingStartThreshold,        4},     \
-	{BLK3_setupAnimalWeighingAutoPrint,             1},     \
-	{BLK3_setupAnimalWeighingPrintDelay,            1},     \
-	{BLK3_setupOverUnderOperationSource,			1},		\
-	{BLK3_setupOverUnderOperationTolType,			1},		\
-	{BLK3_setupOverUnderOperationTargetEdit,  		1},		\
-	{BLK3_setupOverUnderOperationHoldTimer,  	 	4},		\
-	{BLK3_setupOverUnderOperationMotionCheck,		1},		\
-	{BLK3_setupOverUnderOperationAutoPrint,			1},		\
-	{BLK3_setupOverUnderDisplayMode,				1},		\
-	{BLK3_setupOverUnderDisplayLine,				1},		\
-	{BLK3_setupOverUnderDisplaySmarttrack,			1},		\
-	{BLK3_setupOverUnderDisplayMotionblanking,		1},		\
-	{BLK3_setupOverUnderTargetTable,                1},		\
-	{BLK3_setupOverUnderTotalizationTotalization,	1},		\
-	{BLK3_setupOverUnderTotalizationCleartotals,	1},		\
-	{BLK3_setupOverUnderMenukeysActivetarget,		1},		\
-	{BLK3_setupOverUnderMenukeysQuicksettarget,	    1},		\
-	{BLK3_setupOverUnderMenukeysTargettable,		1},		\
-	{BLK3_setupOverUnderTargetValues,	    		4},		\
-	{BLK3_setupOverunderAvtiveUnit,                 1},     \
-	{BLK3_setupOverUnderTargetMinusTol,    		    4},		\
-	{BLK3_setupOverUnderTargetPlusTol,     		    4},		\
-	{BLK3_setupOverUnderTargetUnderLimit,    		4},		\
-	{BLK3_setupOverUnderTargetOverLimit,     		4},		\
-	{BLK3_setupOverUnderTargetDiscription, 		    21},	\
-	{BLK3_setupOverUnderRecordIndex,                1},		\
-	{BLK3_setupPeakWeighingOperationMode,			1},		\
-	{BLK3_setupPeakWeighingUseMemory,				1},		\
-	{BLK3_setupPeakWeighingAutoPrint,				1},		\
-	{BLK3_setupPeakWeighingDispLine1,      			1},		\
-	{BLK3_setupPeakWeighingDispLine2,	  			1},		\
-	{BLK3_setupPeakWeighingReports,                 1},     \
-	{BLK3_setupPeakWeighingHoldTimer,               4},     \
-	{BLK3_setupDynamicWeighingTimeInterval,	        2},		\
-	{BLK3_setupDynamicWeighingAccumulation,	        1},		\
-	{BLK3_setupDynamicWeighingAutoMemClear,	        1},		\
-	{BLK3_setupDynamicWeighingAutoPrint,	        1},		\
-	{BLK3_setupDynamicWeighingDispLine,		        1},		\
-	{BLK3_setupCountingOperationPrompt,             1},     \
-	{BLK3_setupCountingOperationOptimize,           1},     \
-	{BLK3_setupCountingOperationAutoClearAPW,       1},     \
-	{BLK3_setupCountingOperationTARGETPCS,			4},		\
-	{BLK3_setupCountingDisplayLine1,                1},     \
-	{BLK3_setupCountingDisplayLine2,                1},     \
-	{BLK3_setupCountingMenuKeysIDTable,             1},     \
-	{BLK3_setupCountingMenuKeysReports,             1},     \
-	{BLK3_setupCountingMenuKeysSampleAPWSelect,     1},     \
-	{BLK3_setupCountingIDMemoryIDTable,             1},     \
-	{BLK3_setupCountingIDMemoryTotalization,        1},     \
-	{BLK3_setupCountingIDMemoryClearOnPrint,        1},     \
-    {BLK3_setupCountingIDMemoryUpdateAPW,           1},     \
-	{BLK3_setupCountingWeighingAutoRefOpti,	        1},		\
-	{BLK3_setupCountingWeighingAPWEntry,	        1},		\
-	{BLK3_setupCountingWeighingAccumulate,	        1},		\
-	{BLK3_setupCountingWeighingLastUsedID,	        16},	\
-	{BLK3_setupCountingWeighingIDLKUPTAB0,	        2},		\
-	{BLK3_setupCountingWeighingIDLKUPTAB1,	        2},		\
-	{BLK3_setupCountingWeighingIDLKUPTAB2,	        2},		\
-	{BLK3_setupCountingWeighingIDLKUPTAB3,	        2},		\
-	{BLK3_setupCountingWeighingIDLKUPTAB4,	        2},		\
-	{BLK3_setupCountingWeighingIDLKUPTAB5,	        2},		\
-	{BLK3_setupCountingWeighingIDLKUPTAB6,	        2},		\
-	{BLK3_setupVehicleOperationTemporaryID,         1},     \
-	{BLK3_setupVehicleOperationAutoID,              1},     \
-	{BLK3_setupVehicleOperationOperatorClearing,    1},     \
-	{BLK3_setupVehicleOperationPermanentID,         1},     \
-	{BLK3_setupVehicleOperationDescription,         1},     \
-	{BLK3_setupVehicleOperationTotalization,        1},     \
-	{BLK3_setupVehicleOperationClearTotals,         1},     \
-	{BLK3_setupVehicleGeneralTempPrompt,            1},     \
-	{BLK3_setupVehicleGeneralPermPrompt,            1},     \
-	{BLK3_setupVehicleGeneralThresholdWt,           4},     \
-    {BLK3_setupVehicleGeneralResetWt,               4},     \
-    {BLK3_setupVehicleGeneralTransactionTable,      1},     \
-    {BLK3_SERVICENUMBER,                            21},    \
-    {BLK3_checksum,							2},		\
+    USER_PARAM_ENTRY(BLK2_setupBlueToothName,               11)    \
+	USER_PARAM_ENTRY(BLK2_setupBlueToothPIN,      			11)    \
+    USER_PARAM_ENTRY(BLK2_setupBlueToothUARTBAUDRATE,		1)		\
+	USER_PARAM_ENTRY(BLK2_setupBlueToothUARTSTOP,			1)		\
+	USER_PARAM_ENTRY(BLK2_setupBlueToothUARTPARITY,			1)		\
+	USER_PARAM_ENTRY(BLK2_setupLabelPrintBarcodePrefixlen,	1)		\
+	USER_PARAM_ENTRY(BLK2_setupLabelPrintBarcodeSuffixlen,	1)		\
+	USER_PARAM_ENTRY(BLK2_setupLabelPrintBarcodeDatalen,	1)		\
+	USER_PARAM_ENTRY(BLK2_setupLabelPrintBarcodeEndchar,	1)		\
+	USER_PARAM_ENTRY(BLK2_setupPrintLanguage,				1)		\
+	USER_PARAM_ENTRY(BLK2_setupTFTPserverIP,				4)		\
+    USER_PARAM_ENTRY(BLK2_setupAlibiTransactionPW,            8)     \
+	USER_PARAM_ENTRY(BLK2_checksum,                 2)		\
+	USER_PARAM_ENTRY(BLK3_AlibiMemoryEnable,        1)		\
+	USER_PARAM_ENTRY(BLK3_setupIDExpand,			1)		\
+	USER_PARAM_ENTRY(BLK3_setupTotalizationMode,         			1)		\
+	USER_PARAM_ENTRY(BLK3_setupTotalizationClearGT,           		1)		\
+	USER_PARAM_ENTRY(BLK3_setupTotalizationSubTotal,         		1)		\
+	USER_PARAM_ENTRY(BLK3_setupTotalizationClearST,            		1)		\
+	USER_PARAM_ENTRY(BLK3_setupTotalizationConvertWeight,			1)		\
+	USER_PARAM_ENTRY(BLK3_setupInput1Polarity,						1)		\
+	USER_PARAM_ENTRY(BLK3_setupInput1Assignment,      				1)		\
+	USER_PARAM_ENTRY(BLK3_setupInput2Polarity,       				1)		\
+	USER_PARAM_ENTRY(BLK3_setupInput2Assignment,       				1)		\
+	USER_PARAM_ENTRY(BLK3_setupOutput1Assignment,					1)		\
+	USER_PARAM_ENTRY(BLK3_setupOutput2Assignment,       			1)		\
+	USER_PARAM_ENTRY(BLK3_setupOutput3Assignment,       			1)		\
+	USER_PARAM_ENTRY(BLK3_setupOutput4Assignment,       			1)		\
+	USER_PARAM_ENTRY(BLK3_setupFunctionkeyAssignment,       		1)		\
+	USER_PARAM_ENTRY(BLK3_setupFunctionAutoStart,                   1)		\
+	USER_PARAM_ENTRY(BLK3_setupAnimalWeighingOperationMode,         1)     \
+	USER_PARAM_ENTRY(BLK3_setupAnimalWeighingSamplingTime,          4)     \
+	USER_PARAM_ENTRY(BLK3_setupAnimalWeighingAutoStart,             1)     \
+	USER_PARAM_ENTRY(BLK3_setupAnimalWeighingdisplayLine2,          1)     \
+	USER_PARAM_ENTRY(BLK3_setupAnimalWeighingStartThreshold,        4)     \
+	USER_PARAM_ENTRY(BLK3_setupAnimalWeighingAutoPrint,             1)     \
+	USER_PARAM_ENTRY(BLK3_setupAnimalWeighingPrintDelay,            1)     \
+	USER_PARAM_ENTRY(BLK3_setupOverUnderOperationSource,			1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderOperationTolType,			1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderOperationTargetEdit,  		1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderOperationHoldTimer,  	 	4)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderOperationMotionCheck,		1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderOperationAutoPrint,			1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderDisplayMode,				1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderDisplayLine,				1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderDisplaySmarttrack,			1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderDisplayMotionblanking,		1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderTargetTable,                1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderTotalizationTotalization,	1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderTotalizationCleartotals,	1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderMenukeysActivetarget,		1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderMenukeysQuicksettarget,	    1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderMenukeysTargettable,		1)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderTargetValues,	    		4)		\
+	USER_PARAM_ENTRY(BLK3_setupOverunderAvtiveUnit,                 1)     \
+	USER_PARAM_ENTRY(BLK3_setupOverUnderTargetMinusTol,    		    4)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderTargetPlusTol,     		    4)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderTargetUnderLimit,    		4)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderTargetOverLimit,     		4)		\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderTargetDiscription, 		    21)	\
+	USER_PARAM_ENTRY(BLK3_setupOverUnderRecordIndex,                1)		\
+	USER_PARAM_ENTRY(BLK3_setupPeakWeighingOperationMode,			1)		\
+	USER_PARAM_ENTRY(BLK3_setupPeakWeighingUseMemory,				1)		\
+	USER_PARAM_ENTRY(BLK3_setupPeakWeighingAutoPrint,				1)		\
+	USER_PARAM_ENTRY(BLK3_setupPeakWeighingDispLine1,      			1)		\
+	USER_PARAM_ENTRY(BLK3_setupPeakWeighingDispLine2,	  			1)		\
+	USER_PARAM_ENTRY(BLK3_setupPeakWeighingReports,                 1)     \
+	USER_PARAM_ENTRY(BLK3_setupPeakWeighingHoldTimer,               4)     \
+	USER_PARAM_ENTRY(BLK3_setupDynamicWeighingTimeInterval,	        2)		\
+	USER_PARAM_ENTRY(BLK3_setupDynamicWeighingAccumulation,	        1)		\
+	USER_PARAM_ENTRY(BLK3_setupDynamicWeighingAutoMemClear,	        1)		\
+	USER_PARAM_ENTRY(BLK3_setupDynamicWeighingAutoPrint,	        1)		\
+	USER_PARAM_ENTRY(BLK3_setupDynamicWeighingDispLine,		        1)		\
+	USER_PARAM_ENTRY(BLK3_setupCountingOperationPrompt,             1)     \
+	USER_PARAM_ENTRY(BLK3_setupCountingOperationOptimize,           1)     \
+	USER_PARAM_ENTRY(BLK3_setupCountingOperationAutoClearAPW,       1)     \
+	USER_PARAM_ENTRY(BLK3_setupCountingOperationTARGETPCS,			4)		\
+	USER_PARAM_ENTRY(BLK3_setupCountingDisplayLine1,                1)     \
+	USER_PARAM_ENTRY(BLK3_setupCountingDisplayLine2,                1)     \
+	USER_PARAM_ENTRY(BLK3_setupCountingMenuKeysIDTable,             1)     \
+	USER_PARAM_ENTRY(BLK3_setupCountingMenuKeysReports,             1)     \
+	USER_PARAM_ENTRY(BLK3_setupCountingMenuKeysSampleAPWSelect,     1)     \
+	USER_PARAM_ENTRY(BLK3_setupCountingIDMemoryIDTable,             1)     \
+	USER_PARAM_ENTRY(BLK3_setupCountingIDMemoryTotalization,        1)     \
+	USER_PARAM_ENTRY(BLK3_setupCountingIDMemoryClearOnPrint,        1)     \
+    USER_PARAM_ENTRY(BLK3_setupCountingIDMemoryUpdateAPW,           1)     \
+	USER_PARAM_ENTRY(BLK3_setupCountingWeighingAutoRefOpti,	        1)		\
+	USER_PARAM_ENTRY(BLK3_setupCountingWeighingAPWEntry,	        1)		\
+	USER_PARAM_ENTRY(BLK3_setupCountingWeighingAccumulate,	        1)		\
+	USER_PARAM_ENTRY(BLK3_setupCountingWeighingLastUsedID,	        16)	\
+	USER_PARAM_ENTRY(BLK3_setupCountingWeighingIDLKUPTAB0,	        2)		\
+	USER_PARAM_ENTRY(BLK3_setupCountingWeighingIDLKUPTAB1,	        2)		\
+	USER_PARAM_ENTRY(BLK3_setupCountingWeighingIDLKUPTAB2,	        2)		\
+	USER_PARAM_ENTRY(BLK3_setupCountingWeighingIDLKUPTAB3,	        2)		\
+	USER_PARAM_ENTRY(BLK3_setupCountingWeighingIDLKUPTAB4,	        2)		\
+	USER_PARAM_ENTRY(BLK3_setupCountingWeighingIDLKUPTAB5,	        2)		\
+	USER_PARAM_ENTRY(BLK3_setupCountingWeighingIDLKUPTAB6,	        2)		\
+	USER_PARAM_ENTRY(BLK3_setupVehicleOperationTemporaryID,         1)     \
+	USER_PARAM_ENTRY(BLK3_setupVehicleOperationAutoID,              1)     \
+	USER_PARAM_ENTRY(BLK3_setupVehicleOperationOperatorClearing,    1)     \
+	USER_PARAM_ENTRY(BLK3_setupVehicleOperationPermanentID,         1)     \
+	USER_PARAM_ENTRY(BLK3_setupVehicleOperationDescription,         1)     \
+	USER_PARAM_ENTRY(BLK3_setupVehicleOperationTotalization,        1)     \
+	USER_PARAM_ENTRY(BLK3_setupVehicleOperationClearTotals,         1)     \
+	USER_PARAM_ENTRY(BLK3_setupVehicleGeneralTempPrompt,            1)     \
+	USER_PARAM_ENTRY(BLK3_setupVehicleGeneralPermPrompt,            1)     \
+	USER_PARAM_ENTRY(BLK3_setupVehicleGeneralThresholdWt,           4)     \
+    USER_PARAM_ENTRY(BLK3_setupVehicleGeneralResetWt,               4)     \
+    USER_PARAM_ENTRY(BLK3_setupVehicleGeneralTransactionTable,      1)     \
+    USER_PARAM_ENTRY(BLK3_SERVICENUMBER,                            21)    \
+    USER_PARAM_ENTRY(BLK3_checksum,							2)		\
 	/* MFG eeprom block start */						\
-	{BLK4_zeroCounts2mv, 			 		4},		\
-	{BLK4_spanCounts2mv,  					4},		\
-	/*{BLK4_startupcounter,                   4},		\*/\
-	{BLK4_checksum,       					2},		\
+	USER_PARAM_ENTRY(BLK4_zeroCounts2mv, 			 		4)		\
+	USER_PARAM_ENTRY(BLK4_spanCounts2mv,  					4)		\
+	/*USER_PARAM_ENTRY(BLK4_startupcounter,                   4)		\*/\
+	USER_PARAM_ENTRY(BLK4_checksum,       					2)		\
 	/* block3 start */                           		\
-	{BLK5_sdWasPresent, 					1},		\
-	{BLK5_setupMaintenanceRestorefromSDCard,1},     \
-	{BLK5_checksum,       					2},		\
+	USER_PARAM_ENTRY(BLK5_sdWasPresent, 					1)		\
+	USER_PARAM_ENTRY(BLK5_setupMaintenanceRestorefromSDCard,1)     \
+	USER_PARAM_ENTRY(BLK5_checksum,       					2)		\
 
 //! WARNING C-Syntax: NO character is allowed after the backspace '\' !!!  BLK1_targetSource
 //! Storage type definitions for blocks. Note that blocks with STORAGE_BAK type should put ahead of those with STORAGE_APP type consecutively
@@ -755,10 +769,18 @@ typedef enum
 #define EEPROM_USEDBLOCKS	6
 #define MFGPARAPOSITION		(1 << 3)
 
+//! time in ms the flush task collects parameter changes before it writes the eeprom
+#define USER_PARAM_FLUSH_DELAY  100
+
 int USER_PARAM_Initialize(void);
 USER_PARAM_tStatus USER_PARAM_Get(USER_PARAM_tIdent ident, uint8_t* param);
 USER_PARAM_tStatus USER_PARAM_Set(USER_PARAM_tIdent ident, uint8_t* param);
 USER_PARAM_tStatus USER_PARAM_GetBlock(int32_t blockIndex, uint8_t* param);
 USER_PARAM_tStatus USER_PARAM_SetBlock(int32_t blockIndex, uint8_t* param);
+USER_PARAM_tStatus USER_PARAM_Flush(void);
+void USER_PARAM_Begin(void);
+USER_PARAM_tStatus USER_PARAM_Commit(void);
+USER_PARAM_tStatus USER_PARAM_Sync(void);
+bool USER_PARAM_IsDirty(void);
 
 #endif // _USER_PARAM_H
@@ -56,6 +56,18 @@
 #include "gpio.h"
 #include "usart.h"
 #include "CmdProcess.h"
+#include "ModbusRTUSlave.h"
+#include "MTSICS.h"
+#include "ContOut.h"
+#include "WeightBus.h"
+#include "Telemetry.h"
+#include "UserParam.h"
+#include "WarmStart.h"
+#include "BootTime.h"
+#include "Trace.h"
+#include "TaskStat.h"
+#include "EventLoop.h"
+#include "SimLoad.h"
 #include "scale.h"
 #include "ADS12xx.h"
 #include "ADS1230.h"    
@@ -63,27 +75,75 @@
 /* USER CODE END Includes */
 
 /* Variables -----------------------------------------------------------------*/
-osThreadId WeighProcessHandle;
-osThreadId Uart1_ProcessHandle;
-osThreadId Uart2_ProcessHandle;
 
 osSemaphoreId uart1BinarySemHandle;
+osStaticSemaphoreDef_t uart1BinarySemControlBlock;
 
 /* USER CODE BEGIN Variables */
 
+// all RTOS objects are allocated statically, the RAM use is in the map file
+//
+// The tasks are created here and not in YL_DLC.ioc: APP_EVENT_LOOP selects them and the stack of
+// WeighProcessTask, CubeMX keeps this code when it generates the file again.
+//
+// Stack words of the tasks: the deepest call path found by make stack in Host/, library calls, the
+// 16 words of the exception frame and the saved context, and about 30 % reserve. The frames are
+// those of the x86-64 host build, larger than on the Cortex-M3; READTASK shows the words that
+// were never used on target.
+//   WeighProcess    154 --> 224
+//   Uart1_Process   118 --> 192
+//   Uart2_Process   194 + 64 sprintf(), sscanf(), strtod() --> 320
+//   ADC_Process      64 --> 128
+//   EE_Flush        112 --> 160
+#define WEIGH_PROCESS_STACK     224
+#define UART1_PROCESS_STACK     192
+#define UART2_PROCESS_STACK     320
+#define ADC_PROCESS_STACK       128
+#define EE_FLUSH_STACK          160
+
+#if (APP_EVENT_LOOP == 0)
+#define WEIGH_TASK_STACK        WEIGH_PROCESS_STACK
+#else
+// all handlers run on the stack of WeighProcessTask, it gets the budget of the five tasks
+#define WEIGH_TASK_STACK        (WEIGH_PROCESS_STACK + UART1_PROCESS_STACK + UART2_PROCESS_STACK \
+                                 + ADC_PROCESS_STACK + EE_FLUSH_STACK)
+#endif
+
+osThreadId WeighProcessHandle;
+uint32_t WeighProcessBuffer[ WEIGH_TASK_STACK ];
+osStaticThreadDef_t WeighProcessControlBlock;
+#if (APP_EVENT_LOOP == 0)
+osThreadId Uart1_ProcessHandle;
+uint32_t Uart1_ProcessBuffer[ UART1_PROCESS_STACK ];
+osStaticThreadDef_t Uart1_ProcessControlBlock;
+osThreadId Uart2_ProcessHandle;
+uint32_t Uart2_ProcessBuffer[ UART2_PROCESS_STACK ];
+osStaticThreadDef_t Uart2_ProcessControlBlock;
 osThreadId ADC_ProcessHandle;
+uint32_t ADC_ProcessBuffer[ ADC_PROCESS_STACK ];
+osStaticThreadDef_t ADC_ProcessControlBlock;
+osThreadId EE_FlushHandle;
+uint32_t EE_FlushBuffer[ EE_FLUSH_STACK ];
+osStaticThreadDef_t EE_FlushControlBlock;
+osSemaphoreId eeFlushSemHandle;
+osStaticSemaphoreDef_t eeFlushSemControlBlock;
+#endif
+osMutexId eeMutexHandle;
+osStaticMutexDef_t eeMutexControlBlock;
 int32_t adcvalue1;
 int32_t adcvalue2;
 int32_t sumvalue;
 double dFilerAdcValue;
 double sFilerAdcValue;
 //strFiltertype FisrtFilter;
+
+// state of the handlers between two calls
+static bool adc1flag1 = false;
+static bool adc1flag2 = false;
+static int runtime = 0;
 /* USER CODE END Variables */
 
 /* Function prototypes -------------------------------------------------------*/
-void WeighProcessTask(void const * argument);
-void Uart1_ProcessTask(void const * argument);
-void Uart2_ProcessTask(void const * argument);
 
 
 
@@ -91,184 +151,302 @@ void Uart2_ProcessTask(void const * argument);
 void MX_FREERTOS_Init(void); /* (MISRA C 2004 rule 8.1) */
 
 /* USER CODE BEGIN FunctionPrototypes */
+void WeighProcessTask(void const * argument);
+#if (APP_EVENT_LOOP == 0)
+void Uart1_ProcessTask(void const * argument);
+void Uart2_ProcessTask(void const * argument);
 void ADC_ProcessTask(void const * argument);
+void EE_FlushTask(void const * argument);
+#endif
 
-extern void FreshRegArry();
-extern int  ModbusRTU_Process( int com, unsigned char * rebuf,int receivelenth );//ս֡ͷ
 /* USER CODE END FunctionPrototypes */
 
 /* Hook prototypes */
 
+/* GetIdleTaskMemory prototype (linked to static allocation support) */
+void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize );
+
+/* USER CODE BEGIN GET_IDLE_TASK_MEMORY */
+static StaticTask_t xIdleTaskTCBBuffer;
+static StackType_t xIdleStack[configMINIMAL_STACK_SIZE];
+  
+void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize )
+{
+  *ppxIdleTaskTCBBuffer = &xIdleTaskTCBBuffer;
+  *ppxIdleTaskStackBuffer = &xIdleStack[0];
+  *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+  /* place for user code */
+}                   
+/* USER CODE END GET_IDLE_TASK_MEMORY */
+
 /* Init FreeRTOS */
 
 void MX_FREERTOS_Init(void) {
   /* USER CODE BEGIN Init */
-       
+  // weighing state of the last run after a watchdog or pin reset
+  WARM_Restore(&dFilerAdcValue);
   /* USER CODE END Init */
 
   /* USER CODE BEGIN RTOS_MUTEX */
   /* add mutexes, ... */
+  // eeprom access of the parameter module
+  osMutexStaticDef(eeMutex, &eeMutexControlBlock);
+  eeMutexHandle = osMutexCreate(osMutex(eeMutex));
   /* USER CODE END RTOS_MUTEX */
 
   /* Create the semaphores(s) */
   /* definition and creation of uart1BinarySem */
-  osSemaphoreDef(uart1BinarySem);
+  osSemaphoreStaticDef(uart1BinarySem, &uart1BinarySemControlBlock);
   uart1BinarySemHandle = osSemaphoreCreate(osSemaphore(uart1BinarySem), 1);
 
   /* USER CODE BEGIN RTOS_SEMAPHORES */
   /* add semaphores, ... */
+  // a static binary semaphore is created empty, COM1 is free for the first SendCom()
+  osSemaphoreRelease(uart1BinarySemHandle);
+#if (APP_EVENT_LOOP == 0)
+  // parameter changes to write, empty: no flush before the first change
+  osSemaphoreStaticDef(eeFlushSem, &eeFlushSemControlBlock);
+  eeFlushSemHandle = osSemaphoreCreate(osSemaphore(eeFlushSem), 1);
+#endif
   /* USER CODE END RTOS_SEMAPHORES */
 
   /* USER CODE BEGIN RTOS_TIMERS */
   /* start timers, add new ones, ... */
   /* USER CODE END RTOS_TIMERS */
 
-  /* Create the thread(s) */
-  /* definition and creation of WeighProcess */
-  osThreadDef(WeighProcess, WeighProcessTask, osPriorityNormal, 0, 128);
-  WeighProcessHandle = osThreadCreate(osThread(WeighProcess), NULL);
-
-  /* definition and creation of Uart1_Process */
-  osThreadDef(Uart1_Process, Uart1_ProcessTask, osPriorityIdle, 0, 128);
-  Uart1_ProcessHandle = osThreadCreate(osThread(Uart1_Process), NULL);
-
-  /* definition and creation of Uart2_Process */
-  osThreadDef(Uart2_Process, Uart2_ProcessTask, osPriorityIdle, 0, 128);
-  Uart2_ProcessHandle = osThreadCreate(osThread(Uart2_Process), NULL);
-
   /* USER CODE BEGIN RTOS_THREADS */
   
   /* add threads, ... */
+  osThreadStaticDef(WeighProcess, WeighProcessTask, osPriorityNormal, 0, WEIGH_TASK_STACK, WeighProcessBuffer, &WeighProcessControlBlock);
+  WeighProcessHandle = osThreadCreate(osThread(WeighProcess), NULL);
+#if (APP_EVENT_LOOP == 0)
+  osThreadStaticDef(Uart1_Process, Uart1_ProcessTask, osPriorityIdle, 0, UART1_PROCESS_STACK, Uart1_ProcessBuffer, &Uart1_ProcessControlBlock);
+  Uart1_ProcessHandle = osThreadCreate(osThread(Uart1_Process), NULL);
+  osThreadStaticDef(Uart2_Process, Uart2_ProcessTask, osPriorityIdle, 0, UART2_PROCESS_STACK, Uart2_ProcessBuffer, &Uart2_ProcessControlBlock);
+  Uart2_ProcessHandle = osThreadCreate(osThread(Uart2_Process), NULL);
+  osThreadStaticDef(EE_Flush, EE_FlushTask, osPriorityIdle, 0, EE_FLUSH_STACK, EE_FlushBuffer, &EE_FlushControlBlock);
+  EE_FlushHandle = osThreadCreate(osThread(EE_Flush), NULL);
+  osThreadStaticDef(ADC_Process, ADC_ProcessTask, osPriorityIdle, 0, ADC_PROCESS_STACK, ADC_ProcessBuffer, &ADC_ProcessControlBlock);
+  ADC_ProcessHandle = osThreadCreate(osThread(ADC_Process), NULL);
+#else
+  // all handlers are RB_OS tasks of WeighProcessTask
+  EVLOOP_Init();
+#endif
   /* USER CODE END RTOS_THREADS */
-  osThreadDef(ADC_Process, ADC_ProcessTask, osPriorityIdle, 0, 128);
-  Uart2_ProcessHandle = osThreadCreate(osThread(ADC_Process), NULL);
   /* USER CODE BEGIN RTOS_QUEUES */
   /* add queues, ... */
   /* USER CODE END RTOS_QUEUES */
 }
 
-/* WeighProcessTask function */
-void WeighProcessTask(void const * argument)
-{
+/* USER CODE BEGIN Application */
 
-  /* USER CODE BEGIN WeighProcessTask */
+/**---------------------------------------------------------------------
+ * Name         : APP_WeighCycle
+ * Description  : weight cycle, every 100 ms
+ * Prototype in : EventLoop.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void APP_WeighCycle(void)
+{
   double filteredCounts;  
   double stabfilercounts;
-  int runtime;
-  /* Infinite loop */
-  for(;;)
-  {
+
+    TRACE_START(TRACE_STAGE_CYCLE);
      filteredCounts = dFilerAdcValue;
+     TRACE_START(TRACE_STAGE_STABFILT);
      stabfilercounts = FilterWeight(&filteredCounts);
+     TRACE_STOP(TRACE_STAGE_STABFILT);
      sFilerAdcValue = stabfilercounts;
+    WBUS_SetCounts(filteredCounts, stabfilercounts);
     SCALE_PostProcess(&g_ScaleData, (long)stabfilercounts);
+    CONT_Process();
+    WARM_WeightCycle();
+    TRACE_STOP(TRACE_STAGE_CYCLE);
     runtime++;
     if(runtime==10)
     {
      HAL_GPIO_TogglePin(LED1_GPIO_Port, LED1_Pin);
+     // CPU share of the tasks over the last second
+     TSTAT_Update();
      runtime = 0;
     }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : APP_Com1Frame
+ * Description  : Modbus frame received on COM1
+ * Prototype in : EventLoop.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void APP_Com1Frame(void)
+{
+    uint8_t *pFrame;
+    uint16_t len;
+
+    // the next frame goes to the other buffer meanwhile
+    pFrame = UsartTakeFrame1(&len);
+    if(pFrame != NULL)
+        ModbusRTU_Process(0, pFrame, len);
+}
+
+/**---------------------------------------------------------------------
+ * Name         : APP_Com2Frame
+ * Description  : command frame received on COM2
+ * Prototype in : EventLoop.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void APP_Com2Frame(void)
+{
+    // flag cleared afterwards, the FIFO must not be refilled while the lines are parsed
+    SetCmdProcess((char*)usart2_rx_FIFO,usart2_rx_len);
+    usart2_rx_flag = 0;  
+}
+
+/**---------------------------------------------------------------------
+ * Name         : APP_SicsPoll
+ * Description  : SIR stream and pending S/Z/T answers of the latest
+ *                weight cycle, every 20 ms
+ * Prototype in : EventLoop.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void APP_SicsPoll(void)
+{
+    MTSICS_Poll();
+}
+
+/**---------------------------------------------------------------------
+ * Name         : APP_AdcPoll
+ * Description  : read the converters or take a sample of the
+ *                scripted load, every 10 ms
+ * Prototype in : EventLoop.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void APP_AdcPoll(void)
+{
+    TRACE_START(TRACE_STAGE_ADC);
+    if(SIM_IsActive())
+    {
+      // scripted load, one sample of both channels per poll
+      SIM_Sample(&adcvalue1, &adcvalue2);
+      adc1flag1 = true;
+      adc1flag2 = true;
+    }
+    else
+    {
+      if(ADS1_DATA_READY == 0)
+      {
+        adcvalue1 = ReadADS1230Value1();
+        adc1flag1 = true;
+      }
+      if(ADS2_DATA_READY == 0)
+      {
+        adcvalue2 = ReadADS1230Value2();
+        adc1flag2 = true;
+      }
+    }
+    TRACE_STOP(TRACE_STAGE_ADC);
     
+    if(adc1flag1&adc1flag2)
+    {
+      TRACE_START(TRACE_STAGE_SAMPLE);
+      sumvalue = (int)(adcvalue1 + g_ScaleData.adjutk2*adcvalue2+2000); 
+      
+      TRACE_START(TRACE_STAGE_FILTER);
+      dFilerAdcValue = execute_filter(sumvalue);
+      TRACE_STOP(TRACE_STAGE_FILTER);
+      TLM_Sample(adcvalue1, adcvalue2, dFilerAdcValue);
+      WARM_Save(dFilerAdcValue);
+      BOOT_Stamp(BOOT_STAGE_ADC);
+      TRACE_STOP(TRACE_STAGE_SAMPLE);
+      
+      adc1flag1 = false;
+      adc1flag2 = false;
+    }
+}
+
+/**---------------------------------------------------------------------
+ * Name         : APP_ParamFlush
+ * Description  : write the parameter changes to the eeprom
+ * Prototype in : EventLoop.h
+ * \return    	: none
+ *---------------------------------------------------------------------*/
+void APP_ParamFlush(void)
+{
+    USER_PARAM_Flush();
+}
+
+/* WeighProcessTask function */
+void WeighProcessTask(void const * argument)
+{
+  BOOT_Stamp(BOOT_STAGE_SCHED);
+#if (APP_EVENT_LOOP == 1)
+  EVLOOP_Run();
+#endif
+  /* Infinite loop */
+  for(;;)
+  {
+    APP_WeighCycle();
     osDelay(100); //10HZ
   }
-  /* USER CODE END WeighProcessTask */
 }
 
+#if (APP_EVENT_LOOP == 0)
 /* Uart1_ProcessTask function */
 void Uart1_ProcessTask(void const * argument)
 {
-  /* USER CODE BEGIN Uart1_ProcessTask */
   /* Infinite loop */
   for(;;)
   {
-    FreshRegArry();
     if(usart1_rx_flag == 1)  // 
     {
-         
-        ModbusRTU_Process(0, usart1_rx_FIFO,usart1_rx_len);
-        usart1_rx_flag = 0;
-        memset(usart1_rx_FIFO,0,1024);
+        APP_Com1Frame();
     }
     osDelay(10);
   }
-  /* USER CODE END Uart1_ProcessTask */
 }
 
 /* Uart2_ProcessTask function */
 void Uart2_ProcessTask(void const * argument)
 {
-  /* USER CODE BEGIN Uart2_ProcessTask */
   /* Infinite loop */
   for(;;)
   {
     
        if(usart2_rx_flag == 1)  // 
       {
-          usart2_rx_flag = 0;  
-          SetCmdProcess((char*)usart2_rx_FIFO,SetCmdArry);
-          memset(usart2_rx_FIFO,0,1024);
-          
+          APP_Com2Frame();
       }      
+      APP_SicsPoll();
     
     osDelay(20);
   }
-  /* USER CODE END Uart2_ProcessTask */
 }
 
-/* USER CODE BEGIN Application */
- 
 /* ADC_ProcessTask function */
 void ADC_ProcessTask(void const * argument)
 {
-  /* USER CODE BEGIN ADC_ProcessTask */
-  // read adc
-   bool adc1flag1 = false;
-   bool adc1flag2 = false;
-//   int readtimes = 0;
-//   int sumfilter = 0;
-//   memset(&FisrtFilter,0,sizeof(FisrtFilter));
-//   FisrtFilter.headpt = FILTER_BUF_NUM-1;
   /* Infinite loop */
   for(;;)
   {
-    if(ADS1_DATA_READY == 0)
-    {
-      adcvalue1 = ReadADS1230Value1();
-      adc1flag1 = true;
-    }
-    if(ADS2_DATA_READY == 0)
-    {
-      adcvalue2 = ReadADS1230Value2();
-      adc1flag2 = true;
-    }
-    
-    if(adc1flag1&adc1flag2)
-    {
-//       readtimes++;
-       sumvalue = (int)(adcvalue1 + g_ScaleData.adjutk2*adcvalue2+2000); 
-//       sumfilter +=  CountsFilter(&FisrtFilter,sumvalue);
-//      if(readtimes == 64)
-//      {
-//         sumfilter >>=3;
-//         readtimes = 0;
-//         dFilerAdcValue = sumfilter;
-//         sumfilter = 0;
-//         
-//      }
-      
-      dFilerAdcValue = execute_filter(sumvalue);
-//      dFilerAdcValue =  CountsFilter(strFiltertype *PFilter,int32_t adcvalue)
-//      stabfilercounts = dFilerAdcValue;
-      
-      adc1flag1 = false;
-      adc1flag2 = false;
-    }
-    
+    APP_AdcPoll();
     osDelay(10);
   }
-  /* USER CODE END ADC_ProcessTask */
 }
 
+/* EE_FlushTask function */
+void EE_FlushTask(void const * argument)
+{
+  /* Infinite loop */
+  for(;;)
+  {
+    osSemaphoreWait(eeFlushSemHandle, osWaitForever);
+    // the parameters of one command are written with one flush
+    osDelay(USER_PARAM_FLUSH_DELAY);
+    APP_ParamFlush();
+  }
+}
+#endif
+
 /* USER CODE END Application */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -54,7 +54,21 @@
 
 /* USER CODE BEGIN 0 */
 
-#define EE_PAGE_SIZE 64
+#include <string.h>
+#include "cmsis_os.h"
+
+static EEPROM_tStat eeStat;
+static uint16_t eePageWear[EE_SIZE / EE_PAGE_SIZE];    // page programs since the clear, saturated
+
+static void EEPROM_CountProgram(uint16_t address, uint8_t size)
+{
+    uint16_t page = address / EE_PAGE_SIZE;
+
+    eeStat.pagePrograms++;
+    eeStat.writeBytes += size;
+    if ((page < EE_SIZE / EE_PAGE_SIZE) && (eePageWear[page] != 0xFFFF))
+        eePageWear[page]++;
+}
 
 /* USER CODE END 0 */
 
@@ -133,18 +147,35 @@ void HAL_I2C_MspDeInit(I2C_HandleTypeDef* i2cHandle)
 /* USER CODE BEGIN 1 */
 
 
+/* sequential read, one transfer per page; the eeprom does not acknowledge during a write cycle, the transfer is repeated */
 HAL_StatusTypeDef  EEPROM_Read(uint16_t address,uint8_t *pData, uint16_t Size, uint32_t Timeout)
 {
     
-     uint16_t i;
-     HAL_StatusTypeDef sta;
-     for(i=0;i<Size;i++) 
+     uint16_t i = 0, n;
+     uint8_t retry;
+     HAL_StatusTypeDef sta = HAL_OK;
+     uint32_t start = get_time_us();
+     while(i < Size)
      {
-         sta = HAL_I2C_Mem_Read(&hi2c1, 0xA1, address++,I2C_MEMADD_SIZE_16BIT, pData++, 1, Timeout);
+         n = EE_PAGE_SIZE - address % EE_PAGE_SIZE;
+         if(n > Size - i)
+             n = Size - i;
+         for(retry = 0; retry < EE_READ_RETRY; retry++)
+         {
+             sta = HAL_I2C_Mem_Read(&hi2c1, 0xA1, address,I2C_MEMADD_SIZE_16BIT, pData, n, Timeout);
+             if(sta == HAL_OK)
+                 break;
+             HAL_Delay(1);
+         }
          if(sta!=HAL_OK)
-             return sta;
-          delay_us(4000);
+             break;
+         address += n;
+         pData += n;
+         i += n;
      }
+     eeStat.readCalls++;
+     eeStat.readBytes += i;
+     eeStat.busTimeUs += get_time_us() - start;
      return sta;    
 //    return HAL_I2C_Mem_Read(&hi2c1, 0xA1, address,I2C_MEMADD_SIZE_16BIT, pData, Size, Timeout);
 }
@@ -172,7 +203,9 @@ HAL_StatusTypeDef EEPROM_Write(uint16_t writeAddr,uint8_t *pData,uint16_t size,u
         uint8_t index;
         uint8_t temp1,temp2,temp3;
         uint16_t addrTemp = writeAddr;
+        uint32_t start = get_time_us();
 
+        eeStat.writeCalls++;
         temp1 = EE_PAGE_SIZE - writeAddr % EE_PAGE_SIZE;
         if(size > temp1)                                //дݳǰҳд
         {
@@ -188,6 +221,7 @@ HAL_StatusTypeDef EEPROM_Write(uint16_t writeAddr,uint8_t *pData,uint16_t size,u
         if(temp1)                                                                //дʼҳ
         {
                 I2C2_WriteBuff16(0xa0,addrTemp,pData,temp1);
+                EEPROM_CountProgram(addrTemp, temp1);
                 pData = pData+temp1;        //ָƫ
                 addrTemp += temp1;
                 HAL_Delay(8);                                        //룬5msдڣд
@@ -197,6 +231,7 @@ HAL_StatusTypeDef EEPROM_Write(uint16_t writeAddr,uint8_t *pData,uint16_t size,u
                 for(index = 0;index<temp2;index++)
                 {
                         I2C2_WriteBuff16(0xa0,addrTemp,pData,EE_PAGE_SIZE);
+                        EEPROM_CountProgram(addrTemp, EE_PAGE_SIZE);
                         pData = pData+EE_PAGE_SIZE;
                         addrTemp += EE_PAGE_SIZE;
                         HAL_Delay(8);
@@ -205,11 +240,39 @@ HAL_StatusTypeDef EEPROM_Write(uint16_t writeAddr,uint8_t *pData,uint16_t size,u
         if(temp3)                                                                //дʣ
         {
                 I2C2_WriteBuff16(0xa0,addrTemp,pData,temp3);
+                EEPROM_CountProgram(addrTemp, temp3);
                 HAL_Delay(8);
         }
+        eeStat.busTimeUs += get_time_us() - start;
         return HAL_OK;
 }
 
+/* eeprom traffic and the most worn page, bReset clears the counters */
+void EEPROM_GetStat(EEPROM_tStat *pStat, uint16_t *pMaxWear, uint16_t *pMaxPage, uint8_t bReset)
+{
+        uint16_t i;
+
+        taskENTER_CRITICAL();
+        *pStat = eeStat;
+        *pMaxWear = 0;
+        *pMaxPage = 0;
+        for(i = 0; i < EE_SIZE / EE_PAGE_SIZE; i++)
+        {
+                if(eePageWear[i] > *pMaxWear)
+                {
+                        *pMaxWear = eePageWear[i];
+                        *pMaxPage = i;
+                }
+        }
+        if(bReset)
+        {
+                memset(&eeStat, 0, sizeof(eeStat));
+                memset(eePageWear, 0, sizeof(eePageWear));
+                eeStat.startTick = HAL_GetTick();
+        }
+        taskEXIT_CRITICAL();
+}
+
 
 /* USER CODE END 1 */
 
@@ -59,6 +59,11 @@
 
 #include "scale.h"
 #include "UserParam.h"
+#include "ContOut.h"
+#include "MTSICS.h"
+#include "WarmStart.h"
+#include "BootTime.h"
+#include "DebugLog.h"
 
 /* USER CODE END Includes */
 
@@ -94,6 +99,23 @@ void delay_us(uint32_t Number)
     }
 }
 
+// free running microsecond time, from the TIM1 time base (1 MHz counter, 1 ms period)
+uint32_t get_time_us(void)
+{
+    extern TIM_HandleTypeDef htim1;
+    uint32_t tick, cnt;
+
+    do
+    {
+      tick = HAL_GetTick();
+      cnt = __HAL_TIM_GET_COUNTER(&htim1);
+    } while(tick != HAL_GetTick());
+    // counter wrapped, tick interrupt not served yet (interrupts locked)
+    if(__HAL_TIM_GET_FLAG(&htim1, TIM_FLAG_UPDATE) && (cnt < 500))
+      tick++;
+    return tick*1000 + cnt;
+}
+
 
 /* USER CODE END 0 */
 
@@ -106,6 +128,11 @@ int main(void)
 {
   /* USER CODE BEGIN 1 */
   char tmpchar[21]={0};
+  BOOT_Init();
+  // reset cause and time, before the tick starts
+  WARM_Init();
+  // keeps the log of before the reset
+  DLOG_Init();
   /* USER CODE END 1 */
 
   /* MCU Configuration----------------------------------------------------------*/
@@ -114,6 +141,13 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
+  BOOT_Stamp(BOOT_STAGE_HAL);
+  {
+    WARM_tStat warm;
+    // the time base of get_time_us() runs from here
+    WARM_GetStat(&warm);
+    DLOG(DLOG_BOOT, warm.resetFlags, 0);
+  }
 
   /* USER CODE END Init */
 
@@ -121,6 +155,7 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  BOOT_Stamp(BOOT_STAGE_CLOCK);
 
   /* USER CODE END SysInit */
 
@@ -131,6 +166,7 @@ int main(void)
   MX_I2C1_Init();
   MX_USART2_UART_Init();
   /* USER CODE BEGIN 2 */
+  BOOT_Stamp(BOOT_STAGE_PERIPH);
 
   // ʼ EEPROM SCALE 
     USER_PARAM_Initialize();
@@ -141,11 +177,15 @@ int main(void)
     {
        memset(tmpchar,0,sizeof(tmpchar));
        memcpy(tmpchar,"Scale 1",strlen("Scale 1"));
+       // all defaults with one commit per block
+       USER_PARAM_Begin();
        USER_PARAM_Set(BLK0_setupScaleName, (uint8_t *)tmpchar);
        memcpy(g_ScaleData.scaleName,tmpchar,sizeof(tmpchar));
        InitScaleStruct(&g_ScaleData);
        ResetScaleParameters();
+       USER_PARAM_Commit();
     }
+    BOOT_Stamp(BOOT_STAGE_PARAM);
     
     SCALE_Init(&g_ScaleData); 
 //    FilterReInit((g_ScaleData.filter), (g_ScaleData.jfilter)); 
@@ -153,6 +193,9 @@ int main(void)
     initialize_filter();
     StabilityFilterInit(25.0,0);
     reInitializeScaleParameters(&g_ScaleData,NORMAL_INIT);
+    CONT_Init();
+    MTSICS_Init();
+    BOOT_Stamp(BOOT_STAGE_SCALE);
   /* USER CODE END 2 */
 
   /* Call init function for freertos objects (in freertos.c) */
@@ -248,7 +291,9 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
     HAL_IncTick();
   }
   /* USER CODE BEGIN Callback 1 */
-
+  if (htim->Instance == TIM1) {
+    WARM_Tick();
+  }
   /* USER CODE END Callback 1 */
 }
 
@@ -56,6 +56,10 @@
 /* USER CODE BEGIN 0 */
 #include "cmsis_os.h"
 #include "string.h" 
+#include "ContOut.h"
+#include "Trace.h"
+#include "EventLoop.h"
+#include "DebugLog.h"
 
 #define RX_BUFFER_LENTH  1024
 extern osSemaphoreId uart1BinarySemHandle;
@@ -64,13 +68,22 @@ uint16_t usart1_rx_len ;
 uint16_t usart1_rx_FIFO_len ;
 uint8_t usart1_rx_flag ;
 uint8_t usart1_rx_buffer[RX_BUFFER_LENTH];
-uint8_t usart1_rx_FIFO[RX_BUFFER_LENTH];
+// the latest frame and the one ModbusRTU_Process() works on, UsartTakeFrame1() swaps them
+static uint8_t usart1_rx_frames[2][RX_BUFFER_LENTH];
+uint8_t *usart1_rx_FIFO = usart1_rx_frames[0];
 
 
 uint16_t usart2_rx_len ;
 uint8_t usart2_rx_flag ;
 uint8_t usart2_rx_buffer[RX_BUFFER_LENTH];
-uint8_t usart2_rx_FIFO[RX_BUFFER_LENTH];
+uint8_t usart2_rx_FIFO[RX_BUFFER_LENTH+1];   // +1 for the terminating 0
+
+// per SendCom() port, 0 = USART1, 1 = USART2
+uint32_t usart_rx_time[USART_PORT_NUM];
+uint32_t usart_tx_time[USART_PORT_NUM];
+uint16_t usart_rx_drop_frames[USART_PORT_NUM];
+uint32_t usart_rx_drop_bytes[USART_PORT_NUM];
+uint16_t usart_tx_drop_frames[USART_PORT_NUM];
 
 
 /* USER CODE END 0 */
@@ -333,12 +346,13 @@ void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
     // лģʽ
     HAL_GPIO_WritePin(RS485_DE_GPIO_Port, RS485_DE_Pin, GPIO_PIN_RESET);
     osSemaphoreRelease (uart1BinarySemHandle);
+    // һ֡, ´򿪷ʹ
+    CONT_TxComplete(0);
+  }
+  else if(huart->Instance == USART2)
+  {
+    CONT_TxComplete(1);
   }
-//  else if(huart->Instance == USART2)
-//  {
-//    HAL_GPIO_WritePin(RS485_DE_GPIO_Port, RS485_DE_Pin, GPIO_PIN_RESET);
-//    osSemaphoreRelease (uart1BinarySemHandle);
-//  }
   
 }
 
@@ -356,16 +370,26 @@ void UsartReceive_IDLE(UART_HandleTypeDef *huart)
       i = huart->Instance->SR;
       i = huart->Instance->DR;
       i = hdma_usart1_rx.Instance->CNDTR; 
-      HAL_UART_DMAStop(huart);
+      HAL_UART_AbortReceive(huart);       // ֹֻͣ, DMA
       
       /* ˴ݣҪǿλ־λ */
-      if(usart1_rx_flag == 0)
+      if(usart1_rx_flag != 0)
       {
-        memcpy(usart1_rx_FIFO,usart1_rx_buffer,(RX_BUFFER_LENTH - i));
-        usart1_rx_flag = 1;
-        usart1_rx_len = RX_BUFFER_LENTH - i;
-//        usart1_rx_FIFO_len = usart1_rx_len;
+        // not taken yet, the newer frame replaces it: on the bus only the latest one can still be answered
+        if(usart_rx_drop_frames[0] < 0xFFFF)
+          usart_rx_drop_frames[0]++;
+        usart_rx_drop_bytes[0] += usart1_rx_len;
+        DLOG(DLOG_COM_DROP, 1, usart1_rx_len);
       }
+      memcpy(usart1_rx_FIFO,usart1_rx_buffer,(RX_BUFFER_LENTH - i));
+      usart1_rx_len = RX_BUFFER_LENTH - i;
+      usart_rx_time[0] = get_time_us();
+//        usart1_rx_FIFO_len = usart1_rx_len;
+#if (APP_EVENT_LOOP == 1)
+      if(usart1_rx_flag == 0)
+        EVLOOP_Post(EVLOOP_QUEUE_COM1);
+#endif
+      usart1_rx_flag = 1;
       
       /* ջ棬½ */
       memset(usart1_rx_buffer,0x00,RX_BUFFER_LENTH);
@@ -378,7 +402,7 @@ void UsartReceive_IDLE(UART_HandleTypeDef *huart)
       i = huart->Instance->SR;
       i = huart->Instance->DR;
       i = hdma_usart2_rx.Instance->CNDTR; 
-      HAL_UART_DMAStop(huart);
+      HAL_UART_AbortReceive(huart);       // ֹֻͣ, DMA
       
       /* ˴ݣҪǿλ־λ */
       if(usart2_rx_flag == 0)
@@ -386,6 +410,18 @@ void UsartReceive_IDLE(UART_HandleTypeDef *huart)
         memcpy(usart2_rx_FIFO,usart2_rx_buffer,(RX_BUFFER_LENTH - i));
         usart2_rx_flag = 1;
         usart2_rx_len = RX_BUFFER_LENTH - i;
+        usart2_rx_FIFO[usart2_rx_len] = 0;
+        usart_rx_time[1] = get_time_us();
+#if (APP_EVENT_LOOP == 1)
+        EVLOOP_Post(EVLOOP_QUEUE_COM2);
+#endif
+      }
+      else
+      {
+        if(usart_rx_drop_frames[1] < 0xFFFF)
+          usart_rx_drop_frames[1]++;
+        usart_rx_drop_bytes[1] += RX_BUFFER_LENTH - i;
+        DLOG(DLOG_COM_DROP, 2, RX_BUFFER_LENTH - i);
       }
       
       /* ջ棬½ */
@@ -397,22 +433,116 @@ void UsartReceive_IDLE(UART_HandleTypeDef *huart)
 }  
 
 
-void SendCom(int Nport,uint8_t *sendstr,int lenth,int timeout)
+/* ȡCOM1µһ֡, ڼжϰһ֡յһ */
+uint8_t *UsartTakeFrame1(uint16_t *pLen)
+{
+  uint8_t *pFrame = NULL;
+  
+  taskENTER_CRITICAL();
+  if(usart1_rx_flag != 0)
+  {
+    pFrame = usart1_rx_FIFO;
+    *pLen = usart1_rx_len;
+    usart1_rx_FIFO = (pFrame == usart1_rx_frames[0]) ? usart1_rx_frames[1] : usart1_rx_frames[0];
+    usart1_rx_flag = 0;
+  }
+  taskEXIT_CRITICAL();
+  return pFrame;
+}
+
+
+HAL_StatusTypeDef SendCom(int Nport,uint8_t *sendstr,int lenth,int timeout)
 {
-  //    UART_HandleTypeDef *huart;
+  UART_HandleTypeDef *huart;
+  HAL_StatusTypeDef status = HAL_BUSY;
+  bool bTaken = false;
+#if TRACE_ENABLE
+  uint32_t traceStart = TRACE_NOW();
+#endif
   
   // RS485 send enable
   if(Nport == 0)
   {
-    osSemaphoreWait (uart1BinarySemHandle, 25);
-    HAL_GPIO_WritePin(RS485_DE_GPIO_Port, RS485_DE_Pin, GPIO_PIN_SET);
-    HAL_UART_Transmit_IT(&huart1, sendstr, lenth); //  жϷ
-    // жɺΪģʽ
+    bTaken = (osSemaphoreWait (uart1BinarySemHandle, 25) == osOK);
+    huart = &huart1;
   }
   else if(Nport == 1)
   {       
-    HAL_UART_Transmit_IT(&huart2, sendstr, lenth); //  жϷ
+    huart = &huart2;
+  }
+  else
+  {
+    return HAL_ERROR;
+  }
+  
+  // DMA֡ڷʱ, ȴtimeout ms
+  while((huart->gState != HAL_UART_STATE_READY) && (timeout > 0) && osKernelRunning())
+  {
+    osDelay(1);
+    timeout--;
+  }
+  
+  taskENTER_CRITICAL();
+  if(huart->gState == HAL_UART_STATE_READY)
+  {
+    if(Nport == 0)
+    {
+      HAL_GPIO_WritePin(RS485_DE_GPIO_Port, RS485_DE_Pin, GPIO_PIN_SET);
+    }
+    usart_tx_time[Nport] = get_time_us();
+    status = HAL_UART_Transmit_IT(huart, sendstr, lenth); //  жϷ
+    // жɺΪģʽ
+    if((status != HAL_OK) && (Nport == 0))
+    {
+      HAL_GPIO_WritePin(RS485_DE_GPIO_Port, RS485_DE_Pin, GPIO_PIN_RESET);
+    }
+  }
+  taskEXIT_CRITICAL();
+  
+  if(status != HAL_OK)
+  {
+    // transmitter still busy after timeout ms, the reply is lost, no TX complete releases COM1
+    if(bTaken)
+    {
+      osSemaphoreRelease(uart1BinarySemHandle);
+    }
+    usart_tx_drop_frames[Nport]++;
+    DLOG(DLOG_COM_TX_DROP, Nport + 1, lenth);
+  }
+#if TRACE_ENABLE
+  TRACE_Record((TRACE_tStage)(TRACE_STAGE_TX1 + Nport), TRACE_NOW() - traceStart);
+#endif
+  return status;
+}
+
+/* DMA, ȴ, Ҳڷж */
+HAL_StatusTypeDef SendComDMA(int Nport,uint8_t *sendstr,int lenth)
+{
+  UART_HandleTypeDef *huart;
+  
+  if(Nport == 0)
+  {
+    huart = &huart1;
+  }
+  else if(Nport == 1)
+  {
+    huart = &huart2;
+  }
+  else
+  {
+    return HAL_ERROR;
+  }
+  
+  if(huart->gState != HAL_UART_STATE_READY)
+  {
+    return HAL_BUSY;
+  }
+  if(Nport == 0)
+  {
+    HAL_GPIO_WritePin(RS485_DE_GPIO_Port, RS485_DE_Pin, GPIO_PIN_SET);
   }
+  usart_tx_time[Nport] = get_time_us();
+  return HAL_UART_Transmit_DMA(huart, sendstr, lenth);
 }
 
 /* USER CODE END 1 */
@@ -4,8 +4,11 @@
 //
 //! \file		util/RB_CRC.h
 //! \ingroup	util
-//! \brief		Functions to calculate CRC codes of arbitrary data. These functions are optimized
-//!					for low memory consumption (no lookup tables are used).
+//! \brief		Functions to calculate CRC codes of arbitrary data. Without a lookup table the CRC
+//!					is calculated bit by bit (low memory consumption). A configuration may carry a
+//!					byte-wise lookup table, reflected configurations also a slicing-by-4 table.
+//!					Tables are either embedded as const (predefined configurations) or built at
+//!					runtime by RB_CRC_BuildTable.
 //!
 //!	For more information about CRC algorithms refer to:
 //!	"A PAINLESS GUIDE TO CRC ERROR DETECTION ALGORITHMS", available on the internet.
@@ -23,6 +26,9 @@
 //!
 //!			You can also use the convenience function RB_CRC_Calculate, which does all the steps for you
 //!
+//!			The predefined configurations are already initialized and may also be passed directly to
+//!			RB_CRC_InitialValue, RB_CRC_UpdateValue and RB_CRC_FinalizeValue.
+//!
 //! \code
 //!				static const char *str[4] = {"1","234","5678","90123"};
 //!				RB_CRC_tCfg cfg;
@@ -50,11 +56,13 @@
 //!
 //! \code
 //!				static const char *str[4] = {"1","234","5678","90123"};
-//!				const RB_CRC_tCfg myConfig = {8,0x8D /*  x8 + x7 + x3 + x2 + 1 */,false,0x00,false,0x00,0,0};
+//!				const RB_CRC_tCfg myConfig = {8,0x8D /*  x8 + x7 + x3 + x2 + 1 */,false,0x00,false,0x00,NULL,0};
+//!				static RB_CRC_tCRC myTable[256];
 //!				RB_CRC_tCfg cfg;
 //!				RB_CRC_tCRC crc;
 //!				int i = 0;
 //!				if(RB_CRC_InitializeConfig(&cfg,&myConfig)){
+//!					RB_CRC_BuildTable(&cfg,myTable,1);	// optional, speeds up RB_CRC_UpdateValue
 //!					crc = RB_CRC_InitialValue(&cfg);
 //!					for(i = 0;i<4;i++){
 //!						crc = RB_CRC_UpdateValue(&cfg,crc,(uint8_t *)str[i],strlen(str[i]));
@@ -81,11 +89,12 @@
 //  I N C L U D E D   F I L E S
 //==================================================================================================
 
-#include "RB_Config.h"
+// This module is automatically enabled/disabled and has no RB_CONFIG_USE, no check is needed here.
 
-#if defined(RB_CONFIG_USE_CRC) && (RB_CONFIG_USE_CRC == RB_CONFIG_YES)
+//#include "RB_Typedefs.h"
 
-#include "RB_Typedefs.h"
+#include <stddef.h>
+#include "comm.h"
 
 
 //==================================================================================================
@@ -101,6 +110,12 @@ extern "C" {
 //  G L O B A L    D E F I N I T I O N S
 //==================================================================================================
 
+//! Number of 256 entry slices of the embedded tables of reflected configurations.
+//! 4 = slicing-by-4 (4 KByte per table), 1 = byte-wise only (1 KByte per table)
+#ifndef RB_CRC_TABLE_SLICES
+#define RB_CRC_TABLE_SLICES		4
+#endif
+
 //! The type of the CRC values. The size of this type limits the max. CRC width
 typedef uint32_t RB_DECL_TYPE RB_CRC_tCRC;
 
@@ -114,10 +129,13 @@ typedef struct {
     RB_CRC_tCRC xorIn;      //!< The initial value of the algorithm
     bool reflectOut;      //!< Wether the output shall be reflected or not
     RB_CRC_tCRC xorOut;     //!< The value which shall be XOR-ed to the final CRC value
+    const RB_CRC_tCRC* table;	//!< Lookup table (tableSlices * 256 entries) or NULL for bit by bit calculation
+    uint32_t tableSlices;	//!< 1 = byte-wise table, 4 = slicing-by-4 table (reflected input only)
 
     // internal parameters, do not change
     RB_CRC_tCRC msbMask;    //!< bitmask with the Most Significant Bit set to 1
     RB_CRC_tCRC crcMask;    //!< bitmask with all bits set to 1 except the MSB
+    RB_CRC_tCRC polyRefl;   //!< reflected polynom, used for reflected input
 
 } RB_DECL_TYPE RB_CRC_tCfg;
 
@@ -126,12 +144,15 @@ typedef struct {
 //  G L O B A L    C O N S T A N T S
 //==================================================================================================
 
-//! The definitions of 3 standard configurations for 8 bit CCITT,16 bit CCITT and 32 bit IEEE802.3 CRC.
-//! Refer to explanation in header about how to use them.
+//! The definitions of 4 standard configurations for 8 bit CCITT, 16 bit CCITT, 16 bit Modbus and
+//! 32 bit IEEE802.3 CRC. Refer to explanation in header about how to use them.
 extern const RB_DECL_CONST RB_CRC_tCfg RB_CRC_8_CCITT_CFG;
 
 extern const RB_DECL_CONST RB_CRC_tCfg RB_CRC_16_CCITT_CFG;
 
+//! Modbus RTU CRC, the final value is transmitted low byte first
+extern const RB_DECL_CONST RB_CRC_tCfg RB_CRC_16_MODBUS_CFG;
+
 extern const RB_DECL_CONST RB_CRC_tCfg RB_CRC_32_IEEE802_3_CFG;
 
 
@@ -159,6 +180,17 @@ RB_DECL_FUNC void RB_CRC_Initialize(void);
 //--------------------------------------------------------------------------------------------------
 RB_DECL_FUNC bool RB_CRC_InitializeConfig(RB_CRC_tCfg* cfg, const RB_CRC_tCfg* cfgdef);
 
+//--------------------------------------------------------------------------------------------------
+// RB_CRC_BuildTable
+//--------------------------------------------------------------------------------------------------
+//! \brief			Build a lookup table for an initialised CRC configuration and attach it to \a cfg.
+//! \param	cfg		A pointer to an initialised RB_CRC_tCfg structure.
+//! \param	table	Buffer of \a slices * 256 entries, must stay valid as long as \a cfg is used.
+//! \param	slices	1 for a byte-wise table, 4 for slicing-by-4 (reflected input only)
+//! \return			true, if table built, false otherwise (width < 8 or unsupported number of slices)
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC bool RB_CRC_BuildTable(RB_CRC_tCfg* cfg, RB_CRC_tCRC* table, uint32_t slices);
+
 //--------------------------------------------------------------------------------------------------
 // RB_CRC_InitialValue
 //--------------------------------------------------------------------------------------------------
@@ -207,5 +239,4 @@ RB_DECL_FUNC RB_CRC_tCRC RB_CRC_Calculate(const uint8_t* data, size_t offset, si
 }
 #endif
 
-#endif // RB_CONFIG_USE_CRC
 #endif // _RB_CRC__h
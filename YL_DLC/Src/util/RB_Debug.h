@@ -40,7 +40,8 @@
 
 // This module is mandatory (in case of !NDEBUG) and has no RB_CONFIG_USE, no check is needed here.
 
-#include "RB_Sysdefs.h"			// Needed for RB_DECL_FUNC and RB_DECL_TYPE
+//#include "RB_Sysdefs.h"			// Needed for RB_DECL_FUNC and RB_DECL_TYPE
+#include "RB_Typedefs.h"			// RB_DECL_FUNC and RB_DECL_TYPE are defined there in this project
 
 
 //==================================================================================================
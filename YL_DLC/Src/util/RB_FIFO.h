@@ -56,6 +56,9 @@ extern "C" {
 //! FIFO control block (wrapped to RB_Queue)
 #define RB_FIFO_tFifo	RB_QUEUE_tQueue
 
+//! Single producer / single consumer FIFO control block (wrapped to RB_Queue)
+#define RB_FIFO_tSpscFifo	RB_QUEUE_tSpscQueue
+
 
 //==================================================================================================
 //  G L O B A L   F U N C T I O N   D E C L A R A T I O N
@@ -191,6 +194,61 @@ RB_DECL_FUNC uint8_t RB_FIFO_Get(RB_FIFO_tFifo *fifo) RB_ATTR_THREAD_SAFE;
 #define RB_FIFO_IsHigh(fifo)	RB_QUEUE_IsHigh(fifo)	// RB_ATTR_THREAD_SAFE, direct wrapped to RB_Queue
 
 
+//--------------------------------------------------------------------------------------------------
+// RB_FIFO_SpscInitialize
+//--------------------------------------------------------------------------------------------------
+//! \brief	Initialization of a single producer / single consumer fifo. All data is lost.
+//!
+//! The RB_FIFO_Spsc... functions are lock-free for one writer and one reader, e.g. a UART
+//! interrupt and a task, and move whole spans of octets.
+//!
+//! \attention length must be a power of two, otherwise it is rounded down to the highest power of
+//!			  two below it, e.g. 100 --> 64.
+//!
+//! \param	fifo        input   Pointer to fifo data structure
+//! \param	buffer      input   Pointer to fifo data buffer, i.e. uint8_t[]
+//! \param	length      input   Length of fifo data buffer, power of two
+//! \return	false if length is 0, the fifo then takes no octet
+//--------------------------------------------------------------------------------------------------
+#define RB_FIFO_SpscInitialize(fifo, buffer, length)	\
+		RB_QUEUE_SpscInitialize(fifo, buffer, length, sizeof(uint8_t)) // direct wrapped to RB_Queue
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_FIFO_Write
+//--------------------------------------------------------------------------------------------------
+//! \brief	Write up to length octets into a single producer / single consumer fifo, writer only.
+//! \param	fifo        input   Pointer to fifo data structure
+//! \param	pData       input   Octets to put into the fifo
+//! \param	length      input   Number of octets
+//! \return	Number of octets written, the rest is dropped
+//--------------------------------------------------------------------------------------------------
+#define RB_FIFO_Write(fifo, pData, length)	RB_QUEUE_PutN(fifo, pData, length)	// direct wrapped to RB_Queue
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_FIFO_Read
+//--------------------------------------------------------------------------------------------------
+//! \brief	Read up to length octets from a single producer / single consumer fifo, reader only.
+//! \param	fifo        input   Pointer to fifo data structure
+//! \param	pData       output  Destination of the octets
+//! \param	length      input   Maximum number of octets
+//! \return	Number of octets read
+//--------------------------------------------------------------------------------------------------
+#define RB_FIFO_Read(fifo, pData, length)	RB_QUEUE_GetN(fifo, pData, length)	// direct wrapped to RB_Queue
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_FIFO_PeekWrite, RB_FIFO_CommitWrite, RB_FIFO_PeekRead, RB_FIFO_CommitRead
+//--------------------------------------------------------------------------------------------------
+//! \brief	Zero-copy access to a single producer / single consumer fifo, see RB_QUEUE_PeekWrite().
+//--------------------------------------------------------------------------------------------------
+#define RB_FIFO_PeekWrite(fifo, pLength)	((uint8_t*)RB_QUEUE_PeekWrite(fifo, pLength))
+#define RB_FIFO_CommitWrite(fifo, length)	RB_QUEUE_CommitWrite(fifo, length)
+#define RB_FIFO_PeekRead(fifo, pLength)		((const uint8_t*)RB_QUEUE_PeekRead(fifo, pLength))
+#define RB_FIFO_CommitRead(fifo, length)	RB_QUEUE_CommitRead(fifo, length)
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -441,6 +441,97 @@ size_t RB_FORMAT_Double(char* pOutput, int decPlaces, float64 value, size_t bufL
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// RB_FORMAT_Fixed
+//--------------------------------------------------------------------------------------------------
+//! \brief	Convert a fixed decimal value (mantissa / 10^decPlaces) to string with decimal places.
+//!			Integer arithmetic only, the output is the same as RB_FORMAT_Double() of the value
+//!			with the same decPlaces, e.g. mantissa 12345, decPlaces 2 --> "123.45".
+//!
+//! \param	pOutput     Output string  buffer
+//! \param	mantissa	Value scaled by 10^decPlaces
+//! \param	decPlaces	Decimal places, range 0..18 (0 = no decimal places, <0 = value with trailing '.')
+//! \param	bufLen		Buffer length of argument 'pOutput'
+//! \return	In case of successful conversion:	return length of string, pOutput will be filled
+//!			In case output buffer is too short: return 0 and pOutput will be filled with empty string (= '\0')
+//!			In case bufLen == 0:				return 0, pOutput will not be changed
+//--------------------------------------------------------------------------------------------------
+size_t RB_FORMAT_Fixed(char* pOutput, int64_t mantissa, int decPlaces, size_t bufLen)
+{
+	char digits[20];	// digits of the magnitude, least significant first
+	uint64_t value64;
+	uint32_t value32;
+	int count = 0;		// Digit count
+	int dp;
+	int i;
+	size_t j = 0;		// String index
+	size_t len;
+
+	// bufLen must be greater than 0
+	if (bufLen == 0) {
+		return 0;			// Buffer length insufficient
+	}
+
+	// Same meaning of decimal places as RB_FORMAT_Double()
+	dp = (decPlaces < 0) ? 0 : decPlaces;
+	if (dp > 18) {
+		pOutput[0] = '\0';	// Return empty string
+		return 0;
+	}
+
+	// Magnitude, -INT64_MIN is computed unsigned
+	value64 = (mantissa < 0) ? (uint64_t)0 - (uint64_t)mantissa : (uint64_t)mantissa;
+
+	// 64 bit division only while the value does not fit into 32 bit
+	while (value64 > 0xFFFFFFFFuLL) {
+		digits[count++] = (char)(value64 % 10uLL);
+		value64 /= 10uLL;
+	}
+	value32 = (uint32_t)value64;
+	do {
+		digits[count++] = (char)(value32 % 10uL);
+		value32 /= 10uL;
+	} while (value32 != 0uL);
+
+	// At least one integer digit, i.e. "0.05"
+	while (count <= dp) {
+		digits[count++] = 0;
+	}
+
+	// Check for proper string length: sign, digits, decimal point
+	len = (size_t)count;
+	if (mantissa < 0) {
+		len++;
+	}
+	if (decPlaces != 0) {
+		len++;
+	}
+	if (len >= bufLen) {
+		pOutput[0] = '\0';	// Return empty string
+		return 0;			// String length insufficient
+	}
+
+	// Process sign, a zero value has none
+	if (mantissa < 0) {
+		pOutput[j++] = '-';
+	}
+
+	// Compose output string
+	for (i = count - 1; i >= 0; i--) {
+		pOutput[j++] = (char)(digits[i] + '0');
+		if ((i == dp) && (decPlaces != 0)) {
+			pOutput[j++] = '.';
+		}
+	}
+
+	// Append trailing zero
+	pOutput[j] = '\0';
+
+	// Return length of string
+	return j;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // RB_FORMAT_DoubleToEFormat
 //--------------------------------------------------------------------------------------------------
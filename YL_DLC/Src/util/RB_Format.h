@@ -141,6 +141,24 @@ RB_DECL_FUNC size_t RB_FORMAT_Hex(char* pOutput, uint32_t value, size_t bufLen,
 RB_DECL_FUNC size_t RB_FORMAT_Double(char* pOutput, int decPlaces, float64 value, size_t bufLen);
 
 
+//--------------------------------------------------------------------------------------------------
+// RB_FORMAT_Fixed
+//--------------------------------------------------------------------------------------------------
+//! \brief	Convert a fixed decimal value (mantissa / 10^decPlaces) to string with decimal places.
+//!			Integer arithmetic only, the output is the same as RB_FORMAT_Double() of the value
+//!			with the same decPlaces, e.g. mantissa 12345, decPlaces 2 --> "123.45".
+//!
+//! \param	pOutput     Output string  buffer
+//! \param	mantissa	Value scaled by 10^decPlaces
+//! \param	decPlaces	Decimal places, range 0..18 (0 = no decimal places, <0 = value with trailing '.')
+//! \param	bufLen		Buffer length of argument 'pOutput'
+//! \return	In case of successful conversion:	return length of string, pOutput will be filled
+//!			In case output buffer is too short: return 0 and pOutput will be filled with empty string (= "\0")
+//!			In case bufLen == 0:				return 0, pOutput will not be changed
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC size_t RB_FORMAT_Fixed(char* pOutput, int64_t mantissa, int decPlaces, size_t bufLen);
+
+
 //--------------------------------------------------------------------------------------------------
 // RB_FORMAT_DoubleToEFormat
 //--------------------------------------------------------------------------------------------------
@@ -248,6 +248,29 @@ void RB_OS_TaskTicker(void)
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// RB_OS_TaskGetNextDelay
+//--------------------------------------------------------------------------------------------------
+//! \brief	Shortest remaining delay of the delayed tasks.
+//!
+//! \return	Delay in ms, UINT32_MAX if no task is delayed
+//--------------------------------------------------------------------------------------------------
+uint32_t RB_OS_TaskGetNextDelay(void) RB_ATTR_THREAD_SAFE
+{
+	RB_OS_tTask* pTask;
+	uint32_t delay = UINT32_MAX;
+
+	RB_ENTER_CRITICAL_SECTION;
+	for (pTask = m_pTaskQueue; pTask != NULL; pTask = pTask->next)
+	{
+		if ((pTask->state == RB_OS_DELAYED) && (pTask->delay < delay))
+			delay = pTask->delay;
+	}
+	RB_LEAVE_CRITICAL_SECTION;
+	return delay;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // RB_OS_TaskCreate
 //--------------------------------------------------------------------------------------------------
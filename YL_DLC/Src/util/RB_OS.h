@@ -204,6 +204,20 @@ RB_DECL_FUNC void RB_OS_TaskReschedule(void);
 RB_DECL_FUNC void RB_OS_TaskTicker(void);
 
 
+//--------------------------------------------------------------------------------------------------
+// RB_OS_TaskGetNextDelay
+//--------------------------------------------------------------------------------------------------
+//! \brief	Shortest remaining delay of the delayed tasks.
+//!
+//! A caller that waits for the ticks itself, instead of calling RB_OS_TaskReschedule() every tick,
+//! may sleep this long plus one tick: RB_OS_TaskTicker() makes a task ready one tick after its
+//! delay ran out.
+//!
+//! \return	Delay in ms, UINT32_MAX if no task is delayed
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC uint32_t RB_OS_TaskGetNextDelay(void) RB_ATTR_THREAD_SAFE;
+
+
 //--------------------------------------------------------------------------------------------------
 // RB_OS_TaskCreate
 //--------------------------------------------------------------------------------------------------
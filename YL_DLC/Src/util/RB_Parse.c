@@ -31,6 +31,7 @@
 #include "RB_Parse.h"
 // This module is automatically enabled/disabled and has no RB_CONFIG_USE, no check is needed here.
 
+#include "RB_Config.h" // RB_ENV_DEBUG_LEVEL, RB_Sysdefs.h is not used in this project
 #include "RB_Debug.h"
 
 #include <ctype.h>
@@ -99,7 +100,7 @@ bool RB_PARSE_Long(const char** ppInput, int32_t* pValue)
 				}
 				*pValue = *pValue * 10L + (int32_t)(**ppInput - '0');
 				// Range check: if value is negative -> out of range
-				if ((*pValue < 0) && !((*pValue == LONG_MIN) && valueIsNegativ)) {
+				if ((*pValue < 0) && !((*pValue == INT32_MIN) && valueIsNegativ)) {
 					return false;
 				}
 				valueScanOk = true;
@@ -326,6 +327,166 @@ bool RB_PARSE_Double(const char** ppInput, float64* pValue)
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// RB_PARSE_Fixed
+//--------------------------------------------------------------------------------------------------
+//! \brief	Read a decimal value from string as fixed decimal value (value * 10^decPlaces), like
+//!			RB_PARSE_Double() but with integer arithmetic only. Digits beyond decPlaces are
+//!			rounded half away from zero, e.g. "123.456" with decPlaces 2 --> 12346.
+//!
+//! \param	ppInput		Pointer to input string to parse, points past the value at return
+//! \param	pMantissa	Returned value scaled by 10^decPlaces
+//! \param	decPlaces	Decimal places, range 0..18
+//! \return
+//!		- false	No value could be scanned or the scaled value does not fit into int64_t
+//!		- true	Value could be scanned
+//--------------------------------------------------------------------------------------------------
+bool RB_PARSE_Fixed(const char** ppInput, int64_t* pMantissa, int decPlaces)
+{
+	uint64_t value = 0uLL;
+	int exponent = 0;
+	int expCorr = 0;
+	int scale;
+	int roundDigit = 0;		// most significant dropped digit
+	bool digitDropped = false;
+	bool valueScanOk = false;
+	bool valueIsNegativ = false;
+	bool expIsNegativ = false;
+	bool decPointParsed = false;
+	bool expInputParsed = false;
+	bool expSignParsed = false;
+	bool parsing = true;
+	bool firstChar = true;
+	bool firstExpChar = false;
+
+	// Check input string
+	if ((*ppInput == NULL) || (strlen(*ppInput) == 0U) || (decPlaces < 0) || (decPlaces > 18))
+		return false;
+
+	// Skip spaces in input
+	while (**ppInput == ' ')
+		(*ppInput)++;
+
+	// Parse input string, same syntax as RB_PARSE_Double()
+	while (parsing) {
+		switch (**ppInput) {
+			case '+' :
+			case '-' :
+				if (firstChar) {
+					valueIsNegativ = (**ppInput == '-');
+				}
+				else if (expInputParsed && !expSignParsed) {
+					expIsNegativ = (**ppInput == '-');
+					expSignParsed = true;
+				}
+				else {
+					return false;
+				}
+				break;
+
+			case 'e' :
+			case 'E' :
+				if (!expInputParsed) {
+					expInputParsed = true;
+					expSignParsed = false;
+					firstExpChar = true;
+				}
+				else {
+					return false;
+				}
+				break;
+
+			case '.' :
+				if (expInputParsed) {
+					return false;
+				}
+				if (!decPointParsed)
+					decPointParsed = true;
+				else
+					return false;
+				break;
+
+			case '0' :
+			case '1' :
+			case '2' :
+			case '3' :
+			case '4' :
+			case '5' :
+			case '6' :
+			case '7' :
+			case '8' :
+			case '9' :
+				if (! expInputParsed) {
+					if (value <= 1844674407370955160uLL) {
+						// 19 significant digits are kept while value * 10 + 9 fits into uint64_t
+						value = value * 10uLL + (uint64_t)(**ppInput - '0');
+						if (decPointParsed)
+							expCorr--;
+					}
+					else if (!decPointParsed) {
+						// integer digit beyond the kept ones, overflows later
+						expCorr++;
+					}
+					else if (!digitDropped) {
+						// first dropped decimal digit, rounds if no kept digit is divided off
+						roundDigit = **ppInput - '0';
+						digitDropped = true;
+					}
+					valueScanOk = true;
+				}
+				else {
+					if (exponent < 1000)
+						exponent = exponent * 10 + (**ppInput - '0');
+					firstExpChar = false;
+				}
+				break;
+
+			default:
+				if (firstExpChar) {
+					return false;
+				}
+				parsing = false;
+				break;
+		} // switch
+		(*ppInput)++;
+		firstChar = false;
+	}
+	(*ppInput)--;
+
+	if (!valueScanOk)
+		return false;
+
+	// Scale the digits to decPlaces
+	if (expIsNegativ)
+		exponent = -exponent;
+	scale = exponent + expCorr + decPlaces;
+
+	while ((scale > 0) && (value != 0uLL)) {
+		if (value > 922337203685477580uLL)
+			return false;
+		value *= 10uLL;
+		scale--;
+	}
+	while ((scale < 0) && (value != 0uLL)) {
+		roundDigit = (int)(value % 10uLL);
+		value /= 10uLL;
+		scale++;
+	}
+	// Round half away from zero
+	if (roundDigit >= 5)
+		value++;
+
+	// Range check
+	if (value > ((valueIsNegativ) ? 9223372036854775808uLL : 9223372036854775807uLL))
+		return false;
+
+	// Adjust sign
+	*pMantissa = (valueIsNegativ) ? (int64_t)((uint64_t)0 - value) : (int64_t)value;
+
+	return true;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // RB_PARSE_Hex
 //--------------------------------------------------------------------------------------------------
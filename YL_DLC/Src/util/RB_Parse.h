@@ -104,6 +104,23 @@ RB_DECL_FUNC bool RB_PARSE_ULong(const char** ppInput, uint32_t* pValue);
 RB_DECL_FUNC bool RB_PARSE_Double(const char** ppInput, float64* pValue);
 
 
+//--------------------------------------------------------------------------------------------------
+// RB_PARSE_Fixed
+//--------------------------------------------------------------------------------------------------
+//! \brief	Read a decimal value from string as fixed decimal value (value * 10^decPlaces), like
+//!			RB_PARSE_Double() but with integer arithmetic only. Digits beyond decPlaces are
+//!			rounded half away from zero, e.g. "123.456" with decPlaces 2 --> 12346.
+//!
+//! \param	ppInput		Pointer to input string to parse, points past the value at return
+//! \param	pMantissa	Returned value scaled by 10^decPlaces
+//! \param	decPlaces	Decimal places, range 0..18
+//! \return
+//!		- false	No value could be scanned or the scaled value does not fit into int64_t
+//!		- true	Value could be scanned
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC bool RB_PARSE_Fixed(const char** ppInput, int64_t* pMantissa, int decPlaces);
+
+
 //--------------------------------------------------------------------------------------------------
 // RB_PARSE_Hex
 //--------------------------------------------------------------------------------------------------
@@ -12,6 +12,12 @@
 //!
 //! All functions of RB_Queue are interrupt safe.
 //!
+//! The single producer / single consumer queue RB_QUEUE_tSpscQueue needs no critical section:
+//! head is written by the producer only, tail by the consumer only. The indices run freely and
+//! are masked with numElements - 1, so the level is head - tail and no element is left unused.
+//! A producer publishes head after the elements are written (release), a consumer reads the
+//! elements after it has read head (acquire), and vice versa for tail.
+//!
 //! (c) Copyright Mettler-Toledo. All Rights Reserved.
 //! \author		Christian Zingg. Martin Heusser
 //
@@ -32,8 +38,15 @@
 //  I N C L U D E D   F I L E S
 //==================================================================================================
 
+#include <string.h>
+
 #include "RB_Queue.h"
 // This module is mandatory and has no RB_CONFIG_USE, no check is needed here.
+#include "RB_Config.h" // RB_ENTER/LEAVE_CRITICAL_SECTION, RB_Sysdefs.h is not used in this project
+
+#ifndef RB_MEMORY_BARRIER
+#error "RB_MEMORY_BARRIER() must be defined in RB_Config.h for the single producer / single consumer queue"
+#endif
 
 
 //==================================================================================================
@@ -305,4 +318,233 @@ bool RB_QUEUE_IsHigh(const RB_QUEUE_tQueue* pQueue) RB_ATTR_THREAD_SAFE
 	}
 
 
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_SpscInitialize
+//--------------------------------------------------------------------------------------------------
+//! \brief	Initialization of a single producer / single consumer queue.
+//!
+//! \attention numOfElements must be a power of two, otherwise it is rounded down to the highest
+//!			  power of two below it, e.g. 100 --> 64.
+//! \attention Not thread safe, the queue must not be used by producer or consumer meanwhile.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	pBuffer				input	Pointer to queue data buffer, size must be numOfElements * lengthPerElement
+//! \param	numOfElements		input	Number of elements, power of two, 1 to 32768
+//! \param	lengthPerElement	input	Length in bytes of a single queue element
+//!
+//! \return	false if numOfElements is 0, the queue then takes no element
+//--------------------------------------------------------------------------------------------------
+bool RB_QUEUE_SpscInitialize(RB_QUEUE_tSpscQueue* pQueue, void* pBuffer, uint16_t numOfElements, uint16_t lengthPerElement)
+	{
+	// 0 is kept, the queue has no free element and no element to get
+	bool ok = (numOfElements != 0u);
+
+	// head - tail must tell a full queue from an empty one in 16 bits
+	if (numOfElements > 0x8000u)
+		numOfElements = 0x8000u;
+	while (numOfElements & (numOfElements - 1u))
+		numOfElements &= (uint16_t)(numOfElements - 1u);	// clear the lowest bit set
+
+	pQueue->pBuf        = pBuffer;
+	pQueue->numElements = numOfElements;
+	pQueue->lenElement  = lengthPerElement;
+	pQueue->head        = 0u;
+	pQueue->tail        = 0u;
+	return(ok);
+	}
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_PutN
+//--------------------------------------------------------------------------------------------------
+//! \brief	Puts up to num elements into the queue, producer only.
+//!
+//! \attention Elements that do not fit are dropped, the caller sees it from the return value.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	pElements			input	Pointer to the first element
+//! \param	num					input	Number of elements
+//!
+//! \return	Number of elements put
+//--------------------------------------------------------------------------------------------------
+uint16_t RB_QUEUE_PutN(RB_QUEUE_tSpscQueue* pQueue, const void* pElements, uint16_t num)
+	{
+	union {const void *cpV; const uint8_t *cpU8;} src; // Union to convert const void* to const uint8_t*
+	uint16_t head = pQueue->head;
+	uint16_t freeNum = (uint16_t)(pQueue->numElements - (uint16_t)(head - pQueue->tail));
+	uint16_t index = head & (pQueue->numElements - 1u);
+	uint16_t span;
+	src.cpV = pElements;
+
+	// acquire: the consumer has read the freed elements before it moved tail
+	RB_MEMORY_BARRIER();
+	if (num > freeNum)
+		num = freeNum;
+	span = pQueue->numElements - index;
+	if (span > num)
+		span = num;
+	memcpy(&pQueue->pBuf[(uint32_t)index * pQueue->lenElement], src.cpU8, (uint32_t)span * pQueue->lenElement);
+	memcpy(pQueue->pBuf, src.cpU8 + (uint32_t)span * pQueue->lenElement, (uint32_t)(num - span) * pQueue->lenElement);
+
+	// release: the elements are written before head is moved
+	RB_MEMORY_BARRIER();
+	pQueue->head = head + num;
+	return(num);
+	}
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_GetN
+//--------------------------------------------------------------------------------------------------
+//! \brief	Gets up to num elements from the queue, consumer only.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	pElements			output	Pointer to the destination of the elements
+//! \param	num					input	Maximum number of elements
+//!
+//! \return	Number of elements copied to pElements
+//--------------------------------------------------------------------------------------------------
+uint16_t RB_QUEUE_GetN(RB_QUEUE_tSpscQueue* pQueue, void* pElements, uint16_t num)
+	{
+	union {void *pV; uint8_t *pU8;} dst; // Union to convert void* to uint8_t*
+	uint16_t tail = pQueue->tail;
+	uint16_t level = (uint16_t)(pQueue->head - tail);
+	uint16_t index = tail & (pQueue->numElements - 1u);
+	uint16_t span;
+	dst.pV = pElements;
+
+	// acquire: the elements were written before the producer moved head
+	RB_MEMORY_BARRIER();
+	if (num > level)
+		num = level;
+	span = pQueue->numElements - index;
+	if (span > num)
+		span = num;
+	memcpy(dst.pU8, &pQueue->pBuf[(uint32_t)index * pQueue->lenElement], (uint32_t)span * pQueue->lenElement);
+	memcpy(dst.pU8 + (uint32_t)span * pQueue->lenElement, pQueue->pBuf, (uint32_t)(num - span) * pQueue->lenElement);
+
+	// release: the elements are read before tail is moved
+	RB_MEMORY_BARRIER();
+	pQueue->tail = tail + num;
+	return(num);
+	}
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_PeekWrite
+//--------------------------------------------------------------------------------------------------
+//! \brief	Contiguous free space of the queue, producer only.
+//!
+//! The producer writes the elements in place, e.g. with a DMA, and publishes them with
+//! RB_QUEUE_CommitWrite(). At the end of the buffer the span stops, the rest of the free space
+//! is returned by the next call.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	pNum				output	Number of elements that can be written at the returned address
+//!
+//! \return	Address of the first free element
+//--------------------------------------------------------------------------------------------------
+void* RB_QUEUE_PeekWrite(RB_QUEUE_tSpscQueue* pQueue, uint16_t* pNum)
+	{
+	uint16_t head = pQueue->head;
+	uint16_t freeNum = (uint16_t)(pQueue->numElements - (uint16_t)(head - pQueue->tail));
+	uint16_t index = head & (pQueue->numElements - 1u);
+	uint16_t span = pQueue->numElements - index;
+
+	RB_MEMORY_BARRIER();
+	*pNum = (span < freeNum) ? span : freeNum;
+	return(&pQueue->pBuf[(uint32_t)index * pQueue->lenElement]);
+	}
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_CommitWrite
+//--------------------------------------------------------------------------------------------------
+//! \brief	Publish elements written in place after RB_QUEUE_PeekWrite(), producer only.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	num					input	Number of elements written, not more than returned by RB_QUEUE_PeekWrite()
+//!
+//! \return	none
+//--------------------------------------------------------------------------------------------------
+void RB_QUEUE_CommitWrite(RB_QUEUE_tSpscQueue* pQueue, uint16_t num)
+	{
+	RB_MEMORY_BARRIER();
+	pQueue->head = pQueue->head + num;
+	}
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_PeekRead
+//--------------------------------------------------------------------------------------------------
+//! \brief	Contiguous elements in the queue, consumer only.
+//!
+//! The consumer reads the elements in place and frees them with RB_QUEUE_CommitRead(). At the end
+//! of the buffer the span stops, the rest of the elements is returned by the next call.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	pNum				output	Number of elements at the returned address
+//!
+//! \return	Address of the first element
+//--------------------------------------------------------------------------------------------------
+const void* RB_QUEUE_PeekRead(RB_QUEUE_tSpscQueue* pQueue, uint16_t* pNum)
+	{
+	uint16_t tail = pQueue->tail;
+	uint16_t level = (uint16_t)(pQueue->head - tail);
+	uint16_t index = tail & (pQueue->numElements - 1u);
+	uint16_t span = pQueue->numElements - index;
+
+	RB_MEMORY_BARRIER();
+	*pNum = (span < level) ? span : level;
+	return(&pQueue->pBuf[(uint32_t)index * pQueue->lenElement]);
+	}
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_CommitRead
+//--------------------------------------------------------------------------------------------------
+//! \brief	Free elements read in place after RB_QUEUE_PeekRead(), consumer only.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	num					input	Number of elements read, not more than returned by RB_QUEUE_PeekRead()
+//!
+//! \return	none
+//--------------------------------------------------------------------------------------------------
+void RB_QUEUE_CommitRead(RB_QUEUE_tSpscQueue* pQueue, uint16_t num)
+	{
+	RB_MEMORY_BARRIER();
+	pQueue->tail = pQueue->tail + num;
+	}
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_SpscLevel
+//--------------------------------------------------------------------------------------------------
+//! \brief	Test how many elements are in the queue, exact for the consumer.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//!
+//! \return	Number of elements in queue
+//--------------------------------------------------------------------------------------------------
+uint16_t RB_QUEUE_SpscLevel(const RB_QUEUE_tSpscQueue* pQueue)
+	{
+	return((uint16_t)(pQueue->head - pQueue->tail));
+	}
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_SpscFree
+//--------------------------------------------------------------------------------------------------
+//! \brief	Test how many elements can be put into the queue, exact for the producer.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//!
+//! \return	Number of free elements in queue
+//--------------------------------------------------------------------------------------------------
+uint16_t RB_QUEUE_SpscFree(const RB_QUEUE_tSpscQueue* pQueue)
+	{
+	return((uint16_t)(pQueue->numElements - (uint16_t)(pQueue->head - pQueue->tail)));
+	}
+
+
 //--------------------------------------------------------------------------------------------------
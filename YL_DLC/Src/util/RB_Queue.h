@@ -13,6 +13,11 @@
 //!
 //! All functions of RB_Queue are thread safe.
 //!
+//! The RB_QUEUE_Spsc..., RB_QUEUE_PutN/GetN and RB_QUEUE_Peek/Commit functions work on a separate
+//! control block RB_QUEUE_tSpscQueue with a power of two number of elements. They are lock-free
+//! for exactly one producer and one consumer, e.g. an interrupt and a task, and copy contiguous
+//! spans with memcpy. The indices are published with RB_MEMORY_BARRIER() of RB_Config.h.
+//!
 //! (c) Copyright Mettler-Toledo. All Rights Reserved.
 //! \author		Christian Zingg. Martin Heusser
 //
@@ -60,6 +65,15 @@ typedef struct {
 	const char*		pName;			//!< Name
 } RB_DECL_TYPE RB_QUEUE_tQueue;
 
+//! Single producer / single consumer queue control block, see RB_QUEUE_SpscInitialize()
+typedef struct {
+	uint8_t*			pBuf;			//!< Data buffer
+	uint16_t			numElements;	//!< number of elements that can be stored to queue, power of two
+	uint16_t			lenElement;		//!< Length of a single queue element
+	volatile uint16_t	head;			//!< Input index, free running, written by the producer only
+	volatile uint16_t	tail;			//!< Output index, free running, written by the consumer only
+} RB_DECL_TYPE RB_QUEUE_tSpscQueue;
+
 
 //==================================================================================================
 //  G L O B A L   F U N C T I O N   D E C L A R A T I O N
@@ -241,6 +255,138 @@ RB_DECL_FUNC bool RB_QUEUE_IsLow(const RB_QUEUE_tQueue* pQueue) RB_ATTR_THREAD_S
 RB_DECL_FUNC bool RB_QUEUE_IsHigh(const RB_QUEUE_tQueue* pQueue) RB_ATTR_THREAD_SAFE;
 
 
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_SpscInitialize
+//--------------------------------------------------------------------------------------------------
+//! \brief	Initialization of a single producer / single consumer queue.
+//!
+//! \attention numOfElements must be a power of two, otherwise it is rounded down to the highest
+//!			  power of two below it, e.g. 100 --> 64.
+//! \attention Not thread safe, the queue must not be used by producer or consumer meanwhile.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	pBuffer				input	Pointer to queue data buffer, size must be numOfElements * lengthPerElement
+//! \param	numOfElements		input	Number of elements, power of two, 1 to 32768
+//! \param	lengthPerElement	input	Length in bytes of a single queue element
+//!
+//! \return	false if numOfElements is 0, the queue then takes no element
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC bool RB_QUEUE_SpscInitialize(RB_QUEUE_tSpscQueue* pQueue, void* pBuffer, uint16_t numOfElements, uint16_t lengthPerElement);
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_PutN
+//--------------------------------------------------------------------------------------------------
+//! \brief	Puts up to num elements into the queue, producer only.
+//!
+//! \attention Elements that do not fit are dropped, the caller sees it from the return value.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	pElements			input	Pointer to the first element
+//! \param	num					input	Number of elements
+//!
+//! \return	Number of elements put
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC uint16_t RB_QUEUE_PutN(RB_QUEUE_tSpscQueue* pQueue, const void* pElements, uint16_t num);
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_GetN
+//--------------------------------------------------------------------------------------------------
+//! \brief	Gets up to num elements from the queue, consumer only.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	pElements			output	Pointer to the destination of the elements
+//! \param	num					input	Maximum number of elements
+//!
+//! \return	Number of elements copied to pElements
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC uint16_t RB_QUEUE_GetN(RB_QUEUE_tSpscQueue* pQueue, void* pElements, uint16_t num);
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_PeekWrite
+//--------------------------------------------------------------------------------------------------
+//! \brief	Contiguous free space of the queue, producer only.
+//!
+//! The producer writes the elements in place, e.g. with a DMA, and publishes them with
+//! RB_QUEUE_CommitWrite(). At the end of the buffer the span stops, the rest of the free space
+//! is returned by the next call.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	pNum				output	Number of elements that can be written at the returned address
+//!
+//! \return	Address of the first free element
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC void* RB_QUEUE_PeekWrite(RB_QUEUE_tSpscQueue* pQueue, uint16_t* pNum);
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_CommitWrite
+//--------------------------------------------------------------------------------------------------
+//! \brief	Publish elements written in place after RB_QUEUE_PeekWrite(), producer only.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	num					input	Number of elements written, not more than returned by RB_QUEUE_PeekWrite()
+//!
+//! \return	none
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC void RB_QUEUE_CommitWrite(RB_QUEUE_tSpscQueue* pQueue, uint16_t num);
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_PeekRead
+//--------------------------------------------------------------------------------------------------
+//! \brief	Contiguous elements in the queue, consumer only.
+//!
+//! The consumer reads the elements in place and frees them with RB_QUEUE_CommitRead(). At the end
+//! of the buffer the span stops, the rest of the elements is returned by the next call.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	pNum				output	Number of elements at the returned address
+//!
+//! \return	Address of the first element
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC const void* RB_QUEUE_PeekRead(RB_QUEUE_tSpscQueue* pQueue, uint16_t* pNum);
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_CommitRead
+//--------------------------------------------------------------------------------------------------
+//! \brief	Free elements read in place after RB_QUEUE_PeekRead(), consumer only.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//! \param	num					input	Number of elements read, not more than returned by RB_QUEUE_PeekRead()
+//!
+//! \return	none
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC void RB_QUEUE_CommitRead(RB_QUEUE_tSpscQueue* pQueue, uint16_t num);
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_SpscLevel
+//--------------------------------------------------------------------------------------------------
+//! \brief	Test how many elements are in the queue, exact for the consumer.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//!
+//! \return	Number of elements in queue
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC uint16_t RB_QUEUE_SpscLevel(const RB_QUEUE_tSpscQueue* pQueue);
+
+
+//--------------------------------------------------------------------------------------------------
+// RB_QUEUE_SpscFree
+//--------------------------------------------------------------------------------------------------
+//! \brief	Test how many elements can be put into the queue, exact for the producer.
+//!
+//! \param	pQueue				input	Pointer to queue data structure
+//!
+//! \return	Number of free elements in queue
+//--------------------------------------------------------------------------------------------------
+RB_DECL_FUNC uint16_t RB_QUEUE_SpscFree(const RB_QUEUE_tSpscQueue* pQueue);
+
+
 //--------------------------------------------------------------------------------------------------
 #ifdef __cplusplus
 }
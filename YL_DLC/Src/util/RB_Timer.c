@@ -11,10 +11,19 @@
 //! will overflow after approximately 136 years.
 //!
 //! The module also supports timeout handling for single or repetitive callbacks or messages.
-//! It contains two lists of timers. One list will be maintained on main level (for main level timer
-//! callback), the other list will be maintained on interrupt level (for interrupt level timer
+//! It contains two timer wheels. One wheel will be maintained on main level (for main level timer
+//! callback), the other wheel will be maintained on interrupt level (for interrupt level timer
 //! callback or event messages).
 //!
+//! Each wheel is hierarchical: TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots, a slot of
+//! level n covers TIMER_WHEEL_SLOTS^n ticks. A timer is linked into the slot of its expiration tick
+//! on the lowest level that reaches it. Every TIMER_WHEEL_SLOTS ticks the next slot of the level
+//! above is moved down (cascaded). The handling of a tick does not depend on the number of pending
+//! timers, a timer within TIMER_WHEEL_MAX_TICKS is cascaded at most TIMER_WHEEL_LEVELS - 1 times.
+//! Setting and canceling a timer unlinks it through ppPrev, without a list walk. A linked element
+//! carries a check value of its own address in link, so an element that has never been used needs
+//! no initialization, as with the timer lists before.
+//!
 //! Generally the timers can be manipulated (i.e. calling the functions RB_TIMER_SetTimeout,
 //! RB_TIMER_SetTimeoutMessage, RB_TIMER_CancelTimeout) from main or interrupt level, but there are
 //! some restrictions:
@@ -52,14 +61,18 @@
 // This module is mandatory and has no RB_CONFIG_USE, no check is needed here.
 
 #include "RB_Config.h"
-#include "RB_Ticker.h"
+#include "main.h"		// delay_us() of RB_BusyWaitMicroSeconds, RB_Ticker.h is not used in this project
 
 
 //==================================================================================================
 //  L O C A L   D E F I N I T I O N S
 //==================================================================================================
 
-//! Check RB_CONFIG_TICKER_TICKS_PER_SEC is in range 50..1000 is alread done by RB_Ticker.h
+//! Check RB_CONFIG_TICKER_TICKS_PER_SEC is in range 50..1000
+#if (RB_CONFIG_TICKER_TICKS_PER_SEC < 50) || (RB_CONFIG_TICKER_TICKS_PER_SEC > 1000)
+	#error RB_CONFIG_TICKER_TICKS_PER_SEC must be in range 50..1000
+#endif
+
 //! Check if RB_CONFIG_TICKER_TICKS_PER_SEC results in a natural number of milliseconds. As a result
 //! of this check, only values 1000, 500, 250, 200, 125, 100 or 50 are valid.
 #if ((1000 / RB_CONFIG_TICKER_TICKS_PER_SEC) * RB_CONFIG_TICKER_TICKS_PER_SEC) != 1000
@@ -69,20 +82,51 @@
 //! Time of one tick in ms
 #define MILLISECONDS_PER_TICK		(1000UL / (uint32_t)RB_CONFIG_TICKER_TICKS_PER_SEC)
 
+//! Number of bits of the slot index of one wheel level. The wheels take
+//! 2 * TIMER_WHEEL_LEVELS * 2^RB_CONFIG_TIMER_WHEEL_BITS pointers of RAM.
+#if !defined(RB_CONFIG_TIMER_WHEEL_BITS)
+	#define RB_CONFIG_TIMER_WHEEL_BITS	5
+#endif
+
+#if (RB_CONFIG_TIMER_WHEEL_BITS < 2) || (RB_CONFIG_TIMER_WHEEL_BITS > 7)
+	#error RB_CONFIG_TIMER_WHEEL_BITS must be in range 2..7
+#endif
+
+//! Levels of a wheel
+#define TIMER_WHEEL_LEVELS			4
+//! Slots of a wheel level
+#define TIMER_WHEEL_SLOTS			(1UL << RB_CONFIG_TIMER_WHEEL_BITS)
+//! Mask of the slot index
+#define TIMER_WHEEL_MASK			(TIMER_WHEEL_SLOTS - 1UL)
+//! Ticks reached by the wheel, timers expiring later are placed at the end and cascaded again
+#define TIMER_WHEEL_MAX_TICKS		((1UL << (TIMER_WHEEL_LEVELS * RB_CONFIG_TIMER_WHEEL_BITS)) - 1UL)
+//! RB_TIMER_tElement.link of a linked element, garbage or a copy of another element does not match
+#define TIMER_LINK_CHECK(pElement)	((uint32_t)(uintptr_t)(pElement) ^ 0x5AC3E10FuL)
+
+//! Hierarchical timer wheel
+typedef struct
+{
+	RB_TIMER_tElement*	pSlot[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];	//!< Pending timers
+	uint32_t			nextTick;										//!< Next tick to handle
+} tTimerWheel;
+
 
 //==================================================================================================
 //  L O C A L   V A R I A B L E S
 //==================================================================================================
 
-//! List of pending timers on interrupt level
-static RB_TIMER_tElement* pIntTimerList = NULL;
+//! Pending timers on interrupt level
+static tTimerWheel intWheel = { { { NULL } }, 1uL };
 //! List of expired timers on interrupt level
 static RB_TIMER_tElement* pIntExpList = NULL;
-//! List of pending timers on main level
-static RB_TIMER_tElement* pMainTimerList = NULL;
+//! Pending timers on main level
+static tTimerWheel mainWheel = { { { NULL } }, 1uL };
 //! List of expired timers on main level
 static RB_TIMER_tElement* pMainExpList = NULL;
 
+//! Tick counter, the expiration of the timers is given in ticks
+static volatile uint32_t tickCount = (uint32_t)0;
+
 //! Millisecond counter that counts up after power up and will overflow after approximately 49 days
 static volatile uint32_t millisecondCount = (uint32_t)0;
 
@@ -99,18 +143,17 @@ static const RB_TIMER_tElement* pActiveIntTimer = NULL;
 //! true, when callback function under interrupt is executed, used in RB_TIMER_GetTimerElement
 static bool interruptActive = false;
 
-//! Milliseconds of last execution of this function
-static uint32_t lastMillisecondsOfExecCallback = (uint32_t)0;
-
 
 //==================================================================================================
 //  F O R W A R D   D E C L A R A T I O N S
 //==================================================================================================
 
-static void AddTimerToIntTimerList(RB_TIMER_tElement* pTimerElement);
-static void AddTimerToMainTimerList(RB_TIMER_tElement* pTimerElement);
-static bool RemoveTimerFromIntTimerList(const RB_TIMER_tElement* pTimerElement);
-static bool RemoveTimerFromMainTimerList(const RB_TIMER_tElement* pTimerElement);
+static void LinkTimer(RB_TIMER_tElement** ppList, RB_TIMER_tElement* pTimerElement);
+static void UnlinkTimer(RB_TIMER_tElement* pTimerElement);
+static bool IsTimerLinked(const RB_TIMER_tElement* pTimerElement);
+static void AddTimerToWheel(tTimerWheel* pWheel, RB_TIMER_tElement* pTimerElement);
+static void ArmTimer(tTimerWheel* pWheel, RB_TIMER_tElement* pTimerElement, uint32_t milliseconds);
+static void HandleWheelTick(tTimerWheel* pWheel, RB_TIMER_tElement** ppExpList);
 
 
 //==================================================================================================
@@ -175,30 +218,24 @@ bool RB_TIMER_SetTimeout(RB_TIMER_tElement* pTimerElement,
 
 	// Fill timer element
 	pTimerElement->ptr.pCallback = pCallbackFunction;
-	pTimerElement->milliseconds = milliseconds;
 	pTimerElement->period = ((periodic) ? milliseconds : 0uL);
 
+	// Add element to the wheel (needs critical section)
+	RB_ENTER_CRITICAL_SECTION;
 	if (execOnTimeoutInterrupt)
 	{
 		pTimerElement->type = RB_TIMER_CALLBACK_INT;
-		AddTimerToIntTimerList(pTimerElement);
+		ArmTimer(&intWheel, pTimerElement, milliseconds);
 	}
 	else
 	{
-		// Correct time by the elapsed time since last execution of RB_TIMER_ExecuteCallbackOnTimeout.
-		// This correction is needed only for main timer when a task has taken a long time to execute
-		// before setting the timeout.
-		// No correction is needed for interrupt timer since they are handled each ticker interval.
-		uint32_t correction = millisecondCount - lastMillisecondsOfExecCallback;
-		if (correction != 0)
-		{
-			if (pTimerElement->milliseconds <= (UINT32_MAX - correction)) // prevent overflow
-				pTimerElement->milliseconds += correction;
-		}
-
+		// The expiration is counted from the current tick, not from the last execution of
+		// RB_TIMER_ExecuteCallbackOnTimeout. So a task that has taken a long time to execute before
+		// setting the timeout does not shorten it.
 		pTimerElement->type = RB_TIMER_CALLBACK_MAIN;
-		AddTimerToMainTimerList(pTimerElement);
+		ArmTimer(&mainWheel, pTimerElement, milliseconds);
 	}
+	RB_LEAVE_CRITICAL_SECTION;
 
 	return (true);
 }
@@ -239,14 +276,15 @@ bool RB_TIMER_SetTimeoutMessage(RB_TIMER_tElement* pTimerElement,
 		milliseconds = MILLISECONDS_PER_TICK; // Correct times below minimum
 
 	// Fill timer element
-	pTimerElement->milliseconds = milliseconds;
 	pTimerElement->period = ((periodic) ? milliseconds : 0uL);
 	pTimerElement->type = RB_TIMER_MESSAGE_INT;
 	pTimerElement->ptr.pMsgQueue = pMsgQueue;
 	pTimerElement->message.src = source;
 	pTimerElement->message.evt = event;
 
-	AddTimerToIntTimerList(pTimerElement);
+	RB_ENTER_CRITICAL_SECTION;
+	ArmTimer(&intWheel, pTimerElement, milliseconds);
+	RB_LEAVE_CRITICAL_SECTION;
 
 	return (true);
 }
@@ -274,19 +312,19 @@ bool RB_TIMER_CancelTimeout(RB_TIMER_tElement* pTimerElement)
 	if (pTimerElement == NULL)
 		return(false);
 
-	// Prevent any additional actions on this timer
+	// Prevent any additional actions on this timer and remove it from the wheel or the expired list.
+	// The element may never have been used, ppPrev is trusted only with a valid link check.
 	RB_ENTER_CRITICAL_SECTION;
+	ret = IsTimerLinked(pTimerElement);
+	if (ret)
+		UnlinkTimer(pTimerElement);
+	else
+		pTimerElement->ppPrev = NULL; // Initialize an element used the first time
 	pTimerElement->milliseconds = 0;
 	pTimerElement->period = 0;
 	pTimerElement->ptr.pCallback = NULL;
 	pTimerElement->ptr.pMsgQueue = NULL;
 	RB_LEAVE_CRITICAL_SECTION;
-
-	// Remove from lists. CancelTimeout may also be called with uninitialized or corrupted timer
-	// elements. Since no data of timer element is valid, the element must be removed from both lists.
-	ret = RemoveTimerFromIntTimerList(pTimerElement);
-	if (!ret)
-		ret = RemoveTimerFromMainTimerList(pTimerElement);
 	return(ret);
 }
 
@@ -308,69 +346,50 @@ bool RB_TIMER_CancelTimeout(RB_TIMER_tElement* pTimerElement)
 void RB_TIMER_ExecuteCallbackOnTimeout(void)
 {
 	RB_TIMER_tElement* pMainTimer = NULL;
-	RB_TIMER_tElement* pMainPrev = NULL;
-	uint32_t milliseconds = millisecondCount; // Copy volatile timer once
-	uint32_t delta; // Time since last call
-
-	// Calculate the amount of time that elapsed since the last execution of this function.
-	delta = milliseconds - lastMillisecondsOfExecCallback;
-	lastMillisecondsOfExecCallback = milliseconds;
+	uint32_t ticks = tickCount; // Copy volatile counter once
 
-	// Check if walk through timer list is needed
-	if (delta == 0)
-		return; // Execute only once when millisecondCount has changed
+	// Check if the wheel has to be handled
+	if (mainWheel.nextTick == ticks + 1uL)
+		return; // Execute only once when tickCount has changed
 
-	// Handle main timers (needs critical section for list manipulation by interrupts)
-	RB_ENTER_CRITICAL_SECTION;
-	pMainTimer = pMainTimerList;
-	// Phase 1: Decrement all main timers by delta and remove them from list if expired
-	while (pMainTimer)
+	// Phase 1: Handle all ticks since the last execution, expired timers are moved to the expired
+	// list (needs critical section for wheel manipulation by interrupts)
+	while (mainWheel.nextTick != ticks + 1uL)
 	{
-		if (pMainTimer->milliseconds > delta)
-		{
-			// Non-expired timers:
-			pMainTimer->milliseconds -= delta; // Does not expire
-			pMainPrev = pMainTimer;
-			pMainTimer = pMainTimer->pNext; // Step to next element
-			continue;
-		}
-
-		// Expired timers: Remove from list, add to expired list
-		pMainTimer->milliseconds = 0uL;
-		if (pMainPrev)
-			pMainPrev->pNext = pMainTimer->pNext;
-		else
-			pMainTimerList = pMainTimer->pNext;
-		pMainTimer->pExpNext = pMainExpList; // Use alternate next pointer
-		pMainExpList = pMainTimer;
-		pMainTimer = pMainTimer->pNext; // Step to next element
+		RB_ENTER_CRITICAL_SECTION;
+		HandleWheelTick(&mainWheel, &pMainExpList);
+		RB_LEAVE_CRITICAL_SECTION;
 	}
-	RB_LEAVE_CRITICAL_SECTION;
 
-	// Phase 2: Walk through the expired list and execute callbacks
-	while (pMainExpList)
+	// Phase 2: Take the expired timers one by one and execute callbacks. A callback may cancel
+	// other expired timers, they are removed from the expired list by RB_TIMER_CancelTimeout.
+	for (;;)
 	{
-		RB_tCallback callback = pMainExpList->ptr.pCallback;
-		// Check for periodic: Re-attach to main timer list
-		if (pMainExpList->period)
+		RB_tCallback callback;
+
+		RB_ENTER_CRITICAL_SECTION;
+		pMainTimer = pMainExpList;
+		if (pMainTimer)
 		{
-			pMainExpList->milliseconds = pMainExpList->period; // reload timer
-			pMainExpList->pNext = pMainTimerList; // Prepends main timer list
-			pMainTimerList = pMainExpList;
+			UnlinkTimer(pMainTimer);
+			// Check for periodic: Re-attach to main timer wheel
+			if (pMainTimer->period)
+				ArmTimer(&mainWheel, pMainTimer, pMainTimer->period);
+			else
+				pMainTimer->milliseconds = 0uL;
 		}
+		RB_LEAVE_CRITICAL_SECTION;
+
+		if (pMainTimer == NULL)
+			break;
 
-		pActiveMainTimer = pMainExpList;	// used in RB_TIMER_GetTimerElement()
+		callback = pMainTimer->ptr.pCallback;
+		pActiveMainTimer = pMainTimer;	// used in RB_TIMER_GetTimerElement()
 		// Call callback function
 		if (callback)
 		{
 			callback();
 		}
-		// Step to next timer. If pMainExpList is not the same as the active timer, then the
-		// active timer was canceled during the callback and the list is already updated.
-		if (pMainExpList == pActiveMainTimer)
-		{
-			pMainExpList = pMainExpList->pExpNext;
-		}
 		pActiveMainTimer = NULL;
 	}
 }
@@ -392,8 +411,7 @@ void RB_TIMER_ExecuteCallbackOnTimeout(void)
 //--------------------------------------------------------------------------------------------------
 void RB_TIMER_Ticker(void)
 {
-	RB_TIMER_tElement* pIntTimer = pIntTimerList;
-	RB_TIMER_tElement* pIntPrev = NULL;
+	RB_TIMER_tElement* pIntTimer = NULL;
 
 	// Handle milliseconds and seconds counter
 	millisecondCount += MILLISECONDS_PER_TICK;
@@ -403,65 +421,41 @@ void RB_TIMER_Ticker(void)
 		secondPrescaler -= 1000uL;
 		secondCount++;
 	}
+	tickCount++;
 
 	// Handle interrupt timers
-	// Phase 1: Decrement all interrupt timers by MILLISECONDS_PER_TICK and remove them from list if expired
-	while (pIntTimer)
-	{
-		if (pIntTimer->milliseconds > MILLISECONDS_PER_TICK)
-		{
-			// Non-expired timers:
-			pIntTimer->milliseconds -= MILLISECONDS_PER_TICK; // Does not expire
-			pIntPrev = pIntTimer;
-			pIntTimer = pIntTimer->pNext; // Step to next element
-			continue;
-		}
+	// Phase 1: Advance the interrupt timer wheel by one tick, expired timers are moved to the expired list
+	HandleWheelTick(&intWheel, &pIntExpList);
 
-		// Expired timers: Remove from list, add to expired list
-		pIntTimer->milliseconds = 0uL;
-		if (pIntPrev)
-			pIntPrev->pNext = pIntTimer->pNext; // Remove intermediate element
-		else
-			pIntTimerList = pIntTimer->pNext; // Remove first element
-		pIntTimer->pExpNext = pIntExpList; // Use alternate next pointer
-		pIntExpList = pIntTimer;
-		pIntTimer = pIntTimer->pNext;
-	}
-
-	// Phase 2: Walk through the expired list and execute callbacks or send messages
+	// Phase 2: Take the expired timers one by one and execute callbacks or send messages
 	while (pIntExpList)
 	{
-		RB_tCallback callback = pIntExpList->ptr.pCallback;
-		if (pIntExpList->period)
-		{
-			pIntExpList->milliseconds = pIntExpList->period; // reload timer
-			pIntExpList->pNext = pIntTimerList; // Prepends interrupt timer list
-			pIntTimerList = pIntExpList;
-		}
+		RB_tCallback callback;
+
+		pIntTimer = pIntExpList;
+		callback = pIntTimer->ptr.pCallback;
+		UnlinkTimer(pIntTimer);
+		if (pIntTimer->period)
+			ArmTimer(&intWheel, pIntTimer, pIntTimer->period); // reload timer
+		else
+			pIntTimer->milliseconds = 0uL;
 
 		// Send Message or call callback
-		if (pIntExpList->type == RB_TIMER_MESSAGE_INT)
+		if (pIntTimer->type == RB_TIMER_MESSAGE_INT)
 		{
 			// Send message
-			if (pIntExpList->ptr.pMsgQueue)
-				RB_OS_MsgQueuePost(pIntExpList->ptr.pMsgQueue, &pIntExpList->message);
-			pIntExpList = pIntExpList->pExpNext;
+			if (pIntTimer->ptr.pMsgQueue)
+				RB_OS_MsgQueuePost(pIntTimer->ptr.pMsgQueue, &pIntTimer->message);
 		}
 		else
 		{
-			interruptActive = true;						// used in RB_TIMER_GetTimerElement()
-			pActiveIntTimer = pIntExpList;	// used in RB_TIMER_GetTimerElement()
+			interruptActive = true;			// used in RB_TIMER_GetTimerElement()
+			pActiveIntTimer = pIntTimer;	// used in RB_TIMER_GetTimerElement()
 			// Call callback function
 			if (callback)
 			{
 				callback();
 			}
-			// Step to next timer. If pIntExpList is not the same as the active timer, then
-			// the active timer was canceled during the callback and the list is already updated.
-			if (pIntExpList == pActiveIntTimer)
-			{
-				pIntExpList = pIntExpList->pExpNext;
-			}
 			pActiveIntTimer = NULL;
 			interruptActive = false;
 		}
@@ -546,146 +540,172 @@ void RB_TIMER_BusyDelay(uint32_t ms)
 //==================================================================================================
 
 //--------------------------------------------------------------------------------------------------
-// AddTimerToIntTimerList
+// LinkTimer
 //--------------------------------------------------------------------------------------------------
-//! \brief	Add timer to interrupt list
+//! \brief	Add timer as first element of a wheel slot or an expired list
 //!
-//! \param		pTimerElement	Timer list element
+//! \param		ppList			List head
+//! \param		pTimerElement	Timer list element, not linked
 //--------------------------------------------------------------------------------------------------
-static void AddTimerToIntTimerList(RB_TIMER_tElement* pTimerElement)
+static void LinkTimer(RB_TIMER_tElement** ppList, RB_TIMER_tElement* pTimerElement)
 {
-	// Add element to interrupt timer list as first element (needs critical section)
-	// Note: If corrections are made also correct in AddTimerToMainTimerList
-	RB_ENTER_CRITICAL_SECTION;
-	pTimerElement->pNext = pIntTimerList;
-	pIntTimerList = pTimerElement;
-	RB_LEAVE_CRITICAL_SECTION;
+	pTimerElement->pNext = *ppList;
+	if (*ppList)
+		(*ppList)->ppPrev = &pTimerElement->pNext;
+	*ppList = pTimerElement;
+	pTimerElement->ppPrev = ppList;
+	pTimerElement->link = TIMER_LINK_CHECK(pTimerElement);
 }
 
 
 //--------------------------------------------------------------------------------------------------
-// AddTimerToMainTimerList
+// UnlinkTimer
 //--------------------------------------------------------------------------------------------------
-//! \brief	Add timer to main list
+//! \brief	Remove timer from the wheel slot or the expired list it is linked into
 //!
-//! \param		pTimerElement	Timer list element
+//! ppPrev points to the list head or to pNext of the previous element, no list walk is needed.
+//!
+//! \param		pTimerElement	Timer list element, linked or ppPrev NULL
 //--------------------------------------------------------------------------------------------------
-static void AddTimerToMainTimerList(RB_TIMER_tElement* pTimerElement)
+static void UnlinkTimer(RB_TIMER_tElement* pTimerElement)
 {
-	// Add element to main timer list as first element (needs critical section)
-	// Note: If corrections are made also correct in AddTimerToIntTimerList
-	RB_ENTER_CRITICAL_SECTION;
-	pTimerElement->pNext = pMainTimerList;
-	pMainTimerList = pTimerElement;
-	RB_LEAVE_CRITICAL_SECTION;
+	if (pTimerElement->ppPrev == NULL)
+		return; // Not linked
+
+	*pTimerElement->ppPrev = pTimerElement->pNext;
+	if (pTimerElement->pNext)
+		pTimerElement->pNext->ppPrev = pTimerElement->ppPrev;
+	pTimerElement->pNext = NULL;
+	pTimerElement->ppPrev = NULL;
+	pTimerElement->link = 0uL;
 }
 
 
 //--------------------------------------------------------------------------------------------------
-// RemoveTimerFromIntTimerList
+// IsTimerLinked
 //--------------------------------------------------------------------------------------------------
-//! \brief	Remove timer from interrupt list
+//! \brief	Check whether a timer is linked into a wheel slot or an expired list
 //!
-//! \param		pTimerElement	Timer list element
-//! \return		true if remove was successful (timer found in list)
+//! An element that has never been set is not initialized, its pointers must not be used before its
+//! link check matches. ppPrev of a linked element points to it.
+//!
+//! \param		pTimerElement	Timer list element, any content
+//! \return		true if linked, ppPrev is valid
 //--------------------------------------------------------------------------------------------------
-static bool RemoveTimerFromIntTimerList(const RB_TIMER_tElement* pTimerElement)
+static bool IsTimerLinked(const RB_TIMER_tElement* pTimerElement)
 {
-	// Note: If corrections are made also correct in RemoveTimerFromMainTimerList
-	bool ret = false;
-	RB_TIMER_tElement* pT;
-	RB_TIMER_tElement* pPrev;
-	RB_ENTER_CRITICAL_SECTION;
-	// Remove from pending timer list
-	pT = pIntTimerList;
-	pPrev = NULL;
-	while (pT)
+	if (pTimerElement->link != TIMER_LINK_CHECK(pTimerElement))
+		return false;
+	return ((pTimerElement->ppPrev != NULL) && (*pTimerElement->ppPrev == pTimerElement));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// AddTimerToWheel
+//--------------------------------------------------------------------------------------------------
+//! \brief	Link timer into the slot of its expiration tick
+//!
+//! The lowest level that reaches the expiration tick is used. Timers expiring after
+//! TIMER_WHEEL_MAX_TICKS are placed at the end of the wheel and cascaded again from there.
+//!
+//! \param		pWheel			Timer wheel
+//! \param		pTimerElement	Timer list element, not linked, expiry not before pWheel->nextTick
+//--------------------------------------------------------------------------------------------------
+static void AddTimerToWheel(tTimerWheel* pWheel, RB_TIMER_tElement* pTimerElement)
+{
+	uint32_t expiry = pTimerElement->expiry;
+	uint32_t delta = expiry - pWheel->nextTick;
+	uint32_t level;
+	uint32_t slot;
+
+	if (delta > TIMER_WHEEL_MAX_TICKS)
 	{
-		if (pT == pTimerElement)
-		{
-			if (pPrev)
-				pPrev->pNext = pT->pNext; // Remove intermediate element
-			else
-				pIntTimerList = pT->pNext; // Remove first element
-			ret = true;
-			break; // leave loop
-		}
-		pPrev = pT;
-		pT = pT->pNext;
+		delta = TIMER_WHEEL_MAX_TICKS;
+		expiry = pWheel->nextTick + TIMER_WHEEL_MAX_TICKS;
 	}
-	// Remove from expired timer list
-	pT = pIntExpList;
-	pPrev = NULL;
-	while (pT)
+
+	for (level = 0; level < (TIMER_WHEEL_LEVELS - 1); level++)
 	{
-		if (pT == pTimerElement)
-		{
-			if (pPrev)
-				pPrev->pExpNext = pT->pExpNext; // Remove intermediate element
-			else
-				pIntExpList = pT->pExpNext; // Remove first element
-			ret = true;
-			break; // leave loop
-		}
-		pPrev = pT;
-		pT = pT->pExpNext;
+		if (delta < (1UL << ((level + 1) * RB_CONFIG_TIMER_WHEEL_BITS)))
+			break;
 	}
-	RB_LEAVE_CRITICAL_SECTION;
-	return(ret);
+	slot = (expiry >> (level * RB_CONFIG_TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK;
+	LinkTimer(&pWheel->pSlot[level][slot], pTimerElement);
 }
 
 
 //--------------------------------------------------------------------------------------------------
-// RemoveTimerFromMainTimerList
+// ArmTimer
 //--------------------------------------------------------------------------------------------------
-//! \brief	Remove timer from main list
+//! \brief	Start a timer, the caller ensures the critical section
 //!
-//! \param		pTimerElement	Timer list element
-//! \return		true if remove was successful (timer found in list)
+//! The timer expires with the tick after the given time has elapsed, counted from the current tick.
+//!
+//! \param		pWheel			Timer wheel
+//! \param		pTimerElement	Timer list element, not linked
+//! \param		milliseconds	Timeout time, at least MILLISECONDS_PER_TICK
 //--------------------------------------------------------------------------------------------------
-static bool RemoveTimerFromMainTimerList(const RB_TIMER_tElement* pTimerElement)
+static void ArmTimer(tTimerWheel* pWheel, RB_TIMER_tElement* pTimerElement, uint32_t milliseconds)
 {
-	// Note: If corrections are made also correct in RemoveTimerFromIntTimerList
-	bool ret = false;
+	uint32_t ticks = milliseconds / MILLISECONDS_PER_TICK;
+
+	if ((milliseconds % MILLISECONDS_PER_TICK) != 0)
+		ticks++;
+	pTimerElement->milliseconds = milliseconds;
+	pTimerElement->expiry = tickCount + ticks;
+	AddTimerToWheel(pWheel, pTimerElement);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// HandleWheelTick
+//--------------------------------------------------------------------------------------------------
+//! \brief	Handle the next tick of a wheel
+//!
+//! At the start of a revolution of level n the next slot of level n + 1 is cascaded, i.e. its
+//! timers are linked again into the lower levels. Then all timers of the level 0 slot of the tick
+//! expire and are moved to the expired list. The caller ensures the critical section.
+//!
+//! \param		pWheel			Timer wheel
+//! \param		ppExpList		Expired list
+//--------------------------------------------------------------------------------------------------
+static void HandleWheelTick(tTimerWheel* pWheel, RB_TIMER_tElement** ppExpList)
+{
+	uint32_t tick = pWheel->nextTick;
+	uint32_t level;
+	uint32_t slot;
+	RB_TIMER_tElement* pList;
 	RB_TIMER_tElement* pT;
-	RB_TIMER_tElement* pPrev;
-	RB_ENTER_CRITICAL_SECTION;
-	// Remove from pending timer list
-	pT = pMainTimerList;
-	pPrev = NULL;
-	while (pT)
+
+	// Cascade the levels whose lower level starts a new revolution
+	for (level = 1; level < TIMER_WHEEL_LEVELS; level++)
 	{
-		if (pT == pTimerElement)
+		if (((tick >> ((level - 1) * RB_CONFIG_TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK) != 0)
+			break;
+		slot = (tick >> (level * RB_CONFIG_TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK;
+		// Detach the slot first, timers placed at the end of the wheel may come back to it
+		pList = pWheel->pSlot[level][slot];
+		pWheel->pSlot[level][slot] = NULL;
+		while (pList)
 		{
-			if (pPrev)
-				pPrev->pNext = pT->pNext; // Remove intermediate element
-			else
-				pMainTimerList = pT->pNext; // Remove first element
-			ret = true;
-			break; // leave loop
+			pT = pList;
+			pList = pT->pNext;
+			AddTimerToWheel(pWheel, pT);
 		}
-		pPrev = pT;
-		pT = pT->pNext;
 	}
-	// Remove from expired timer list
-	pT = pMainExpList;
-	pPrev = NULL;
-	while (pT)
+
+	// Expire the level 0 slot
+	slot = tick & TIMER_WHEEL_MASK;
+	pList = pWheel->pSlot[0][slot];
+	pWheel->pSlot[0][slot] = NULL;
+	while (pList)
 	{
-		if (pT == pTimerElement)
-		{
-			if (pPrev)
-				pPrev->pExpNext = pT->pExpNext; // Remove intermediate element
-			else
-				pMainExpList = pT->pExpNext; // Remove first element
-			ret = true;
-			break; // leave loop
-		}
-		pPrev = pT;
-		pT = pT->pExpNext;
+		pT = pList;
+		pList = pT->pNext;
+		LinkTimer(ppExpList, pT);
 	}
-	RB_LEAVE_CRITICAL_SECTION;
-	return(ret);
+
+	pWheel->nextTick = tick + 1uL;
 }
 
 
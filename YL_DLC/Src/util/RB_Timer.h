@@ -11,9 +11,10 @@
 //! will overflow after approximately 136 years.
 //!
 //! The module also supports timeout handling for single or repetitive callbacks or messages.
-//! It contains two lists of timers. One list will be maintained on main level (for main level timer
-//! callback), the other list will be maintained on interrupt level (for interrupt level timer
-//! callback or event messages).
+//! It contains two timer wheels. One wheel will be maintained on main level (for main level timer
+//! callback), the other wheel will be maintained on interrupt level (for interrupt level timer
+//! callback or event messages). A timer is linked into the wheel slot of its expiration, expiring
+//! it does not depend on the number of pending timers, setting and canceling it unlinks it directly.
 //!
 //! Generally the timers can be manipulated (i.e. calling the functions RB_TIMER_SetTimeout,
 //! RB_TIMER_SetTimeoutMessage, RB_TIMER_CancelTimeout) from main or interrupt level, but there are
@@ -77,10 +78,12 @@ typedef enum {
 typedef struct _RB_TIMER_tElement
 {
 	RB_TIMER_tTimeoutType			type;			//!< Type: Callback | Message, Interrupt | Main
-	uint32_t						milliseconds;	//!< Count will be decremented each timer interrupt
-	uint32_t						period;			//!< Constant to reload count if periodic
-	struct _RB_TIMER_tElement*		pNext;			//!< Address of next timer list element
-	struct _RB_TIMER_tElement*		pExpNext;		//!< Address of next timer expired list element
+	uint32_t						milliseconds;	//!< Timeout time, 0 when not pending
+	uint32_t						period;			//!< Constant to reload timeout if periodic
+	uint32_t						expiry;			//!< Tick of the expiration
+	struct _RB_TIMER_tElement*		pNext;			//!< Address of next element in wheel slot or expired list
+	struct _RB_TIMER_tElement**		ppPrev;			//!< Address of the pointer to this element, valid while linked
+	uint32_t						link;			//!< Check value of the element address while linked
 	union {
 		RB_tCallback				pCallback;		//!< Address of callback function
 		RB_OS_tMsgQueue*			pMsgQueue;		//!< Address of message queue